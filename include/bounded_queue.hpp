@@ -0,0 +1,169 @@
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <thread>
+
+#if defined(__x86_64__) || defined(_M_X64) || defined(__i386__) || defined(_M_IX86)
+    #include <immintrin.h>
+#endif
+
+namespace converter {
+
+/**
+ * Bounded lock-free ring buffer
+ *
+ * Array-based queue with a sequence counter per cell (D. Vyukov's bounded
+ * MPMC design). Producers and consumers never take a lock; each side claims a
+ * cell with a single CAS on its own cache line.
+ *
+ * The pipeline mostly uses it as SPSC/MPSC, but because any thread may pop,
+ * a producer can also evict the oldest item itself (drop-oldest policy).
+ *
+ * T must be cheap to move (the pipeline passes pointers to pooled buffers).
+ */
+template <typename T>
+class BoundedQueue {
+public:
+    /**
+     * Constructor
+     * @param capacity Maximum number of items (rounded up to a power of two)
+     */
+    explicit BoundedQueue(size_t capacity)
+    {
+        size_t size = 2;
+        while (size < capacity) {
+            size <<= 1;
+        }
+        mask_ = size - 1;
+        cells_ = std::make_unique<Cell[]>(size);
+        for (size_t i = 0; i < size; i++) {
+            cells_[i].sequence.store(i, std::memory_order_relaxed);
+        }
+    }
+
+    // Disable copy and move (threads hold references)
+    BoundedQueue(const BoundedQueue&) = delete;
+    BoundedQueue& operator=(const BoundedQueue&) = delete;
+
+    /**
+     * Push an item if there is room
+     * @param item Item to push (moved from on success)
+     * @return true if pushed, false if the queue is full
+     */
+    bool tryPush(T& item)
+    {
+        size_t pos = enqueue_pos_.load(std::memory_order_relaxed);
+        for (;;) {
+            Cell& cell = cells_[pos & mask_];
+            size_t seq = cell.sequence.load(std::memory_order_acquire);
+            intptr_t diff = static_cast<intptr_t>(seq) - static_cast<intptr_t>(pos);
+
+            if (diff == 0) {
+                if (enqueue_pos_.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed)) {
+                    cell.value = std::move(item);
+                    cell.sequence.store(pos + 1, std::memory_order_release);
+                    return true;
+                }
+            } else if (diff < 0) {
+                return false;  // Full
+            } else {
+                pos = enqueue_pos_.load(std::memory_order_relaxed);
+            }
+        }
+    }
+
+    /**
+     * Pop the oldest item if there is one
+     * @param item Output item
+     * @return true if popped, false if the queue is empty
+     */
+    bool tryPop(T& item)
+    {
+        size_t pos = dequeue_pos_.load(std::memory_order_relaxed);
+        for (;;) {
+            Cell& cell = cells_[pos & mask_];
+            size_t seq = cell.sequence.load(std::memory_order_acquire);
+            intptr_t diff = static_cast<intptr_t>(seq) - static_cast<intptr_t>(pos + 1);
+
+            if (diff == 0) {
+                if (dequeue_pos_.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed)) {
+                    item = std::move(cell.value);
+                    cell.sequence.store(pos + mask_ + 1, std::memory_order_release);
+                    return true;
+                }
+            } else if (diff < 0) {
+                return false;  // Empty
+            } else {
+                pos = dequeue_pos_.load(std::memory_order_relaxed);
+            }
+        }
+    }
+
+    /**
+     * Get approximate number of queued items (exact only when quiescent)
+     * @return Queue depth
+     */
+    size_t sizeApprox() const
+    {
+        size_t enq = enqueue_pos_.load(std::memory_order_relaxed);
+        size_t deq = dequeue_pos_.load(std::memory_order_relaxed);
+        return enq >= deq ? enq - deq : 0;
+    }
+
+    /**
+     * Get capacity
+     * @return Maximum number of items
+     */
+    size_t capacity() const { return mask_ + 1; }
+
+private:
+    static constexpr size_t kCacheLine = 64;
+
+    struct Cell {
+        std::atomic<size_t> sequence{0};
+        T value{};
+    };
+
+    std::unique_ptr<Cell[]> cells_;
+    size_t mask_ = 0;
+
+    alignas(kCacheLine) std::atomic<size_t> enqueue_pos_{0};
+    alignas(kCacheLine) std::atomic<size_t> dequeue_pos_{0};
+};
+
+/**
+ * Spin-then-sleep wait helper for threads polling a BoundedQueue
+ *
+ * Spins briefly (cheapest when the other side is about to deliver), then
+ * yields, then sleeps in short steps so an idle stage does not burn a core.
+ */
+class QueueBackoff {
+public:
+    void wait()
+    {
+        if (count_ < kSpinLimit) {
+#if defined(__x86_64__) || defined(_M_X64) || defined(__i386__) || defined(_M_IX86)
+            _mm_pause();
+#endif
+        } else if (count_ < kYieldLimit) {
+            std::this_thread::yield();
+        } else {
+            std::this_thread::sleep_for(std::chrono::microseconds(50));
+            return;
+        }
+        count_++;
+    }
+
+    void reset() { count_ = 0; }
+
+private:
+    static constexpr int kSpinLimit = 64;
+    static constexpr int kYieldLimit = 128;
+    int count_ = 0;
+};
+
+} // namespace converter
@@ -0,0 +1,105 @@
+#pragma once
+
+#include "config.hpp"
+#include "timestamp_engine.hpp"
+#include <cstdint>
+#include <thread>
+
+namespace converter {
+
+/**
+ * What a busy-polling receiver did while its socket was empty
+ */
+struct BusyPollStats {
+    uint64_t spins = 0;         // Empty polls answered by polling again at once
+    uint64_t yields = 0;        // Empty polls that gave the core away (sched_yield) first
+    uint64_t hits = 0;          // Data that arrived while spinning, with no kernel wait
+    uint64_t waits = 0;         // Budgets used up: the receiver slept in the kernel
+};
+
+/**
+ * Spin budget of a receiver polling a non-blocking socket (ReceiveMode::BusyPoll)
+ *
+ * A receiver that finds its socket empty asks shouldSpin() before waiting on
+ * its reactor. Within busy_poll_budget_us of the first empty poll the answer
+ * is yes and the receiver polls again right away (every kYieldInterval-th
+ * time after a sched_yield, so threads sharing the core still run). Once the
+ * budget is used up it waits in the kernel as in Blocking mode. received()
+ * starts a new budget. In Blocking mode shouldSpin() is always false.
+ *
+ * Receiver thread only; the counters are read after it stops.
+ */
+class BusyPoller {
+public:
+    explicit BusyPoller(const Config& cfg)
+        : enabled_(cfg.receive_mode == ReceiveMode::BusyPoll)
+        , budget_ns_(cfg.busy_poll_budget_us * 1000)
+    {
+    }
+
+    /**
+     * Called on an empty poll
+     * @return true to poll again now, false to wait in the kernel
+     */
+    bool shouldSpin()
+    {
+        if (!enabled_) {
+            return false;
+        }
+        const int64_t now = steadyClockNs();
+        if (spin_start_ns_ == 0) {
+            spin_start_ns_ = now;
+        } else if (now - spin_start_ns_ >= budget_ns_) {
+            spin_start_ns_ = 0;
+            stats_.waits++;
+            return false;
+        }
+        if (++empty_polls_ % kYieldInterval == 0) {
+            std::this_thread::yield();
+            stats_.yields++;
+        } else {
+            stats_.spins++;
+        }
+        return true;
+    }
+
+    /**
+     * Called when a poll returned data
+     */
+    void received()
+    {
+        if (spin_start_ns_ != 0) {
+            spin_start_ns_ = 0;
+            stats_.hits++;
+        }
+    }
+
+    bool isEnabled() const { return enabled_; }
+    const BusyPollStats& getStats() const { return stats_; }
+
+private:
+    static constexpr uint64_t kYieldInterval = 64;
+
+    bool enabled_;
+    int64_t budget_ns_;
+    int64_t spin_start_ns_ = 0;     // First empty poll of the current budget, 0 = not spinning
+    uint64_t empty_polls_ = 0;
+    BusyPollStats stats_;
+};
+
+#ifdef __linux__
+/**
+ * Set a socket up for busy polling: SO_BUSY_POLL (the kernel polls the NIC
+ * queue during each receive, socket_busy_poll_us) and SO_INCOMING_CPU (the
+ * receiver's first core, if it is pinned)
+ *
+ * Only for ReceiveMode::BusyPoll; warns about each option it cannot set
+ * (raising SO_BUSY_POLL needs CAP_NET_ADMIN).
+ *
+ * @param fd Socket
+ * @param cfg Configuration (busy-poll and core settings)
+ */
+void configureBusyPoll(int fd, const Config& cfg);
+#endif
+
+} // namespace converter
@@ -0,0 +1,166 @@
+#pragma once
+
+#include "config.hpp"
+#include "pipeline.hpp"
+#include "reactor.hpp"
+#include "tcp_receiver.hpp"
+#include "udp_receiver.hpp"
+#include <atomic>
+#include <chrono>
+#include <string>
+#include <variant>
+
+namespace converter {
+
+using ReceiverVariant = std::variant<TcpReceiver, UdpReceiver>;
+
+/**
+ * One camera input: receiver, reconnect handling and its own Pipeline
+ *
+ * Each source keeps a private copy of the configuration for its camera
+ * (Config::for_camera: port, output port, cores), so several sources built
+ * from one Config run side by side without sharing any per-frame state:
+ * every camera has its own receiver thread, unpack workers, frame pool and
+ * timestamp engine. Unpacked frames reach the write callback on this
+ * camera's writer thread, in receive order.
+ *
+ * The receiver waits on the source's Reactor whenever its socket has nothing
+ * to deliver, so interrupt() (or stop()) ends a blocked accept or receive at
+ * once. After a receive failure the receiver is reconnected at once: a TCP
+ * source keeps its port listening, so that is an accept of the FPGA's next
+ * connection, which may already be waiting in the backlog. Failed attempts,
+ * and an input that fails again within reconnect_delay_ms, back off
+ * exponentially (reconnect_delay_ms doubling up to reconnect_max_delay_ms)
+ * until reconnecting works or the source is stopped.
+ *
+ * For a fast start, listen() and warmUp() can run before the outputs exist,
+ * with the write callback set later (setWriteCallback()).
+ */
+class CameraSource {
+public:
+    /**
+     * Constructor
+     * @param cfg Shared configuration
+     * @param index Camera index (into Config::cameras, 0 for a single camera)
+     * @param write Write callback (this camera's writer thread; may be set later with setWriteCallback())
+     */
+    CameraSource(const Config& cfg, size_t index, Pipeline::WriteFn write = nullptr);
+
+    /**
+     * Destructor - stops the pipeline and disconnects
+     */
+    ~CameraSource();
+
+    // Disable copy and move (the receiver and pipeline hold references to the config copy)
+    CameraSource(const CameraSource&) = delete;
+    CameraSource& operator=(const CameraSource&) = delete;
+
+    /**
+     * Open the TCP port, so the FPGA can connect before connect() is called
+     * (UDP binds in connect())
+     * @return true if listening (always true for UDP)
+     */
+    bool listen();
+
+    /**
+     * Pre-fault the pipeline's and receiver's buffers (Config::warm_start; before start())
+     * @return Bytes of buffer memory faulted in
+     */
+    size_t warmUp();
+
+    /**
+     * Connect (TCP: wait for the FPGA) or bind (UDP) the receiver
+     * @return true if the receiver is ready
+     */
+    bool connect();
+
+    /**
+     * Set the write callback (see Pipeline::setWriteCallback(); before start())
+     * @param write Write callback (this camera's writer thread)
+     */
+    void setWriteCallback(Pipeline::WriteFn write) { pipeline_.setWriteCallback(std::move(write)); }
+
+    /**
+     * Observe every received frame (see Pipeline::setReceiveTap; before start())
+     * @param tap Tap callback (this camera's receiver thread)
+     */
+    void setReceiveTap(Pipeline::TapFn tap) { pipeline_.setReceiveTap(std::move(tap)); }
+
+    /**
+     * Start the pipeline threads
+     */
+    void start();
+
+    /**
+     * Stop the pipeline threads (the receiver stays connected)
+     */
+    void stop();
+
+    /**
+     * Apply the hot-reloadable settings to the running pipeline (see Pipeline::reload())
+     *
+     * getConfig() keeps the values the camera started with.
+     *
+     * @param cfg Shared configuration with the new values
+     * @return false if a setting needs a restart
+     */
+    bool reload(const Config& cfg) { return pipeline_.reload(cfg); }
+
+    /**
+     * Make a blocked connect, receive or reconnect wait return promptly
+     * (thread-safe, async-signal-safe; start() clears it)
+     */
+    void interrupt();
+
+    /**
+     * Check if the pipeline is still running
+     * @return false once stopped or reconnecting failed
+     */
+    bool isRunning() const { return pipeline_.isRunning(); }
+
+    /**
+     * Get the camera's label
+     * @return Config::camera_name() of this camera
+     */
+    const std::string& getName() const { return name_; }
+
+    /**
+     * Get the configuration this camera runs with
+     * @return Per-camera configuration
+     */
+    const Config& getConfig() const { return config_; }
+
+    /**
+     * Get the camera's pipeline (counters, timestamp engine, buffer pool)
+     * @return Pipeline
+     */
+    const Pipeline& getPipeline() const { return pipeline_; }
+
+    /**
+     * Get the camera's receiver (protocol-specific statistics)
+     * @return TcpReceiver or UdpReceiver
+     */
+    const ReceiverVariant& getReceiver() const { return receiver_; }
+
+private:
+    /**
+     * Reconnect after a receive failure (receiver thread)
+     * @return false if stopping or the receiver could not be set up again
+     */
+    bool reconnect();
+
+    Config config_;     // Declared first: receiver and pipeline keep references to it
+    std::string name_;
+    std::atomic<bool> stopping_;
+    std::chrono::steady_clock::time_point last_reconnect_;  // Receiver thread only
+    Reactor reactor_;   // Declared before receiver_, which waits on it
+
+    // The pipeline is declared (and built) before the receiver so it is
+    // destroyed after it: a UDP receiver may keep pipeline pool slots in its
+    // reassembly window and releases them in its destructor. The pipeline
+    // only calls into receiver_ from its threads, started after both exist.
+    Pipeline pipeline_;
+    ReceiverVariant receiver_;
+};
+
+} // namespace converter
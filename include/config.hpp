@@ -1,6 +1,7 @@
 #pragma once
 
 #include <string>
+#include <vector>
 #include <cstdint>
 
 namespace converter {
@@ -24,6 +25,290 @@ inline const char* protocolToString(Protocol p) {
     }
 }
 
+/**
+ * Receive engine for the TCP input
+ */
+enum class TcpBackend {
+    Socket,     // Blocking recv() loop (all platforms)
+    IoUring     // Linux io_uring: one MSG_WAITALL receive per frame into registered pool buffers
+};
+
+/**
+ * Helper to convert TcpBackend enum to string
+ */
+inline const char* tcpBackendToString(TcpBackend b) {
+    switch (b) {
+        case TcpBackend::Socket: return "Socket";
+        case TcpBackend::IoUring: return "io_uring";
+        default: return "Unknown";
+    }
+}
+
+/**
+ * How receivers wait for data
+ */
+enum class ReceiveMode {
+    Blocking,   // Sleep in the kernel (event loop) as soon as the socket is empty
+    BusyPoll    // Low-latency profile: re-poll the socket for a spin budget first, burning a core
+};
+
+/**
+ * Helper to convert ReceiveMode enum to string
+ */
+inline const char* receiveModeToString(ReceiveMode m) {
+    switch (m) {
+        case ReceiveMode::Blocking: return "Blocking";
+        case ReceiveMode::BusyPoll: return "BusyPoll";
+        default: return "Unknown";
+    }
+}
+
+/**
+ * Unpack kernel selection
+ *
+ * Auto picks the widest instruction set supported by the running CPU.
+ * Requesting a kernel the CPU (or build) does not support falls back to Scalar.
+ */
+enum class UnpackKernel {
+    Auto,   // Runtime dispatch: AVX2 > SSE4.1 > NEON > Scalar
+    Scalar, // Portable byte-at-a-time loop
+    SSE41,  // x86 SSE4.1, 16-byte blocks
+    AVX2,   // x86 AVX2, 32-byte blocks
+    NEON,   // ARM NEON, 16-byte blocks
+    Sparse  // Portable 64-bit words, ctz over event pixels (mostly empty scenes)
+};
+
+/**
+ * Helper to convert UnpackKernel enum to string
+ */
+inline const char* unpackKernelToString(UnpackKernel k) {
+    switch (k) {
+        case UnpackKernel::Auto: return "Auto";
+        case UnpackKernel::Scalar: return "Scalar";
+        case UnpackKernel::SSE41: return "SSE4.1";
+        case UnpackKernel::AVX2: return "AVX2";
+        case UnpackKernel::NEON: return "NEON";
+        case UnpackKernel::Sparse: return "Sparse";
+        default: return "Unknown";
+    }
+}
+
+/**
+ * Occupancy bitmap sent by the FPGA after the size header (TCP with has_header)
+ *
+ * Bit i (LSB first within each byte) is set when unit i of the frame holds at
+ * least one event; units whose bit is clear are never read.
+ */
+enum class OccupancyMap {
+    None,   // No bitmap, every byte is scanned
+    Rows,   // One bit per pixel row
+    Blocks  // One bit per occupancy_block_bytes of packed frame data
+};
+
+/**
+ * Helper to convert OccupancyMap enum to string
+ */
+inline const char* occupancyMapToString(OccupancyMap m) {
+    switch (m) {
+        case OccupancyMap::None: return "None";
+        case OccupancyMap::Rows: return "Rows";
+        case OccupancyMap::Blocks: return "Blocks";
+        default: return "Unknown";
+    }
+}
+
+/**
+ * What a pipeline stage does when the queue to the next stage is full
+ */
+enum class QueueFullPolicy {
+    Block,      // Wait for space (back-pressure reaches the socket)
+    DropOldest  // Discard the oldest queued frame and count it as dropped
+};
+
+/**
+ * Helper to convert QueueFullPolicy enum to string
+ */
+inline const char* queueFullPolicyToString(QueueFullPolicy p) {
+    switch (p) {
+        case QueueFullPolicy::Block: return "Block";
+        case QueueFullPolicy::DropOldest: return "DropOldest";
+        default: return "Unknown";
+    }
+}
+
+/**
+ * What the UDP receiver does with a frame whose fragments did not all arrive
+ */
+enum class IncompleteFramePolicy {
+    Drop,       // Discard the frame
+    ZeroFill    // Deliver it with the missing fragments zeroed (no events there)
+};
+
+/**
+ * Helper to convert IncompleteFramePolicy enum to string
+ */
+inline const char* incompleteFramePolicyToString(IncompleteFramePolicy p) {
+    switch (p) {
+        case IncompleteFramePolicy::Drop: return "Drop";
+        case IncompleteFramePolicy::ZeroFill: return "ZeroFill";
+        default: return "Unknown";
+    }
+}
+
+/**
+ * Where event timestamps come from
+ *
+ * Every event of a frame gets the frame's timestamp (plus the row offset when
+ * frame_readout_us is set). Timestamps never go backwards, whatever the source.
+ */
+enum class TimestampSource {
+    FrameCounter,       // frame_number * frame_interval_us (ignores real arrival times)
+    FpgaHeader,         // FPGA timestamp after the size header (TCP with has_header)
+    KernelReceive,      // Kernel receive time of the frame's last packet (SO_TIMESTAMPNS, Linux)
+    HardwareReceive,    // NIC receive time (SO_TIMESTAMPING, Linux, NIC stamping enabled)
+    SteadyClock         // steady_clock when the frame is complete, mapped to wall time
+};
+
+/**
+ * Helper to convert TimestampSource enum to string
+ */
+inline const char* timestampSourceToString(TimestampSource s) {
+    switch (s) {
+        case TimestampSource::FrameCounter: return "FrameCounter";
+        case TimestampSource::FpgaHeader: return "FpgaHeader";
+        case TimestampSource::KernelReceive: return "KernelReceive";
+        case TimestampSource::HardwareReceive: return "HardwareReceive";
+        case TimestampSource::SteadyClock: return "SteadyClock";
+        default: return "Unknown";
+    }
+}
+
+/**
+ * How a frame's payload is encoded on the wire
+ *
+ * Selected per frame by the top bits of the size word (TCP size header with
+ * has_header, UdpFragmentHeader::frame_bytes with udp_sequence_header), so a
+ * camera can send sparse frames compressed and busy ones dense. Senders
+ * without a header always send Dense frames. Compressed frames are expanded
+ * into events directly, never back into a 2-bit frame.
+ *
+ *   - ZeroRuns: runs of [uint16 zero bytes][uint16 literal bytes][literals],
+ *     host byte order like the size header; bytes after the last run are zero
+ *   - ByteList: uint32 entries (offset << 8) | value, one per non-zero byte,
+ *     offsets strictly increasing (frames up to 16 MB)
+ *
+ * A compressed payload may not be larger than the dense frame; the sender
+ * should fall back to Dense for frames that would be. An empty compressed
+ * payload (size 0) is a frame without events. Any other value in the
+ * encoding bits is a protocol error: the receiver cannot tell where such a
+ * frame ends (TCP resets the connection, UDP drops the fragment).
+ */
+enum class FrameEncoding {
+    Dense = 0,      // Plain 2-bit packed frame (frame_size() bytes)
+    ZeroRuns = 1,   // Zero-run-length coded frame bytes
+    ByteList = 2    // Offsets and values of the non-zero frame bytes
+};
+
+// Size words carry the encoding in their top 4 bits and the payload size below
+inline constexpr uint32_t kFrameEncodingShift = 28;
+inline constexpr uint32_t kFrameSizeMask = (uint32_t{1} << kFrameEncodingShift) - 1;
+
+/**
+ * Helper to convert FrameEncoding enum to string
+ */
+inline const char* frameEncodingToString(FrameEncoding e) {
+    switch (e) {
+        case FrameEncoding::Dense: return "Dense";
+        case FrameEncoding::ZeroRuns: return "ZeroRuns";
+        case FrameEncoding::ByteList: return "ByteList";
+        default: return "Unknown";
+    }
+}
+
+/**
+ * Where the events of several cameras go (see Config::cameras)
+ */
+enum class CameraOutput {
+    Separate,   // One AEDAT4 server per camera (CameraInput::aedat_port)
+    Merged      // All cameras in one timestamp-ordered stream on aedat_port
+};
+
+/**
+ * Helper to convert CameraOutput enum to string
+ */
+inline const char* cameraOutputToString(CameraOutput o) {
+    switch (o) {
+        case CameraOutput::Separate: return "Separate";
+        case CameraOutput::Merged: return "Merged";
+        default: return "Unknown";
+    }
+}
+
+/**
+ * What the converter records to disk itself (see FrameRecorder)
+ */
+enum class RecordFormat {
+    None,       // No recording
+    Aedat4,     // Unpacked events, dv-processing MonoCameraWriter (.aedat4)
+    RawFrames   // Frames exactly as received, 2-bit or compressed (.dvraw)
+};
+
+/**
+ * Helper to convert RecordFormat enum to string
+ */
+inline const char* recordFormatToString(RecordFormat f) {
+    switch (f) {
+        case RecordFormat::None: return "None";
+        case RecordFormat::Aedat4: return "Aedat4";
+        case RecordFormat::RawFrames: return "RawFrames";
+        default: return "Unknown";
+    }
+}
+
+/**
+ * What the accumulated frame output draws (see FrameAccumulator)
+ */
+enum class FrameOutputMode {
+    Polarity,       // Event count per pixel around grey: ON brighter, OFF darker
+    TimeSurface     // Time since each pixel's last event, fading from white to black
+};
+
+/**
+ * Helper to convert FrameOutputMode enum to string
+ */
+inline const char* frameOutputModeToString(FrameOutputMode m) {
+    switch (m) {
+        case FrameOutputMode::Polarity: return "Polarity";
+        case FrameOutputMode::TimeSurface: return "TimeSurface";
+        default: return "Unknown";
+    }
+}
+
+/**
+ * One camera input in multi-camera mode
+ */
+struct CameraInput {
+    std::string name;           // Label for logs and statistics (empty = "camera<index>")
+    int camera_port = 6000;     // Port this camera connects / sends to
+    int aedat_port = 0;         // Separate outputs: AEDAT4 port (0 = Config::aedat_port + index)
+    std::vector<int> cpus;      // Cores for this camera's pipeline threads (empty = not pinned)
+    std::vector<int> receiver_cpus;     // Per-role cores (see Config::receiver_cpus)
+    std::vector<int> worker_cpus;
+    std::vector<int> writer_cpus;
+    int numa_node = -1;         // Frame pool node (see Config::numa_node)
+    std::string numa_interface; // NIC this camera arrives on (see Config::numa_interface)
+};
+
+/**
+ * One additional AEDAT4 output carrying the same events (see Config::output_sinks)
+ */
+struct OutputSink {
+    std::string name;           // Label for logs and metrics (empty = "aedat<port>")
+    int port = 0;               // AEDAT4 port (separate outputs: port + camera index)
+    size_t queue_depth = 0;     // Packets it may fall behind (0 = Config::sink_queue_depth)
+    QueueFullPolicy full_policy = QueueFullPolicy::DropOldest;
+};
+
 /**
  * Configuration for TCP/UDP to AEDAT4 Converter
  * 
@@ -49,6 +334,46 @@ struct Config {
     int total_pixels() const { return width * height; }
     int frame_size() const { return (total_pixels() + 3) / 4; }  // 230,400 bytes for 1280x720
 
+    // Region of interest and binning, applied while unpacking: rows outside
+    // the ROI are never scanned, and the output (AEDAT4 stream, shared
+    // memory, event recordings) advertises the reduced resolution.
+    // roi_width / roi_height 0 = up to the frame edge
+    int roi_x = 0;
+    int roi_y = 0;
+    int roi_width = 0;
+    int roi_height = 0;
+
+    // Combine binning x binning ROI pixels into one output pixel (1, 2 or 4);
+    // per frame an output pixel carries at most one event of each polarity
+    int binning = 1;
+
+    int binning_factor() const { return (binning == 2 || binning == 4) ? binning : 1; }
+    int roi_left() const { return roi_x < 0 ? 0 : (roi_x >= width ? width - 1 : roi_x); }
+    int roi_top() const { return roi_y < 0 ? 0 : (roi_y >= height ? height - 1 : roi_y); }
+
+    // ROI size in frame pixels, clamped to the frame; partial bins are cut off
+    int roi_columns() const {
+        int columns = width - roi_left();
+        if (roi_width > 0 && roi_width < columns) {
+            columns = roi_width;
+        }
+        return columns / binning_factor() * binning_factor();
+    }
+    int roi_rows() const {
+        int rows = height - roi_top();
+        if (roi_height > 0 && roi_height < rows) {
+            rows = roi_height;
+        }
+        return rows / binning_factor() * binning_factor();
+    }
+
+    // Resolution of the published events
+    int output_width() const { return roi_columns() / binning_factor(); }
+    int output_height() const { return roi_rows() / binning_factor(); }
+
+    // Output differs from the full frame?
+    bool roi_enabled() const { return output_width() != width || output_height() != height; }
+
     // =========================================================================
     // PROTOCOL SELECTION
     // =========================================================================
@@ -67,6 +392,29 @@ struct Config {
     // Receive buffer size (bytes) - larger = handles bursts better
     int recv_buffer_size = 50 * 1024 * 1024;  // 50 MB
 
+    // TCP receive engine (IoUring falls back to Socket where unavailable)
+    TcpBackend tcp_backend = TcpBackend::Socket;
+
+    // Latency-optimised profile: BusyPoll keeps polling an empty socket
+    // (non-blocking recv()/recvmmsg()) for busy_poll_budget_us before the
+    // receiver sleeps in the kernel, trading a busy core for wake-up latency.
+    // TCP needs the Socket backend. Best with the receiver pinned (receiver_cpus).
+    ReceiveMode receive_mode = ReceiveMode::Blocking;
+    int64_t busy_poll_budget_us = 1000;
+
+    // BusyPoll on Linux: SO_BUSY_POLL microseconds, so the kernel polls the
+    // NIC queue itself during each receive (raising it needs CAP_NET_ADMIN;
+    // 0 = leave unset). SO_INCOMING_CPU is set to the receiver's first core.
+    int socket_busy_poll_us = 50;
+
+    // Reconnect after a lost input: the first attempt is immediate (TCP keeps
+    // its port listening, so this just accepts the FPGA's next connection).
+    // After a failed attempt, or an input that fails again within
+    // reconnect_delay_ms of reconnecting, wait reconnect_delay_ms, doubling
+    // after each further failure up to reconnect_max_delay_ms
+    int reconnect_delay_ms = 1000;
+    int reconnect_max_delay_ms = 30000;
+
     // =========================================================================
     // UDP-SPECIFIC SETTINGS
     // =========================================================================
@@ -75,13 +423,91 @@ struct Config {
     // Standard: 65535 bytes (max UDP datagram)
     // Jumbo frames on 10G: up to 9000 bytes MTU, ~8972 payload
     // Set this to match your network configuration
+    // (ideally the sender's exact payload size: batched receive aims each
+    // datagram at frame offset k * udp_packet_size, and shorter datagrams
+    // have to be moved down to close the gap)
     int udp_packet_size = 65535;
+
+    // Datagrams fetched per recvmmsg() call (Linux only; 1 = one syscall per
+    // datagram, which is also what other platforms always do)
+    int udp_batch_size = 32;
+
+    // Let the kernel coalesce consecutive datagrams into one (UDP_GRO, Linux 5.0+)
+    bool udp_gro = false;
+
+    // Each datagram starts with a 16-byte UdpFragmentHeader (frame id,
+    // fragment index/count, offset), see udp_receiver.hpp. Frames are then
+    // reassembled by id, so a lost datagram costs one frame instead of
+    // shifting every later frame. Datagrams are received one per call in
+    // this mode (udp_batch_size and udp_gro are ignored).
+    bool udp_sequence_header = false;
+
+    // Frames that may be partially received at once (reorder window)
+    int udp_reorder_window = 4;
+
+    // Give up on an incomplete frame this long after its first fragment
+    int64_t udp_frame_timeout_us = 5000;
+
+    // What to do with a frame that is given up on
+    IncompleteFramePolicy udp_incomplete_policy = IncompleteFramePolicy::Drop;
     
     // =========================================================================
     // NETWORK SETTINGS - OUTPUT (to DV viewer)
     // =========================================================================
     
     int aedat_port = 7777;      // Port where DV viewer connects
+
+    // Combine consecutive frames into one AEDAT4 packet, holding events at
+    // most this long (0 = one packet per frame). A batch is flushed early
+    // once the next frame would push it past the budget, so at frame
+    // intervals above the budget every frame still goes out on its own
+    int64_t output_batch_latency_us = 1000;
+
+    // Flush a batch once it holds this many events (dense frames go out at once)
+    size_t output_batch_max_events = 200000;
+
+    // More AEDAT4 servers fed from the same unpack, e.g. for a recorder and a
+    // processing node next to dv-gui. Every AEDAT4 server (aedat_port too) is
+    // a sink with its own queue and thread sharing the same event packets,
+    // so a slow client only backs up its own queue
+    std::vector<OutputSink> output_sinks;
+
+    // Packets the aedat_port server may fall behind, and what happens then
+    // (DropOldest: its client skips ahead; Block: the whole output waits)
+    size_t sink_queue_depth = 64;
+    QueueFullPolicy sink_full_policy = QueueFullPolicy::DropOldest;
+
+    // Also publish events to a shared-memory ring for viewers on this host
+    // (POSIX shm object, e.g. /dev/shm/dvbridge; empty = disable). Separate
+    // outputs get one ring per camera, named "<name>-<camera>". Unbatched:
+    // local readers see each frame as soon as it is unpacked
+    std::string shm_output_name = "";
+
+    // Ring size in events (16 bytes each, rounded up to a power of two).
+    // A reader further behind than this loses the oldest events
+    size_t shm_output_capacity = 1 << 22;
+
+    // =========================================================================
+    // FRAME OUTPUT SETTINGS (accumulated images)
+    // =========================================================================
+
+    // Also serve accumulated 8-bit frames (a dv::io frame stream) for viewers
+    // that only draw an image, at a fraction of the event stream's bandwidth
+    // (0 = disable). Each camera gets its own: frame_output_port + index.
+    // Busy dense frames are accumulated straight from the packed 2-bit data;
+    // sparse ones, and any with a ROI, binning, noise filter or compression,
+    // from their events
+    int frame_output_port = 0;
+    FrameOutputMode frame_output_mode = FrameOutputMode::Polarity;
+
+    // One frame per this much event time (33333 = 30 FPS)
+    int64_t frame_output_interval_us = 33333;
+
+    // Polarity: grey levels per event, up from 128 for ON and down for OFF
+    int frame_output_contrast = 64;
+
+    // TimeSurface: a pixel fades from 255 to 0 over this long after its last event
+    int64_t frame_output_decay_us = 100000;
     
     // =========================================================================
     // FRAME HEADER SETTINGS (TCP only)
@@ -91,9 +517,217 @@ struct Config {
     // FPGA sends raw data without headers
     bool has_header = false;
     
-    // Header size in bytes (only used if has_header = true)
+    // Header size in bytes, 1-4, little-endian (only used if has_header =
+    // true). The top 4 bits of a 4-byte size select the frame's FrameEncoding
+    // (0 = Dense, so plain size headers keep working)
     int header_size = 4;
+
+    // Bytes of FPGA timestamp following the size header (timestamp_source = FpgaHeader)
+    int timestamp_header_bytes() const {
+        return has_header && timestamp_source == TimestampSource::FpgaHeader ? 8 : 0;
+    }
+
+    // Occupancy bitmap following the size header (only used if has_header = true)
+    OccupancyMap occupancy_map = OccupancyMap::None;
+
+    // Packed bytes covered by one bit in OccupancyMap::Blocks mode
+    int occupancy_block_bytes = 256;
+
+    // Number of bits in the occupancy bitmap
+    int occupancy_units() const {
+        switch (occupancy_map) {
+            case OccupancyMap::Rows: return height;
+            case OccupancyMap::Blocks: return (frame_size() + occupancy_block_bytes - 1) / occupancy_block_bytes;
+            default: return 0;
+        }
+    }
+
+    // Bytes of occupancy bitmap per frame (0 when disabled)
+    int occupancy_map_bytes() const {
+        return has_header ? (occupancy_units() + 7) / 8 : 0;
+    }
+
+    // =========================================================================
+    // FRAME INTEGRITY SETTINGS
+    // =========================================================================
+
+    // Each frame carries a CRC32C of its bytes (occupancy bitmap, if any,
+    // then payload), little-endian like the size header; frames that do not
+    // match are dropped and counted.
+    //   TCP (needs has_header): after the size (and timestamp):
+    //     [size][timestamp][crc][bitmap][frame]. A run of bad frames means
+    //     the stream lost its alignment: the connection is reset.
+    //   UDP: a 4-byte trailer after each frame (after the payload).
+    //     With udp_sequence_header the trailer is reassembled with the frame
+    //     (UdpFragmentHeader::frame_bytes excludes it) and a bad frame is just
+    //     dropped: the next frame id starts the next frame. Without it, after
+    //     a bad frame datagrams are skipped up to the next short one (the end
+    //     of a frame), so a lost datagram costs two frames, not all. That
+    //     guess needs one packet per datagram, so udp_gro without
+    //     udp_sequence_header turns the check off.
+    bool frame_crc = false;
+
+    // Bytes of CRC in the TCP frame header (0 when disabled)
+    int frame_crc_header_bytes() const {
+        return frame_crc && has_header && protocol == Protocol::TCP ? 4 : 0;
+    }
+
+    // Bytes of CRC trailer after each UDP frame (0 when disabled)
+    int frame_crc_trailer_bytes() const {
+        return frame_crc && protocol == Protocol::UDP && (udp_sequence_header || !udp_gro) ? 4 : 0;
+    }
     
+    // =========================================================================
+    // UNPACK SETTINGS
+    // =========================================================================
+
+    // Which unpack kernel to use (Auto = best available on this CPU)
+    UnpackKernel unpack_kernel = UnpackKernel::Auto;
+
+    // Threads used to unpack a single frame in parallel row bands
+    // (1 = single-threaded; per unpack worker, so total = workers * band threads)
+    int unpack_band_threads = 1;
+
+    // Only split frames once the recent event density (events per pixel)
+    // reaches this; sparse frames are faster on one core
+    double parallel_density_threshold = 0.01;
+
+    // =========================================================================
+    // NOISE FILTER SETTINGS
+    // =========================================================================
+
+    // Rejected pixels are cleared in the packed frame before unpacking, so
+    // they never become events. Each filter is off at 0; any one turns the
+    // filter stage on
+
+    // Drop a pixel's event if it had an accepted event less than this long ago
+    int64_t refractory_period_us = 0;
+
+    // Background-activity filter: keep an event only if one of its 8
+    // neighbours fired within this long (or fires in the same frame)
+    int64_t background_activity_us = 0;
+
+    // Learn hot pixels over the first N frames of each camera, then mask
+    // them out for good
+    int hot_pixel_learn_frames = 0;
+
+    // A pixel is hot if it fired in more than this fraction of the learning frames
+    double hot_pixel_fraction = 0.5;
+
+    // Any noise filter enabled?
+    bool noise_filter_enabled() const {
+        return refractory_period_us > 0 || background_activity_us > 0 || hot_pixel_learn_frames > 0;
+    }
+
+    // =========================================================================
+    // PIPELINE SETTINGS
+    // =========================================================================
+
+    // Receive, unpack and write run on separate threads connected by
+    // bounded queues. Frames are always written in receive order.
+
+    // Number of unpack worker threads
+    int unpack_workers = 1;
+
+    // Frames buffered between each pair of stages (per worker, rounded up to a power of two)
+    int queue_depth = 8;
+
+    // Behaviour when a queue is full
+    QueueFullPolicy queue_full_policy = QueueFullPolicy::Block;
+
+    // Back the frame buffer pool with hugepages (Linux; needs vm.nr_hugepages
+    // reserved, otherwise transparent hugepages are requested instead)
+    bool use_hugepages = false;
+
+    // Cores the receiver, unpack worker and writer threads may run on
+    // (Linux; empty = no pinning). Set per camera from CameraInput::cpus.
+    std::vector<int> pipeline_cpus;
+
+    // Cores per role (Linux; empty = pipeline_cpus). Worker i runs alone on
+    // worker_cpus[i % size]; put the receiver on a core of the NIC's node.
+    // Set per camera from CameraInput.
+    std::vector<int> receiver_cpus;
+    std::vector<int> worker_cpus;
+    std::vector<int> writer_cpus;
+
+    // Cores the receiver thread runs on (empty = not pinned)
+    const std::vector<int>& receiver_thread_cpus() const {
+        return receiver_cpus.empty() ? pipeline_cpus : receiver_cpus;
+    }
+
+    // NUMA node the frame pool is allocated on (-1 = the node of
+    // numa_interface, or of the receiver's first core if it is pinned)
+    int numa_node = -1;
+
+    // Network interface the camera arrives on (e.g. "eth2"), whose device's
+    // NUMA node is used when numa_node is -1
+    std::string numa_interface;
+
+    // Run the receiver, worker and writer threads under SCHED_FIFO at this
+    // priority (Linux, 1-99; 0 = normal scheduling). Needs CAP_SYS_NICE or an
+    // rtprio limit; give them cores of their own, nothing else runs there.
+    int realtime_priority = 0;
+
+    // Lock all process memory (mlockall) once the frame pools exist, so
+    // pages are neither swapped out nor first faulted in on the hot path
+    bool lock_memory = false;
+
+    // Warm start: before the AEDAT4 outputs come up (with the TCP port
+    // already listening, so the FPGA can connect meanwhile), pre-fault the
+    // frame pools and give each unpacker an event packet per frame it can
+    // have in flight, so the first frames see no page faults or allocations
+    bool warm_start = true;
+
+    // Events per pixel the warm packets are sized for; also the unpackers'
+    // starting density estimate
+    double warm_start_density = 0.02;
+
+    // =========================================================================
+    // MULTI-CAMERA SETTINGS
+    // =========================================================================
+
+    // Cameras served by this process. Empty = one camera on camera_port /
+    // aedat_port. All other settings are shared; every camera gets its own
+    // receiver, unpack workers, frame pool and timestamp engine.
+    std::vector<CameraInput> cameras;
+
+    // Separate AEDAT4 servers, or one timestamp-ordered stream on aedat_port
+    // (merging needs a common time base, e.g. KernelReceive on every camera)
+    CameraOutput camera_output = CameraOutput::Separate;
+
+    // Merged output: how long a camera with nothing queued may hold the
+    // stream back before it is merged without (raised to 2 frame intervals)
+    int64_t merge_timeout_us = 100000;
+
+    // Number of camera inputs
+    size_t camera_count() const { return cameras.empty() ? 1 : cameras.size(); }
+
+    // Label of camera `index`
+    std::string camera_name(size_t index) const {
+        if (index < cameras.size() && !cameras[index].name.empty()) {
+            return cameras[index].name;
+        }
+        return "camera" + std::to_string(index);
+    }
+
+    // Settings for camera `index`: its ports, cores and NUMA node, everything else shared
+    Config for_camera(size_t index) const {
+        Config camera = *this;
+        camera.cameras.clear();
+        if (index < cameras.size()) {
+            const CameraInput& input = cameras[index];
+            camera.camera_port = input.camera_port;
+            camera.aedat_port = input.aedat_port > 0 ? input.aedat_port : aedat_port + static_cast<int>(index);
+            camera.pipeline_cpus = input.cpus;
+            camera.receiver_cpus = input.receiver_cpus;
+            camera.worker_cpus = input.worker_cpus;
+            camera.writer_cpus = input.writer_cpus;
+            camera.numa_node = input.numa_node;
+            camera.numa_interface = input.numa_interface;
+        }
+        return camera;
+    }
+
     // =========================================================================
     // TIMING SETTINGS
     // =========================================================================
@@ -102,20 +736,95 @@ struct Config {
     // FPGA uses SLICE_PERIOD_US = 10000 (100 FPS)
     // Adjust based on actual frame rate from FPGA
     int64_t frame_interval_us = 10000;
+
+    // Event timestamp source. FpgaHeader expects a 64-bit tick counter
+    // (host byte order, like the size header) right after the size header:
+    // [size][timestamp][occupancy bitmap][frame]
+    TimestampSource timestamp_source = TimestampSource::FrameCounter;
+
+    // Length of one FPGA timestamp tick in nanoseconds (1000 = microsecond ticks)
+    int64_t fpga_timestamp_tick_ns = 1000;
+
+    // Smooth receive-time sources (KernelReceive, HardwareReceive, SteadyClock)
+    // with a PLL locked to the frame rate, so network jitter does not reach the
+    // events. frame_interval_us is the loop's starting period.
+    bool timestamp_pll = true;
+
+    // PLL loop bandwidth in Hz (lower = smoother, slower to follow rate changes)
+    double timestamp_pll_bandwidth_hz = 1.0;
+
+    // Row-scanned sensor: time from reading the first row to the last. Row y
+    // gets frame timestamp + y * frame_readout_us / height (0 = all rows share
+    // the frame timestamp)
+    int64_t frame_readout_us = 0;
     
+    // =========================================================================
+    // RECORDING SETTINGS
+    // =========================================================================
+
+    // Record to disk from the converter itself, on a dedicated I/O thread.
+    // RawFrames taps each camera right after the receive stage; Aedat4 records
+    // what the AEDAT4 output sends (one file per output)
+    RecordFormat record_format = RecordFormat::None;
+
+    // File name prefix: "<prefix>[-<camera>]-<NNNN>.aedat4" / ".dvraw"
+    std::string record_path = "recording";
+
+    // Start a new file after this many bytes / seconds (0 = never)
+    uint64_t record_rotate_bytes = 0;
+    int64_t record_rotate_seconds = 0;
+
+    // Frames (or event batches) the I/O thread may fall behind by. Beyond
+    // that the recording drops frames (counted) rather than stall the live
+    // stream. RawFrames holds a pool slot per queued frame: the frame pool
+    // grows by this many slots
+    size_t record_queue_frames = 64;
+
+    // RawFrames: bytes gathered per write(); a multiple of 4096
+    size_t record_buffer_bytes = 8 * 1024 * 1024;
+
+    // RawFrames: bypass the page cache (O_DIRECT, Linux) so a long capture
+    // does not evict everything else; falls back to buffered writes where
+    // the filesystem refuses it
+    bool record_direct_io = true;
+
+    // =========================================================================
+    // MONITORING SETTINGS
+    // =========================================================================
+
+    // Serve counters and per-stage latency histograms for Prometheus at
+    // http://<host>:metrics_port/metrics (0 = disable)
+    int metrics_port = 0;
+
+    // =========================================================================
+    // CONFIGURATION FILE SETTINGS
+    // =========================================================================
+
+    // Settings can come from a file (--config) and the command line instead
+    // of this header, see config_loader.hpp. The file's modification time is
+    // checked this often; on a change the hot-reloadable settings (statistics
+    // intervals, output batching, noise filter thresholds, queue and sink
+    // full policies, frame output interval, contrast and decay) are applied
+    // between frames, everything else is reported as needing a restart
+    // (0 = do not watch the file)
+    int config_reload_ms = 1000;
+
     // =========================================================================
     // DEBUG SETTINGS
     // =========================================================================
     
     // Print statistics every N frames (0 = disable)
     int stats_interval = 100;
+
+    // Also print them every N milliseconds from the main loop (0 = disable)
+    int stats_period_ms = 0;
     
     // Print verbose debug messages
     bool verbose = false;
 };
 
 // Global configuration instance
-// Modify this in main() or load from file if needed
+// main() fills it from the defaults above, a config file and the command line
 inline Config config;
 
 } // namespace converter
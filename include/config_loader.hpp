@@ -0,0 +1,165 @@
+#pragma once
+
+#include "config.hpp"
+#include <filesystem>
+#include <iosfwd>
+#include <string>
+#include <utility>
+#include <vector>
+
+namespace converter {
+
+/**
+ * What the command line asked for
+ *
+ *   converter [-c FILE | --config=FILE] [--KEY=VALUE ...] [--print-config] [-h | --help]
+ *
+ * KEY is any Config setting (dashes may stand for underscores); a boolean
+ * setting given without a value is set to true. Overrides win over the
+ * configuration file, also when it is reloaded.
+ */
+struct CommandLine {
+    std::string config_path;                                        // Empty = compiled-in defaults only
+    std::vector<std::pair<std::string, std::string>> overrides;     // --KEY=VALUE, in order
+    bool print_config = false;  // Print the effective configuration as a file and exit
+    bool help = false;
+};
+
+/**
+ * One setting that differs between two configurations
+ */
+struct ConfigChange {
+    std::string key;            // e.g. "stats_interval", "output_sinks[1].full_policy"
+    std::string old_value;
+    std::string new_value;
+    bool reloadable = false;    // Applied by a running converter (see isReloadableConfigKey())
+};
+
+/**
+ * Parse the command line
+ * @param argc Argument count
+ * @param argv Arguments
+ * @param cli Parsed command line
+ * @return false on a malformed argument (reported on std::cerr)
+ */
+bool parseCommandLine(int argc, char* argv[], CommandLine& cli);
+
+/**
+ * Build the configuration: compiled-in defaults, then the configuration file
+ * (if any), then the command-line overrides
+ * @param cli Parsed command line
+ * @param cfg Configuration to fill
+ * @return false if the file or an override is invalid (reported on std::cerr)
+ */
+bool loadConfig(const CommandLine& cli, Config& cfg);
+
+/**
+ * Check settings whose values the converter cannot run with (loadConfig()
+ * calls this, so a reload with such a value is refused as well)
+ * @param cfg Configuration to check
+ * @return false if a setting is out of range (reported on std::cerr)
+ */
+bool validateConfig(const Config& cfg);
+
+/**
+ * Apply a configuration file on top of cfg
+ *
+ * The file is a TOML subset: `key = value` lines with Config names, `#`
+ * comments, strings in double quotes (enums may also be bare words), numbers,
+ * true/false, integer arrays `[2, 3]`, and one `[[cameras]]` or
+ * `[[output_sinks]]` table per CameraInput / OutputSink entry.
+ *
+ * @param path File path
+ * @param cfg Configuration to update
+ * @return false if the file cannot be read or has an invalid line (cfg may be partly updated)
+ */
+bool loadConfigFile(const std::string& path, Config& cfg);
+
+/**
+ * Set one setting from its text form
+ * @param cfg Configuration to update
+ * @param key Config name (dashes may stand for underscores)
+ * @param value Value as in a configuration file, quotes optional
+ * @return false if the key is unknown or the value does not parse (reported on std::cerr)
+ */
+bool setConfigValue(Config& cfg, const std::string& key, const std::string& value);
+
+/**
+ * Write a configuration in the file format (all settings, so a file from
+ * --print-config reproduces it exactly)
+ * @param out Output stream
+ * @param cfg Configuration
+ */
+void writeConfig(std::ostream& out, const Config& cfg);
+
+/**
+ * Write the usage text, listing every setting and whether it hot-reloads
+ * @param out Output stream
+ * @param program argv[0]
+ */
+void printUsage(std::ostream& out, const char* program);
+
+/**
+ * Check if a running converter applies a setting without a restart
+ *
+ * Hot-reloadable: statistics intervals, output batching, noise filter
+ * thresholds, the band-split density threshold, queue/sink full policies
+ * and config_reload_ms. Everything else (sockets, geometry, threads, pools)
+ * needs a restart.
+ *
+ * @param key Config name, or "<table>[i].<name>" for cameras / output_sinks
+ * @return true if hot-reloadable
+ */
+bool isReloadableConfigKey(const std::string& key);
+
+/**
+ * List the settings that differ between two configurations
+ * @param from Running configuration
+ * @param to Newly loaded configuration
+ * @return Changes, in Config order
+ */
+std::vector<ConfigChange> diffConfig(const Config& from, const Config& to);
+
+/**
+ * Watches the configuration file for edits (see Config::config_reload_ms)
+ *
+ * poll() compares the file's modification time with the last one seen and,
+ * when it changed, loads the file again with the command-line overrides on
+ * top. A file that fails to parse is reported and skipped; the running
+ * configuration stays as it is until the next edit.
+ *
+ * Main thread only.
+ */
+class ConfigWatcher {
+public:
+    /**
+     * Constructor - remembers the file's current modification time
+     * @param cli Command line the configuration was built from
+     */
+    explicit ConfigWatcher(CommandLine cli);
+
+    /**
+     * Check if there is a file to watch
+     * @return false without --config
+     */
+    bool isEnabled() const { return !cli_.config_path.empty(); }
+
+    /**
+     * Get the watched file
+     * @return Path given with --config
+     */
+    const std::string& getPath() const { return cli_.config_path; }
+
+    /**
+     * Reload the file if it was modified since the last call
+     * @param loaded Configuration loaded from the file (defaults, file, overrides)
+     * @return true if the file changed and loaded
+     */
+    bool poll(Config& loaded);
+
+private:
+    CommandLine cli_;
+    std::filesystem::file_time_type last_write_;
+};
+
+} // namespace converter
@@ -0,0 +1,34 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+
+namespace converter {
+
+/**
+ * CRC32C (Castagnoli polynomial 0x1EDC6F41, reflected), the per-frame
+ * integrity check of Config::frame_crc
+ *
+ * Chains like zlib's crc32(): crc32c(b, crc32c(a)) == crc32c(a + b), so a
+ * frame can be checksummed piece by piece as it arrives. The CRC of no bytes
+ * is 0; "123456789" gives 0xE3069283.
+ *
+ * Uses the SSE4.2 crc32 instruction when the CPU has it (checked once at
+ * runtime) or the ARMv8 CRC instructions when the build targets them, with
+ * three interleaved streams to hide the instruction's latency; otherwise a
+ * slicing-by-8 table.
+ *
+ * @param data Bytes to checksum
+ * @param size Number of bytes
+ * @param crc CRC of the bytes before these (0 to start)
+ * @return CRC of all bytes so far
+ */
+uint32_t crc32c(const void* data, size_t size, uint32_t crc = 0);
+
+/**
+ * Get the CRC32C implementation in use
+ * @return "SSE4.2", "ARMv8 CRC" or "Table"
+ */
+const char* crc32cImplementation();
+
+} // namespace converter
@@ -0,0 +1,121 @@
+#pragma once
+
+#include "config.hpp"
+#include <dv-processing/core/event.hpp>
+#include <atomic>
+#include <cstdint>
+#include <functional>
+#include <mutex>
+
+namespace converter {
+
+/**
+ * Combines the events of consecutive frames into fewer, larger output packets
+ *
+ * Every NetworkWriter::writeEvents() call becomes one AEDAT4 packet with its
+ * own framing and compression, so at 10K FPS one packet per frame is mostly
+ * overhead for the viewer. The batcher appends frames (a shallow EventStore
+ * add, no event copy) and writes the batch when:
+ *
+ *   - it holds output_batch_max_events (dense frames flush at once), or
+ *   - the next frame, expected one measured frame gap later, would make the
+ *     oldest event wait longer than output_batch_latency_us, or
+ *   - flushExpired() finds it past the budget (the stream paused)
+ *
+ * With frame intervals above the budget every frame is written on its own,
+ * as without batching. output_batch_latency_us = 0 disables batching.
+ *
+ * add() is called from one thread (the writer thread or the merge thread);
+ * flushExpired(), flush() and reload() may be called from any other thread.
+ * The output callback runs on whichever thread flushes, never on two at once
+ * and always in batch order, but without holding the batch lock: a sink that
+ * blocks (SinkFullPolicy::Block) stalls only the flushing thread. While a
+ * batch is being written, flushExpired() and reload() leave the next one
+ * to add() instead of waiting.
+ */
+class EventBatcher {
+public:
+    // Write one batch (e.g. NetworkWriter::writeEvents)
+    using OutputFn = std::function<void(const dv::EventStore&)>;
+
+    /**
+     * Constructor
+     * @param cfg Configuration (batch budget, event limit, frame interval)
+     * @param output Output callback
+     */
+    EventBatcher(const Config& cfg, OutputFn output);
+
+    // Disable copy
+    EventBatcher(const EventBatcher&) = delete;
+    EventBatcher& operator=(const EventBatcher&) = delete;
+
+    /**
+     * Add one frame's events, writing the batch if it is due
+     * @param events Events of the frame, later than all events added before (may be empty)
+     */
+    void add(const dv::EventStore& events);
+
+    /**
+     * Write the batch if its oldest events have waited the full budget
+     */
+    void flushExpired();
+
+    /**
+     * Write whatever is batched now (e.g. on shutdown)
+     */
+    void flush();
+
+    /**
+     * Apply a new batch budget and event limit (hot reload)
+     *
+     * Takes effect between two add() calls; turning batching off writes
+     * what is batched at once (or with the next add(), if a batch is being
+     * written).
+     *
+     * @param cfg Configuration with the new output_batch_latency_us and output_batch_max_events
+     */
+    void reload(const Config& cfg);
+
+    /**
+     * Get how often flushExpired() should be called
+     * @return Period in microseconds (0 = batching disabled, no need)
+     */
+    int64_t getFlushPeriodUs() const;
+
+    /**
+     * Get number of batches written
+     * @return Output packets
+     */
+    uint64_t getBatchesWritten() const { return batches_written_.load(std::memory_order_relaxed); }
+
+    /**
+     * Get number of frames with events that went into batches
+     * @return Frames
+     */
+    uint64_t getFramesBatched() const { return frames_batched_.load(std::memory_order_relaxed); }
+
+private:
+    /**
+     * Take the batch and write it after unlocking mutex_
+     * @param lock Holds mutex_; unlocked on return if the batch was written
+     * @param wait Wait for a batch still being written (else leave this one batched)
+     * @return true if written
+     */
+    bool writePending(std::unique_lock<std::mutex>& lock, bool wait);
+
+    OutputFn output_;
+
+    std::mutex output_mutex_;   // Held while output_ runs; taken before mutex_ is released
+    std::mutex mutex_;
+    std::atomic<int64_t> budget_ns_;    // Written under mutex_
+    size_t max_events_;
+    dv::EventStore pending_;
+    int64_t batch_start_ns_;    // When the first frame of the batch was added
+    int64_t last_add_ns_;
+    int64_t frame_gap_ns_;      // Smoothed time between add() calls
+
+    std::atomic<uint64_t> batches_written_;
+    std::atomic<uint64_t> frames_batched_;
+};
+
+} // namespace converter
@@ -0,0 +1,149 @@
+#pragma once
+
+#include "config.hpp"
+#include "bounded_queue.hpp"
+#include <dv-processing/core/event.hpp>
+#include <atomic>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace converter {
+
+/**
+ * Hands one output's event packets to several sinks, each at its own pace
+ *
+ * publish() queues a shallow copy of the EventStore (the packets are shared
+ * and never modified) on every sink's bounded queue; each sink has a thread
+ * that takes packets off its queue and writes them. Adding a sink therefore
+ * costs one queue operation per packet, not another unpack or copy.
+ *
+ * When a sink's queue is full its policy decides: DropOldest discards the
+ * sink's oldest queued packet (only that client skips ahead), Block makes
+ * publish() wait for room, which stalls every sink of this output.
+ * setSinkPolicy() changes it while running.
+ *
+ * Per sink, packets and events are counted as published, written and
+ * dropped, and the lag is measured: how long the last written packet waited
+ * in the queue (and the longest wait so far), and how many are queued now.
+ */
+class EventFanout {
+public:
+    // Write one packet to a sink (called on the sink's thread)
+    using SinkFn = std::function<void(const dv::EventStore&)>;
+
+    /**
+     * Statistics of one sink
+     */
+    struct SinkStats {
+        std::string name;
+        uint64_t packets_published = 0;
+        uint64_t packets_written = 0;
+        uint64_t packets_dropped = 0;
+        uint64_t events_written = 0;
+        uint64_t events_dropped = 0;
+        size_t queue_depth = 0;         // Packets queued right now
+        size_t queue_capacity = 0;
+        int64_t lag_ns = 0;             // Queue wait of the last written packet
+        int64_t max_lag_ns = 0;
+    };
+
+    EventFanout() = default;
+
+    /**
+     * Destructor - stops the sink threads
+     */
+    ~EventFanout();
+
+    // Disable copy
+    EventFanout(const EventFanout&) = delete;
+    EventFanout& operator=(const EventFanout&) = delete;
+
+    /**
+     * Add a sink (before start())
+     * @param name Label for statistics and metrics
+     * @param queue_depth Packets the sink may fall behind (rounded up to a power of two)
+     * @param policy What publish() does when the sink's queue is full
+     * @param write Output callback
+     * @return Sink index
+     */
+    size_t addSink(std::string name, size_t queue_depth, QueueFullPolicy policy, SinkFn write);
+
+    /**
+     * Change a sink's full policy (hot reload; from the next published packet)
+     * @param sink Sink index
+     * @param policy New policy
+     */
+    void setSinkPolicy(size_t sink, QueueFullPolicy policy)
+    {
+        sinks_[sink]->policy.store(policy, std::memory_order_relaxed);
+    }
+
+    /**
+     * Start one thread per sink
+     */
+    void start();
+
+    /**
+     * Write what is still queued, then stop and join the sink threads
+     */
+    void stop();
+
+    /**
+     * Queue events for every sink
+     *
+     * Called by one thread at a time (the output's batcher serializes its
+     * flushes). Never waits unless a Block sink is full.
+     *
+     * @param events Events in timestamp order (empty stores are skipped)
+     */
+    void publish(const dv::EventStore& events);
+
+    /**
+     * Get number of sinks
+     */
+    size_t getSinkCount() const { return sinks_.size(); }
+
+    /**
+     * Get a snapshot of one sink's counters
+     * @param sink Sink index
+     * @return Statistics
+     */
+    SinkStats getSinkStats(size_t sink) const;
+
+private:
+    struct Item {
+        dv::EventStore events;
+        int64_t queued_ns = 0;
+    };
+
+    struct Sink {
+        Sink(std::string sink_name, size_t depth, QueueFullPolicy full_policy, SinkFn fn)
+            : name(std::move(sink_name)), queue(depth), policy(full_policy), write(std::move(fn))
+        {}
+
+        const std::string name;
+        BoundedQueue<Item> queue;
+        std::atomic<QueueFullPolicy> policy;
+        const SinkFn write;
+        std::thread thread;
+
+        std::atomic<uint64_t> packets_published{0};
+        std::atomic<uint64_t> packets_written{0};
+        std::atomic<uint64_t> packets_dropped{0};
+        std::atomic<uint64_t> events_written{0};
+        std::atomic<uint64_t> events_dropped{0};
+        std::atomic<int64_t> lag_ns{0};
+        std::atomic<int64_t> max_lag_ns{0};
+    };
+
+    void sinkLoop(Sink& sink);
+
+    std::vector<std::unique_ptr<Sink>> sinks_;
+    std::atomic<bool> stop_requested_{false};
+};
+
+} // namespace converter
@@ -0,0 +1,138 @@
+#pragma once
+
+#include "config.hpp"
+#include "bounded_queue.hpp"
+#include <dv-processing/core/event.hpp>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <thread>
+#include <vector>
+
+namespace converter {
+
+/**
+ * Merges the event streams of several cameras into one timestamp-ordered stream
+ *
+ * Each input is fed by one thread (a camera's pipeline writer), frame by
+ * frame in its own timestamp order, together with a watermark: the earliest
+ * time the input's next frame can start (for a pipeline frame: its timestamp
+ * plus frame_readout_us). A merge thread repeatedly takes the input whose
+ * next event is earliest and passes on its events up to the earliest event
+ * any other input could still deliver, so the output never goes backwards,
+ * even when the readouts of different cameras overlap in time.
+ *
+ * An input with nothing queued holds the others back until it delivers its
+ * next frame. After merge_timeout_us (at least two frame intervals) without
+ * a frame it is merged without; events it delivers later that are older
+ * than the merged output are dropped and counted as late.
+ *
+ * Inputs should share a time base (receive-time timestamp sources, or FPGA
+ * clocks on a common epoch); frame-counter timestamps merge frame by frame.
+ */
+class EventMerger {
+public:
+    // Consume a batch of merged events (called on the merge thread)
+    using OutputFn = std::function<void(const dv::EventStore&)>;
+
+    /**
+     * Constructor
+     * @param cfg Configuration reference (camera count, queue depth, timeout)
+     * @param output Output callback (merge thread)
+     */
+    EventMerger(const Config& cfg, OutputFn output);
+
+    /**
+     * Destructor - stops the merge thread
+     */
+    ~EventMerger();
+
+    // Disable copy
+    EventMerger(const EventMerger&) = delete;
+    EventMerger& operator=(const EventMerger&) = delete;
+
+    /**
+     * Start the merge thread
+     */
+    void start();
+
+    /**
+     * Stop and join the merge thread (queued events are discarded)
+     */
+    void stop();
+
+    /**
+     * Queue one frame's events, waiting while the input's queue is full
+     * @param input Input index (one producer thread per input)
+     * @param events Events of the frame, in timestamp order (may be empty)
+     * @param watermark No later frame of this input has events before this time
+     * @return false if stopping (frame not queued)
+     */
+    bool push(size_t input, const dv::EventStore& events, int64_t watermark);
+
+    /**
+     * Get number of events passed to the output
+     * @return Merged events
+     */
+    uint64_t getEventsMerged() const { return events_merged_.load(std::memory_order_relaxed); }
+
+    /**
+     * Get number of events dropped for arriving after the merged output had passed them
+     * @return Late events
+     */
+    uint64_t getLateEvents() const { return late_events_.load(std::memory_order_relaxed); }
+
+    /**
+     * Get number of times an input timed out and was merged without
+     * @return Stalls
+     */
+    uint64_t getStalls() const { return stalls_.load(std::memory_order_relaxed); }
+
+private:
+    struct Item {
+        dv::EventStore events;
+        int64_t watermark = 0;
+    };
+
+    struct Input {
+        std::unique_ptr<BoundedQueue<Item>> queue;
+        dv::EventStore pending;     // Current frame's events not passed on yet
+        int64_t watermark = 0;      // Watermark of the current frame
+        bool seen = false;          // Has delivered a frame
+        bool stalled = false;       // Timed out, merged without until it delivers again
+        std::chrono::steady_clock::time_point last_frame;
+    };
+
+    void mergeLoop();
+
+    /**
+     * Take the input's next frame if its current one is used up (merge thread)
+     */
+    void refill(Input& input, std::chrono::steady_clock::time_point now);
+
+    /**
+     * Get the earliest time the input can still deliver (merge thread)
+     * @param lower Set to the earliest event time
+     * @return false if the input has timed out
+     */
+    bool lowerBound(Input& input, std::chrono::steady_clock::time_point now, int64_t& lower);
+
+    OutputFn output_;
+    std::chrono::microseconds timeout_;
+    std::vector<std::unique_ptr<Input>> inputs_;
+
+    // Merge thread only
+    bool has_output_;
+    int64_t last_time_;             // Highest timestamp passed to the output
+
+    std::thread thread_;
+    std::atomic<bool> stop_requested_;
+
+    std::atomic<uint64_t> events_merged_;
+    std::atomic<uint64_t> late_events_;
+    std::atomic<uint64_t> stalls_;
+};
+
+} // namespace converter
@@ -0,0 +1,149 @@
+#pragma once
+
+#include "config.hpp"
+#include "bounded_queue.hpp"
+#include <dv-processing/core/event.hpp>
+#include <dv-processing/core/frame.hpp>
+#include <atomic>
+#include <cstdint>
+#include <functional>
+#include <thread>
+#include <vector>
+
+namespace converter {
+
+struct PipelineFrame;
+
+/**
+ * Accumulates one camera's frames into 8-bit images for the frame output
+ * (Config::frame_output_port)
+ *
+ * accumulate() is called on the camera's writer thread, in frame order. A
+ * busy dense frame covering the whole sensor, unfiltered, is read straight
+ * from its packed 2-bit data: a 64-bit word (32 pixels) at a time, skipping
+ * empty words, with branch-free table and SWAR updates. Sparse frames, and
+ * everything else (ROI or binning, noise filter, compressed frames), are
+ * accumulated from the frame's events, which the unpacker already made and
+ * which carry the output coordinates.
+ *
+ * Polarity counts events per pixel over the window around grey (128), by
+ * frame_output_contrast per event. TimeSurface keeps each pixel's last event
+ * time across windows and renders a linear fade over frame_output_decay_us.
+ *
+ * Windows follow event time: once a frame's timestamp reaches the end of the
+ * current window, the image is rendered, stamped with the window start and
+ * queued for the output thread, which writes it (e.g. to a NetworkWriter)
+ * so a slow client never stalls the writer thread. When that thread is
+ * still busy with the previous frames, the new one is dropped and counted.
+ */
+class FrameAccumulator {
+public:
+    // Write one accumulated frame (called on the output thread)
+    using OutputFn = std::function<void(const dv::Frame&)>;
+
+    /**
+     * Constructor
+     * @param cfg Configuration reference (geometry, frame_output_* settings)
+     * @param output Output callback
+     */
+    FrameAccumulator(const Config& cfg, OutputFn output);
+
+    /**
+     * Destructor - stops the output thread
+     */
+    ~FrameAccumulator();
+
+    // Disable copy
+    FrameAccumulator(const FrameAccumulator&) = delete;
+    FrameAccumulator& operator=(const FrameAccumulator&) = delete;
+
+    /**
+     * Start the output thread
+     */
+    void start();
+
+    /**
+     * Write what is still queued, then stop and join the output thread
+     */
+    void stop();
+
+    /**
+     * Add one unpacked frame (one producer thread, in frame order)
+     * @param frame Frame with its buffer, timestamp and events
+     */
+    void accumulate(const PipelineFrame& frame);
+
+    /**
+     * Apply the hot-reloadable frame output settings (interval, contrast,
+     * decay); any thread, picked up from the next frame
+     * @param cfg Configuration with the new values
+     */
+    void reload(const Config& cfg);
+
+    /**
+     * Get number of frames written by the output thread
+     * @return Frames
+     */
+    uint64_t getFramesWritten() const { return frames_written_.load(std::memory_order_relaxed); }
+
+    /**
+     * Get number of frames dropped because the output thread fell behind
+     * @return Frames
+     */
+    uint64_t getFramesDropped() const { return frames_dropped_.load(std::memory_order_relaxed); }
+
+    /**
+     * Get number of input frames accumulated from their packed data
+     * @return Frames (the rest went through their events)
+     */
+    uint64_t getPackedFrames() const { return packed_frames_.load(std::memory_order_relaxed); }
+
+    /**
+     * Get number of input frames accumulated
+     * @return Frames
+     */
+    uint64_t getInputFrames() const { return input_frames_.load(std::memory_order_relaxed); }
+
+private:
+    void accumulatePacked(const uint8_t* data, size_t size, int64_t timestamp);
+    void accumulateEvents(const dv::EventStore& events);
+
+    /**
+     * Render the current window, queue it and start the next one
+     * @param end End of the window (event time)
+     */
+    void emit(int64_t end);
+
+    void outputLoop();
+
+    const int width_;
+    const int height_;
+    const FrameOutputMode mode_;
+    const bool packed_input_;   // Output pixels are the packed frame's pixels
+    const size_t packed_min_events_;    // Events from which the packed data is read
+    const OutputFn output_;
+
+    // Hot-reloadable
+    std::atomic<int64_t> interval_us_;
+    std::atomic<int> contrast_;
+    std::atomic<int64_t> decay_us_;
+
+    // Writer thread only
+    std::vector<uint8_t> counts_;       // Polarity: grey level per pixel
+    std::vector<int64_t> last_event_;   // TimeSurface: last event time per pixel
+    int step_;                          // Contrast of the current frame
+    bool started_;
+    int64_t window_start_;
+    int64_t window_end_;
+
+    BoundedQueue<dv::Frame> queue_;
+    std::thread thread_;
+    std::atomic<bool> stop_requested_;
+
+    std::atomic<uint64_t> frames_written_;
+    std::atomic<uint64_t> frames_dropped_;
+    std::atomic<uint64_t> packed_frames_;
+    std::atomic<uint64_t> input_frames_;
+};
+
+} // namespace converter
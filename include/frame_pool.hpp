@@ -0,0 +1,242 @@
+#pragma once
+
+#include "bounded_queue.hpp"
+#include "config.hpp"
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+namespace converter {
+
+class FramePool;
+
+/**
+ * One fixed-size buffer owned by a FramePool
+ */
+struct FrameSlot {
+    uint8_t* data = nullptr;        // Page-aligned start of the slot
+    size_t capacity = 0;            // Usable bytes
+    size_t size = 0;                // Valid bytes of the current frame
+    size_t occupancy_bytes = 0;     // Occupancy bitmap stored at the end of the slot
+    int64_t timestamp = 0;          // Raw input timestamp (see TimestampSource), 0 = none
+    int64_t arrival_ns = 0;         // steady_clock time the frame's first bytes were read, 0 = unknown
+    FrameEncoding encoding = FrameEncoding::Dense;  // How the size bytes are encoded
+    uint32_t index = 0;             // Slot number within the pool
+    std::atomic<uint32_t> refs{0};  // Live FrameHandles
+    FramePool* pool = nullptr;
+};
+
+/**
+ * Reference-counted handle to a pool slot
+ *
+ * Copying a handle shares the slot; the slot goes back to the pool when the
+ * last handle is destroyed or reset. Handles must not outlive their pool.
+ */
+class FrameHandle {
+public:
+    FrameHandle() = default;
+    ~FrameHandle() { reset(); }
+
+    FrameHandle(const FrameHandle& other) noexcept;
+    FrameHandle& operator=(const FrameHandle& other) noexcept;
+    FrameHandle(FrameHandle&& other) noexcept;
+    FrameHandle& operator=(FrameHandle&& other) noexcept;
+
+    /**
+     * Drop this reference (returns the slot to the pool if it was the last)
+     */
+    void reset() noexcept;
+
+    explicit operator bool() const { return slot_ != nullptr; }
+
+    uint8_t* data() { return slot_->data; }
+    const uint8_t* data() const { return slot_->data; }
+
+    /**
+     * Get number of valid bytes
+     * @return Frame size in bytes
+     */
+    size_t size() const { return slot_->size; }
+
+    /**
+     * Set number of valid bytes (must not exceed capacity())
+     * @param size Frame size in bytes
+     */
+    void setSize(size_t size) { slot_->size = size; }
+
+    /**
+     * Get slot capacity
+     * @return Maximum frame size in bytes
+     */
+    size_t capacity() const { return slot_->capacity; }
+
+    /**
+     * Get the occupancy bitmap received with the frame
+     * @return Bitmap (kept in the last bytes of the slot), or nullptr if none
+     */
+    const uint8_t* occupancy() const
+    {
+        return slot_->occupancy_bytes > 0 ? slot_->data + slot_->capacity - slot_->occupancy_bytes : nullptr;
+    }
+
+    /**
+     * Reserve the last bytes of the slot for an occupancy bitmap
+     *
+     * The frame itself must then stay within capacity() - bytes.
+     *
+     * @param bytes Bitmap size (must not exceed capacity(), 0 = no bitmap)
+     * @return Where to write the bitmap
+     */
+    uint8_t* reserveOccupancy(size_t bytes)
+    {
+        slot_->occupancy_bytes = bytes;
+        return slot_->data + slot_->capacity - bytes;
+    }
+
+    /**
+     * Get the raw timestamp the receiver took for this frame
+     * @return FPGA ticks (FpgaHeader) or receive time in ns, 0 if none
+     */
+    int64_t timestamp() const { return slot_->timestamp; }
+
+    /**
+     * Set the raw timestamp of the frame
+     * @param timestamp FPGA ticks or receive time in ns
+     */
+    void setTimestamp(int64_t timestamp) { slot_->timestamp = timestamp; }
+
+    /**
+     * Get when the receiver read the first bytes of this frame
+     * @return steady_clock time in ns, 0 if unknown
+     */
+    int64_t arrival() const { return slot_->arrival_ns; }
+
+    /**
+     * Set when the receiver read the first bytes of this frame
+     * @param arrival_ns steady_clock time in ns
+     */
+    void setArrival(int64_t arrival_ns) { slot_->arrival_ns = arrival_ns; }
+
+    /**
+     * Get how the frame bytes are encoded
+     * @return Dense for a plain 2-bit frame, otherwise a compressed payload of size() bytes
+     */
+    FrameEncoding encoding() const { return slot_->encoding; }
+
+    /**
+     * Set how the frame bytes are encoded
+     * @param encoding Encoding from the frame header
+     */
+    void setEncoding(FrameEncoding encoding) { slot_->encoding = encoding; }
+
+    /**
+     * Get slot number (stable for the pool's lifetime)
+     * @return Slot index
+     */
+    uint32_t index() const { return slot_->index; }
+
+    /**
+     * Get the pool this slot belongs to
+     * @return Owning pool
+     */
+    FramePool* pool() const { return slot_->pool; }
+
+private:
+    friend class FramePool;
+    explicit FrameHandle(FrameSlot* slot) noexcept : slot_(slot) {}
+
+    FrameSlot* slot_ = nullptr;
+};
+
+/**
+ * Fixed-size pool of page-aligned frame buffers
+ *
+ * All slots live in one anonymous mapping created up front, so memory use
+ * is fixed regardless of load and receivers can write straight into a slot.
+ * With hugepages requested, the mapping is backed by 2 MB pages when the
+ * system has them reserved, otherwise transparent hugepages are requested
+ * (Linux only; other platforms use normal pages).
+ *
+ * Given a NUMA node, the mapping is bound to it before any page is touched
+ * (mbind on Linux, VirtualAllocExNuma on Windows), so the NIC's receive
+ * copies and the unpackers' reads stay local. The node is preferred, not
+ * required: if it runs out of memory pages come from another node.
+ */
+class FramePool {
+public:
+    /**
+     * Constructor
+     * @param num_slots Number of buffers
+     * @param slot_size Minimum bytes per buffer (rounded up to the page size)
+     * @param use_hugepages Try to back the pool with hugepages
+     * @param numa_node NUMA node to allocate on (-1 = wherever pages are first touched)
+     */
+    FramePool(size_t num_slots, size_t slot_size, bool use_hugepages = false, int numa_node = -1);
+
+    /**
+     * Destructor - unmaps the pool (all handles must be gone)
+     */
+    ~FramePool();
+
+    // Disable copy and move (slots point back at the pool)
+    FramePool(const FramePool&) = delete;
+    FramePool& operator=(const FramePool&) = delete;
+
+    /**
+     * Fault in every page of the pool now (MADV_POPULATE_WRITE, else one
+     * write per page), so the first frames do not pay for it. Slots are
+     * zeroed; call before any slot is in use.
+     * @return Bytes faulted in
+     */
+    size_t prefault();
+
+    /**
+     * Take a free slot
+     * @return Handle to the slot (size reset to 0), or an empty handle if none is free
+     */
+    FrameHandle tryAcquire();
+
+    /**
+     * Get number of free slots
+     * @return Free slot count (approximate while other threads are active)
+     */
+    size_t freeSlots() const { return free_slots_->sizeApprox(); }
+
+    size_t slotCount() const { return slots_.size(); }
+    size_t slotSize() const { return slot_stride_; }
+
+    /**
+     * Get the start of the pool mapping (slot i starts at base + i * slotSize())
+     * @return Base address
+     */
+    uint8_t* baseAddress() const { return base_; }
+
+    /**
+     * Check if the pool ended up on hugepages
+     * @return true if backed by explicit or transparent hugepages
+     */
+    bool usesHugePages() const { return hugepages_; }
+
+    /**
+     * Get the NUMA node the pool is bound to
+     * @return Node, or -1 if not bound
+     */
+    int numaNode() const { return numa_node_; }
+
+private:
+    friend class FrameHandle;
+    void release(FrameSlot* slot);
+
+    uint8_t* base_;
+    size_t mapped_bytes_;
+    size_t slot_stride_;
+    bool hugepages_;
+    int numa_node_;
+
+    std::vector<FrameSlot> slots_;
+    std::unique_ptr<BoundedQueue<FrameSlot*>> free_slots_;
+};
+
+} // namespace converter
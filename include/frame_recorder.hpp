@@ -0,0 +1,220 @@
+#pragma once
+
+#include "config.hpp"
+#include "bounded_queue.hpp"
+#include "frame_pool.hpp"
+#include <dv-processing/core/event.hpp>
+#include <dv-processing/io/mono_camera_writer.hpp>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <thread>
+
+namespace converter {
+
+struct PipelineFrame;
+
+/**
+ * Raw capture file layout (.dvraw, little endian)
+ *
+ * A 64-byte file header, then one record per frame: a 32-byte frame header
+ * and the payload exactly as received, padded to a multiple of 8 bytes.
+ * size_word is the wire size word (FrameEncoding in the top 4 bits), so
+ * compressed frames stay compressed and a capture can be replayed bit for bit.
+ */
+struct RawCaptureHeader {
+    static constexpr char kMagic[8] = {'D', 'V', 'B', 'R', 'R', 'A', 'W', '1'};
+    static constexpr uint32_t kVersion = 1;
+
+    char magic[8];
+    uint32_t version;
+    uint32_t header_bytes;      // 64
+    uint32_t width;
+    uint32_t height;
+    uint32_t frame_bytes;       // Dense frame size (Config::frame_size())
+    uint32_t file_index;        // Position in a rotated series
+    int64_t start_time_us;      // Wall clock when the file was opened
+    uint8_t reserved[24];
+};
+static_assert(sizeof(RawCaptureHeader) == 64, "RawCaptureHeader layout is part of the file format");
+
+struct RawFrameHeader {
+    static constexpr uint32_t kMagic = 0x4D415246;  // "FRAM"
+
+    uint32_t magic;
+    uint32_t size_word;         // (encoding << kFrameEncodingShift) | payload bytes
+    uint64_t sequence;          // Receive order within the camera's session
+    int64_t timestamp;          // Event timestamp (us) the pipeline assigned
+    int64_t input_timestamp;    // Raw input timestamp (see TimestampSource), 0 = none
+};
+static_assert(sizeof(RawFrameHeader) == 32, "RawFrameHeader layout is part of the file format");
+
+/**
+ * Records one camera (raw frames) or one output (AEDAT4 events) to disk
+ *
+ * Producers only queue: recordFrame() keeps a reference to the frame's pool
+ * slot, recordEvents() a shallow EventStore copy. A dedicated I/O thread does
+ * all copying, encoding and writing, so a slow disk never reaches the live
+ * stream: when the queue (record_queue_frames) is full the recording drops
+ * the frame and counts it.
+ *
+ * RawFrames gathers records into one large page-aligned buffer and writes it
+ * whole, with O_DIRECT where the filesystem allows (record_direct_io), so
+ * every write is aligned and bypasses the page cache; only the last, partial
+ * buffer of a file is written buffered. Aedat4 passes batches to a
+ * dv::io::MonoCameraWriter on the same thread.
+ *
+ * Files rotate at frame boundaries after record_rotate_bytes or
+ * record_rotate_seconds, numbered from 0000.
+ */
+class FrameRecorder {
+public:
+    /**
+     * Constructor
+     * @param cfg Configuration reference (record_* settings, frame size)
+     * @param format Aedat4 or RawFrames
+     * @param prefix File name prefix including any camera label
+     */
+    FrameRecorder(const Config& cfg, RecordFormat format, std::string prefix);
+
+    /**
+     * Destructor - stops the I/O thread, finishing the current file
+     */
+    ~FrameRecorder();
+
+    // Disable copy
+    FrameRecorder(const FrameRecorder&) = delete;
+    FrameRecorder& operator=(const FrameRecorder&) = delete;
+
+    /**
+     * Open the first file and start the I/O thread
+     * @return true if recording
+     */
+    bool start();
+
+    /**
+     * Write everything queued, close the file and stop the I/O thread
+     */
+    void stop();
+
+    /**
+     * Queue a received frame (RawFrames; one producer thread, non-blocking)
+     * @param frame Frame with its buffer and timestamp assigned
+     * @return false if the queue was full and the frame was dropped
+     */
+    bool recordFrame(const PipelineFrame& frame);
+
+    /**
+     * Queue events (Aedat4; one producer thread, non-blocking)
+     * @param events Events in timestamp order
+     * @return false if the queue was full and the events were dropped
+     */
+    bool recordEvents(const dv::EventStore& events);
+
+    /**
+     * Get number of frames (or event batches) written
+     * @return Items recorded
+     */
+    uint64_t getFramesRecorded() const { return frames_recorded_.load(std::memory_order_relaxed); }
+
+    /**
+     * Get number of frames (or event batches) dropped because the disk fell behind
+     * @return Items dropped
+     */
+    uint64_t getFramesDropped() const { return frames_dropped_.load(std::memory_order_relaxed); }
+
+    /**
+     * Get number of bytes written (RawFrames; Aedat4 counts the file sizes at rotation)
+     * @return Bytes
+     */
+    uint64_t getBytesWritten() const { return bytes_written_.load(std::memory_order_relaxed); }
+
+    /**
+     * Get number of files started
+     * @return Files
+     */
+    uint32_t getFilesWritten() const { return files_written_.load(std::memory_order_relaxed); }
+
+    /**
+     * Check if writes bypass the page cache
+     * @return true if the current raw file is open with O_DIRECT
+     */
+    bool isDirectIo() const { return direct_io_.load(std::memory_order_relaxed); }
+
+private:
+    struct Item {
+        FrameHandle buffer;         // RawFrames
+        uint64_t sequence = 0;
+        int64_t timestamp = 0;
+        dv::EventStore events;      // Aedat4
+    };
+
+    void ioLoop();
+    void writeItem(Item& item);
+
+    /**
+     * Open the next file of the series (I/O thread, or start())
+     * @return false if it could not be created
+     */
+    bool openFile();
+
+    /**
+     * Flush and close the current file
+     */
+    void closeFile();
+
+    /**
+     * Check if the current file is due for rotation
+     */
+    bool rotationDue() const;
+
+    /**
+     * Append bytes to the raw buffer, writing it out whenever it fills
+     */
+    bool appendRaw(const void* data, size_t size);
+
+    /**
+     * Write the full raw buffer (aligned, O_DIRECT if enabled)
+     */
+    bool writeBuffer();
+
+    /**
+     * Write whatever part of the buffer is filled (buffered, end of file)
+     */
+    bool writeTail();
+
+    std::string nextPath() const;
+
+    const Config& config_;
+    const RecordFormat format_;
+    const std::string prefix_;
+
+    BoundedQueue<Item> queue_;
+    std::thread thread_;
+    std::atomic<bool> stop_requested_;
+
+    // I/O thread only (and start()/stop() while it is not running)
+    struct BufferDeleter {
+        void operator()(uint8_t* buffer) const;
+    };
+    std::unique_ptr<uint8_t, BufferDeleter> buffer_;
+    size_t buffer_capacity_;
+    size_t buffer_used_;
+    int fd_;
+    std::unique_ptr<dv::io::MonoCameraWriter> aedat_writer_;
+    std::string file_path_;
+    uint64_t file_bytes_;
+    std::chrono::steady_clock::time_point file_opened_;
+    uint32_t file_index_;
+    bool failed_;
+
+    std::atomic<uint64_t> frames_recorded_;
+    std::atomic<uint64_t> frames_dropped_;
+    std::atomic<uint64_t> bytes_written_;
+    std::atomic<uint32_t> files_written_;
+    std::atomic<bool> direct_io_;
+};
+
+} // namespace converter
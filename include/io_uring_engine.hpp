@@ -0,0 +1,115 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+
+namespace converter {
+
+/**
+ * Minimal io_uring receive engine for one stream socket (Linux only)
+ *
+ * Talks to the kernel through the raw io_uring syscalls, so no liburing is
+ * needed. Each receive is a single IORING_OP_RECV with MSG_WAITALL: the
+ * kernel keeps filling the buffer until it is full, so a whole frame costs
+ * one io_uring_enter() instead of one recv() per chunk the socket happens to
+ * have ready. A memory region (the frame pool) can be registered once, so
+ * receives into it skip the per-call page pinning.
+ *
+ * On other platforms, or kernels without io_uring, init() fails and the
+ * caller keeps using plain recv().
+ */
+class IoUringEngine {
+public:
+    IoUringEngine();
+
+    /**
+     * Destructor - tears down the ring (the socket is not closed)
+     */
+    ~IoUringEngine();
+
+    // Disable copy and move (the kernel holds pointers into the ring mapping)
+    IoUringEngine(const IoUringEngine&) = delete;
+    IoUringEngine& operator=(const IoUringEngine&) = delete;
+
+    /**
+     * Check if this build and kernel can run io_uring at all
+     * @return true if a ring can be created
+     */
+    static bool isSupported();
+
+    /**
+     * Create the ring for a connected socket
+     * @param socket_fd Socket to receive from (owned by the caller)
+     * @return true on success
+     */
+    bool init(int socket_fd);
+
+    /**
+     * Register a memory region as fixed buffer 0
+     *
+     * Receives that land entirely inside the region then use it directly.
+     * Fails (harmlessly) if RLIMIT_MEMLOCK is too small or the kernel cannot
+     * receive into fixed buffers.
+     *
+     * @param base Region start
+     * @param size Region size in bytes
+     * @return true if registered
+     */
+    bool registerRegion(uint8_t* base, size_t size);
+
+    /**
+     * Check if a pointer is the currently registered region
+     */
+    bool isRegistered(const uint8_t* base) const { return registered_base_ != nullptr && registered_base_ == base; }
+
+    /**
+     * Receive exactly size bytes
+     * @param buffer Destination
+     * @param size Number of bytes
+     * @return Bytes received (less than size if the peer closed), or -errno on error
+     */
+    int64_t receiveExact(uint8_t* buffer, size_t size);
+
+    /**
+     * Get number of io_uring_enter() calls made
+     * @return Syscalls since init
+     */
+    uint64_t getSubmitCalls() const { return submit_calls_; }
+
+private:
+    /**
+     * Submit one receive and wait for its completion
+     * @return cqe result (bytes or -errno)
+     */
+    int32_t submitReceive(uint8_t* buffer, size_t size, bool fixed);
+
+    void teardown();
+
+    int ring_fd_;
+    int socket_fd_;
+
+    // Ring mappings (sizes kept for munmap)
+    void* sq_ring_;
+    void* cq_ring_;
+    void* sqes_;
+    size_t sq_ring_size_;
+    size_t cq_ring_size_;
+    size_t sqes_size_;
+
+    // Pointers into the shared rings
+    uint32_t* sq_head_;
+    uint32_t* sq_tail_;
+    uint32_t* sq_mask_;
+    uint32_t* sq_array_;
+    uint32_t* cq_head_;
+    uint32_t* cq_tail_;
+    uint32_t* cq_mask_;
+    void* cqes_;
+
+    uint8_t* registered_base_;
+    size_t registered_size_;
+
+    uint64_t submit_calls_;
+};
+
+} // namespace converter
@@ -0,0 +1,172 @@
+#pragma once
+
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+namespace converter {
+
+/**
+ * Pipeline stages with a latency histogram
+ */
+enum class PipelineStage {
+    Receive,    // First bytes of a frame read -> frame complete (receiver thread)
+    Unpack,     // Unpacking one frame (worker threads)
+    Write,      // Write callback for one frame (writer thread)
+    EndToEnd    // First bytes read -> write callback returned
+};
+
+inline constexpr size_t kPipelineStageCount = 4;
+
+inline const char* pipelineStageToString(PipelineStage stage)
+{
+    switch (stage) {
+        case PipelineStage::Receive: return "receive";
+        case PipelineStage::Unpack: return "unpack";
+        case PipelineStage::Write: return "write";
+        case PipelineStage::EndToEnd: return "end_to_end";
+        default: return "unknown";
+    }
+}
+
+/**
+ * HDR-style latency histogram in nanoseconds, recordable at line rate
+ *
+ * Buckets are log-linear: exact below 64 ns, then 32 buckets per power of
+ * two, so any recorded value is off by at most 1/32 (~3 %) of itself. Values
+ * above ~18 minutes land in the last bucket. The 1152 counters take 9 KB.
+ *
+ * record() is for a single writer thread: it uses plain relaxed loads and
+ * stores, no read-modify-write, so it costs a few nanoseconds and never
+ * contends. snapshot() may be called from any thread at any time; a snapshot
+ * taken while recording can be a few samples inconsistent between buckets,
+ * count and sum, which does not matter for monitoring.
+ */
+class LatencyHistogram {
+public:
+    static constexpr int kSubBucketBits = 5;
+    static constexpr int kMaxShift = 34;
+    static constexpr size_t kLinearBuckets = size_t{2} << kSubBucketBits;  // 64
+    static constexpr size_t kBucketCount = kLinearBuckets + kMaxShift * (size_t{1} << kSubBucketBits);
+
+    /**
+     * Point-in-time copy of a histogram, for statistics and export
+     */
+    struct Snapshot {
+        std::vector<uint64_t> counts;   // Per bucket (empty = no samples)
+        uint64_t count = 0;
+        uint64_t sum_ns = 0;
+        uint64_t max_ns = 0;
+
+        /**
+         * Add another snapshot's samples (e.g. of a different worker)
+         * @param other Snapshot to add
+         */
+        void merge(const Snapshot& other);
+
+        /**
+         * Get a quantile
+         * @param q Quantile, 0..1 (0.99 = p99)
+         * @return Upper bound of the bucket holding it in ns (max_ns for q = 1), 0 without samples
+         */
+        uint64_t percentile(double q) const;
+
+        /**
+         * Count samples no larger than a value (for cumulative export buckets)
+         * @param value_ns Upper bound in ns
+         * @return Samples in buckets that lie entirely at or below value_ns
+         */
+        uint64_t countAtOrBelow(uint64_t value_ns) const;
+
+        /**
+         * Get the mean
+         * @return Mean in ns, 0 without samples
+         */
+        double meanNs() const { return count > 0 ? static_cast<double>(sum_ns) / static_cast<double>(count) : 0.0; }
+    };
+
+    LatencyHistogram() = default;
+
+    // Disable copy (atomics; copy a snapshot instead)
+    LatencyHistogram(const LatencyHistogram&) = delete;
+    LatencyHistogram& operator=(const LatencyHistogram&) = delete;
+
+    /**
+     * Record one sample (single writer thread)
+     * @param value_ns Latency in ns (negative values count as 0)
+     */
+    void record(int64_t value_ns)
+    {
+        const uint64_t value = value_ns > 0 ? static_cast<uint64_t>(value_ns) : 0;
+        bump(counts_[bucketIndex(value)], 1);
+        bump(count_, 1);
+        bump(sum_ns_, value);
+        if (value > max_ns_.load(std::memory_order_relaxed)) {
+            max_ns_.store(value, std::memory_order_relaxed);
+        }
+    }
+
+    /**
+     * Copy the current state (any thread)
+     * @return Snapshot
+     */
+    Snapshot snapshot() const;
+
+    /**
+     * Get number of samples recorded
+     * @return Samples
+     */
+    uint64_t count() const { return count_.load(std::memory_order_relaxed); }
+
+    /**
+     * Get the bucket a value is counted in
+     * @param value_ns Value in ns
+     * @return Bucket index, < kBucketCount
+     */
+    static size_t bucketIndex(uint64_t value_ns)
+    {
+        if (value_ns < kLinearBuckets) {
+            return static_cast<size_t>(value_ns);
+        }
+        const int shift = std::min(kMaxShift, highestBit(value_ns) - kSubBucketBits);
+        const uint64_t sub = std::min<uint64_t>(value_ns >> shift, (uint64_t{2} << kSubBucketBits) - 1);
+        return kLinearBuckets + static_cast<size_t>(shift - 1) * (size_t{1} << kSubBucketBits) +
+               static_cast<size_t>(sub - (uint64_t{1} << kSubBucketBits));
+    }
+
+    /**
+     * Get the largest value counted in a bucket
+     * @param index Bucket index
+     * @return Inclusive upper bound in ns
+     */
+    static uint64_t bucketUpperBound(size_t index);
+
+private:
+    static void bump(std::atomic<uint64_t>& counter, uint64_t amount)
+    {
+        counter.store(counter.load(std::memory_order_relaxed) + amount, std::memory_order_relaxed);
+    }
+
+    static int highestBit(uint64_t value)
+    {
+#if defined(__GNUC__) || defined(__clang__)
+        return 63 - __builtin_clzll(value);
+#else
+        int bit = 0;
+        while (value >>= 1) {
+            bit++;
+        }
+        return bit;
+#endif
+    }
+
+    std::array<std::atomic<uint64_t>, kBucketCount> counts_{};
+    std::atomic<uint64_t> count_{0};
+    std::atomic<uint64_t> sum_ns_{0};
+    std::atomic<uint64_t> max_ns_{0};
+};
+
+} // namespace converter
@@ -0,0 +1,110 @@
+#pragma once
+
+#include "config.hpp"
+#include "event_fanout.hpp"
+#include "pipeline.hpp"
+#include "reactor.hpp"
+#include <atomic>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace converter {
+
+/**
+ * One pipeline to export, with the label it is exported under
+ */
+struct MetricsSource {
+    std::string camera;
+    const Pipeline* pipeline;
+};
+
+/**
+ * Render pipeline counters and stage latencies in the Prometheus text format
+ *
+ * Per camera: frame/byte/drop/write counters, per-worker frames and events,
+ * per-queue depth, and per stage (PipelineStage) a latency histogram in
+ * seconds plus p50/p90/p99/p99.9/max gauges taken from the full-resolution
+ * histogram. Export buckets run from 1 us to 1 s in 1-2.5-5 steps; a sample
+ * is counted under the first export bucket its histogram bucket fits in.
+ * Per output sink (EventFanout): packets written and dropped, queue depth
+ * and queue lag.
+ *
+ * @param sources Pipelines to export
+ * @param outputs Output fan-outs to export (sinks labelled by name)
+ * @return Exposition text (text/plain; version=0.0.4)
+ */
+std::string renderMetrics(const std::vector<MetricsSource>& sources,
+                          const std::vector<const EventFanout*>& outputs = {});
+
+/**
+ * Minimal HTTP server answering GET /metrics
+ *
+ * Runs on its own thread and Reactor, so scrapes never touch the pipeline
+ * threads: rendering only reads their relaxed counters and histograms.
+ * Each request is answered and the connection closed (HTTP/1.0 style).
+ */
+class MetricsServer {
+public:
+    // Produce the response body for a scrape (called on the server thread)
+    using RenderFn = std::function<std::string()>;
+
+    /**
+     * Constructor
+     * @param cfg Configuration reference (metrics_port)
+     * @param render Body renderer, e.g. renderMetrics() over all cameras
+     */
+    MetricsServer(const Config& cfg, RenderFn render);
+
+    /**
+     * Destructor - stops the server
+     */
+    ~MetricsServer();
+
+    // Disable copy
+    MetricsServer(const MetricsServer&) = delete;
+    MetricsServer& operator=(const MetricsServer&) = delete;
+
+    /**
+     * Bind metrics_port and start serving
+     * @return true if listening
+     */
+    bool start();
+
+    /**
+     * Stop serving and close all connections
+     */
+    void stop();
+
+    /**
+     * Get number of scrapes answered
+     * @return Requests served with 200
+     */
+    uint64_t getRequestsServed() const { return requests_served_.load(std::memory_order_relaxed); }
+
+private:
+    struct Client {
+        socket_t fd;
+        std::string request;
+        std::string response;
+        size_t sent = 0;
+    };
+
+    void acceptClients();
+    void handleClient(socket_t fd, uint32_t ready);
+    void respond(Client& client);
+    void closeClient(socket_t fd);
+
+    const Config& config_;
+    RenderFn render_;
+    Reactor reactor_;
+    socket_t listen_socket_;
+    std::vector<std::unique_ptr<Client>> clients_;  // Server thread only
+    std::thread thread_;
+    std::atomic<uint64_t> requests_served_;
+};
+
+} // namespace converter
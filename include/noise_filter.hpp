@@ -0,0 +1,179 @@
+#pragma once
+
+#include "config.hpp"
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+namespace converter {
+
+/**
+ * Removes noise events from packed 2-bit frames before they are unpacked
+ *
+ * Three stages, each enabled by its Config setting:
+ *
+ *   - Hot pixels: for the first hot_pixel_learn_frames frames every pixel's
+ *     firings are counted; pixels that fired in more than hot_pixel_fraction
+ *     of them are masked out from then on. The mask is applied to the frame
+ *     8 bytes (32 pixels) at a time with one AND, before anything else looks
+ *     at the frame.
+ *   - Refractory period: an event closer than refractory_period_us to the
+ *     pixel's previous accepted event is dropped.
+ *   - Background activity: an event is kept only if one of its 8 neighbours
+ *     fired within background_activity_us, in an earlier frame or this one.
+ *
+ * All events of a frame share its timestamp. Pixel state is one 8-byte
+ * entry per pixel (last accepted event, last event at all) in 32-bit
+ * wrapping microseconds, with a border that never fires. A first pass stamps
+ * every event, a second checks them, a band of a few kilobytes behind: each
+ * event writes only its own entry and reads its neighbours' with eight
+ * independent loads.
+ *
+ * One filter serves all unpack workers of a pipeline, which filter different
+ * frames at the same time: pixel state is kept in relaxed atomics, and
+ * frames in flight together may see each other's events in either order.
+ * Both checks compare time distances, so this only decides which of two
+ * close events is kept.
+ *
+ * The refractory period, background-activity window and hot-pixel fraction
+ * can be changed while running (reload()); each frame reads both time
+ * thresholds once, as one word, so it is filtered with either the old or
+ * the new pair.
+ */
+class NoiseFilter {
+public:
+    /**
+     * Constructor
+     * @param cfg Configuration reference (frame geometry and filter settings)
+     */
+    explicit NoiseFilter(const Config& cfg);
+
+    // Disable copy
+    NoiseFilter(const NoiseFilter&) = delete;
+    NoiseFilter& operator=(const NoiseFilter&) = delete;
+
+    /**
+     * Filter one dense frame
+     * @param frame Packed frame as received
+     * @param out Filtered frame (may be frame itself)
+     * @param size Frame size in bytes
+     * @param timestamp Frame timestamp (microseconds)
+     * @return Events kept
+     */
+    size_t filter(const uint8_t* frame, uint8_t* out, size_t size, int64_t timestamp);
+
+    /**
+     * Apply new filter thresholds (hot reload, any thread)
+     *
+     * refractory_period_us and background_activity_us take effect from the
+     * next frame; hot_pixel_fraction if the mask is not built yet. A time
+     * filter that was off at construction has no pixel state and stays off.
+     *
+     * @param cfg Configuration with the new thresholds
+     * @return false if a threshold could not be applied without a restart
+     */
+    bool reload(const Config& cfg);
+
+    /**
+     * Get number of hot pixels masked out
+     * @return Pixels (0 until learning has finished)
+     */
+    size_t getHotPixels() const { return hot_pixels_.load(std::memory_order_relaxed); }
+
+    /**
+     * Get number of events removed by the hot-pixel mask
+     */
+    uint64_t getHotPixelEvents() const { return hot_events_.load(std::memory_order_relaxed); }
+
+    /**
+     * Get number of events removed by the refractory period
+     */
+    uint64_t getRefractoryEvents() const { return refractory_events_.load(std::memory_order_relaxed); }
+
+    /**
+     * Get number of events removed by the background-activity filter
+     */
+    uint64_t getBackgroundEvents() const { return background_events_.load(std::memory_order_relaxed); }
+
+    /**
+     * Get number of events that passed
+     */
+    uint64_t getEventsKept() const { return events_kept_.load(std::memory_order_relaxed); }
+
+private:
+    struct PixelState {
+        std::atomic<int32_t> last_event;    // Last accepted event
+        std::atomic<int32_t> last_fire;     // Last event at all, for the neighbours' checks
+    };
+
+    struct Counts {
+        uint64_t hot = 0;
+        uint64_t refractory = 0;
+        uint64_t background = 0;
+        uint64_t kept = 0;
+    };
+
+    /**
+     * Pass 1 over bytes [begin, end): apply the hot-pixel mask, write to out
+     * and stamp every event's last_fire
+     */
+    void maskAndStamp(const uint8_t* frame, uint8_t* out, size_t begin, size_t end, size_t size,
+                      const uint8_t* mask, int32_t now, uint32_t window, Counts& counts);
+
+    /**
+     * Pass 2 over bytes [begin, end) of out: refractory and background checks,
+     * clearing rejected events in place; needs the row below stamped already
+     */
+    void checkEvents(uint8_t* out, size_t begin, size_t end, size_t size, int32_t now, uint32_t refractory,
+                     uint32_t window, Counts& counts);
+
+    /**
+     * Call fn(state index) for each event of one 8-byte word of the frame
+     * @param fn Returns false to clear the event from the word
+     * @return The word with cleared events removed
+     */
+    template<typename Fn>
+    uint64_t forEachEvent(uint64_t word, size_t byte_index, Fn&& fn);
+
+    /**
+     * Check if a neighbour of the pixel at state index `index` fired within `window`
+     */
+    bool isSupported(size_t index, int32_t now, uint32_t window) const;
+
+    /**
+     * Count one learning frame; the frame completing learning builds the mask
+     */
+    void learn(const uint8_t* frame, size_t size);
+    void buildMask();
+
+    bool hasMask() const { return mask_ready_.load(std::memory_order_acquire); }
+
+    const Config& config_;
+    const int width_;
+    const int stride_;                                      // State row length, with the border
+    const size_t band_bytes_;                               // Pass granularity, > one row
+    const int total_pixels_;
+    std::atomic<uint64_t> thresholds_;                     // Refractory period << 32 | support window (us)
+    std::atomic<double> hot_pixel_fraction_;
+
+    std::unique_ptr<PixelState[]> pixels_;                  // (width + 2) x (height + 2)
+    std::once_flag pixels_init_;
+
+    // Hot-pixel learning
+    std::unique_ptr<std::atomic<uint32_t>[]> fire_counts_;
+    std::atomic<int> learn_frames_started_;
+    std::atomic<int> learn_frames_done_;
+    std::vector<uint8_t> mask_;                             // Packed, 11 = keep, 00 = hot
+    std::atomic<bool> mask_ready_;
+    std::atomic<size_t> hot_pixels_;
+
+    std::atomic<uint64_t> hot_events_;
+    std::atomic<uint64_t> refractory_events_;
+    std::atomic<uint64_t> background_events_;
+    std::atomic<uint64_t> events_kept_;
+};
+
+} // namespace converter
@@ -0,0 +1,338 @@
+#pragma once
+
+#include "config.hpp"
+#include "bounded_queue.hpp"
+#include "frame_pool.hpp"
+#include "frame_unpacker.hpp"
+#include "latency_histogram.hpp"
+#include "noise_filter.hpp"
+#include "thread_placement.hpp"
+#include "timestamp_engine.hpp"
+#include <dv-processing/core/event.hpp>
+#include <atomic>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace converter {
+
+/**
+ * One pooled frame travelling through the pipeline
+ */
+struct PipelineFrame {
+    FrameHandle buffer;         // Raw frame as received (pool slot, see FrameHandle::encoding())
+    uint64_t sequence = 0;      // Receive order, also used as the frame number
+    int64_t timestamp = 0;      // Event timestamp (us), from the TimestampEngine
+    dv::EventStore events;      // Unpacked events
+    size_t num_events = 0;
+    int64_t received_ns = 0;    // steady_clock time the frame was complete
+};
+
+/**
+ * Multi-threaded receive -> unpack -> write pipeline
+ *
+ * Threads:
+ *   - 1 receiver: fills pooled frames and deals them round-robin to workers
+ *   - N unpack workers: each owns a FrameUnpacker
+ *   - 1 writer: collects frames round-robin, so output stays in receive order
+ *
+ * Every receiver->worker and worker->writer link is its own BoundedQueue, and
+ * all frame buffers come from a FramePool allocated up front: the receiver
+ * writes into a slot and the same slot is unpacked, with no copy in between. A stall in the
+ * writer therefore fills the queues instead of the socket; what happens next
+ * is Config::queue_full_policy (block, or drop the oldest queued frame).
+ *
+ * Frame timestamps are assigned on the receiver thread, in receive order, by
+ * a TimestampEngine; the workers only apply them.
+ *
+ * With Config::pipeline_cpus set, the receiver, worker and writer threads are
+ * confined to those cores (band threads of the unpackers are not);
+ * receiver_cpus, worker_cpus and writer_cpus place each role separately, and
+ * realtime_priority runs all three under SCHED_FIFO. The frame pool is bound
+ * to the NUMA node of the NIC (numa_node, numa_interface) or, failing that,
+ * of the receiver's core.
+ *
+ * With a noise filter configured (Config::noise_filter_enabled()), workers
+ * run each frame through one shared NoiseFilter into a private scratch
+ * frame and unpack that; compressed frames are expanded to dense first.
+ *
+ * Every frame is timed on steady_clock at each stage (see PipelineStage) into
+ * LatencyHistograms that only the recording thread writes: one for the
+ * receiver, one per worker, two for the writer. Together with the per-worker
+ * counters they can be read from any thread while the pipeline runs.
+ *
+ * reload() changes the queue-full policy, the noise filter thresholds and
+ * the band-split threshold while running. Each thread reads them once per
+ * frame, so a frame is never handled half with the old settings.
+ */
+class Pipeline {
+public:
+    // Fill the pool slot with one frame; return false on receive failure
+    using ReceiveFn = std::function<bool(FrameHandle&)>;
+
+    // Re-establish the input after a receive failure; return false to give up
+    using ReconnectFn = std::function<bool()>;
+
+    // Consume one unpacked frame (called on the writer thread, in order)
+    using WriteFn = std::function<void(const PipelineFrame&)>;
+
+    // Observe a received frame before it is unpacked (receiver thread; must not block)
+    using TapFn = std::function<void(const PipelineFrame&)>;
+
+    /**
+     * Constructor
+     * @param cfg Configuration reference
+     * @param receive Receive callback (receiver thread)
+     * @param reconnect Reconnect callback (receiver thread)
+     * @param write Write callback (writer thread)
+     */
+    Pipeline(const Config& cfg, ReceiveFn receive, ReconnectFn reconnect, WriteFn write);
+
+    /**
+     * Destructor - stops all threads
+     */
+    ~Pipeline();
+
+    // Disable copy
+    Pipeline(const Pipeline&) = delete;
+    Pipeline& operator=(const Pipeline&) = delete;
+
+    /**
+     * Set a callback that sees every received frame, including ones the
+     * queue-full policy later drops (e.g. FrameRecorder::recordFrame).
+     * Must be set before start(). A tap that keeps the frame's buffer holds
+     * a pool slot: Config::record_queue_frames spare slots exist for that.
+     * @param tap Tap callback (receiver thread)
+     */
+    void setReceiveTap(TapFn tap) { receive_tap_ = std::move(tap); }
+
+    /**
+     * Replace the write callback given to the constructor, for outputs that
+     * come up after the pipeline (see Config::warm_start). Must be set before start().
+     * @param write Write callback (writer thread)
+     */
+    void setWriteCallback(WriteFn write) { write_ = std::move(write); }
+
+    /**
+     * Pre-fault the frame pool and fill each unpacker's event arena with one
+     * packet per frame a worker can have in flight (Config::warm_start).
+     * Must be called before start().
+     * @return Bytes of buffer memory faulted in
+     */
+    size_t warmUp();
+
+    /**
+     * Start receiver, worker and writer threads
+     */
+    void start();
+
+    /**
+     * Stop and join all threads (queued frames are discarded)
+     */
+    void stop();
+
+    /**
+     * Apply the hot-reloadable settings (see isReloadableConfigKey()); any thread
+     * @param cfg Configuration with the new values
+     * @return false if a setting needs a restart (e.g. turning on a noise filter that is off)
+     */
+    bool reload(const Config& cfg);
+
+    /**
+     * Check if the pipeline is still running
+     * @return false once stopped or the receiver gave up reconnecting
+     */
+    bool isRunning() const { return running_.load(std::memory_order_relaxed); }
+
+    /**
+     * Get number of frames received from the input
+     * @return Frames received
+     */
+    uint64_t getFramesReceived() const { return frames_received_.load(std::memory_order_relaxed); }
+
+    /**
+     * Get number of frame bytes received from the input
+     * @return Bytes received
+     */
+    uint64_t getBytesReceived() const { return bytes_received_.load(std::memory_order_relaxed); }
+
+    /**
+     * Get number of frames dropped by the DropOldest policy
+     * @return Frames dropped
+     */
+    uint64_t getFramesDropped() const { return frames_dropped_.load(std::memory_order_relaxed); }
+
+    /**
+     * Get number of frames handed to the write callback
+     * @return Frames written
+     */
+    uint64_t getFramesWritten() const { return frames_written_.load(std::memory_order_relaxed); }
+
+    /**
+     * Get the latency distribution of a stage
+     * @param stage Pipeline stage (Unpack merges all workers)
+     * @return Snapshot of the stage's histogram
+     */
+    LatencyHistogram::Snapshot getLatency(PipelineStage stage) const;
+
+    /**
+     * Get number of unpack workers
+     * @return Workers
+     */
+    size_t getWorkerCount() const { return num_workers_; }
+
+    /**
+     * Get number of frames a worker unpacked
+     * @param worker Worker index
+     * @return Frames
+     */
+    uint64_t getWorkerFrames(size_t worker) const
+    {
+        return worker_counters_[worker]->frames.load(std::memory_order_relaxed);
+    }
+
+    /**
+     * Get number of events a worker produced
+     * @param worker Worker index
+     * @return Events
+     */
+    uint64_t getWorkerEvents(size_t worker) const
+    {
+        return worker_counters_[worker]->events.load(std::memory_order_relaxed);
+    }
+
+    /**
+     * Get frames waiting for a worker
+     * @param worker Worker index
+     * @return Approximate depth of the receiver -> worker queue
+     */
+    size_t getUnpackQueueDepth(size_t worker) const { return unpack_queues_[worker]->sizeApprox(); }
+
+    /**
+     * Get unpacked frames of a worker waiting for the writer
+     * @param worker Worker index
+     * @return Approximate depth of the worker -> writer queue
+     */
+    size_t getWriteQueueDepth(size_t worker) const { return write_queues_[worker]->sizeApprox(); }
+
+    /**
+     * Get capacity of each stage queue
+     * @return Frames per queue
+     */
+    size_t getQueueCapacity() const { return unpack_queues_.front()->capacity(); }
+
+    /**
+     * Get number of event storage allocations made by all unpack workers
+     * @return Allocations (flat once the event arenas are warm)
+     */
+    uint64_t getEventAllocations() const;
+
+    /**
+     * Get the kernel the unpack workers use
+     * @return Resolved unpack kernel
+     */
+    UnpackKernel getActiveKernel() const { return unpackers_.front()->getActiveKernel(); }
+
+    /**
+     * Get the noise filter shared by the unpack workers
+     * @return Filter, or nullptr if no noise filter is configured
+     */
+    const NoiseFilter* getNoiseFilter() const { return noise_filter_.get(); }
+
+    /**
+     * Get the timestamp engine (source in use, PLL statistics)
+     * @return Timestamp engine
+     */
+    const TimestampEngine& getTimestampEngine() const { return timestamps_; }
+
+    /**
+     * Get the frame buffer pool
+     * @return Buffer pool shared by receiver and unpackers
+     */
+    const FramePool& getBufferPool() const { return *buffer_pool_; }
+
+    /**
+     * Get the cores and scheduling each pipeline thread ended up with
+     * @return Receiver, workers, writer (empty before start())
+     */
+    const std::vector<ThreadPlacement>& getThreadPlacement() const { return placement_; }
+
+private:
+    using FrameQueue = BoundedQueue<PipelineFrame*>;
+
+    void receiverLoop();
+    void workerLoop(size_t worker);
+    void writerLoop();
+
+    /**
+     * Take a frame and a buffer slot from the pools, waiting if either is empty
+     * @return Frame, or nullptr if stopping
+     */
+    PipelineFrame* acquireFrame();
+
+    /**
+     * Return a frame to the pool
+     */
+    void recycleFrame(PipelineFrame* frame);
+
+    /**
+     * Push a frame applying the queue-full policy
+     * @return false if stopping (frame not pushed)
+     */
+    bool pushFrame(FrameQueue& queue, PipelineFrame* frame);
+
+    const Config& config_;
+    ReceiveFn receive_;
+    ReconnectFn reconnect_;
+    WriteFn write_;
+    TapFn receive_tap_;
+
+    size_t num_workers_;
+    std::vector<std::unique_ptr<FrameUnpacker>> unpackers_;
+    std::vector<std::unique_ptr<FrameQueue>> unpack_queues_;  // receiver -> worker[i]
+    std::vector<std::unique_ptr<FrameQueue>> write_queues_;   // worker[i] -> writer
+
+    // Optional filter stage between receive and unpack; each worker filters
+    // into its own scratch frame (the pool slot may be shared, e.g. recorded)
+    std::unique_ptr<NoiseFilter> noise_filter_;
+    std::vector<std::vector<uint8_t>> filtered_frames_;
+
+    // Receiver thread only
+    TimestampEngine timestamps_;
+
+    // Raw buffer slots, declared first so frames holding handles die before it
+    std::unique_ptr<FramePool> buffer_pool_;
+
+    // Frame pool: per-frame state plus free list
+    std::vector<std::unique_ptr<PipelineFrame>> frames_;
+    std::unique_ptr<FrameQueue> free_frames_;
+
+    std::vector<std::thread> threads_;
+    std::vector<ThreadPlacement> placement_;
+    std::atomic<bool> running_;
+    std::atomic<bool> stop_requested_;
+    std::atomic<QueueFullPolicy> queue_full_policy_;
+
+    std::atomic<uint64_t> frames_received_;
+    std::atomic<uint64_t> bytes_received_;
+    std::atomic<uint64_t> frames_dropped_;
+    std::atomic<uint64_t> frames_written_;
+
+    // Written by one worker each, on its own cache line
+    struct alignas(64) WorkerCounters {
+        std::atomic<uint64_t> frames{0};
+        std::atomic<uint64_t> events{0};
+    };
+    std::vector<std::unique_ptr<WorkerCounters>> worker_counters_;
+
+    // Stage latencies, each written by one thread only
+    LatencyHistogram receive_latency_;                                      // Receiver
+    std::vector<std::unique_ptr<LatencyHistogram>> unpack_latency_;         // Worker i
+    LatencyHistogram write_latency_;                                        // Writer
+    LatencyHistogram end_to_end_latency_;                                   // Writer
+};
+
+} // namespace converter
@@ -0,0 +1,239 @@
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <functional>
+#include <vector>
+
+#ifdef _WIN32
+    #include <winsock2.h>
+    typedef SOCKET socket_t;
+#else
+    typedef int socket_t;
+#endif
+
+namespace converter {
+
+/**
+ * Readiness-based event loop for sockets and timers
+ *
+ * Backends: epoll (Linux), kqueue (macOS/BSD), WSAPoll (Windows) or poll
+ * (other POSIX). Sockets are registered with a handler that runs once they
+ * are readable or writable (errors and hang-ups wake both); timers run once
+ * or periodically. Everything runs on the thread calling runOnce()/run()/
+ * waitFor(); only stop() and wake() may be called from other threads, and
+ * both are async-signal-safe, so a signal handler can end a wait at once.
+ *
+ * A socket must be removed before it is closed: the kernel may hand its
+ * number to the next socket opened.
+ *
+ * The receivers use waitFor() when a non-blocking call would block, so the
+ * receive path costs no extra syscalls while data is flowing.
+ */
+class Reactor {
+public:
+    // Interest / readiness bits
+    static constexpr uint32_t Readable = 1u << 0;
+    static constexpr uint32_t Writable = 1u << 1;
+
+    // Outcome of waitFor()
+    enum class WaitResult {
+        Ready,      // The socket is ready
+        Timeout,    // The timeout expired first
+        Stopped,    // stop() was called
+        Error       // The backend failed
+    };
+
+    // Called with the readiness bits of a registered socket
+    using IoHandler = std::function<void(uint32_t ready)>;
+
+    // Called when a timer expires
+    using TimerHandler = std::function<void()>;
+
+    using TimerId = uint64_t;
+
+    /**
+     * Constructor - creates the backend and its wake-up channel
+     */
+    Reactor();
+
+    /**
+     * Destructor - closes the backend (registered sockets are not closed)
+     */
+    ~Reactor();
+
+    // Disable copy and move (handlers capture it, the kernel holds its descriptors)
+    Reactor(const Reactor&) = delete;
+    Reactor& operator=(const Reactor&) = delete;
+
+    /**
+     * Check if the backend was created
+     * @return true if usable
+     */
+    bool isValid() const { return valid_; }
+
+    /**
+     * Get the backend in use
+     * @return "epoll", "kqueue", "WSAPoll" or "poll"
+     */
+    static const char* getBackendName();
+
+    /**
+     * Register a socket
+     * @param fd Socket
+     * @param interest Readable and/or Writable
+     * @param handler Called when ready (may be empty for sockets only used with waitFor())
+     * @return true if registered
+     */
+    bool add(socket_t fd, uint32_t interest, IoHandler handler);
+
+    /**
+     * Change what a registered socket is watched for
+     * @param fd Registered socket
+     * @param interest Readable and/or Writable
+     * @return true on success
+     */
+    bool modify(socket_t fd, uint32_t interest);
+
+    /**
+     * Unregister a socket (no-op if it is not registered)
+     * @param fd Socket
+     */
+    void remove(socket_t fd);
+
+    /**
+     * Start a timer
+     * @param delay_us Time until the first expiry
+     * @param period_us Time between further expiries (0 = one-shot)
+     * @param handler Called on expiry
+     * @return Timer id for cancelTimer()
+     */
+    TimerId addTimer(int64_t delay_us, int64_t period_us, TimerHandler handler);
+
+    /**
+     * Cancel a timer (no-op if it already fired or was cancelled)
+     * @param id Timer id
+     */
+    void cancelTimer(TimerId id);
+
+    /**
+     * Wait for ready sockets or due timers once and run their handlers
+     * @param timeout_us Longest wait (-1 = until something happens)
+     * @return false if stopped
+     */
+    bool runOnce(int64_t timeout_us = -1);
+
+    /**
+     * Run handlers and timers until stop()
+     */
+    void run();
+
+    /**
+     * Run handlers and timers for a while
+     * @param duration_us How long
+     * @return false if stopped before the time was up
+     */
+    bool runFor(int64_t duration_us);
+
+    /**
+     * Wait until a socket is ready, running other handlers and timers meanwhile
+     *
+     * The socket is registered on first use and stays registered until
+     * remove(), so waiting again costs a single backend call.
+     *
+     * @param fd Socket
+     * @param interest Readable and/or Writable
+     * @param timeout_us Longest wait (-1 = no limit)
+     * @return Ready, Timeout, Stopped or Error
+     */
+    WaitResult waitFor(socket_t fd, uint32_t interest, int64_t timeout_us = -1);
+
+    /**
+     * Make every current and future wait return Stopped until resume()
+     * (thread-safe, async-signal-safe)
+     */
+    void stop();
+
+    /**
+     * Clear a stop()
+     */
+    void resume() { stopped_.store(false, std::memory_order_release); }
+
+    /**
+     * Check if stop() was called
+     * @return true if stopped
+     */
+    bool isStopped() const { return stopped_.load(std::memory_order_acquire); }
+
+    /**
+     * Interrupt the current wait once (thread-safe, async-signal-safe)
+     */
+    void wake();
+
+private:
+    struct Entry {
+        socket_t fd;
+        uint32_t interest;
+        IoHandler handler;
+    };
+
+    struct Timer {
+        TimerId id;
+        std::chrono::steady_clock::time_point due;
+        std::chrono::microseconds period;
+        TimerHandler handler;
+    };
+
+    struct Ready {
+        socket_t fd;
+        uint32_t events;
+    };
+
+    Entry* find(socket_t fd);
+
+    /**
+     * Wait in the backend
+     * @param timeout_ms Longest wait (-1 = no limit)
+     * @return false on backend error
+     */
+    bool poll(int timeout_ms);
+
+    /**
+     * Wait up to timeout_us (shortened to the next timer), then run ready
+     * handlers (except `target`'s) and due timers
+     * @return Readiness of target (0 if not ready), or -1 on backend error
+     */
+    int64_t dispatch(int64_t timeout_us, socket_t target);
+
+    void runTimers();
+    void drainWake();
+
+    bool valid_;
+    std::atomic<bool> stopped_;
+
+    int poll_fd_;           // epoll / kqueue descriptor (-1 for the poll backends)
+    socket_t wake_read_;    // eventfd, pipe or loopback socket
+    socket_t wake_write_;
+
+    std::vector<Entry> entries_;
+    std::vector<Ready> ready_;
+    std::vector<Timer> timers_;
+    TimerId next_timer_id_;
+};
+
+/**
+ * Switch a socket between blocking and non-blocking mode
+ * @param fd Socket
+ * @param enable true for non-blocking
+ * @return true on success
+ */
+bool setNonBlocking(socket_t fd, bool enable);
+
+/**
+ * Check if the last failed socket call only found nothing to do
+ * @return true for EAGAIN / EWOULDBLOCK / EINTR (WSAEWOULDBLOCK on Windows)
+ */
+bool socketWouldBlock();
+
+} // namespace converter
@@ -0,0 +1,261 @@
+#pragma once
+
+#include <algorithm>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <string>
+
+namespace converter {
+
+/**
+ * One event in the shared-memory ring (16 bytes, little endian)
+ */
+struct ShmEventRecord {
+    int64_t timestamp;      // Microseconds, as in the AEDAT4 stream
+    int16_t x;
+    int16_t y;
+    uint8_t polarity;       // 1 = ON
+    uint8_t reserved[3];
+};
+static_assert(sizeof(ShmEventRecord) == 16, "ShmEventRecord layout is part of the shared-memory format");
+
+/**
+ * Header at the start of the shared-memory object (one page)
+ *
+ * Records follow at header_bytes. write_index counts every record ever
+ * published; record i lives at slot i % capacity. A write is a seqlock:
+ * the writer first stores reserve_index (the end of the batch it is about
+ * to write), fills the slots, then stores write_index (release) and bumps
+ * notify, a futex word readers may sleep on. A reader that copied records
+ * checks reserve_index afterwards: anything older than reserve_index -
+ * capacity may have been overwritten under it. Readers never write to the
+ * mapping except `waiters`.
+ */
+struct ShmRingHeader {
+    static constexpr uint32_t kMagic = 0x52425644;  // "DVBR"
+    static constexpr uint32_t kVersion = 1;
+
+    std::atomic<uint32_t> magic;        // Written last when the ring is ready
+    uint32_t version;
+    uint32_t header_bytes;
+    uint32_t record_bytes;
+    uint64_t capacity;                  // Records, a power of two
+    uint32_t width;
+    uint32_t height;
+    uint64_t session;                   // Changes when the converter restarts
+
+    alignas(64) std::atomic<uint64_t> write_index;
+    std::atomic<uint64_t> reserve_index;
+    alignas(64) std::atomic<uint32_t> notify;
+    std::atomic<uint32_t> waiters;      // Readers sleeping on notify
+};
+static_assert(std::atomic<uint64_t>::is_always_lock_free, "shared-memory atomics must be lock-free");
+
+/**
+ * Producer side of the shared-memory event ring
+ *
+ * A single writer; slow readers are overrun rather than waited for, so the
+ * converter never blocks on a local consumer. With no reader sleeping, a
+ * publish is two stores; otherwise one futex wake (Linux).
+ */
+class ShmRingWriter {
+public:
+    ShmRingWriter() = default;
+    ~ShmRingWriter();
+
+    // Disable copy (owns the mapping)
+    ShmRingWriter(const ShmRingWriter&) = delete;
+    ShmRingWriter& operator=(const ShmRingWriter&) = delete;
+
+    /**
+     * Create (or replace) the shared-memory object and map it
+     * @param name Object name (POSIX shm, e.g. "dvbridge" -> /dev/shm/dvbridge)
+     * @param capacity Records (rounded up to a power of two)
+     * @param width Sensor width, for readers
+     * @param height Sensor height, for readers
+     * @return true on success
+     */
+    bool create(const std::string& name, size_t capacity, int width, int height);
+
+    /**
+     * Unmap and remove the object (readers keep their mappings)
+     */
+    void close();
+
+    /**
+     * Check if the ring is mapped
+     * @return true once created
+     */
+    bool isOpen() const { return header_ != nullptr; }
+
+    /**
+     * Publish events
+     * @param events Anything with size() and iterable over events with timestamp(), x(), y(),
+     *               polarity() (e.g. dv::EventStore); a batch larger than the ring keeps its newest events
+     */
+    template <typename Events>
+    void writeEvents(const Events& events)
+    {
+        const uint64_t size = static_cast<uint64_t>(events.size());
+        if (size == 0) {
+            return;
+        }
+        const uint64_t skip = size > mask_ + 1 ? size - (mask_ + 1) : 0;
+        uint64_t index = header_->write_index.load(std::memory_order_relaxed);
+        const uint64_t end = index + (size - skip);
+
+        // Readers must learn which slots are about to change before they do
+        header_->reserve_index.store(end, std::memory_order_relaxed);
+        std::atomic_thread_fence(std::memory_order_release);
+
+        uint64_t position = 0;
+        for (const auto& event : events) {
+            if (position++ < skip) {
+                continue;
+            }
+            ShmEventRecord& record = records_[index & mask_];
+            record.timestamp = event.timestamp();
+            record.x = event.x();
+            record.y = event.y();
+            record.polarity = event.polarity() ? 1 : 0;
+            index++;
+        }
+        publish(end);
+    }
+
+    /**
+     * Get number of records published
+     * @return Records
+     */
+    uint64_t getRecordsWritten() const { return header_ ? header_->write_index.load(std::memory_order_relaxed) : 0; }
+
+private:
+    void publish(uint64_t write_index);
+
+    std::string name_;
+    ShmRingHeader* header_ = nullptr;
+    ShmEventRecord* records_ = nullptr;
+    uint64_t mask_ = 0;
+    size_t mapped_bytes_ = 0;
+};
+
+/**
+ * Consumer side of the shared-memory event ring (any process)
+ *
+ * A reader keeps its own position and starts at the newest event. Records
+ * are read in place: consume() hands out pointers into the mapping and then
+ * checks, seqlock style, that the writer did not lap them meanwhile. Events
+ * overwritten before they were read are skipped and counted as lost.
+ */
+class ShmRingReader {
+public:
+    ShmRingReader() = default;
+    ~ShmRingReader();
+
+    // Disable copy (owns the mapping)
+    ShmRingReader(const ShmRingReader&) = delete;
+    ShmRingReader& operator=(const ShmRingReader&) = delete;
+
+    /**
+     * Map an existing ring read-only
+     * @param name Object name given to the converter (shm_output_name)
+     * @return true if a valid ring was found
+     */
+    bool open(const std::string& name);
+
+    /**
+     * Unmap the ring
+     */
+    void close();
+
+    /**
+     * Process available events in place
+     *
+     * `fn(const ShmEventRecord* records, size_t count)` is called at most twice
+     * (the ring may wrap). If the writer overran records while fn looked at
+     * them, they are counted as lost and the reader moves past them: fn must
+     * tolerate having seen a few torn records in that case.
+     *
+     * @param fn Chunk callback
+     * @param max_records Upper bound on records handed out
+     * @return Records handed out that were still intact afterwards
+     */
+    template <typename Fn>
+    size_t consume(Fn&& fn, size_t max_records = SIZE_MAX)
+    {
+        uint64_t available = skipOverrun();
+        const uint64_t count = std::min<uint64_t>(available, max_records);
+        if (count == 0) {
+            return 0;
+        }
+
+        const uint64_t first = read_index_ & mask_;
+        const uint64_t chunk = std::min<uint64_t>(count, capacity_ - first);
+        fn(static_cast<const ShmEventRecord*>(records_ + first), static_cast<size_t>(chunk));
+        if (chunk < count) {
+            fn(static_cast<const ShmEventRecord*>(records_), static_cast<size_t>(count - chunk));
+        }
+        return static_cast<size_t>(finishRead(count));
+    }
+
+    /**
+     * Copy available events out
+     * @param out Destination
+     * @param max_records Room in out
+     * @return Records copied (all intact)
+     */
+    size_t read(ShmEventRecord* out, size_t max_records);
+
+    /**
+     * Sleep until the writer publishes or the timeout expires
+     * @param timeout_us Longest wait (-1 = no limit)
+     * @return true if events are available
+     */
+    bool wait(int64_t timeout_us);
+
+    /**
+     * Get number of events the reader fell too far behind to read
+     * @return Lost events
+     */
+    uint64_t getLost() const { return lost_; }
+
+    /**
+     * Get the sensor size the converter announced
+     * @return Width / height in pixels
+     */
+    int getWidth() const { return header_ ? static_cast<int>(header_->width) : 0; }
+    int getHeight() const { return header_ ? static_cast<int>(header_->height) : 0; }
+
+    /**
+     * Check if the converter that created the ring has since been restarted
+     * @return true if the ring under this name was replaced (reopen it)
+     */
+    bool isStale() const;
+
+private:
+    /**
+     * Move past records the writer has already overwritten
+     * @return Records available from the new position
+     */
+    uint64_t skipOverrun();
+
+    /**
+     * Validate and commit a read of `count` records from the current position
+     * @return Records that were still intact
+     */
+    uint64_t finishRead(uint64_t count);
+
+    std::string name_;
+    const ShmRingHeader* header_ = nullptr;
+    ShmRingHeader* mutable_header_ = nullptr;   // Only for `waiters`
+    const ShmEventRecord* records_ = nullptr;
+    uint64_t capacity_ = 0;
+    uint64_t mask_ = 0;
+    uint64_t inode_ = 0;
+    size_t mapped_bytes_ = 0;
+    uint64_t read_index_ = 0;
+    uint64_t lost_ = 0;
+};
+
+} // namespace converter
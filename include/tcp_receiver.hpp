@@ -1,9 +1,15 @@
 #pragma once
 
 #include "config.hpp"
+#include "busy_poll.hpp"
+#include "frame_pool.hpp"
+#include "io_uring_engine.hpp"
+#include "reactor.hpp"
+#include <atomic>
 #include <vector>
 #include <string>
 #include <cstdint>
+#include <memory>
 #include <stdexcept>
 
 // Platform-specific includes
@@ -33,14 +39,27 @@ namespace converter {
  * Listens for incoming TCP connections from the FPGA/camera.
  * The FPGA acts as client and connects to this server.
  * Handles partial reads and optional frame headers.
+ *
+ * With Config::tcp_backend = IoUring, receives go through an IoUringEngine
+ * (one MSG_WAITALL receive per frame, frame pool registered with the
+ * kernel); where io_uring is unavailable the recv() loop is used instead.
+ *
+ * The listening socket outlives client connections: after a disconnect
+ * the FPGA can reconnect into the backlog while the converter is still
+ * clearing up, and connect() then accepts it immediately.
+ *
+ * Sockets are non-blocking: accept() and recv() wait on a Reactor when
+ * there is nothing to take, so interrupt() ends a wait for the FPGA or for
+ * data at once (io_uring receives are ended by shutting the socket down).
  */
 class TcpReceiver {
 public:
     /**
      * Constructor
      * @param cfg Configuration reference
+     * @param reactor Event loop to wait on (nullptr = create one)
      */
-    explicit TcpReceiver(const Config& cfg);
+    explicit TcpReceiver(const Config& cfg, Reactor* reactor = nullptr);
     
     /**
      * Destructor - closes sockets
@@ -56,13 +75,43 @@ public:
     TcpReceiver& operator=(TcpReceiver&& other) noexcept;
     
     /**
-     * Start listening and wait for FPGA connection
-     * @return true if connection accepted successfully
+     * Bind the camera port and start listening (no-op if already listening)
+     *
+     * The FPGA's connection completes in the listen backlog from then on, so
+     * a later connect() takes it at once.
+     *
+     * @return true if the port is listening
+     */
+    bool startListening();
+
+    /**
+     * Close the listening socket (the client connection is left alone)
+     */
+    void stopListening();
+
+    /**
+     * Start listening if needed, then wait for the FPGA connection
+     * @return true if connection accepted successfully (false if interrupted)
      */
     bool connect();
+
+    /**
+     * Make a blocked connect() or receive return false promptly; sticks until
+     * resume() (thread-safe, async-signal-safe)
+     */
+    void interrupt();
+
+    /**
+     * Allow waiting again after interrupt()
+     */
+    void resume();
     
     /**
-     * Disconnect and close sockets
+     * Close the client connection
+     *
+     * The listening socket stays open (until stopListening() or destruction),
+     * so an FPGA that reconnects right away lands in the backlog and the
+     * next connect() accepts it without binding again.
      */
     void disconnect();
     
@@ -74,10 +123,27 @@ public:
     
     /**
      * Receive one complete frame
-     * @param buffer Output buffer (will be resized to frame size)
+     * @param buffer Output buffer (resized to the frame size, or the payload
+     *               size of a compressed frame, see getLastFrameEncoding())
      * @return true if frame received successfully, false on error/disconnect
      */
     bool receiveFrame(std::vector<uint8_t>& buffer);
+
+    /**
+     * Receive one complete frame straight into a pool slot (no copy)
+     *
+     * Frames whose header announces more bytes than the slot holds are
+     * read and discarded, then the next frame is received. With an occupancy
+     * bitmap configured, it is read into the end of the slot (see
+     * FrameHandle::occupancy()). The frame's raw timestamp (FPGA header,
+     * receive time or steady_clock, per Config::timestamp_source) is stored
+     * in the slot (see FrameHandle::timestamp()), and so is the encoding the
+     * size header announced (see FrameHandle::encoding()).
+     *
+     * @param frame Pool slot to fill (size set to the frame size)
+     * @return true if frame received successfully, false on error/disconnect
+     */
+    bool receiveFrame(FrameHandle& frame);
     
     /**
      * Get the expected frame size (without header)
@@ -97,14 +163,106 @@ public:
      */
     uint64_t getTotalFramesReceived() const { return total_frames_received_; }
 
+    /**
+     * Get number of receive syscalls (recv() or io_uring_enter())
+     * @return Syscalls since connection
+     */
+    uint64_t getTotalReceiveCalls() const;
+
+    /**
+     * Get what the receiver did while the socket was empty (all connections)
+     * @return Busy-poll counters, all 0 in Blocking mode
+     */
+    const BusyPollStats& getBusyPollStats() const { return poller_.getStats(); }
+
+    /**
+     * Get the receive engine actually in use
+     * @return IoUring only if the ring was set up for this connection
+     */
+    TcpBackend getActiveBackend() const { return uring_ ? TcpBackend::IoUring : TcpBackend::Socket; }
+
+    /**
+     * Get the raw timestamp of the last frame received
+     * @return FPGA ticks or receive time in ns (see FrameHandle::timestamp()), 0 if none
+     */
+    int64_t getLastFrameTimestamp() const { return last_timestamp_; }
+
+    /**
+     * Get the encoding of the last frame received
+     * @return Encoding from its size header (always Dense without has_header)
+     */
+    FrameEncoding getLastFrameEncoding() const { return header_encoding_; }
+
+    /**
+     * Get number of size headers with an unknown encoding (each one resets the connection)
+     * @return Malformed headers
+     */
+    uint64_t getMalformedHeaders() const { return malformed_headers_; }
+
+    /**
+     * Get number of frames dropped for a CRC mismatch (Config::frame_crc; all connections)
+     * @return Bad frames
+     */
+    uint64_t getCrcErrors() const { return crc_errors_; }
+
+    /**
+     * Get number of connections reset after kCrcErrorsBeforeResync bad frames in a row
+     * @return Resyncs
+     */
+    uint64_t getCrcResyncs() const { return crc_resyncs_; }
+
+    // Bad frames in a row taken as lost stream alignment (the connection is reset)
+    static constexpr int kCrcErrorsBeforeResync = 3;
+
 private:
     /**
      * Receive exact number of bytes (handles partial reads)
      * @param buffer Output buffer
      * @param size Number of bytes to receive
+     * @param crc If set, CRC32C running over the bytes, updated per chunk while they are in cache
      * @return true if all bytes received, false on error
      */
-    bool receiveExact(uint8_t* buffer, size_t size);
+    bool receiveExact(uint8_t* buffer, size_t size, uint32_t* crc = nullptr);
+
+    /**
+     * Compare a frame's CRC with the one from its header, counting mismatches
+     * (kCrcErrorsBeforeResync in a row mark the connection as lost)
+     * @param crc CRC32C of the bitmap and payload as received
+     * @return true if it matches
+     */
+    bool checkFrameCrc(uint32_t crc);
+
+    /**
+     * Read the frame header (if any) and get the size of the next frame
+     * @param frame_size Output frame size in bytes
+     * @return true on success, false on error
+     */
+    bool receiveFrameSize(size_t& frame_size);
+
+    /**
+     * Read and drop bytes from the stream
+     * @param size Number of bytes to drop
+     * @param scratch Buffer to read into
+     * @param scratch_size Size of scratch buffer
+     * @return true if all bytes were read, false on error
+     */
+    bool discardExact(size_t size, uint8_t* scratch, size_t scratch_size);
+
+#ifdef __linux__
+    /**
+     * recv() that also picks up the kernel/NIC receive timestamp
+     * @param buffer Output buffer
+     * @param size Maximum bytes to receive
+     * @return Bytes received, 0 on close, -1 on error
+     */
+    ssize_t receiveStamped(uint8_t* buffer, size_t size);
+#endif
+
+    /**
+     * Take the raw timestamp of the frame just received
+     * @return Raw timestamp for the configured source (0 for FrameCounter)
+     */
+    int64_t stampFrame();
     
     /**
      * Initialize socket library (Windows only)
@@ -120,9 +278,48 @@ private:
     socket_t server_socket_;   // Listening socket
     socket_t client_socket_;   // Connected client (FPGA)
     bool connected_;
+
+    // Event loop for accept()/recv() waits (own_reactor_ if none was passed in)
+    std::unique_ptr<Reactor> own_reactor_;
+    Reactor* reactor_;
+
+    // Client socket while receives block in io_uring (interrupt() shuts it down)
+    std::atomic<socket_t> blocking_socket_;
     
     uint64_t total_bytes_received_;
     uint64_t total_frames_received_;
+    uint64_t total_receive_calls_;
+
+    // Spin budget while the socket is empty (ReceiveMode::BusyPoll)
+    BusyPoller poller_;
+
+    // io_uring engine (null when using plain recv()) and the pool it has
+    // registered, so each pool is only offered to the kernel once
+    std::unique_ptr<IoUringEngine> uring_;
+    const FramePool* registered_pool_;
+
+    // Encoding of the current frame, from the size header (Dense without one)
+    FrameEncoding header_encoding_;
+
+    // Size headers whose encoding bits are unknown (all connections)
+    uint64_t malformed_headers_;
+
+    // Frame integrity (Config::frame_crc): CRC from the current header,
+    // counters over all connections, and bad frames in a row
+    uint32_t header_crc_;
+    uint64_t crc_errors_;
+    uint64_t crc_resyncs_;
+    int crc_error_run_;
+
+    // Timestamp sources: receive_timestamps_ is set when the socket delivers
+    // kernel/NIC stamps; header_timestamp_ is the last FPGA header value
+    bool receive_timestamps_;
+    uint64_t header_timestamp_;
+    int64_t receive_timestamp_;
+    int64_t last_timestamp_;
+
+    // steady_clock time the first bytes of the current frame were read (0 = none yet)
+    int64_t arrival_ns_;
     
     static bool socket_lib_initialized_;
 };
@@ -0,0 +1,67 @@
+#pragma once
+
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace converter {
+
+/**
+ * Where one pipeline thread ended up, read back from the kernel after start
+ */
+struct ThreadPlacement {
+    std::string role;           // "receiver", "worker<i>" or "writer"
+    std::vector<int> cpus;      // Cores the thread may run on (empty = unknown)
+    int realtime_priority = 0;  // SCHED_FIFO priority, 0 = normal scheduling
+};
+
+/**
+ * Restrict a thread to a set of cores (Linux)
+ * @param thread Running thread
+ * @param cpus Core numbers
+ * @return true if the affinity was set
+ */
+bool pinThread(std::thread& thread, const std::vector<int>& cpus);
+
+/**
+ * Switch a thread to SCHED_FIFO (Linux; needs CAP_SYS_NICE or an rtprio limit)
+ * @param thread Running thread
+ * @param priority 1-99
+ * @return true if the policy was set
+ */
+bool setRealtimePriority(std::thread& thread, int priority);
+
+/**
+ * Read back a thread's cores and scheduling
+ * @param thread Running thread
+ * @param role Label for the report
+ * @return Effective placement
+ */
+ThreadPlacement getThreadPlacement(std::thread& thread, std::string role);
+
+/**
+ * Get the NUMA node a core belongs to (Linux, from sysfs)
+ * @return Node, or -1 if unknown
+ */
+int cpuNumaNode(int cpu);
+
+/**
+ * Get the NUMA node a network interface's device is attached to (Linux, from sysfs)
+ * @param interface Interface name, e.g. "eth2"
+ * @return Node, or -1 if unknown (virtual devices, single-node machines)
+ */
+int interfaceNumaNode(const std::string& interface);
+
+/**
+ * Lock all current and future pages of the process into memory (mlockall)
+ * @return true if locked
+ */
+bool lockProcessMemory();
+
+/**
+ * Format a core list compactly, e.g. "0-3,8"
+ * @return Formatted list, "none" if empty
+ */
+std::string formatCpuList(const std::vector<int>& cpus);
+
+} // namespace converter
@@ -0,0 +1,147 @@
+#pragma once
+
+#include "config.hpp"
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+
+struct msghdr;
+
+namespace converter {
+
+/**
+ * Turns the raw timestamp a receiver took for a frame into the timestamp of
+ * the frame's events (microseconds), according to Config::timestamp_source
+ *
+ *   - FrameCounter: frame_number * frame_interval_us, as before
+ *   - FpgaHeader: FPGA ticks * fpga_timestamp_tick_ns
+ *   - KernelReceive / HardwareReceive / SteadyClock: receive time on the wall
+ *     clock, optionally smoothed by a second-order PLL
+ *
+ * The PLL predicts each frame one period after the previous one and pulls
+ * phase and period towards the measured time (loop bandwidth
+ * timestamp_pll_bandwidth_hz), so receive jitter is filtered out while a
+ * drifting FPGA clock is still followed. An error beyond the resync threshold
+ * (16 periods or 100 ms: a stall or reconnect) re-locks on the measured time.
+ *
+ * Whatever the source, the result never runs backwards: a frame starts no
+ * earlier than the end of the previous frame's readout (frame_readout_us).
+ *
+ * frameTimestamp() must be called from one thread, in receive order; the
+ * statistics getters may be called from any thread.
+ */
+class TimestampEngine {
+public:
+    /**
+     * Constructor
+     * @param cfg Configuration reference
+     */
+    explicit TimestampEngine(const Config& cfg);
+
+    /**
+     * Get the timestamp for a frame's events
+     * @param raw Raw timestamp from the receiver (FrameHandle::timestamp(), 0 = none)
+     * @param frame_number Frame sequence number
+     * @return Timestamp of the frame's first row in microseconds
+     */
+    int64_t frameTimestamp(int64_t raw, uint64_t frame_number);
+
+    /**
+     * Get the source actually in use
+     * @return Config::timestamp_source, or FrameCounter if it cannot work with this input
+     */
+    TimestampSource getActiveSource() const { return source_; }
+
+    /**
+     * Drop the PLL lock, e.g. after a reconnect (monotonicity is kept)
+     */
+    void reset() { locked_ = false; }
+
+    /**
+     * Get number of times the PLL re-locked on a measured time
+     * @return Resyncs
+     */
+    uint64_t getResyncs() const { return resyncs_.load(std::memory_order_relaxed); }
+
+    /**
+     * Get number of frames that arrived more than half a period late
+     * @return Late frames (bursts, stalls or frames lost upstream)
+     */
+    uint64_t getLateFrames() const { return late_frames_.load(std::memory_order_relaxed); }
+
+    /**
+     * Get the smoothed receive jitter the PLL is filtering out
+     * @return Mean absolute phase error in microseconds
+     */
+    double getJitterUs() const { return static_cast<double>(jitter_ns_.load(std::memory_order_relaxed)) / 1000.0; }
+
+private:
+    /**
+     * Run one PLL step
+     * @param measured_ns Measured wall time of the frame
+     * @return Smoothed wall time of the frame
+     */
+    int64_t track(int64_t measured_ns);
+
+    const Config& config_;
+    TimestampSource source_;
+    int64_t steady_to_wall_ns_;     // Add to a steady_clock time to get wall time
+
+    // PLL state (nanoseconds)
+    bool locked_;
+    double phase_;
+    double period_;
+    double nominal_period_;
+    double gain_phase_;             // sqrt(2) * omega
+    double gain_period_;            // omega^2
+    double resync_threshold_;
+
+    int64_t next_allowed_us_;       // Earliest timestamp the next frame may get
+
+    std::atomic<uint64_t> resyncs_;
+    std::atomic<uint64_t> late_frames_;
+    std::atomic<int64_t> jitter_ns_;
+};
+
+/**
+ * Get the current time on the clock kernel receive timestamps use
+ * @return CLOCK_REALTIME in nanoseconds
+ */
+int64_t wallClockNs();
+
+/**
+ * Get the current steady_clock time
+ * @return steady_clock time in nanoseconds
+ */
+int64_t steadyClockNs();
+
+#ifdef __linux__
+/**
+ * Room needed in a recvmsg() control buffer for one receive timestamp
+ */
+inline constexpr size_t kReceiveTimestampControlBytes = 128;
+
+/**
+ * Ask the kernel to timestamp packets received on a socket
+ *
+ * KernelReceive enables SO_TIMESTAMPNS. HardwareReceive enables
+ * SO_TIMESTAMPING with NIC and software receive stamps (software is used
+ * for packets the NIC did not stamp); the NIC's receive filter has to be
+ * enabled separately, e.g. `hwstamp_ctl -i eth0 -r 1`.
+ *
+ * @param fd Socket
+ * @param source Timestamp source (other sources do nothing)
+ * @return true if enabled (or nothing to enable)
+ */
+bool enableReceiveTimestamps(int fd, TimestampSource source);
+
+/**
+ * Extract the receive timestamp from a recvmsg() result
+ * @param msg Message header whose control buffer the kernel filled
+ * @param source Timestamp source the socket was set up for
+ * @return Receive time in nanoseconds, 0 if the message carries none
+ */
+int64_t readReceiveTimestamp(const msghdr& msg, TimestampSource source);
+#endif
+
+} // namespace converter
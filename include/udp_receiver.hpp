@@ -1,9 +1,14 @@
 #pragma once
 
 #include "config.hpp"
+#include "busy_poll.hpp"
+#include "frame_pool.hpp"
+#include "reactor.hpp"
 #include <vector>
 #include <string>
+#include <chrono>
 #include <cstdint>
+#include <memory>
 #include <stdexcept>
 
 // Platform-specific includes
@@ -18,6 +23,7 @@
     #include <sys/socket.h>
     #include <netinet/in.h>
     #include <arpa/inet.h>
+    #include <sys/uio.h>
     #include <unistd.h>
     typedef int socket_t;
     #define INVALID_SOCK (-1)
@@ -26,6 +32,45 @@
 
 namespace converter {
 
+/**
+ * Datagram header used when Config::udp_sequence_header is set
+ *
+ * Every datagram starts with this header (all fields big-endian), followed by
+ * frame bytes [fragment_offset, fragment_offset + payload length). Fragments
+ * of a frame must not overlap and are expected in offset order by index;
+ * the last one may be shorter than the rest.
+ *
+ * A compressed frame (see FrameEncoding) is fragmented like a dense one, with
+ * frame_bytes = payload size | encoding << 28; it is delivered as the payload
+ * and never zero-filled. An empty one (payload size 0, no CRC trailer) is a
+ * single fragment carrying only this header.
+ */
+struct UdpFragmentHeader {
+    uint32_t frame_id;          // +1 per frame (wraps around)
+    uint16_t fragment_index;    // 0 .. fragment_count - 1
+    uint16_t fragment_count;    // Fragments making up this frame
+    uint32_t frame_bytes;       // Frame size; top 4 bits = FrameEncoding (Dense must be Config::frame_size())
+    uint32_t fragment_offset;   // Where this payload goes in the frame
+};
+
+static_assert(sizeof(UdpFragmentHeader) == 16, "UdpFragmentHeader must be 16 bytes on the wire");
+
+/**
+ * Frame reassembly counters (sequence header mode only)
+ */
+struct UdpReassemblyStats {
+    uint64_t frames_completed = 0;      // Delivered with every fragment
+    uint64_t frames_zero_filled = 0;    // Delivered with missing fragments zeroed
+    uint64_t frames_dropped = 0;        // Incomplete, discarded
+    uint64_t frames_missing = 0;        // Frame ids skipped without a single fragment
+    uint64_t fragments_lost = 0;        // Missing from frames that were given up on
+    uint64_t fragments_reordered = 0;   // Arrived after a later fragment or frame
+    uint64_t fragments_duplicate = 0;   // Already had this fragment
+    uint64_t fragments_late = 0;        // Frame already delivered or given up on
+    uint64_t fragments_malformed = 0;   // Short datagram or inconsistent header
+    uint64_t resyncs = 0;               // Frame id jumps that reset the window
+};
+
 /**
  * UDP Receiver class
  *
@@ -34,15 +79,25 @@ namespace converter {
  * 2. Multiple datagrams per frame with sequence numbers (for fragmented frames)
  *
  * The FPGA sends raw frame data without headers, so we accumulate data
- * until we have a complete frame.
+ * until we have a complete frame. With Config::udp_sequence_header every
+ * datagram carries a UdpFragmentHeader instead, and frames are reassembled
+ * by frame id: up to udp_reorder_window frames can be in flight, fragments
+ * may arrive in any order, and a frame that is still incomplete after
+ * udp_frame_timeout_us (or that the window has to move past) is dropped or
+ * zero-filled. A frame id far outside the window resyncs immediately.
+ *
+ * The socket is non-blocking: when no datagram is queued the receiver waits
+ * on a Reactor (at most udp_frame_timeout_us with the sequence header, so
+ * incomplete frames still time out), and interrupt() ends the wait at once.
  */
 class UdpReceiver {
 public:
     /**
      * Constructor
      * @param cfg Configuration reference
+     * @param reactor Event loop to wait on (nullptr = create one)
      */
-    explicit UdpReceiver(const Config& cfg);
+    explicit UdpReceiver(const Config& cfg, Reactor* reactor = nullptr);
 
     /**
      * Destructor - closes socket
@@ -74,6 +129,23 @@ public:
      */
     bool isConnected() const;
 
+    /**
+     * Make a blocked receive return false promptly; sticks until resume()
+     * (thread-safe, async-signal-safe)
+     */
+    void interrupt();
+
+    /**
+     * Allow waiting again after interrupt()
+     */
+    void resume();
+
+    /**
+     * Pre-fault the fragment reassembly buffers (Config::warm_start; before the first receive)
+     * @return Bytes faulted in (0 without udp_sequence_header)
+     */
+    size_t warmUp() { return reassembly_pool_ ? reassembly_pool_->prefault() : 0; }
+
     /**
      * Receive one complete frame
      *
@@ -81,11 +153,30 @@ public:
      * If frame boundaries are marked (e.g., by timing or sequence numbers),
      * it will respect those boundaries.
      *
-     * @param buffer Output buffer (will be resized to frame size)
+     * @param buffer Output buffer (resized to the frame size, or the payload
+     *               size of a compressed frame, see getLastFrameEncoding())
      * @return true if frame received successfully, false on error
      */
     bool receiveFrame(std::vector<uint8_t>& buffer);
 
+    /**
+     * Receive one complete frame straight into a pool slot
+     *
+     * Datagrams are scattered directly to their offset in the slot; only the
+     * part of a datagram that spills past the end of the frame is copied.
+     * The receive time of the frame's newest datagram (or steady_clock, per
+     * Config::timestamp_source) is stored in the slot.
+     *
+     * With udp_sequence_header, the frame comes back in one of the receiver's
+     * reassembly buffers. If none is free, the caller's slot is kept as the
+     * replacement, so the caller's pool must outlive the receiver.
+     *
+     * @param frame Pool slot to fill (size set to the frame size, or to the
+     *              payload size of a compressed frame, see FrameHandle::encoding())
+     * @return true if frame received successfully, false on error
+     */
+    bool receiveFrame(FrameHandle& frame);
+
     /**
      * Get the expected frame size (without header)
      * @return Frame size in bytes
@@ -104,7 +195,226 @@ public:
      */
     uint64_t getTotalFramesReceived() const { return total_frames_received_; }
 
+    /**
+     * Get total datagrams received
+     * @return Datagrams received since connection
+     */
+    uint64_t getTotalDatagramsReceived() const { return total_datagrams_received_; }
+
+    /**
+     * Get average datagrams delivered per receive syscall
+     * @return Datagrams per syscall (1.0 without batching)
+     */
+    double getDatagramsPerSyscall() const;
+
+    /**
+     * Get what the receiver did while the socket was empty (all bindings)
+     * @return Busy-poll counters, all 0 in Blocking mode
+     */
+    const BusyPollStats& getBusyPollStats() const { return poller_.getStats(); }
+
+    /**
+     * Get the raw timestamp of the last frame received
+     * @return Receive time in ns (see FrameHandle::timestamp()), 0 if none
+     */
+    int64_t getLastFrameTimestamp() const { return last_timestamp_; }
+
+    /**
+     * Get the encoding of the last frame received
+     * @return Encoding from its fragment headers (always Dense without the sequence header)
+     */
+    FrameEncoding getLastFrameEncoding() const { return last_encoding_; }
+
+    /**
+     * Get frame reassembly counters
+     * @return Counters since connection (all zero without the sequence header)
+     */
+    const UdpReassemblyStats& getReassemblyStats() const { return reassembly_stats_; }
+
+    /**
+     * Get number of frames dropped for a CRC mismatch (Config::frame_crc; all connections)
+     * @return Bad frames
+     */
+    uint64_t getCrcErrors() const { return crc_errors_; }
+
+    /**
+     * Get number of times bytes were skipped to realign on a frame after a bad one
+     * @return Resyncs
+     */
+    uint64_t getCrcResyncs() const { return crc_resyncs_; }
+
 private:
+    // Platform-neutral scatter element (iovec / WSABUF)
+    struct ScatterBuffer {
+        uint8_t* data;
+        size_t len;
+    };
+
+    // One frame being reassembled
+    struct ReassemblySlot {
+        FrameHandle buffer;
+        bool active = false;
+        uint32_t frame_id = 0;
+        uint32_t frame_bytes = 0;               // Header value (encoding + payload size)
+        uint16_t fragment_count = 0;
+        uint16_t fragments_received = 0;
+        uint16_t highest_fragment = 0;
+        std::chrono::steady_clock::time_point first_seen;
+        std::vector<uint32_t> fragment_offset;
+        std::vector<uint32_t> fragment_end;     // 0 = not received yet
+    };
+
+    // Parsed header plus where its payload currently is
+    struct Fragment {
+        UdpFragmentHeader header;
+        size_t length;              // Payload bytes
+        const uint8_t* first;       // First part of the payload
+        size_t first_len;
+        const uint8_t* rest;        // Remainder (staging buffer)
+    };
+
+    /**
+     * Assemble one frame of frame_size bytes at dst
+     * @param dst Frame destination
+     * @param frame_size Frame size in bytes (with the CRC trailer, if any)
+     * @param crc If set, CRC32C of the first crc_bytes, updated per datagram while they are in cache
+     * @param crc_bytes Bytes the CRC covers
+     * @return true if frame received successfully, false on error
+     */
+    bool receiveInto(uint8_t* dst, size_t frame_size, uint32_t* crc = nullptr, size_t crc_bytes = 0);
+
+    /**
+     * Receive one frame plus CRC trailer (Config::frame_crc_trailer_bytes())
+     * at dst, skipping frames whose CRC does not match
+     * @param dst Frame destination (room for frame_size + trailer)
+     * @param frame_size Frame size in bytes, without the trailer
+     * @return true if a good frame was received, false on error
+     */
+    bool receiveChecked(uint8_t* dst, size_t frame_size);
+
+    /**
+     * After a bad frame, drop datagrams up to and including the next short
+     * one (the last of a frame) unless the bad frame already ended in one,
+     * so the next receive starts on a frame
+     * @param frame_size Frame size on the wire, trailer included
+     * @return true if realigned, false on error
+     */
+    bool skipToFrameEnd(size_t frame_size);
+
+    /**
+     * Receive one datagram scattered over two buffers
+     *
+     * The first len bytes go to dst, anything beyond that to spill.
+     *
+     * @param dst Primary destination
+     * @param len Primary destination size
+     * @param spill Overflow destination
+     * @param spill_len Overflow destination size
+     * @param sender Output sender address
+     * @return Datagram size, or <= 0 on error
+     */
+    int64_t receiveDatagram(uint8_t* dst, size_t len, uint8_t* spill, size_t spill_len,
+                            struct sockaddr_in& sender);
+
+    /**
+     * Receive one datagram scattered over up to three buffers
+     * @param buffers Destinations, filled in order
+     * @param count Number of buffers (1-3)
+     * @param sender Output sender address
+     * @return Datagram size, or <= 0 on error
+     */
+    int64_t receiveScattered(const ScatterBuffer* buffers, size_t count, struct sockaddr_in& sender);
+
+    /**
+     * Wait on the event loop until a datagram is queued (BusyPoll: return at
+     * once to poll again while the spin budget lasts)
+     * @param timeout_us Longest wait (-1 = no limit)
+     * @return true to receive again (ready or timed out), false if interrupted or on error
+     */
+    bool waitReadable(int64_t timeout_us);
+
+    /**
+     * Reassemble the next frame from sequence-headed datagrams
+     *
+     * The frame is swapped into the handle, so it may refer to a different
+     * slot afterwards; the handle passed in becomes a reassembly buffer.
+     *
+     * @param frame Output frame
+     * @return true if a frame was delivered, false on socket error
+     */
+    bool receiveSequenced(FrameHandle& frame);
+
+    /**
+     * Deliver the oldest in-flight frame if it is complete or timed out
+     * @return true if a frame was swapped into the handle
+     */
+    bool popReadyFrame(FrameHandle& frame, std::chrono::steady_clock::time_point now);
+
+    /**
+     * Finish the oldest in-flight frame to make room in the window
+     * @return true if a frame was swapped into the handle
+     */
+    bool retireOldest(FrameHandle& frame);
+
+    /**
+     * Check a complete slot against its CRC trailer (Config::frame_crc);
+     * a bad frame is dropped and counted, and the window moves past it
+     * @return true if the frame may be delivered
+     */
+    bool checkSlotCrc(ReassemblySlot& slot);
+
+    /**
+     * Apply the incomplete-frame policy to a slot
+     * @return true if the frame was delivered (zero-filled)
+     */
+    bool giveUp(ReassemblySlot& slot, FrameHandle& frame);
+
+    /**
+     * Swap a finished slot's buffer out to the caller and advance the window
+     */
+    void deliver(ReassemblySlot& slot, FrameHandle& frame);
+
+    /**
+     * Copy a fragment into its frame (activating a slot if needed)
+     * @param fragment Validated fragment inside the window
+     */
+    void placeFragment(const Fragment& fragment);
+
+    /**
+     * Drop every in-flight frame and restart the window at frame_id
+     */
+    void resync(uint32_t frame_id);
+
+    /**
+     * Get the in-flight frame with the lowest id
+     * @return Slot, or nullptr if nothing is in flight
+     */
+    ReassemblySlot* oldestSlot();
+
+    ReassemblySlot* findSlot(uint32_t frame_id);
+    ReassemblySlot* freeSlot();
+
+#ifdef __linux__
+    /**
+     * Receive up to udp_batch_size datagrams with one recvmmsg() call
+     *
+     * Datagram k is aimed directly at dst + accumulated + k * stride, and
+     * short datagrams are compacted afterwards so the frame stays contiguous.
+     *
+     * @param dst Frame destination
+     * @param frame_size Frame size in bytes
+     * @param accumulated Bytes of the frame already received (updated)
+     * @return Number of datagrams received, or <= 0 on error
+     */
+    int receiveBatch(uint8_t* dst, size_t frame_size, size_t& accumulated);
+#endif
+
+    /**
+     * Take the raw timestamp of the frame just received
+     * @return Receive time of its newest datagram in ns, steady_clock time, or 0 (per timestamp_source)
+     */
+    int64_t stampFrame();
+
     /**
      * Initialize socket library (Windows only)
      */
@@ -119,15 +429,62 @@ private:
     socket_t socket_;
     bool bound_;
 
-    // Receive buffer for individual UDP packets
-    std::vector<uint8_t> packet_buffer_;
+    // Event loop for receive waits (own_reactor_ if none was passed in)
+    std::unique_ptr<Reactor> own_reactor_;
+    Reactor* reactor_;
 
-    // Leftover bytes from previous packet that belong to next frame
+    // Tail of a datagram that ran past the end of a frame; it belongs to the
+    // start of the next frame (one datagram worth at most)
     std::vector<uint8_t> leftover_buffer_;
     size_t leftover_bytes_;
+    size_t last_datagram_bytes_;    // Length of the last datagram received (frame_crc resync)
+
+    // Largest datagram we may see (udp_packet_size, or 64 KB with GRO)
+    size_t datagram_stride_;
+
+#ifdef __linux__
+    // recvmmsg() descriptors, reused for every batch
+    std::vector<struct mmsghdr> batch_msgs_;
+    std::vector<struct iovec> batch_iovs_;
+    std::vector<uint8_t> batch_control_;    // Receive timestamp control data, one area per message
+#endif
+
+    // Sequence header reassembly: window slots, their spare buffers, and
+    // where the next datagram is expected to land (so in-order fragments are
+    // received in place)
+    std::unique_ptr<FramePool> reassembly_pool_;
+    std::vector<ReassemblySlot> slots_;
+    std::vector<uint8_t> pending_buffer_;   // Fragment waiting for window room
+    bool has_pending_;
+    Fragment pending_;
+    bool has_next_frame_id_;
+    uint32_t next_frame_id_;                // Oldest frame id still acceptable
+    uint32_t last_frame_id_;
+    uint16_t last_fragment_;
+    uint32_t last_end_;
+    uint32_t last_length_;
 
     uint64_t total_bytes_received_;
     uint64_t total_frames_received_;
+    uint64_t total_datagrams_received_;
+    uint64_t total_receive_calls_;
+    UdpReassemblyStats reassembly_stats_;
+    uint64_t crc_errors_;
+    uint64_t crc_resyncs_;
+
+    // Spin budget while the socket is empty (ReceiveMode::BusyPoll)
+    BusyPoller poller_;
+
+    // Kernel/NIC receive stamps enabled on the socket, newest stamp seen,
+    // and the raw timestamp of the last frame delivered
+    bool receive_timestamps_;
+    int64_t receive_timestamp_;
+    int64_t last_timestamp_;
+
+    // steady_clock time the current frame's first datagram was read
+    int64_t arrival_ns_;
+
+    FrameEncoding last_encoding_;
 
     static bool socket_lib_initialized_;
 };
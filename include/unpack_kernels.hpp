@@ -0,0 +1,175 @@
+#pragma once
+
+#include "config.hpp"
+#include <dv-processing/core/event.hpp>
+#include <cstddef>
+#include <cstdint>
+
+#if defined(_MSC_VER) && !defined(__clang__)
+    #include <intrin.h>
+#endif
+
+namespace converter {
+
+/**
+ * Index of the lowest set bit
+ * @param mask Bit mask (must be non-zero)
+ * @return Bit index
+ */
+inline unsigned countTrailingZeros(uint64_t mask)
+{
+#if defined(_MSC_VER) && !defined(__clang__)
+    unsigned long index;
+    _BitScanForward64(&index, mask);
+    return static_cast<unsigned>(index);
+#else
+    return static_cast<unsigned>(__builtin_ctzll(mask));
+#endif
+}
+
+/**
+ * Per-frame parameters shared by all unpack kernels
+ */
+struct UnpackParams {
+    int width = 0;              // Frame width in pixels
+    int total_pixels = 0;       // width * height (pixels past this are padding)
+    int64_t timestamp = 0;      // Timestamp assigned to every event of the frame
+
+    // floor(2^40 / width) + 1: pixel / width == (pixel * width_reciprocal) >> 40,
+    // exact while pixel * width < 2^40 (see supportsGeometry)
+    uint64_t width_reciprocal = 0;
+
+    UnpackParams() = default;
+    UnpackParams(int w, int total, int64_t ts)
+        : width(w)
+        , total_pixels(total)
+        , timestamp(ts)
+        , width_reciprocal(((uint64_t{1} << 40) / static_cast<uint64_t>(w)) + 1)
+    {}
+
+    /**
+     * Check that the kernels decode a geometry exactly
+     *
+     * The reciprocal overshoots 1/width by less than 2^-40, so the row of the
+     * last pixel is exact as long as total_pixels * width stays below 2^40.
+     * The kernels also assume at least 4 pixels per row (a byte straddles
+     * two rows at most). validateConfig rejects anything else.
+     *
+     * @param width Frame width in pixels
+     * @param total_pixels width * height
+     * @return true if supported
+     */
+    static constexpr bool supportsGeometry(int width, int total_pixels)
+    {
+        return width >= 4 && total_pixels >= width
+            && static_cast<uint64_t>(total_pixels) * static_cast<uint64_t>(width) < (uint64_t{1} << 40);
+    }
+};
+
+/**
+ * Unpack kernel signature
+ *
+ * Decodes bytes [begin, end) of a 2-bit packed frame into `out`. Byte indices
+ * are frame-relative, so any sub-range (e.g. a band of rows) decodes to the
+ * same events it would produce as part of the whole frame.
+ * The caller must provide room for 4 * (end - begin) events: kernels store
+ * a whole byte's worth of slots at a time and only count the real events.
+ *
+ * @param data Packed frame data (start of the frame)
+ * @param begin First byte to decode
+ * @param end One past the last byte to decode
+ * @param params Frame geometry and timestamp
+ * @param out Output event array
+ * @return Number of events written
+ */
+using UnpackKernelFn = size_t (*)(
+    const uint8_t* data,
+    size_t begin,
+    size_t end,
+    const UnpackParams& params,
+    dv::Event* out
+);
+
+/**
+ * Check if a kernel can run on this CPU (and was compiled into this build)
+ * @param kernel Kernel to check
+ * @return true if supported
+ */
+bool isUnpackKernelSupported(UnpackKernel kernel);
+
+/**
+ * Resolve a requested kernel to the one that will actually run
+ *
+ * Auto resolves to the best supported kernel. Unsupported kernels
+ * resolve to Scalar.
+ *
+ * @param requested Requested kernel
+ * @return Concrete kernel (never Auto)
+ */
+UnpackKernel resolveUnpackKernel(UnpackKernel requested);
+
+/**
+ * Get the generic function implementing a kernel (any frame geometry)
+ * @param kernel Kernel (resolved internally, so Auto is accepted)
+ * @return Kernel function pointer
+ */
+UnpackKernelFn getUnpackKernel(UnpackKernel kernel);
+
+/**
+ * Get the function implementing a kernel for one frame geometry
+ *
+ * Known sensor sizes (1280x720, 640x480 and the DAVIS346's 346x260, see
+ * isUnpackGeometrySpecialized()) have instantiations with the geometry folded
+ * in at compile time; any other size gets the generic kernel. Both produce the same events, and UnpackParams must still
+ * describe the frame.
+ *
+ * @param kernel Kernel (resolved internally, so Auto is accepted)
+ * @param width Frame width in pixels
+ * @param height Frame height in pixels
+ * @return Kernel function pointer
+ */
+UnpackKernelFn getUnpackKernel(UnpackKernel kernel, int width, int height);
+
+/**
+ * Check if a frame geometry has its own kernel instantiations
+ * @return true for the sizes getUnpackKernel(kernel, width, height) specializes
+ */
+bool isUnpackGeometrySpecialized(int width, int height);
+
+/**
+ * Decode a compressed frame payload (see FrameEncoding) into events
+ *
+ * Bytes are expanded exactly as the unpack kernels expand them, in frame
+ * order, so the events match those of the equivalent dense frame. Only the
+ * payload is read; the dense frame is never rebuilt.
+ * The caller must provide room for 4 * frame_bytes events.
+ *
+ * @param encoding ZeroRuns or ByteList
+ * @param payload Encoded frame
+ * @param payload_size Payload size in bytes
+ * @param frame_bytes Size of the dense frame (Config::frame_size())
+ * @param params Frame geometry and timestamp
+ * @param out Output event array
+ * @param count Output number of events written
+ * @return false if the payload is malformed or the encoding is not a compressed one
+ */
+bool decodeCompressedFrame(FrameEncoding encoding, const uint8_t* payload, size_t payload_size,
+                           size_t frame_bytes, const UnpackParams& params, dv::Event* out, size_t& count);
+
+/**
+ * Rebuild the dense 2-bit frame from a compressed payload
+ *
+ * For stages that have to see the whole frame (the noise filter); the
+ * payload is validated exactly as decodeCompressedFrame() does.
+ *
+ * @param encoding ZeroRuns or ByteList
+ * @param payload Encoded frame
+ * @param payload_size Payload size in bytes
+ * @param frame_bytes Size of the dense frame (Config::frame_size())
+ * @param frame Output frame of frame_bytes bytes (fully overwritten)
+ * @return false if the payload is malformed or the encoding is not a compressed one
+ */
+bool expandCompressedFrame(FrameEncoding encoding, const uint8_t* payload, size_t payload_size,
+                           size_t frame_bytes, uint8_t* frame);
+
+} // namespace converter
@@ -0,0 +1,76 @@
+#pragma once
+
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace converter {
+
+/**
+ * Persistent fork-join worker pool
+ *
+ * Threads are created once and parked between jobs, so splitting a frame
+ * across cores costs a wake-up rather than a thread creation. The calling
+ * thread takes part in every job, so a pool of N threads runs N + 1 tasks at
+ * once.
+ */
+class WorkerPool {
+public:
+    /**
+     * Constructor
+     * @param num_threads Number of helper threads (in addition to the caller)
+     */
+    explicit WorkerPool(size_t num_threads);
+
+    /**
+     * Destructor - stops and joins all threads
+     */
+    ~WorkerPool();
+
+    // Disable copy
+    WorkerPool(const WorkerPool&) = delete;
+    WorkerPool& operator=(const WorkerPool&) = delete;
+
+    /**
+     * Run task(i) for every i in [0, num_tasks) and wait for all of them
+     *
+     * Tasks are claimed dynamically, so uneven tasks balance across threads.
+     * Not re-entrant: only one thread may call run() at a time.
+     *
+     * @param num_tasks Number of tasks
+     * @param task Task body, called with the task index
+     */
+    void run(size_t num_tasks, const std::function<void(size_t)>& task);
+
+    /**
+     * Get number of helper threads
+     * @return Helper thread count (excluding the caller)
+     */
+    size_t size() const { return threads_.size(); }
+
+private:
+    void workerLoop();
+
+    // Claim and run tasks of the current job until none are left
+    void runTasks();
+
+    std::vector<std::thread> threads_;
+
+    std::mutex mutex_;
+    std::condition_variable work_cv_;
+    std::condition_variable done_cv_;
+
+    const std::function<void(size_t)>* task_;
+    size_t num_tasks_;
+    std::atomic<size_t> next_task_;
+    size_t busy_threads_;
+    uint64_t generation_;
+    bool stopping_;
+};
+
+} // namespace converter
@@ -0,0 +1,41 @@
+#include "busy_poll.hpp"
+#include <cerrno>
+#include <cstring>
+#include <iostream>
+
+#ifdef __linux__
+    #include <sys/socket.h>
+#endif
+
+namespace converter {
+
+#ifdef __linux__
+void configureBusyPoll(int fd, const Config& cfg)
+{
+    if (cfg.receive_mode != ReceiveMode::BusyPoll) {
+        return;
+    }
+
+#ifdef SO_BUSY_POLL
+    if (cfg.socket_busy_poll_us > 0) {
+        int busy_poll = cfg.socket_busy_poll_us;
+        if (setsockopt(fd, SOL_SOCKET, SO_BUSY_POLL, &busy_poll, sizeof(busy_poll)) < 0) {
+            std::cerr << "Warning: Failed to set SO_BUSY_POLL (" << std::strerror(errno)
+                      << "), busy polling in user space only" << std::endl;
+        }
+    }
+#endif
+
+#ifdef SO_INCOMING_CPU
+    const std::vector<int>& cpus = cfg.receiver_thread_cpus();
+    if (!cpus.empty()) {
+        int cpu = cpus.front();
+        if (setsockopt(fd, SOL_SOCKET, SO_INCOMING_CPU, &cpu, sizeof(cpu)) < 0) {
+            std::cerr << "Warning: Failed to set SO_INCOMING_CPU (" << std::strerror(errno) << ")" << std::endl;
+        }
+    }
+#endif
+}
+#endif
+
+} // namespace converter
@@ -0,0 +1,117 @@
+#include "camera_source.hpp"
+#include <algorithm>
+#include <iostream>
+
+namespace converter {
+
+namespace {
+
+ReceiverVariant makeReceiver(const Config& cfg, Reactor* reactor)
+{
+    if (cfg.protocol == Protocol::TCP) {
+        return ReceiverVariant(std::in_place_type<TcpReceiver>, cfg, reactor);
+    }
+    return ReceiverVariant(std::in_place_type<UdpReceiver>, cfg, reactor);
+}
+
+} // namespace
+
+CameraSource::CameraSource(const Config& cfg, size_t index, Pipeline::WriteFn write)
+    : config_(cfg.for_camera(index))
+    , name_(cfg.camera_name(index))
+    , stopping_(false)
+    , pipeline_(config_,
+                [this](FrameHandle& frame) {
+                    return std::visit([&frame](auto& r) { return r.receiveFrame(frame); }, receiver_);
+                },
+                [this]() { return reconnect(); },
+                std::move(write))
+    , receiver_(makeReceiver(config_, &reactor_))
+{
+}
+
+CameraSource::~CameraSource()
+{
+    stop();
+    std::visit([](auto& r) { r.disconnect(); }, receiver_);
+}
+
+bool CameraSource::listen()
+{
+    if (auto* tcp = std::get_if<TcpReceiver>(&receiver_)) {
+        return tcp->startListening();
+    }
+    return true;
+}
+
+size_t CameraSource::warmUp()
+{
+    size_t bytes = pipeline_.warmUp();
+    if (auto* udp = std::get_if<UdpReceiver>(&receiver_)) {
+        bytes += udp->warmUp();
+    }
+    return bytes;
+}
+
+bool CameraSource::connect()
+{
+    return std::visit([](auto& r) { return r.connect(); }, receiver_);
+}
+
+void CameraSource::start()
+{
+    std::visit([](auto& r) { r.resume(); }, receiver_);
+    stopping_ = false;
+    pipeline_.start();
+}
+
+void CameraSource::stop()
+{
+    interrupt();
+    pipeline_.stop();
+}
+
+void CameraSource::interrupt()
+{
+    stopping_ = true;
+    std::visit([](auto& r) { r.interrupt(); }, receiver_);
+}
+
+bool CameraSource::reconnect()
+{
+    if (stopping_) {
+        return false;
+    }
+    std::cerr << "[" << name_ << "] Failed to receive frame. Reconnecting..." << std::endl;
+    std::visit([](auto& r) { r.disconnect(); }, receiver_);
+
+    // Try again at once (TCP: accept the FPGA's next connection). An input
+    // that fails again right after reconnecting backs off like a failed
+    // attempt. The wait ends early if interrupted.
+    const auto started = std::chrono::steady_clock::now();
+    const int64_t min_delay_ms = std::max(1, config_.reconnect_delay_ms);
+    const int64_t max_delay_ms = std::max<int64_t>(min_delay_ms, config_.reconnect_max_delay_ms);
+    const bool flapping = last_reconnect_ != std::chrono::steady_clock::time_point() &&
+                          started - last_reconnect_ < std::chrono::milliseconds(min_delay_ms);
+    int64_t delay_ms = flapping ? min_delay_ms : 0;
+    while (true) {
+        if (delay_ms > 0 && (!reactor_.runFor(delay_ms * 1000) || stopping_)) {
+            return false;
+        }
+        if (connect()) {
+            last_reconnect_ = std::chrono::steady_clock::now();
+            std::cout << "[" << name_ << "] Reconnected after "
+                      << std::chrono::duration_cast<std::chrono::milliseconds>(last_reconnect_ - started).count()
+                      << " ms" << std::endl;
+            return true;
+        }
+        if (stopping_) {
+            return false;
+        }
+        delay_ms = delay_ms == 0 ? min_delay_ms : std::min(delay_ms * 2, max_delay_ms);
+        std::cerr << "[" << name_ << "] Reconnection failed. Retrying in "
+                  << delay_ms << " ms..." << std::endl;
+    }
+}
+
+} // namespace converter
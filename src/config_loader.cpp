@@ -0,0 +1,684 @@
+#include "config_loader.hpp"
+#include "unpack_kernels.hpp"
+#include <algorithm>
+#include <cctype>
+#include <charconv>
+#include <fstream>
+#include <functional>
+#include <iostream>
+#include <type_traits>
+
+namespace converter {
+
+namespace {
+
+// =============================================================================
+// Value parsing and formatting
+// =============================================================================
+
+const char* enumName(Protocol v) { return protocolToString(v); }
+const char* enumName(TcpBackend v) { return tcpBackendToString(v); }
+const char* enumName(ReceiveMode v) { return receiveModeToString(v); }
+const char* enumName(UnpackKernel v) { return unpackKernelToString(v); }
+const char* enumName(OccupancyMap v) { return occupancyMapToString(v); }
+const char* enumName(QueueFullPolicy v) { return queueFullPolicyToString(v); }
+const char* enumName(IncompleteFramePolicy v) { return incompleteFramePolicyToString(v); }
+const char* enumName(TimestampSource v) { return timestampSourceToString(v); }
+const char* enumName(CameraOutput v) { return cameraOutputToString(v); }
+const char* enumName(RecordFormat v) { return recordFormatToString(v); }
+const char* enumName(FrameOutputMode v) { return frameOutputModeToString(v); }
+
+std::string trim(const std::string& text)
+{
+    const size_t begin = text.find_first_not_of(" \t\r\n");
+    if (begin == std::string::npos) {
+        return std::string();
+    }
+    const size_t end = text.find_last_not_of(" \t\r\n");
+    return text.substr(begin, end - begin + 1);
+}
+
+bool equalsIgnoreCase(const std::string& a, const char* b)
+{
+    size_t i = 0;
+    for (; i < a.size() && b[i] != '\0'; i++) {
+        if (std::tolower(static_cast<unsigned char>(a[i])) != std::tolower(static_cast<unsigned char>(b[i]))) {
+            return false;
+        }
+    }
+    return i == a.size() && b[i] == '\0';
+}
+
+// Strip one pair of double quotes, resolving \" and \\; bare text is taken as is
+bool unquote(const std::string& text, std::string& value)
+{
+    if (text.empty() || text.front() != '"') {
+        value = text;
+        return true;
+    }
+    value.clear();
+    for (size_t i = 1; i < text.size(); i++) {
+        if (text[i] == '"') {
+            return i + 1 == text.size();
+        }
+        if (text[i] == '\\' && i + 1 < text.size()) {
+            i++;
+        }
+        value += text[i];
+    }
+    return false;   // No closing quote
+}
+
+std::string quote(const std::string& value)
+{
+    std::string text = "\"";
+    for (char c : value) {
+        if (c == '"' || c == '\\') {
+            text += '\\';
+        }
+        text += c;
+    }
+    return text + "\"";
+}
+
+bool parseValue(const std::string& text, std::string& value)
+{
+    return unquote(text, value);
+}
+
+bool parseValue(const std::string& text, bool& value)
+{
+    std::string word;
+    if (!unquote(text, word)) {
+        return false;
+    }
+    if (word == "true" || word == "1") {
+        value = true;
+        return true;
+    }
+    if (word == "false" || word == "0") {
+        value = false;
+        return true;
+    }
+    return false;
+}
+
+// Integers may use digit separators (50_000_000)
+template<typename T>
+std::enable_if_t<std::is_integral_v<T>, bool> parseValue(const std::string& text, T& value)
+{
+    std::string digits;
+    if (!unquote(text, digits)) {
+        return false;
+    }
+    digits.erase(std::remove(digits.begin(), digits.end(), '_'), digits.end());
+    const char* end = digits.data() + digits.size();
+    auto [ptr, error] = std::from_chars(digits.data(), end, value);
+    return !digits.empty() && error == std::errc() && ptr == end;
+}
+
+template<typename T>
+std::enable_if_t<std::is_floating_point_v<T>, bool> parseValue(const std::string& text, T& value)
+{
+    std::string digits;
+    if (!unquote(text, digits)) {
+        return false;
+    }
+    const char* end = digits.data() + digits.size();
+    auto [ptr, error] = std::from_chars(digits.data(), end, value);
+    return !digits.empty() && error == std::errc() && ptr == end;
+}
+
+// Enum values by their xxxToString() names, case-insensitive
+template<typename T>
+std::enable_if_t<std::is_enum_v<T>, bool> parseValue(const std::string& text, T& value)
+{
+    std::string word;
+    if (!unquote(text, word)) {
+        return false;
+    }
+    for (int i = 0;; i++) {
+        const char* name = enumName(static_cast<T>(i));
+        if (std::string(name) == "Unknown") {
+            return false;
+        }
+        if (equalsIgnoreCase(word, name)) {
+            value = static_cast<T>(i);
+            return true;
+        }
+    }
+}
+
+// "[2, 3]", or "2,3" on the command line
+bool parseValue(const std::string& text, std::vector<int>& value)
+{
+    std::string list = trim(text);
+    if (!list.empty() && list.front() == '[') {
+        if (list.back() != ']') {
+            return false;
+        }
+        list = list.substr(1, list.size() - 2);
+    }
+    std::vector<int> parsed;
+    if (!trim(list).empty()) {
+        size_t begin = 0;
+        for (;;) {
+            const size_t comma = list.find(',', begin);
+            int number = 0;
+            if (!parseValue(trim(list.substr(begin, comma - begin)), number)) {
+                return false;
+            }
+            parsed.push_back(number);
+            if (comma == std::string::npos) {
+                break;
+            }
+            begin = comma + 1;
+        }
+    }
+    value = std::move(parsed);
+    return true;
+}
+
+std::string formatValue(const std::string& value) { return quote(value); }
+std::string formatValue(bool value) { return value ? "true" : "false"; }
+
+template<typename T>
+std::enable_if_t<std::is_arithmetic_v<T>, std::string> formatValue(T value)
+{
+    char buffer[64];
+    auto [ptr, error] = std::to_chars(buffer, buffer + sizeof(buffer), value);
+    return error == std::errc() ? std::string(buffer, ptr) : std::string();
+}
+
+template<typename T>
+std::enable_if_t<std::is_enum_v<T>, std::string> formatValue(T value)
+{
+    return quote(enumName(value));
+}
+
+std::string formatValue(const std::vector<int>& value)
+{
+    std::string text = "[";
+    for (size_t i = 0; i < value.size(); i++) {
+        text += (i > 0 ? ", " : "") + std::to_string(value[i]);
+    }
+    return text + "]";
+}
+
+// =============================================================================
+// Settings tables
+// =============================================================================
+
+template<typename T>
+struct Setting {
+    const char* name;
+    bool reloadable;
+    std::function<bool(T&, const std::string&)> parse;
+    std::function<std::string(const T&)> format;
+};
+
+template<typename T, typename V>
+Setting<T> setting(const char* name, V T::*member, bool reloadable = false)
+{
+    return {name, reloadable,
+            [member](T& target, const std::string& text) { return parseValue(text, target.*member); },
+            [member](const T& source) { return formatValue(source.*member); }};
+}
+
+constexpr bool kReloadable = true;
+
+// In Config order; cameras and output_sinks are tables of their own
+const std::vector<Setting<Config>>& configSettings()
+{
+    static const std::vector<Setting<Config>> settings = {
+        setting("width", &Config::width),
+        setting("height", &Config::height),
+        setting("roi_x", &Config::roi_x),
+        setting("roi_y", &Config::roi_y),
+        setting("roi_width", &Config::roi_width),
+        setting("roi_height", &Config::roi_height),
+        setting("binning", &Config::binning),
+        setting("protocol", &Config::protocol),
+        setting("camera_ip", &Config::camera_ip),
+        setting("camera_port", &Config::camera_port),
+        setting("recv_buffer_size", &Config::recv_buffer_size),
+        setting("tcp_backend", &Config::tcp_backend),
+        setting("receive_mode", &Config::receive_mode),
+        setting("busy_poll_budget_us", &Config::busy_poll_budget_us),
+        setting("socket_busy_poll_us", &Config::socket_busy_poll_us),
+        setting("reconnect_delay_ms", &Config::reconnect_delay_ms),
+        setting("reconnect_max_delay_ms", &Config::reconnect_max_delay_ms),
+        setting("udp_packet_size", &Config::udp_packet_size),
+        setting("udp_batch_size", &Config::udp_batch_size),
+        setting("udp_gro", &Config::udp_gro),
+        setting("udp_sequence_header", &Config::udp_sequence_header),
+        setting("udp_reorder_window", &Config::udp_reorder_window),
+        setting("udp_frame_timeout_us", &Config::udp_frame_timeout_us),
+        setting("udp_incomplete_policy", &Config::udp_incomplete_policy),
+        setting("aedat_port", &Config::aedat_port),
+        setting("output_batch_latency_us", &Config::output_batch_latency_us, kReloadable),
+        setting("output_batch_max_events", &Config::output_batch_max_events, kReloadable),
+        setting("sink_queue_depth", &Config::sink_queue_depth),
+        setting("sink_full_policy", &Config::sink_full_policy, kReloadable),
+        setting("shm_output_name", &Config::shm_output_name),
+        setting("shm_output_capacity", &Config::shm_output_capacity),
+        setting("frame_output_port", &Config::frame_output_port),
+        setting("frame_output_mode", &Config::frame_output_mode),
+        setting("frame_output_interval_us", &Config::frame_output_interval_us, kReloadable),
+        setting("frame_output_contrast", &Config::frame_output_contrast, kReloadable),
+        setting("frame_output_decay_us", &Config::frame_output_decay_us, kReloadable),
+        setting("has_header", &Config::has_header),
+        setting("header_size", &Config::header_size),
+        setting("occupancy_map", &Config::occupancy_map),
+        setting("occupancy_block_bytes", &Config::occupancy_block_bytes),
+        setting("frame_crc", &Config::frame_crc),
+        setting("unpack_kernel", &Config::unpack_kernel),
+        setting("unpack_band_threads", &Config::unpack_band_threads),
+        setting("parallel_density_threshold", &Config::parallel_density_threshold, kReloadable),
+        setting("refractory_period_us", &Config::refractory_period_us, kReloadable),
+        setting("background_activity_us", &Config::background_activity_us, kReloadable),
+        setting("hot_pixel_learn_frames", &Config::hot_pixel_learn_frames),
+        setting("hot_pixel_fraction", &Config::hot_pixel_fraction, kReloadable),
+        setting("unpack_workers", &Config::unpack_workers),
+        setting("queue_depth", &Config::queue_depth),
+        setting("queue_full_policy", &Config::queue_full_policy, kReloadable),
+        setting("use_hugepages", &Config::use_hugepages),
+        setting("pipeline_cpus", &Config::pipeline_cpus),
+        setting("receiver_cpus", &Config::receiver_cpus),
+        setting("worker_cpus", &Config::worker_cpus),
+        setting("writer_cpus", &Config::writer_cpus),
+        setting("numa_node", &Config::numa_node),
+        setting("numa_interface", &Config::numa_interface),
+        setting("realtime_priority", &Config::realtime_priority),
+        setting("lock_memory", &Config::lock_memory),
+        setting("warm_start", &Config::warm_start),
+        setting("warm_start_density", &Config::warm_start_density),
+        setting("camera_output", &Config::camera_output),
+        setting("merge_timeout_us", &Config::merge_timeout_us),
+        setting("frame_interval_us", &Config::frame_interval_us),
+        setting("timestamp_source", &Config::timestamp_source),
+        setting("fpga_timestamp_tick_ns", &Config::fpga_timestamp_tick_ns),
+        setting("timestamp_pll", &Config::timestamp_pll),
+        setting("timestamp_pll_bandwidth_hz", &Config::timestamp_pll_bandwidth_hz),
+        setting("frame_readout_us", &Config::frame_readout_us),
+        setting("record_format", &Config::record_format),
+        setting("record_path", &Config::record_path),
+        setting("record_rotate_bytes", &Config::record_rotate_bytes),
+        setting("record_rotate_seconds", &Config::record_rotate_seconds),
+        setting("record_queue_frames", &Config::record_queue_frames),
+        setting("record_buffer_bytes", &Config::record_buffer_bytes),
+        setting("record_direct_io", &Config::record_direct_io),
+        setting("metrics_port", &Config::metrics_port),
+        setting("config_reload_ms", &Config::config_reload_ms, kReloadable),
+        setting("stats_interval", &Config::stats_interval, kReloadable),
+        setting("stats_period_ms", &Config::stats_period_ms, kReloadable),
+        setting("verbose", &Config::verbose),
+    };
+    return settings;
+}
+
+const std::vector<Setting<CameraInput>>& cameraSettings()
+{
+    static const std::vector<Setting<CameraInput>> settings = {
+        setting("name", &CameraInput::name),
+        setting("camera_port", &CameraInput::camera_port),
+        setting("aedat_port", &CameraInput::aedat_port),
+        setting("cpus", &CameraInput::cpus),
+        setting("receiver_cpus", &CameraInput::receiver_cpus),
+        setting("worker_cpus", &CameraInput::worker_cpus),
+        setting("writer_cpus", &CameraInput::writer_cpus),
+        setting("numa_node", &CameraInput::numa_node),
+        setting("numa_interface", &CameraInput::numa_interface),
+    };
+    return settings;
+}
+
+const std::vector<Setting<OutputSink>>& sinkSettings()
+{
+    static const std::vector<Setting<OutputSink>> settings = {
+        setting("name", &OutputSink::name),
+        setting("port", &OutputSink::port),
+        setting("queue_depth", &OutputSink::queue_depth),
+        setting("full_policy", &OutputSink::full_policy, kReloadable),
+    };
+    return settings;
+}
+
+template<typename T>
+const Setting<T>* findSetting(const std::vector<Setting<T>>& settings, const std::string& name)
+{
+    auto it = std::find_if(settings.begin(), settings.end(), [&](const Setting<T>& s) { return name == s.name; });
+    return it == settings.end() ? nullptr : &*it;
+}
+
+std::string normalizeKey(std::string key)
+{
+    std::replace(key.begin(), key.end(), '-', '_');
+    return key;
+}
+
+// Split "<table>[<index>].<name>"; false for a plain key
+bool splitTableKey(const std::string& key, std::string& table, size_t& index, std::string& name)
+{
+    const size_t open = key.find('[');
+    const size_t close = key.find("].");
+    if (open == std::string::npos || close == std::string::npos || close < open) {
+        return false;
+    }
+    table = key.substr(0, open);
+    name = key.substr(close + 2);
+    return parseValue(key.substr(open + 1, close - open - 1), index);
+}
+
+// Set one entry's setting; index == size appends an entry
+template<typename T>
+bool setTableValue(std::vector<T>& entries, const std::vector<Setting<T>>& settings, size_t index,
+                   const std::string& name, const std::string& value, const std::string& key)
+{
+    const Setting<T>* s = findSetting(settings, name);
+    if (s == nullptr || index > entries.size()) {
+        std::cerr << "Unknown setting '" << key << "'" << std::endl;
+        return false;
+    }
+    if (index == entries.size()) {
+        entries.emplace_back();
+    }
+    if (!s->parse(entries[index], value)) {
+        std::cerr << "Invalid value for " << key << ": " << value << std::endl;
+        return false;
+    }
+    return true;
+}
+
+template<typename T>
+void diffTable(const char* table, const std::vector<T>& from, const std::vector<T>& to,
+               const std::vector<Setting<T>>& settings, std::vector<ConfigChange>& changes)
+{
+    if (from.size() != to.size()) {
+        changes.push_back({table, std::to_string(from.size()) + " entries", std::to_string(to.size()) + " entries", false});
+        return;
+    }
+    for (size_t i = 0; i < from.size(); i++) {
+        for (const Setting<T>& s : settings) {
+            std::string old_value = s.format(from[i]);
+            std::string new_value = s.format(to[i]);
+            if (old_value != new_value) {
+                changes.push_back({std::string(table) + "[" + std::to_string(i) + "]." + s.name,
+                                   std::move(old_value), std::move(new_value), s.reloadable});
+            }
+        }
+    }
+}
+
+template<typename T>
+void writeTable(std::ostream& out, const char* table, const std::vector<T>& entries,
+                const std::vector<Setting<T>>& settings)
+{
+    for (const T& entry : entries) {
+        out << "\n[[" << table << "]]\n";
+        for (const Setting<T>& s : settings) {
+            out << s.name << " = " << s.format(entry) << "\n";
+        }
+    }
+}
+
+// Remove a trailing comment; '#' inside a string does not start one
+std::string stripComment(const std::string& line)
+{
+    bool in_string = false;
+    for (size_t i = 0; i < line.size(); i++) {
+        if (line[i] == '\\' && in_string) {
+            i++;
+        } else if (line[i] == '"') {
+            in_string = !in_string;
+        } else if (line[i] == '#' && !in_string) {
+            return line.substr(0, i);
+        }
+    }
+    return line;
+}
+
+} // namespace
+
+bool parseCommandLine(int argc, char* argv[], CommandLine& cli)
+{
+    for (int i = 1; i < argc; i++) {
+        const std::string arg = argv[i];
+        if (arg == "-h" || arg == "--help") {
+            cli.help = true;
+        } else if (arg == "--print-config") {
+            cli.print_config = true;
+        } else if (arg == "-c" || arg == "--config") {
+            if (i + 1 >= argc) {
+                std::cerr << arg << " needs a file name" << std::endl;
+                return false;
+            }
+            cli.config_path = argv[++i];
+        } else if (arg.rfind("--config=", 0) == 0) {
+            cli.config_path = arg.substr(9);
+        } else if (arg.size() > 2 && arg.rfind("--", 0) == 0) {
+            // --KEY=VALUE, or --KEY for a boolean setting
+            const size_t equals = arg.find('=');
+            std::string key = normalizeKey(arg.substr(2, equals == std::string::npos ? std::string::npos : equals - 2));
+            cli.overrides.emplace_back(std::move(key), equals == std::string::npos ? "true" : arg.substr(equals + 1));
+        } else {
+            std::cerr << "Unexpected argument '" << arg << "'" << std::endl;
+            return false;
+        }
+    }
+    return true;
+}
+
+bool loadConfig(const CommandLine& cli, Config& cfg)
+{
+    Config loaded;
+    if (!cli.config_path.empty() && !loadConfigFile(cli.config_path, loaded)) {
+        return false;
+    }
+    for (const auto& [key, value] : cli.overrides) {
+        if (!setConfigValue(loaded, key, value)) {
+            return false;
+        }
+    }
+    if (!validateConfig(loaded)) {
+        return false;
+    }
+    cfg = std::move(loaded);
+    return true;
+}
+
+bool validateConfig(const Config& cfg)
+{
+    bool valid = true;
+    auto reject = [&valid](const std::string& message) {
+        std::cerr << "Invalid configuration: " << message << std::endl;
+        valid = false;
+    };
+
+    // Events carry int16 coordinates, and the kernels' reciprocal row division
+    // is only exact up to a bounded frame size
+    if (cfg.width < 4 || cfg.width > 32767 || cfg.height < 1 || cfg.height > 32767) {
+        reject("frame geometry " + std::to_string(cfg.width) + "x" + std::to_string(cfg.height)
+            + " out of range (width 4-32767, height 1-32767)");
+    } else if (!UnpackParams::supportsGeometry(cfg.width, cfg.width * cfg.height)) {
+        reject("frame geometry " + std::to_string(cfg.width) + "x" + std::to_string(cfg.height)
+            + " too large for the unpack kernels (width * width * height must stay below 2^40)");
+    }
+
+    // The size header is decoded into 32 bits
+    if (cfg.header_size < 1 || cfg.header_size > 4) {
+        reject("header_size must be 1 to 4 bytes (got " + std::to_string(cfg.header_size) + ")");
+    }
+    return valid;
+}
+
+bool loadConfigFile(const std::string& path, Config& cfg)
+{
+    std::ifstream file(path);
+    if (!file) {
+        std::cerr << "Cannot open config file " << path << std::endl;
+        return false;
+    }
+
+    // Keys go to the top level until the first [[cameras]] / [[output_sinks]]
+    std::string table;
+    std::string line;
+    for (int number = 1; std::getline(file, line); number++) {
+        const std::string text = trim(stripComment(line));
+        if (text.empty()) {
+            continue;
+        }
+        const std::string where = path + ":" + std::to_string(number) + ": ";
+
+        if (text.front() == '[') {
+            if (text == "[[cameras]]") {
+                table = "cameras";
+                cfg.cameras.emplace_back();
+            } else if (text == "[[output_sinks]]") {
+                table = "output_sinks";
+                cfg.output_sinks.emplace_back();
+            } else {
+                std::cerr << where << "unsupported table " << text << " (only [[cameras]] and [[output_sinks]])"
+                          << std::endl;
+                return false;
+            }
+            continue;
+        }
+
+        const size_t equals = text.find('=');
+        if (equals == std::string::npos) {
+            std::cerr << where << "expected key = value" << std::endl;
+            return false;
+        }
+        std::string key = trim(text.substr(0, equals));
+        const std::string value = trim(text.substr(equals + 1));
+        if (table == "cameras") {
+            key = "cameras[" + std::to_string(cfg.cameras.size() - 1) + "]." + key;
+        } else if (table == "output_sinks") {
+            key = "output_sinks[" + std::to_string(cfg.output_sinks.size() - 1) + "]." + key;
+        }
+        if (!setConfigValue(cfg, key, value)) {
+            std::cerr << "  at " << where << line << std::endl;
+            return false;
+        }
+    }
+    return true;
+}
+
+bool setConfigValue(Config& cfg, const std::string& key, const std::string& value)
+{
+    const std::string normalized = normalizeKey(key);
+    std::string table;
+    std::string name;
+    size_t index = 0;
+    if (splitTableKey(normalized, table, index, name)) {
+        if (table == "cameras") {
+            return setTableValue(cfg.cameras, cameraSettings(), index, name, value, normalized);
+        }
+        if (table == "output_sinks") {
+            return setTableValue(cfg.output_sinks, sinkSettings(), index, name, value, normalized);
+        }
+    } else if (const Setting<Config>* s = findSetting(configSettings(), normalized)) {
+        if (!s->parse(cfg, value)) {
+            std::cerr << "Invalid value for " << normalized << ": " << value << std::endl;
+            return false;
+        }
+        return true;
+    }
+    std::cerr << "Unknown setting '" << normalized << "'" << std::endl;
+    return false;
+}
+
+void writeConfig(std::ostream& out, const Config& cfg)
+{
+    out << "# DVBridge configuration (converter --print-config)\n";
+    for (const Setting<Config>& s : configSettings()) {
+        out << s.name << " = " << s.format(cfg) << "\n";
+    }
+    writeTable(out, "cameras", cfg.cameras, cameraSettings());
+    writeTable(out, "output_sinks", cfg.output_sinks, sinkSettings());
+}
+
+void printUsage(std::ostream& out, const char* program)
+{
+    const Config defaults;
+    out << "Usage: " << program << " [options]\n"
+        << "  -c, --config=FILE   Load settings from FILE, and reload it when it changes\n"
+        << "  --KEY=VALUE         Set one setting (after the file; --KEY alone sets a boolean)\n"
+        << "  --print-config      Print the effective configuration in the file format and exit\n"
+        << "  -h, --help          Show this help\n"
+        << "\nSettings and defaults (* = applied on reload without a restart):\n";
+    for (const Setting<Config>& s : configSettings()) {
+        out << (s.reloadable ? "  * " : "    ") << s.name << " = " << s.format(defaults) << "\n";
+    }
+    out << "\nPer camera ([[cameras]] tables, or --cameras[i].KEY=VALUE):\n";
+    for (const Setting<CameraInput>& s : cameraSettings()) {
+        out << "    " << s.name << "\n";
+    }
+    out << "\nExtra AEDAT4 outputs ([[output_sinks]] tables, or --output_sinks[i].KEY=VALUE):\n";
+    for (const Setting<OutputSink>& s : sinkSettings()) {
+        out << (s.reloadable ? "  * " : "    ") << s.name << "\n";
+    }
+}
+
+bool isReloadableConfigKey(const std::string& key)
+{
+    const std::string normalized = normalizeKey(key);
+    std::string table;
+    std::string name;
+    size_t index = 0;
+    if (splitTableKey(normalized, table, index, name)) {
+        const Setting<OutputSink>* s = table == "output_sinks" ? findSetting(sinkSettings(), name) : nullptr;
+        return s != nullptr && s->reloadable;
+    }
+    const Setting<Config>* s = findSetting(configSettings(), normalized);
+    return s != nullptr && s->reloadable;
+}
+
+std::vector<ConfigChange> diffConfig(const Config& from, const Config& to)
+{
+    std::vector<ConfigChange> changes;
+    for (const Setting<Config>& s : configSettings()) {
+        std::string old_value = s.format(from);
+        std::string new_value = s.format(to);
+        if (old_value != new_value) {
+            changes.push_back({s.name, std::move(old_value), std::move(new_value), s.reloadable});
+        }
+    }
+    diffTable("cameras", from.cameras, to.cameras, cameraSettings(), changes);
+    diffTable("output_sinks", from.output_sinks, to.output_sinks, sinkSettings(), changes);
+    return changes;
+}
+
+ConfigWatcher::ConfigWatcher(CommandLine cli)
+    : cli_(std::move(cli))
+{
+    std::error_code error;
+    if (isEnabled()) {
+        last_write_ = std::filesystem::last_write_time(cli_.config_path, error);
+    }
+}
+
+bool ConfigWatcher::poll(Config& loaded)
+{
+    if (!isEnabled()) {
+        return false;
+    }
+    std::error_code error;
+    const std::filesystem::file_time_type write_time = std::filesystem::last_write_time(cli_.config_path, error);
+    if (error || write_time == last_write_) {
+        return false;
+    }
+    last_write_ = write_time;
+
+    Config fresh;
+    if (!loadConfig(cli_, fresh)) {
+        std::cerr << "Warning: Not reloading " << cli_.config_path << ", keeping the running configuration"
+                  << std::endl;
+        return false;
+    }
+    loaded = std::move(fresh);
+    return true;
+}
+
+} // namespace converter
@@ -0,0 +1,263 @@
+#include "crc32c.hpp"
+
+// The x86 version is compiled with a target attribute so the binary still
+// runs on CPUs without SSE4.2; the CPU is queried once before it is used.
+// ARM has no portable runtime check, so its version needs a build that
+// targets the CRC extension (-march=armv8-a+crc, default on Apple silicon).
+#if defined(__x86_64__) || defined(_M_X64)
+    #define CONVERTER_CRC_SSE42 1
+    #include <immintrin.h>
+    #if defined(_MSC_VER) && !defined(__clang__)
+        #include <intrin.h>
+        #define CONVERTER_TARGET(isa)
+    #else
+        #define CONVERTER_TARGET(isa) __attribute__((target(isa)))
+    #endif
+#elif defined(__ARM_FEATURE_CRC32)
+    #define CONVERTER_CRC_ARM 1
+    #include <arm_acle.h>
+#endif
+
+#include <array>
+#include <cstring>
+
+namespace converter {
+
+namespace {
+
+constexpr uint32_t kPolynomial = 0x82F63B78;    // 0x1EDC6F41 reflected
+
+// Streams of the interleaved hardware loop; the last few KB use short ones
+constexpr size_t kLongStream = 8192;
+constexpr size_t kShortStream = 256;
+
+using ShiftTable = std::array<std::array<uint32_t, 256>, 4>;
+
+/**
+ * Lookup tables: slicing-by-8 for the portable version, and operators that
+ * append kLongStream / kShortStream zero bytes to a CRC, to merge the
+ * streams of the hardware version
+ */
+struct Tables {
+    std::array<std::array<uint32_t, 256>, 8> slice;
+    ShiftTable long_shift;
+    ShiftTable short_shift;
+
+    Tables()
+    {
+        for (uint32_t n = 0; n < 256; n++) {
+            uint32_t crc = n;
+            for (int k = 0; k < 8; k++) {
+                crc = (crc & 1) ? (crc >> 1) ^ kPolynomial : crc >> 1;
+            }
+            slice[0][n] = crc;
+        }
+        for (uint32_t n = 0; n < 256; n++) {
+            uint32_t crc = slice[0][n];
+            for (size_t k = 1; k < 8; k++) {
+                crc = slice[0][crc & 0xFF] ^ (crc >> 8);
+                slice[k][n] = crc;
+            }
+        }
+        buildShift(long_shift, kLongStream);
+        buildShift(short_shift, kShortStream);
+    }
+
+private:
+    // GF(2) 32x32 matrix times vector; the matrix is 32 columns
+    static uint32_t times(const uint32_t* matrix, uint32_t vector)
+    {
+        uint32_t sum = 0;
+        for (; vector != 0; vector >>= 1, matrix++) {
+            if (vector & 1) {
+                sum ^= *matrix;
+            }
+        }
+        return sum;
+    }
+
+    static void square(uint32_t* result, const uint32_t* matrix)
+    {
+        for (int n = 0; n < 32; n++) {
+            result[n] = times(matrix, matrix[n]);
+        }
+    }
+
+    // Operator for appending `bytes` zero bytes (a power of two), byte-sliced
+    static void buildShift(ShiftTable& table, size_t bytes)
+    {
+        uint32_t even[32];
+        uint32_t odd[32];
+
+        // One zero bit
+        odd[0] = kPolynomial;
+        for (int n = 1; n < 32; n++) {
+            odd[n] = uint32_t{1} << (n - 1);
+        }
+        square(even, odd);      // Two zero bits
+        square(odd, even);      // Four zero bits
+
+        // Each square doubles the zeros: one byte, two bytes, ...
+        uint32_t* op = odd;
+        for (size_t remaining = bytes; remaining != 0; remaining >>= 1) {
+            uint32_t* next = op == odd ? even : odd;
+            square(next, op);
+            op = next;
+        }
+
+        for (uint32_t n = 0; n < 256; n++) {
+            for (int k = 0; k < 4; k++) {
+                table[k][n] = times(op, n << (8 * k));
+            }
+        }
+    }
+};
+
+const Tables& tables()
+{
+    static const Tables instance;
+    return instance;
+}
+
+inline uint32_t shift(const ShiftTable& table, uint32_t crc)
+{
+    return table[0][crc & 0xFF] ^ table[1][(crc >> 8) & 0xFF] ^
+           table[2][(crc >> 16) & 0xFF] ^ table[3][crc >> 24];
+}
+
+inline uint64_t load64(const uint8_t* p)
+{
+    uint64_t value;
+    std::memcpy(&value, p, sizeof(value));
+    return value;
+}
+
+uint32_t crc32cTable(const uint8_t* data, size_t size, uint32_t crc)
+{
+    const auto& slice = tables().slice;
+    uint64_t state = ~crc;
+
+#if !defined(__BYTE_ORDER__) || __BYTE_ORDER__ == __ORDER_LITTLE_ENDIAN__
+    for (; size >= 8; size -= 8, data += 8) {
+        state ^= load64(data);
+        state = slice[7][state & 0xFF] ^ slice[6][(state >> 8) & 0xFF] ^
+                slice[5][(state >> 16) & 0xFF] ^ slice[4][(state >> 24) & 0xFF] ^
+                slice[3][(state >> 32) & 0xFF] ^ slice[2][(state >> 40) & 0xFF] ^
+                slice[1][(state >> 48) & 0xFF] ^ slice[0][state >> 56];
+    }
+#endif
+    for (; size > 0; size--, data++) {
+        state = slice[0][(state ^ *data) & 0xFF] ^ (state >> 8);
+    }
+    return ~static_cast<uint32_t>(state);
+}
+
+#if defined(CONVERTER_CRC_SSE42) || defined(CONVERTER_CRC_ARM)
+
+#ifdef CONVERTER_CRC_SSE42
+    #define CRC_TARGET CONVERTER_TARGET("sse4.2")
+    #define CRC_BYTE(crc, value) _mm_crc32_u8(static_cast<uint32_t>(crc), value)
+    #define CRC_WORD(crc, value) _mm_crc32_u64(crc, value)
+#else
+    #define CRC_TARGET
+    #define CRC_BYTE(crc, value) __crc32cb(static_cast<uint32_t>(crc), value)
+    #define CRC_WORD(crc, value) __crc32cd(static_cast<uint32_t>(crc), value)
+#endif
+
+/**
+ * Three independent streams of `stream` bytes per block: the crc
+ * instruction issues every cycle but takes three, so one stream would run
+ * at a third of the speed. The streams' CRCs are merged by shifting.
+ */
+CRC_TARGET
+uint64_t crc32cBlocks(const uint8_t*& data, size_t& size, uint64_t crc0, size_t stream, const ShiftTable& table)
+{
+    while (size >= 3 * stream) {
+        uint64_t crc1 = 0;
+        uint64_t crc2 = 0;
+        for (const uint8_t* end = data + stream; data < end; data += 8) {
+            crc0 = CRC_WORD(crc0, load64(data));
+            crc1 = CRC_WORD(crc1, load64(data + stream));
+            crc2 = CRC_WORD(crc2, load64(data + 2 * stream));
+        }
+        crc0 = shift(table, static_cast<uint32_t>(crc0)) ^ crc1;
+        crc0 = shift(table, static_cast<uint32_t>(crc0)) ^ crc2;
+        data += 2 * stream;
+        size -= 3 * stream;
+    }
+    return crc0;
+}
+
+CRC_TARGET
+uint32_t crc32cHardware(const uint8_t* data, size_t size, uint32_t crc)
+{
+    uint64_t state = ~crc;
+
+    // Up to seven bytes to reach an 8-byte boundary
+    for (; size > 0 && (reinterpret_cast<uintptr_t>(data) & 7) != 0; size--, data++) {
+        state = CRC_BYTE(state, *data);
+    }
+
+    const Tables& t = tables();
+    state = crc32cBlocks(data, size, state, kLongStream, t.long_shift);
+    state = crc32cBlocks(data, size, state, kShortStream, t.short_shift);
+
+    for (; size >= 8; size -= 8, data += 8) {
+        state = CRC_WORD(state, load64(data));
+    }
+    for (; size > 0; size--, data++) {
+        state = CRC_BYTE(state, *data);
+    }
+    return ~static_cast<uint32_t>(state);
+}
+
+#endif
+
+#ifdef CONVERTER_CRC_SSE42
+bool cpuHasSse42()
+{
+#if defined(_MSC_VER) && !defined(__clang__)
+    int info[4];
+    __cpuid(info, 1);
+    return (info[2] & (1 << 20)) != 0;
+#else
+    return __builtin_cpu_supports("sse4.2");
+#endif
+}
+#endif
+
+using Crc32cFn = uint32_t (*)(const uint8_t*, size_t, uint32_t);
+
+struct Implementation {
+    Crc32cFn fn;
+    const char* name;
+};
+
+const Implementation& implementation()
+{
+    static const Implementation selected = []() -> Implementation {
+#if defined(CONVERTER_CRC_SSE42)
+        if (cpuHasSse42()) {
+            return {crc32cHardware, "SSE4.2"};
+        }
+#elif defined(CONVERTER_CRC_ARM)
+        return {crc32cHardware, "ARMv8 CRC"};
+#endif
+        return {crc32cTable, "Table"};
+    }();
+    return selected;
+}
+
+} // namespace
+
+uint32_t crc32c(const void* data, size_t size, uint32_t crc)
+{
+    return implementation().fn(static_cast<const uint8_t*>(data), size, crc);
+}
+
+const char* crc32cImplementation()
+{
+    return implementation().name;
+}
+
+} // namespace converter
@@ -0,0 +1,120 @@
+#include "event_batcher.hpp"
+#include "timestamp_engine.hpp"
+#include <algorithm>
+
+namespace converter {
+
+EventBatcher::EventBatcher(const Config& cfg, OutputFn output)
+    : output_(std::move(output))
+    , budget_ns_(std::max<int64_t>(0, cfg.output_batch_latency_us) * 1000)
+    , max_events_(cfg.output_batch_max_events)
+    , batch_start_ns_(0)
+    , last_add_ns_(0)
+    , frame_gap_ns_(std::max<int64_t>(0, cfg.frame_interval_us) * 1000)
+    , batches_written_(0)
+    , frames_batched_(0)
+{
+}
+
+void EventBatcher::add(const dv::EventStore& events)
+{
+    const int64_t now = steadyClockNs();
+    std::unique_lock<std::mutex> lock(mutex_);
+    const int64_t budget_ns = budget_ns_.load(std::memory_order_relaxed);
+
+    // Unbatched: straight through, as before (after anything a reload left behind)
+    if (budget_ns == 0) {
+        if (!events.isEmpty()) {
+            pending_.add(events);
+            frames_batched_.fetch_add(1, std::memory_order_relaxed);
+        }
+        if (!pending_.isEmpty()) {
+            writePending(lock, true);
+        }
+        return;
+    }
+
+    // Track the actual frame rate; a pause is clamped (to twice the budget,
+    // which is still clearly too slow to batch) so it is soon forgotten
+    if (last_add_ns_ != 0) {
+        const int64_t gap = std::min(now - last_add_ns_, 2 * budget_ns);
+        frame_gap_ns_ += (gap - frame_gap_ns_) / 8;
+    }
+    last_add_ns_ = now;
+
+    if (!events.isEmpty()) {
+        if (pending_.isEmpty()) {
+            batch_start_ns_ = now;
+        }
+        pending_.add(events);
+        frames_batched_.fetch_add(1, std::memory_order_relaxed);
+    }
+    if (pending_.isEmpty()) {
+        return;
+    }
+
+    if (pending_.size() >= max_events_ || now - batch_start_ns_ + frame_gap_ns_ >= budget_ns) {
+        writePending(lock, true);
+    }
+}
+
+void EventBatcher::flushExpired()
+{
+    if (budget_ns_.load(std::memory_order_relaxed) == 0) {
+        return;
+    }
+    const int64_t now = steadyClockNs();
+    std::unique_lock<std::mutex> lock(mutex_);
+    if (!pending_.isEmpty() && now - batch_start_ns_ >= budget_ns_.load(std::memory_order_relaxed)) {
+        // A batch still being written means add() is busy and will flush this one
+        writePending(lock, false);
+    }
+}
+
+void EventBatcher::flush()
+{
+    std::unique_lock<std::mutex> lock(mutex_);
+    if (!pending_.isEmpty()) {
+        writePending(lock, true);
+    }
+}
+
+void EventBatcher::reload(const Config& cfg)
+{
+    std::unique_lock<std::mutex> lock(mutex_);
+    budget_ns_.store(std::max<int64_t>(0, cfg.output_batch_latency_us) * 1000, std::memory_order_relaxed);
+    max_events_ = cfg.output_batch_max_events;
+    if (budget_ns_.load(std::memory_order_relaxed) == 0 && !pending_.isEmpty()) {
+        // If a write is in progress, the next add() writes it first
+        writePending(lock, false);
+    }
+}
+
+int64_t EventBatcher::getFlushPeriodUs() const
+{
+    // Half the budget keeps a paused batch within 1.5x of it
+    const int64_t budget_ns = budget_ns_.load(std::memory_order_relaxed);
+    return budget_ns == 0 ? 0 : std::max<int64_t>(1000, budget_ns / 2000);
+}
+
+bool EventBatcher::writePending(std::unique_lock<std::mutex>& lock, bool wait)
+{
+    // Taking output_mutex_ before letting go of mutex_ keeps batches in order
+    std::unique_lock<std::mutex> output_lock(output_mutex_, std::defer_lock);
+    if (wait) {
+        output_lock.lock();
+    } else if (!output_lock.try_lock()) {
+        return false;
+    }
+
+    dv::EventStore batch = std::move(pending_);
+    pending_ = dv::EventStore();
+    lock.unlock();
+
+    // A blocking sink only holds up this thread, not add() or flushExpired()
+    output_(batch);
+    batches_written_.fetch_add(1, std::memory_order_relaxed);
+    return true;
+}
+
+} // namespace converter
@@ -0,0 +1,120 @@
+#include "event_fanout.hpp"
+#include "timestamp_engine.hpp"
+#include <algorithm>
+
+namespace converter {
+
+EventFanout::~EventFanout()
+{
+    stop();
+}
+
+size_t EventFanout::addSink(std::string name, size_t queue_depth, QueueFullPolicy policy, SinkFn write)
+{
+    sinks_.push_back(std::make_unique<Sink>(std::move(name), std::max<size_t>(1, queue_depth), policy,
+                                            std::move(write)));
+    return sinks_.size() - 1;
+}
+
+void EventFanout::start()
+{
+    stop_requested_ = false;
+    for (auto& sink : sinks_) {
+        if (!sink->thread.joinable()) {
+            sink->thread = std::thread(&EventFanout::sinkLoop, this, std::ref(*sink));
+        }
+    }
+}
+
+void EventFanout::stop()
+{
+    stop_requested_ = true;
+    for (auto& sink : sinks_) {
+        if (sink->thread.joinable()) {
+            sink->thread.join();
+        }
+    }
+}
+
+void EventFanout::publish(const dv::EventStore& events)
+{
+    if (events.isEmpty()) {
+        return;
+    }
+    const int64_t now = steadyClockNs();
+
+    for (auto& sink_ptr : sinks_) {
+        Sink& sink = *sink_ptr;
+        Item item;
+        item.events = events;       // Shallow: every sink shares the packets
+        item.queued_ns = now;
+        sink.packets_published.fetch_add(1, std::memory_order_relaxed);
+
+        QueueBackoff backoff;
+        const QueueFullPolicy policy = sink.policy.load(std::memory_order_relaxed);
+        while (!sink.queue.tryPush(item)) {
+            if (policy == QueueFullPolicy::DropOldest) {
+                // Make room by discarding this sink's oldest packet
+                Item oldest;
+                if (sink.queue.tryPop(oldest)) {
+                    sink.packets_dropped.fetch_add(1, std::memory_order_relaxed);
+                    sink.events_dropped.fetch_add(oldest.events.size(), std::memory_order_relaxed);
+                }
+                continue;
+            }
+            if (stop_requested_) {
+                sink.packets_dropped.fetch_add(1, std::memory_order_relaxed);
+                sink.events_dropped.fetch_add(item.events.size(), std::memory_order_relaxed);
+                break;
+            }
+            backoff.wait();
+        }
+    }
+}
+
+void EventFanout::sinkLoop(Sink& sink)
+{
+    QueueBackoff backoff;
+    Item item;
+
+    for (;;) {
+        if (sink.queue.tryPop(item)) {
+            backoff.reset();
+            const int64_t lag = steadyClockNs() - item.queued_ns;
+            sink.lag_ns.store(lag, std::memory_order_relaxed);
+            if (lag > sink.max_lag_ns.load(std::memory_order_relaxed)) {
+                sink.max_lag_ns.store(lag, std::memory_order_relaxed);
+            }
+
+            sink.write(item.events);
+            sink.packets_written.fetch_add(1, std::memory_order_relaxed);
+            sink.events_written.fetch_add(item.events.size(), std::memory_order_relaxed);
+            item = Item();  // Release the shared packets now
+            continue;
+        }
+        // Deliver what was queued before stop()
+        if (stop_requested_) {
+            break;
+        }
+        backoff.wait();
+    }
+}
+
+EventFanout::SinkStats EventFanout::getSinkStats(size_t index) const
+{
+    const Sink& sink = *sinks_[index];
+    SinkStats stats;
+    stats.name = sink.name;
+    stats.packets_published = sink.packets_published.load(std::memory_order_relaxed);
+    stats.packets_written = sink.packets_written.load(std::memory_order_relaxed);
+    stats.packets_dropped = sink.packets_dropped.load(std::memory_order_relaxed);
+    stats.events_written = sink.events_written.load(std::memory_order_relaxed);
+    stats.events_dropped = sink.events_dropped.load(std::memory_order_relaxed);
+    stats.queue_depth = sink.queue.sizeApprox();
+    stats.queue_capacity = sink.queue.capacity();
+    stats.lag_ns = sink.lag_ns.load(std::memory_order_relaxed);
+    stats.max_lag_ns = sink.max_lag_ns.load(std::memory_order_relaxed);
+    return stats;
+}
+
+} // namespace converter
@@ -0,0 +1,191 @@
+#include "event_merger.hpp"
+#include <algorithm>
+#include <limits>
+
+namespace converter {
+
+namespace {
+
+// Merged events are handed to the output in batches of up to this many
+// (a smaller batch goes out whenever the merge has to wait for an input)
+constexpr size_t kOutputBatchEvents = 1 << 16;
+
+constexpr int64_t kNoBound = std::numeric_limits<int64_t>::max();
+
+} // namespace
+
+EventMerger::EventMerger(const Config& cfg, OutputFn output)
+    : output_(std::move(output))
+    , timeout_(std::max(cfg.merge_timeout_us, 2 * cfg.frame_interval_us))
+    , has_output_(false)
+    , last_time_(0)
+    , stop_requested_(false)
+    , events_merged_(0)
+    , late_events_(0)
+    , stalls_(0)
+{
+    const size_t depth = static_cast<size_t>(std::max(1, cfg.queue_depth));
+
+    for (size_t i = 0; i < cfg.camera_count(); i++) {
+        inputs_.push_back(std::make_unique<Input>());
+        inputs_.back()->queue = std::make_unique<BoundedQueue<Item>>(depth);
+    }
+}
+
+EventMerger::~EventMerger()
+{
+    stop();
+}
+
+void EventMerger::start()
+{
+    if (thread_.joinable()) {
+        return;
+    }
+
+    stop_requested_ = false;
+    const auto now = std::chrono::steady_clock::now();
+    for (auto& input : inputs_) {
+        input->last_frame = now;  // Every input gets a full timeout to deliver its first frame
+    }
+    thread_ = std::thread(&EventMerger::mergeLoop, this);
+}
+
+void EventMerger::stop()
+{
+    stop_requested_ = true;
+    if (thread_.joinable()) {
+        thread_.join();
+    }
+}
+
+bool EventMerger::push(size_t input, const dv::EventStore& events, int64_t watermark)
+{
+    Item item{events, watermark};
+    BoundedQueue<Item>& queue = *inputs_[input]->queue;
+    QueueBackoff backoff;
+
+    while (!queue.tryPush(item)) {
+        if (stop_requested_) {
+            return false;
+        }
+        backoff.wait();
+    }
+    return true;
+}
+
+void EventMerger::refill(Input& input, std::chrono::steady_clock::time_point now)
+{
+    Item item;
+    while (input.pending.isEmpty() && input.queue->tryPop(item)) {
+        input.pending = std::move(item.events);
+        input.watermark = item.watermark;
+        input.seen = true;
+        input.stalled = false;
+        input.last_frame = now;
+
+        // Only an input that was merged without can be behind the output
+        if (has_output_ && !input.pending.isEmpty() && input.pending.getLowestTime() < last_time_) {
+            dv::EventStore kept;
+            if (input.pending.getHighestTime() >= last_time_) {
+                kept = input.pending.sliceTime(last_time_, input.pending.getHighestTime() + 1);
+            }
+            late_events_.fetch_add(input.pending.size() - kept.size(), std::memory_order_relaxed);
+            input.pending = std::move(kept);
+        }
+    }
+}
+
+bool EventMerger::lowerBound(Input& input, std::chrono::steady_clock::time_point now, int64_t& lower)
+{
+    if (!input.pending.isEmpty()) {
+        lower = input.pending.getLowestTime();
+        return true;
+    }
+
+    if (input.stalled || now - input.last_frame > timeout_) {
+        if (!input.stalled) {
+            input.stalled = true;
+            stalls_.fetch_add(1, std::memory_order_relaxed);
+        }
+        return false;
+    }
+
+    // Before its first frame nothing is known, so everything waits for it
+    lower = input.seen ? input.watermark : std::numeric_limits<int64_t>::min();
+    return true;
+}
+
+void EventMerger::mergeLoop()
+{
+    dv::EventStore batch;
+    QueueBackoff backoff;
+
+    auto flush = [&]() {
+        if (!batch.isEmpty()) {
+            output_(batch);
+            batch = dv::EventStore();
+        }
+    };
+
+    while (!stop_requested_) {
+        const auto now = std::chrono::steady_clock::now();
+
+        // Earliest input, and the earliest time any other input can deliver
+        Input* next = nullptr;
+        int64_t next_lower = 0;
+        int64_t bound = kNoBound;
+
+        for (auto& input : inputs_) {
+            refill(*input, now);
+
+            int64_t lower;
+            if (!lowerBound(*input, now, lower)) {
+                continue;
+            }
+
+            // On a tie prefer an input that has events to pass on
+            if (next == nullptr || lower < next_lower ||
+                (lower == next_lower && next->pending.isEmpty() && !input->pending.isEmpty())) {
+                if (next != nullptr) {
+                    bound = std::min(bound, next_lower);
+                }
+                next = input.get();
+                next_lower = lower;
+            } else {
+                bound = std::min(bound, lower);
+            }
+        }
+
+        if (next == nullptr || next->pending.isEmpty()) {
+            // The earliest input has not delivered yet
+            flush();
+            backoff.wait();
+            continue;
+        }
+        backoff.reset();
+
+        // Everything up to and including `bound` can no longer be preceded
+        dv::EventStore chunk;
+        if (bound == kNoBound || next->pending.getHighestTime() <= bound) {
+            chunk = std::move(next->pending);
+            next->pending = dv::EventStore();
+        } else {
+            chunk = next->pending.sliceTime(next_lower, bound + 1);
+            next->pending = next->pending.sliceTime(bound + 1, next->pending.getHighestTime() + 1);
+        }
+
+        last_time_ = chunk.getHighestTime();
+        has_output_ = true;
+        events_merged_.fetch_add(chunk.size(), std::memory_order_relaxed);
+        batch.add(chunk);
+
+        if (batch.size() >= kOutputBatchEvents) {
+            flush();
+        }
+    }
+
+    flush();
+}
+
+} // namespace converter
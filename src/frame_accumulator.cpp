@@ -0,0 +1,295 @@
+#include "frame_accumulator.hpp"
+#include "pipeline.hpp"
+#include <algorithm>
+#include <array>
+#include <cstring>
+
+namespace converter {
+
+namespace {
+
+// Frames the output thread may fall behind by before new ones are dropped
+constexpr size_t kQueueFrames = 4;
+
+// Last event time of a pixel that never fired: older than any decay
+constexpr int64_t kNever = INT64_MIN / 2;
+
+// Event density from which reading the packed frame beats walking its
+// events (BM_FrameAccumulator): a non-empty word costs 32 pixel updates
+// whatever it holds, an event one scattered update
+constexpr double kPolarityPackedDensity = 0.05;
+constexpr double kTimeSurfacePackedDensity = 0.4;
+
+// Pixels are stored padded to whole 64-bit words of packed data (32 pixels),
+// so the packed path never checks bounds inside a word
+constexpr size_t kWordPixels = 32;
+
+/**
+ * Per packed byte, masks of its 4 pixels (MSB first) as 4 bytes in memory
+ * order: 0xFF where the pixel is 01 (pos) or 10 (neg), 0x00 elsewhere.
+ * Two entries make the 8 pixel bytes of a little-endian 64-bit word.
+ */
+struct PackedTables {
+    std::array<uint32_t, 256> pos;
+    std::array<uint32_t, 256> neg;
+
+    PackedTables()
+    {
+        for (int byte = 0; byte < 256; byte++) {
+            uint8_t pos_bytes[4];
+            uint8_t neg_bytes[4];
+            for (int k = 0; k < 4; k++) {
+                const int code = (byte >> (6 - 2 * k)) & 0x03;
+                pos_bytes[k] = code == 1 ? 0xFF : 0x00;
+                neg_bytes[k] = code == 2 ? 0xFF : 0x00;
+            }
+            std::memcpy(&pos[byte], pos_bytes, sizeof(uint32_t));
+            std::memcpy(&neg[byte], neg_bytes, sizeof(uint32_t));
+        }
+    }
+};
+
+const PackedTables& packedTables()
+{
+    static const PackedTables instance;
+    return instance;
+}
+
+// Byte-wise saturating a + b and a - b on 8 pixels in a 64-bit word
+constexpr uint64_t kHigh = 0x8080808080808080ULL;
+
+inline uint64_t addSaturate(uint64_t a, uint64_t b)
+{
+    const uint64_t sum = ((a & ~kHigh) + (b & ~kHigh)) ^ ((a ^ b) & kHigh);
+    const uint64_t carry = ((a & b) | ((a | b) & ~sum)) & kHigh;
+    return sum | ((carry >> 7) * 0xFF);
+}
+
+inline uint64_t subSaturate(uint64_t a, uint64_t b)
+{
+    const uint64_t diff = ((a | kHigh) - (b & ~kHigh)) ^ ((a ^ ~b) & kHigh);
+    const uint64_t borrow = ((~a & b) | (~(a ^ b) & diff)) & kHigh;
+    return diff & ~((borrow >> 7) * 0xFF);
+}
+
+/**
+ * Call update(first_pixel, pos, neg) for every 2 bytes (8 pixels) of the
+ * non-empty words of a packed frame, pos/neg being the pixels' byte masks
+ *
+ * Reads the frame a 64-bit word (32 pixels) at a time and skips empty
+ * words, so a sparse frame costs little more than one pass over its bytes;
+ * update() is branch-free. The pixel arrays are padded to whole words, so
+ * the last (partial) word needs no bounds checks either.
+ */
+template <typename Update>
+inline void updateWord(const uint8_t* bytes, size_t first, const PackedTables& tables, Update& update)
+{
+    for (size_t b = 0; b < 8; b += 2) {
+        const uint64_t pos = tables.pos[bytes[b]] | (uint64_t{tables.pos[bytes[b + 1]]} << 32);
+        const uint64_t neg = tables.neg[bytes[b]] | (uint64_t{tables.neg[bytes[b + 1]]} << 32);
+        update(first + b * 4, pos, neg);
+    }
+}
+
+template <typename Update>
+void forEachPackedPair(const uint8_t* data, size_t size, Update update)
+{
+    const PackedTables& tables = packedTables();
+    size_t offset = 0;
+    for (; offset + 8 <= size; offset += 8) {
+        uint64_t word;
+        std::memcpy(&word, data + offset, sizeof(word));
+        if (word != 0) {
+            updateWord(data + offset, offset * 4, tables, update);
+        }
+    }
+    if (offset < size) {
+        uint8_t tail[8] = {};
+        std::memcpy(tail, data + offset, size - offset);
+        updateWord(tail, offset * 4, tables, update);
+    }
+}
+
+} // namespace
+
+FrameAccumulator::FrameAccumulator(const Config& cfg, OutputFn output)
+    : width_(cfg.output_width())
+    , height_(cfg.output_height())
+    , mode_(cfg.frame_output_mode)
+    , packed_input_(!cfg.roi_enabled() && !cfg.noise_filter_enabled())
+    , packed_min_events_(static_cast<size_t>(
+          (cfg.frame_output_mode == FrameOutputMode::Polarity ? kPolarityPackedDensity : kTimeSurfacePackedDensity) *
+          static_cast<double>(cfg.output_width()) * static_cast<double>(cfg.output_height())))
+    , output_(std::move(output))
+    , interval_us_(0)
+    , contrast_(0)
+    , decay_us_(0)
+    , step_(0)
+    , started_(false)
+    , window_start_(0)
+    , window_end_(0)
+    , queue_(kQueueFrames)
+    , stop_requested_(false)
+    , frames_written_(0)
+    , frames_dropped_(0)
+    , packed_frames_(0)
+    , input_frames_(0)
+{
+    const size_t pixels = static_cast<size_t>(width_) * static_cast<size_t>(height_);
+    const size_t padded = (pixels + kWordPixels - 1) / kWordPixels * kWordPixels;
+    if (mode_ == FrameOutputMode::Polarity) {
+        counts_.assign(padded, 128);
+    } else {
+        last_event_.assign(padded, kNever);
+    }
+    reload(cfg);
+}
+
+FrameAccumulator::~FrameAccumulator()
+{
+    stop();
+}
+
+void FrameAccumulator::start()
+{
+    stop_requested_ = false;
+    if (!thread_.joinable()) {
+        thread_ = std::thread(&FrameAccumulator::outputLoop, this);
+    }
+}
+
+void FrameAccumulator::stop()
+{
+    stop_requested_ = true;
+    if (thread_.joinable()) {
+        thread_.join();
+    }
+}
+
+void FrameAccumulator::reload(const Config& cfg)
+{
+    interval_us_.store(std::max<int64_t>(1, cfg.frame_output_interval_us), std::memory_order_relaxed);
+    contrast_.store(std::clamp(cfg.frame_output_contrast, 1, 128), std::memory_order_relaxed);
+    decay_us_.store(std::max<int64_t>(1, cfg.frame_output_decay_us), std::memory_order_relaxed);
+}
+
+void FrameAccumulator::accumulate(const PipelineFrame& frame)
+{
+    const int64_t interval = interval_us_.load(std::memory_order_relaxed);
+    if (!started_) {
+        started_ = true;
+        window_start_ = frame.timestamp;
+        window_end_ = frame.timestamp + interval;
+        step_ = contrast_.load(std::memory_order_relaxed);
+    } else if (frame.timestamp >= window_end_) {
+        emit(window_end_);
+        // After a pause, start at this frame instead of catching up with empty windows
+        window_start_ = frame.timestamp >= window_end_ + interval ? frame.timestamp : window_end_;
+        window_end_ = window_start_ + interval;
+        step_ = contrast_.load(std::memory_order_relaxed);
+    }
+
+    const FrameHandle& buffer = frame.buffer;
+    if (packed_input_ && buffer && buffer.encoding() == FrameEncoding::Dense &&
+        frame.num_events >= packed_min_events_) {
+        accumulatePacked(buffer.data(), buffer.size(), frame.timestamp);
+        packed_frames_.fetch_add(1, std::memory_order_relaxed);
+    } else {
+        accumulateEvents(frame.events);
+    }
+    input_frames_.fetch_add(1, std::memory_order_relaxed);
+}
+
+void FrameAccumulator::accumulatePacked(const uint8_t* data, size_t size, int64_t timestamp)
+{
+    const size_t pixels = static_cast<size_t>(width_) * static_cast<size_t>(height_);
+    size = std::min(size, (pixels + 3) / 4);
+
+    if (mode_ == FrameOutputMode::Polarity) {
+        uint8_t* counts = counts_.data();
+        const uint64_t step = static_cast<uint64_t>(step_) * 0x0101010101010101ULL;
+        forEachPackedPair(data, size, [counts, step](size_t first, uint64_t pos, uint64_t neg) {
+            uint64_t levels;
+            std::memcpy(&levels, counts + first, sizeof(levels));
+            levels = subSaturate(addSaturate(levels, step & pos), step & neg);
+            std::memcpy(counts + first, &levels, sizeof(levels));
+        });
+    } else {
+        int64_t* last = last_event_.data();
+        forEachPackedPair(data, size, [last, timestamp](size_t first, uint64_t pos, uint64_t neg) {
+            const uint64_t fired = pos | neg;
+            for (size_t k = 0; k < 8; k++) {
+                const int64_t mask = -static_cast<int64_t>((fired >> (8 * k)) & 1);
+                last[first + k] ^= (last[first + k] ^ timestamp) & mask;
+            }
+        });
+    }
+}
+
+void FrameAccumulator::accumulateEvents(const dv::EventStore& events)
+{
+    for (const dv::Event& event : events) {
+        if (event.x() < 0 || event.y() < 0 || event.x() >= width_ || event.y() >= height_) {
+            continue;
+        }
+        const size_t pixel = static_cast<size_t>(event.y()) * static_cast<size_t>(width_) +
+                             static_cast<size_t>(event.x());
+        if (mode_ == FrameOutputMode::Polarity) {
+            const int level = counts_[pixel] + (event.polarity() ? step_ : -step_);
+            counts_[pixel] = static_cast<uint8_t>(std::clamp(level, 0, 255));
+        } else {
+            last_event_[pixel] = event.timestamp();
+        }
+    }
+}
+
+void FrameAccumulator::emit(int64_t end)
+{
+    // A fresh image per frame: the output keeps a reference to it while
+    // queued and written (at frame_output_interval_us, not per input frame)
+    cv::Mat image(height_, width_, CV_8UC1);
+    uint8_t* pixels = image.ptr<uint8_t>(0);
+    const size_t count = static_cast<size_t>(width_) * static_cast<size_t>(height_);
+
+    if (mode_ == FrameOutputMode::Polarity) {
+        std::memcpy(pixels, counts_.data(), count);
+        std::fill(counts_.begin(), counts_.end(), uint8_t{128});
+    } else {
+        // Linear fade in 16.16 fixed point; branch-free so the loop vectorizes
+        const int64_t decay = decay_us_.load(std::memory_order_relaxed);
+        const int64_t scale = (int64_t{255} << 16) / decay;
+        const int64_t* last = last_event_.data();
+        for (size_t i = 0; i < count; i++) {
+            const int64_t age = std::clamp<int64_t>(end - last[i], 0, decay);
+            pixels[i] = static_cast<uint8_t>(255 - ((age * scale + 0x8000) >> 16));
+        }
+    }
+
+    dv::Frame frame(window_start_, image);
+    if (!queue_.tryPush(frame)) {
+        frames_dropped_.fetch_add(1, std::memory_order_relaxed);
+    }
+}
+
+void FrameAccumulator::outputLoop()
+{
+    QueueBackoff backoff;
+    dv::Frame frame;
+
+    for (;;) {
+        if (queue_.tryPop(frame)) {
+            backoff.reset();
+            output_(frame);
+            frames_written_.fetch_add(1, std::memory_order_relaxed);
+            frame = dv::Frame();    // Release the image now
+            continue;
+        }
+        // Deliver what was queued before stop()
+        if (stop_requested_) {
+            break;
+        }
+        backoff.wait();
+    }
+}
+
+} // namespace converter
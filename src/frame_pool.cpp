@@ -0,0 +1,250 @@
+#include "frame_pool.hpp"
+#include <iostream>
+#include <new>
+
+#ifdef _WIN32
+    #include <windows.h>
+#else
+    #include <sys/mman.h>
+    #include <unistd.h>
+#endif
+
+#ifdef __linux__
+    #include <cerrno>
+    #include <cstring>
+    #include <sys/syscall.h>
+#endif
+
+namespace converter {
+
+namespace {
+
+#ifdef MAP_HUGETLB
+constexpr size_t kHugePageSize = 2 * 1024 * 1024;
+#endif
+
+size_t pageSize()
+{
+#ifdef _WIN32
+    SYSTEM_INFO info;
+    GetSystemInfo(&info);
+    return static_cast<size_t>(info.dwPageSize);
+#else
+    return static_cast<size_t>(sysconf(_SC_PAGESIZE));
+#endif
+}
+
+size_t roundUp(size_t value, size_t alignment)
+{
+    return (value + alignment - 1) / alignment * alignment;
+}
+
+#if defined(__linux__) && defined(SYS_mbind)
+// From <linux/mempolicy.h>; called through syscall() to avoid a libnuma dependency
+constexpr int kMpolPreferred = 1;
+constexpr unsigned kMpolMfMove = 1u << 1;
+constexpr int kMaxNumaNodes = 1024;
+
+/**
+ * Prefer NUMA node `node` for a mapping, moving any pages already faulted in
+ * @return true if the policy was set
+ */
+bool bindToNode(void* memory, size_t bytes, int node)
+{
+    constexpr size_t kBitsPerWord = 8 * sizeof(unsigned long);
+    unsigned long mask[kMaxNumaNodes / kBitsPerWord] = {};
+    mask[static_cast<size_t>(node) / kBitsPerWord] = 1UL << (static_cast<size_t>(node) % kBitsPerWord);
+    return syscall(SYS_mbind, memory, bytes, kMpolPreferred, mask, kMaxNumaNodes + 1, kMpolMfMove) == 0;
+}
+#endif
+
+} // namespace
+
+// =============================================================================
+// FrameHandle
+// =============================================================================
+
+FrameHandle::FrameHandle(const FrameHandle& other) noexcept
+    : slot_(other.slot_)
+{
+    if (slot_ != nullptr) {
+        slot_->refs.fetch_add(1, std::memory_order_relaxed);
+    }
+}
+
+FrameHandle& FrameHandle::operator=(const FrameHandle& other) noexcept
+{
+    if (this != &other) {
+        reset();
+        slot_ = other.slot_;
+        if (slot_ != nullptr) {
+            slot_->refs.fetch_add(1, std::memory_order_relaxed);
+        }
+    }
+    return *this;
+}
+
+FrameHandle::FrameHandle(FrameHandle&& other) noexcept
+    : slot_(other.slot_)
+{
+    other.slot_ = nullptr;
+}
+
+FrameHandle& FrameHandle::operator=(FrameHandle&& other) noexcept
+{
+    if (this != &other) {
+        reset();
+        slot_ = other.slot_;
+        other.slot_ = nullptr;
+    }
+    return *this;
+}
+
+void FrameHandle::reset() noexcept
+{
+    if (slot_ != nullptr) {
+        if (slot_->refs.fetch_sub(1, std::memory_order_acq_rel) == 1) {
+            slot_->pool->release(slot_);
+        }
+        slot_ = nullptr;
+    }
+}
+
+// =============================================================================
+// FramePool
+// =============================================================================
+
+FramePool::FramePool(size_t num_slots, size_t slot_size, bool use_hugepages, int numa_node)
+    : base_(nullptr)
+    , mapped_bytes_(0)
+    , slot_stride_(roundUp(slot_size, pageSize()))
+    , hugepages_(false)
+    , numa_node_(-1)
+    , slots_(num_slots)
+    , free_slots_(std::make_unique<BoundedQueue<FrameSlot*>>(num_slots))
+{
+    mapped_bytes_ = slot_stride_ * num_slots;
+
+#ifdef _WIN32
+    (void)use_hugepages;
+    if (numa_node >= 0) {
+        base_ = static_cast<uint8_t*>(VirtualAllocExNuma(GetCurrentProcess(), nullptr, mapped_bytes_,
+                                                         MEM_RESERVE | MEM_COMMIT, PAGE_READWRITE,
+                                                         static_cast<DWORD>(numa_node)));
+        numa_node_ = base_ != nullptr ? numa_node : -1;
+    }
+    if (base_ == nullptr) {
+        base_ = static_cast<uint8_t*>(VirtualAlloc(nullptr, mapped_bytes_, MEM_RESERVE | MEM_COMMIT, PAGE_READWRITE));
+    }
+#else
+    void* memory = MAP_FAILED;
+
+#ifdef MAP_HUGETLB
+    // Explicit hugepages only work if the admin reserved some (vm.nr_hugepages)
+    if (use_hugepages) {
+        size_t huge_bytes = roundUp(mapped_bytes_, kHugePageSize);
+        memory = mmap(nullptr, huge_bytes, PROT_READ | PROT_WRITE,
+                      MAP_PRIVATE | MAP_ANONYMOUS | MAP_HUGETLB, -1, 0);
+        if (memory != MAP_FAILED) {
+            mapped_bytes_ = huge_bytes;
+            hugepages_ = true;
+        }
+    }
+#endif
+
+    if (memory == MAP_FAILED) {
+        memory = mmap(nullptr, mapped_bytes_, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+#ifdef MADV_HUGEPAGE
+        if (memory != MAP_FAILED && use_hugepages) {
+            hugepages_ = madvise(memory, mapped_bytes_, MADV_HUGEPAGE) == 0;
+        }
+#endif
+    }
+
+    base_ = (memory == MAP_FAILED) ? nullptr : static_cast<uint8_t*>(memory);
+
+#if defined(__linux__) && defined(SYS_mbind)
+    // Before the first touch, so pages are faulted in on the node (with
+    // mlockall(MCL_FUTURE) already active they exist and are moved instead)
+    if (base_ != nullptr && numa_node >= 0 && numa_node < kMaxNumaNodes) {
+        if (bindToNode(base_, mapped_bytes_, numa_node)) {
+            numa_node_ = numa_node;
+        } else {
+            std::cerr << "Warning: Could not bind frame pool to NUMA node " << numa_node << ": "
+                      << std::strerror(errno) << std::endl;
+        }
+    }
+#else
+    (void)numa_node;
+#endif
+#endif
+
+    if (base_ == nullptr) {
+        std::cerr << "Failed to allocate frame pool (" << mapped_bytes_ << " bytes)" << std::endl;
+        throw std::bad_alloc();
+    }
+
+    if (use_hugepages && !hugepages_) {
+        std::cerr << "Warning: Hugepages not available, frame pool uses normal pages" << std::endl;
+    }
+
+    for (size_t i = 0; i < num_slots; i++) {
+        FrameSlot& slot = slots_[i];
+        slot.data = base_ + i * slot_stride_;
+        slot.capacity = slot_stride_;
+        slot.index = static_cast<uint32_t>(i);
+        slot.pool = this;
+
+        FrameSlot* free_slot = &slot;
+        free_slots_->tryPush(free_slot);
+    }
+}
+
+FramePool::~FramePool()
+{
+    if (base_ != nullptr) {
+#ifdef _WIN32
+        VirtualFree(base_, 0, MEM_RELEASE);
+#else
+        munmap(base_, mapped_bytes_);
+#endif
+    }
+}
+
+size_t FramePool::prefault()
+{
+#if defined(__linux__) && defined(MADV_POPULATE_WRITE)
+    if (madvise(base_, mapped_bytes_, MADV_POPULATE_WRITE) == 0) {
+        return mapped_bytes_;
+    }
+#endif
+    volatile uint8_t* bytes = base_;
+    for (size_t offset = 0; offset < mapped_bytes_; offset += pageSize()) {
+        bytes[offset] = 0;
+    }
+    return mapped_bytes_;
+}
+
+FrameHandle FramePool::tryAcquire()
+{
+    FrameSlot* slot = nullptr;
+    if (!free_slots_->tryPop(slot)) {
+        return FrameHandle();
+    }
+
+    slot->size = 0;
+    slot->occupancy_bytes = 0;
+    slot->timestamp = 0;
+    slot->arrival_ns = 0;
+    slot->encoding = FrameEncoding::Dense;
+    slot->refs.store(1, std::memory_order_relaxed);
+    return FrameHandle(slot);
+}
+
+void FramePool::release(FrameSlot* slot)
+{
+    // Cannot fail: the free list has room for every slot
+    free_slots_->tryPush(slot);
+}
+
+} // namespace converter
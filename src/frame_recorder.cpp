@@ -0,0 +1,400 @@
+#include "frame_recorder.hpp"
+#include "pipeline.hpp"
+#include <algorithm>
+#include <cerrno>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <exception>
+#include <filesystem>
+#include <iostream>
+
+#ifdef _WIN32
+    #include <fcntl.h>
+    #include <io.h>
+#else
+    #include <fcntl.h>
+    #include <unistd.h>
+#endif
+
+namespace converter {
+
+namespace {
+
+// O_DIRECT wants buffer address, size and file offset aligned to the block size
+constexpr size_t kIoAlignment = 4096;
+constexpr size_t kMinBufferBytes = 64 * 1024;
+
+/**
+ * Create a file for writing, with O_DIRECT if asked for and possible
+ * @param direct In: try O_DIRECT; out: whether it is in effect
+ * @return File descriptor, or -1
+ */
+int createFile(const std::string& path, bool& direct)
+{
+#ifdef _WIN32
+    direct = false;
+    return _open(path.c_str(), _O_WRONLY | _O_CREAT | _O_TRUNC | _O_BINARY, 0644);
+#else
+    const int flags = O_WRONLY | O_CREAT | O_TRUNC;
+#ifdef O_DIRECT
+    if (direct) {
+        int fd = open(path.c_str(), flags | O_DIRECT, 0644);
+        if (fd >= 0) {
+            return fd;
+        }
+        // tmpfs and some network filesystems refuse O_DIRECT
+    }
+#endif
+    direct = false;
+    return open(path.c_str(), flags, 0644);
+#endif
+}
+
+/**
+ * Switch a file back to buffered writes (for an unaligned tail)
+ */
+void disableDirect(int fd)
+{
+#if !defined(_WIN32) && defined(O_DIRECT)
+    int flags = fcntl(fd, F_GETFL);
+    if (flags >= 0) {
+        fcntl(fd, F_SETFL, flags & ~O_DIRECT);
+    }
+#else
+    (void)fd;
+#endif
+}
+
+/**
+ * Write all bytes, retrying short writes
+ * @return true on success
+ */
+bool writeAll(int fd, const uint8_t* data, size_t size)
+{
+    while (size > 0) {
+#ifdef _WIN32
+        int written = _write(fd, data, static_cast<unsigned int>(std::min<size_t>(size, 1u << 30)));
+#else
+        ssize_t written = ::write(fd, data, size);
+#endif
+        if (written < 0) {
+            if (errno == EINTR) {
+                continue;
+            }
+            return false;
+        }
+        data += written;
+        size -= static_cast<size_t>(written);
+    }
+    return true;
+}
+
+void closeFd(int fd)
+{
+#ifdef _WIN32
+    _close(fd);
+#else
+    ::close(fd);
+#endif
+}
+
+int64_t wallClockUs()
+{
+    return std::chrono::duration_cast<std::chrono::microseconds>(
+        std::chrono::system_clock::now().time_since_epoch()).count();
+}
+
+} // namespace
+
+void FrameRecorder::BufferDeleter::operator()(uint8_t* buffer) const
+{
+#ifdef _WIN32
+    _aligned_free(buffer);
+#else
+    std::free(buffer);
+#endif
+}
+
+FrameRecorder::FrameRecorder(const Config& cfg, RecordFormat format, std::string prefix)
+    : config_(cfg)
+    , format_(format)
+    , prefix_(std::move(prefix))
+    , queue_(std::max<size_t>(1, cfg.record_queue_frames))
+    , stop_requested_(false)
+    , buffer_capacity_(0)
+    , buffer_used_(0)
+    , fd_(-1)
+    , file_bytes_(0)
+    , file_index_(0)
+    , failed_(false)
+    , frames_recorded_(0)
+    , frames_dropped_(0)
+    , bytes_written_(0)
+    , files_written_(0)
+    , direct_io_(false)
+{
+    if (format_ == RecordFormat::RawFrames) {
+        buffer_capacity_ = std::max(kMinBufferBytes, cfg.record_buffer_bytes);
+        buffer_capacity_ = (buffer_capacity_ + kIoAlignment - 1) / kIoAlignment * kIoAlignment;
+#ifdef _WIN32
+        buffer_.reset(static_cast<uint8_t*>(_aligned_malloc(buffer_capacity_, kIoAlignment)));
+#else
+        buffer_.reset(static_cast<uint8_t*>(std::aligned_alloc(kIoAlignment, buffer_capacity_)));
+#endif
+    }
+}
+
+FrameRecorder::~FrameRecorder()
+{
+    stop();
+}
+
+bool FrameRecorder::start()
+{
+    if (format_ == RecordFormat::RawFrames && !buffer_) {
+        std::cerr << "Warning: Failed to allocate the " << buffer_capacity_ << " byte recording buffer" << std::endl;
+        return false;
+    }
+    if (!openFile()) {
+        return false;
+    }
+    stop_requested_ = false;
+    thread_ = std::thread(&FrameRecorder::ioLoop, this);
+    return true;
+}
+
+void FrameRecorder::stop()
+{
+    if (!thread_.joinable()) {
+        return;
+    }
+    stop_requested_ = true;
+    thread_.join();
+    closeFile();
+}
+
+bool FrameRecorder::recordFrame(const PipelineFrame& frame)
+{
+    Item item;
+    item.buffer = frame.buffer;     // Shares the pool slot, no copy
+    item.sequence = frame.sequence;
+    item.timestamp = frame.timestamp;
+    if (!queue_.tryPush(item)) {
+        frames_dropped_.fetch_add(1, std::memory_order_relaxed);
+        return false;
+    }
+    return true;
+}
+
+bool FrameRecorder::recordEvents(const dv::EventStore& events)
+{
+    if (events.isEmpty()) {
+        return true;
+    }
+    Item item;
+    item.events = events;           // Shallow: shares the event packets
+    if (!queue_.tryPush(item)) {
+        frames_dropped_.fetch_add(1, std::memory_order_relaxed);
+        return false;
+    }
+    return true;
+}
+
+void FrameRecorder::ioLoop()
+{
+    QueueBackoff backoff;
+    Item item;
+
+    for (;;) {
+        if (queue_.tryPop(item)) {
+            backoff.reset();
+            writeItem(item);
+            item = Item();  // Release the pool slot / packets now
+            continue;
+        }
+        // Drain what was queued before stop()
+        if (stop_requested_) {
+            break;
+        }
+        backoff.wait();
+    }
+}
+
+void FrameRecorder::writeItem(Item& item)
+{
+    if (!failed_ && rotationDue()) {
+        closeFile();
+        failed_ = !openFile();
+    }
+    if (failed_) {
+        frames_dropped_.fetch_add(1, std::memory_order_relaxed);
+        return;
+    }
+
+    if (format_ == RecordFormat::Aedat4) {
+        try {
+            aedat_writer_->writeEvents(item.events);
+        } catch (const std::exception& e) {
+            std::cerr << "Warning: Recording to " << file_path_ << " failed: " << e.what() << std::endl;
+            failed_ = true;
+            frames_dropped_.fetch_add(1, std::memory_order_relaxed);
+            return;
+        }
+        frames_recorded_.fetch_add(1, std::memory_order_relaxed);
+        return;
+    }
+
+    const FrameHandle& buffer = item.buffer;
+    RawFrameHeader header{};
+    header.magic = RawFrameHeader::kMagic;
+    header.size_word = (static_cast<uint32_t>(buffer.encoding()) << kFrameEncodingShift) |
+                       static_cast<uint32_t>(buffer.size());
+    header.sequence = item.sequence;
+    header.timestamp = item.timestamp;
+    header.input_timestamp = buffer.timestamp();
+
+    static const uint8_t kPadding[8] = {};
+    const size_t padding = (8 - buffer.size() % 8) % 8;
+    if (!appendRaw(&header, sizeof(header)) || !appendRaw(buffer.data(), buffer.size()) ||
+        !appendRaw(kPadding, padding)) {
+        std::cerr << "Warning: Recording to " << file_path_ << " failed: " << std::strerror(errno) << std::endl;
+        failed_ = true;
+        frames_dropped_.fetch_add(1, std::memory_order_relaxed);
+        return;
+    }
+    frames_recorded_.fetch_add(1, std::memory_order_relaxed);
+}
+
+bool FrameRecorder::rotationDue() const
+{
+    if (config_.record_rotate_seconds > 0 &&
+        std::chrono::steady_clock::now() - file_opened_ >= std::chrono::seconds(config_.record_rotate_seconds)) {
+        return true;
+    }
+    if (config_.record_rotate_bytes == 0) {
+        return false;
+    }
+    if (format_ == RecordFormat::RawFrames) {
+        return file_bytes_ >= config_.record_rotate_bytes;
+    }
+    // The AEDAT4 writer compresses and buffers internally: go by the file size
+    std::error_code error;
+    const uintmax_t size = std::filesystem::file_size(file_path_, error);
+    return !error && size >= config_.record_rotate_bytes;
+}
+
+std::string FrameRecorder::nextPath() const
+{
+    char index[16];
+    std::snprintf(index, sizeof(index), "-%04u", file_index_);
+    return prefix_ + index + (format_ == RecordFormat::Aedat4 ? ".aedat4" : ".dvraw");
+}
+
+bool FrameRecorder::openFile()
+{
+    file_path_ = nextPath();
+    file_bytes_ = 0;
+    file_opened_ = std::chrono::steady_clock::now();
+
+    if (format_ == RecordFormat::Aedat4) {
+        try {
+            aedat_writer_ = std::make_unique<dv::io::MonoCameraWriter>(
+                file_path_,
+                dv::io::MonoCameraWriter::EventOnlyConfig(
+                    "DVBridge", cv::Size(config_.output_width(), config_.output_height())));
+        } catch (const std::exception& e) {
+            std::cerr << "Warning: Failed to create recording " << file_path_ << ": " << e.what() << std::endl;
+            return false;
+        }
+    } else {
+        bool direct = config_.record_direct_io;
+        fd_ = createFile(file_path_, direct);
+        if (fd_ < 0) {
+            std::cerr << "Warning: Failed to create recording " << file_path_ << ": "
+                      << std::strerror(errno) << std::endl;
+            return false;
+        }
+        direct_io_ = direct;
+
+        RawCaptureHeader header{};
+        std::memcpy(header.magic, RawCaptureHeader::kMagic, sizeof(header.magic));
+        header.version = RawCaptureHeader::kVersion;
+        header.header_bytes = sizeof(RawCaptureHeader);
+        header.width = static_cast<uint32_t>(config_.width);
+        header.height = static_cast<uint32_t>(config_.height);
+        header.frame_bytes = static_cast<uint32_t>(config_.frame_size());
+        header.file_index = file_index_;
+        header.start_time_us = wallClockUs();
+        buffer_used_ = 0;
+        appendRaw(&header, sizeof(header));
+    }
+
+    file_index_++;
+    files_written_.fetch_add(1, std::memory_order_relaxed);
+    return true;
+}
+
+void FrameRecorder::closeFile()
+{
+    if (aedat_writer_) {
+        aedat_writer_.reset();  // Writes the file trailer
+        std::error_code error;
+        const uintmax_t size = std::filesystem::file_size(file_path_, error);
+        if (!error) {
+            bytes_written_.fetch_add(size, std::memory_order_relaxed);
+        }
+    }
+    if (fd_ >= 0) {
+        if (!writeTail()) {
+            std::cerr << "Warning: Recording to " << file_path_ << " failed: " << std::strerror(errno) << std::endl;
+        }
+        closeFd(fd_);
+        fd_ = -1;
+    }
+}
+
+bool FrameRecorder::appendRaw(const void* data, size_t size)
+{
+    const uint8_t* bytes = static_cast<const uint8_t*>(data);
+    while (size > 0) {
+        const size_t chunk = std::min(size, buffer_capacity_ - buffer_used_);
+        std::memcpy(buffer_.get() + buffer_used_, bytes, chunk);
+        buffer_used_ += chunk;
+        file_bytes_ += chunk;
+        bytes += chunk;
+        size -= chunk;
+        if (buffer_used_ == buffer_capacity_ && !writeBuffer()) {
+            return false;
+        }
+    }
+    return true;
+}
+
+bool FrameRecorder::writeBuffer()
+{
+    if (!writeAll(fd_, buffer_.get(), buffer_capacity_)) {
+        return false;
+    }
+    bytes_written_.fetch_add(buffer_capacity_, std::memory_order_relaxed);
+    buffer_used_ = 0;
+    return true;
+}
+
+bool FrameRecorder::writeTail()
+{
+    if (buffer_used_ == 0) {
+        return true;
+    }
+    if (direct_io_) {
+        disableDirect(fd_);
+    }
+    if (!writeAll(fd_, buffer_.get(), buffer_used_)) {
+        return false;
+    }
+    bytes_written_.fetch_add(buffer_used_, std::memory_order_relaxed);
+    buffer_used_ = 0;
+    return true;
+}
+
+} // namespace converter
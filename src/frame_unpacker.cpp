@@ -1,18 +1,104 @@
 #include "frame_unpacker.hpp"
 #include <iostream>
 #include <stdexcept>
+#include <memory>
+#include <algorithm>
 
 namespace converter {
 
 FrameUnpacker::FrameUnpacker(const Config& cfg)
     : config_(cfg)
+    , active_kernel_(resolveUnpackKernel(cfg.unpack_kernel))
+    , kernel_(getUnpackKernel(active_kernel_, cfg.width, cfg.height))
+    , density_estimate_(0.0)
+    , density_threshold_(cfg.parallel_density_threshold)
+    , last_frame_parallel_(false)
+    , row_step_q16_(cfg.frame_readout_us > 0 ? (cfg.frame_readout_us << 16) / std::max(1, cfg.height) : 0)
+    , occupancy_first_unit_(0)
+    , occupancy_end_unit_(0)
+    , region_(cfg.roi_enabled())
+    , roi_x_(cfg.roi_left())
+    , roi_y_(cfg.roi_top())
+    , roi_columns_(cfg.roi_columns())
+    , roi_rows_(cfg.roi_rows())
+    , bin_shift_(cfg.binning_factor() == 4 ? 2 : (cfg.binning_factor() == 2 ? 1 : 0))
+    , output_width_(cfg.output_width())
+    , bin_generation_(0)
+    , arena_limit_(kArenaPacketsPerBand)
+    , arena_next_(0)
+    , arena_allocations_(0)
+    , arena_reuses_(0)
 {
-    // Pre-compute base pixel index for each byte
-    int frame_size = config_.frame_size();
-    byte_to_base_pixel_.resize(frame_size);
-    
-    for (int byte_idx = 0; byte_idx < frame_size; byte_idx++) {
-        byte_to_base_pixel_[byte_idx] = byte_idx * 4;  // 4 pixels per byte
+    if (cfg.unpack_kernel != UnpackKernel::Auto && active_kernel_ != cfg.unpack_kernel) {
+        std::cerr << "Warning: Unpack kernel " << unpackKernelToString(cfg.unpack_kernel)
+                  << " not supported on this CPU, using " << unpackKernelToString(active_kernel_)
+                  << std::endl;
+    }
+
+    if (region_ && bin_shift_ > 0) {
+        bin_stamps_.assign(static_cast<size_t>(cfg.output_width()) * cfg.output_height(), 0);
+    }
+
+    // Split rows into bands, a few per thread so uneven rows balance out.
+    // With a ROI only its rows are split, in whole bin rows.
+    const int bin_rows = roi_rows_ >> bin_shift_;
+    if (cfg.unpack_band_threads > 1 && bin_rows > 0) {
+        const int num_threads = cfg.unpack_band_threads;
+        const int num_bands = std::min(bin_rows, num_threads * kBandsPerThread);
+
+        band_pool_ = std::make_unique<WorkerPool>(static_cast<size_t>(num_threads - 1));
+        bands_.resize(static_cast<size_t>(num_bands));
+        arena_limit_ = kArenaPacketsPerBand * bands_.size();
+
+        for (int b = 0; b < num_bands; b++) {
+            Band& band = bands_[b];
+            band.first_row = roi_y_ + ((bin_rows * b / num_bands) << bin_shift_);
+            band.end_row = roi_y_ + ((bin_rows * (b + 1) / num_bands) << bin_shift_);
+            // begin rounds down, so a byte that straddles two bands goes to the
+            // later one, the band holding its last pixels
+            band.begin = static_cast<size_t>(band.first_row) * config_.width / 4;
+            band.end = (band.end_row == config_.height)
+                ? static_cast<size_t>(config_.frame_size())
+                : static_cast<size_t>(band.end_row) * config_.width / 4;
+        }
+    }
+
+    // Kernels may store up to 4 events per byte, including the padded last
+    // one, plus one straddling byte per band
+    scratch_.resize((static_cast<size_t>(config_.frame_size()) + bands_.size()) * 4);
+
+    const int frame_size = config_.frame_size();
+
+    // Byte range of every occupancy unit
+    const int units = config_.occupancy_units();
+    if (config_.has_header && units > 0) {
+        occupancy_begin_.resize(static_cast<size_t>(units));
+        occupancy_end_.resize(static_cast<size_t>(units));
+
+        for (int unit = 0; unit < units; unit++) {
+            size_t begin;
+            size_t end;
+            if (config_.occupancy_map == OccupancyMap::Rows) {
+                begin = static_cast<size_t>(unit) * config_.width / 4;
+                end = (static_cast<size_t>(unit + 1) * config_.width + 3) / 4;
+            } else {
+                begin = static_cast<size_t>(unit) * config_.occupancy_block_bytes;
+                end = begin + static_cast<size_t>(config_.occupancy_block_bytes);
+            }
+            occupancy_begin_[unit] = begin;
+            occupancy_end_[unit] = std::min(end, static_cast<size_t>(frame_size));
+        }
+
+        // Only units overlapping the ROI rows are decoded
+        const size_t roi_begin = static_cast<size_t>(roi_y_) * config_.width / 4;
+        const size_t roi_end = (static_cast<size_t>(roi_y_ + roi_rows_) * config_.width + 3) / 4;
+        occupancy_first_unit_ = static_cast<size_t>(units);
+        for (size_t unit = 0; unit < static_cast<size_t>(units); unit++) {
+            if (occupancy_end_[unit] > roi_begin && occupancy_begin_[unit] < roi_end) {
+                occupancy_first_unit_ = std::min(occupancy_first_unit_, unit);
+                occupancy_end_unit_ = unit + 1;
+            }
+        }
     }
 }
 
@@ -23,7 +109,7 @@ int FrameUnpacker::getExpectedFrameSize() const
 
 cv::Size FrameUnpacker::getResolution() const
 {
-    return cv::Size(config_.width, config_.height);
+    return cv::Size(config_.output_width(), config_.output_height());
 }
 
 size_t FrameUnpacker::unpack(
@@ -38,7 +124,19 @@ size_t FrameUnpacker::unpack(
     const uint8_t* frame_data,
     size_t data_size,
     uint64_t frame_number,
-    dv::EventStore& events)
+    dv::EventStore& events,
+    const uint8_t* occupancy)
+{
+    int64_t timestamp = static_cast<int64_t>(frame_number) * config_.frame_interval_us;
+    return unpackWithTimestamp(frame_data, data_size, timestamp, events, occupancy);
+}
+
+size_t FrameUnpacker::unpackWithTimestamp(
+    const uint8_t* frame_data,
+    size_t data_size,
+    int64_t timestamp,
+    dv::EventStore& events,
+    const uint8_t* occupancy)
 {
     // Validate frame size
     int expected_size = getExpectedFrameSize();
@@ -48,68 +146,329 @@ size_t FrameUnpacker::unpack(
         return 0;
     }
 
-    // Clear output
+    UnpackParams params(config_.width, config_.total_pixels(), timestamp);
+
+    // A bitmap already confines the work to occupied rows; no band split
+    const bool use_occupancy = occupancy != nullptr && !occupancy_begin_.empty();
+    last_frame_parallel_ = band_pool_ && !use_occupancy
+                           && density_estimate_ >= density_threshold_.load(std::memory_order_relaxed);
+
+    size_t num_events = 0;
+
+    // Let go of the previous frame's packets first, so they can be reused below
     events = dv::EventStore();
+    const size_t expected_events = static_cast<size_t>(density_estimate_ * params.total_pixels * 1.5)
+                                   + kMinArenaEvents;
 
-    // Calculate timestamp for this frame
-    int64_t timestamp = static_cast<int64_t>(frame_number) * config_.frame_interval_us;
+    if (last_frame_parallel_) {
+        // Packets are taken from the arena here; the workers only fill them
+        for (Band& band : bands_) {
+            band.packet = acquirePacket(expected_events * (band.end - band.begin)
+                                        / static_cast<size_t>(expected_size));
+        }
+
+        // Each band decodes into its own scratch slice and copies it into its
+        // own packet, so both the decode and the copy run in parallel
+        if (region_) {
+            nextBinGeneration();
+        }
+        band_pool_->run(bands_.size(), [&](size_t b) {
+            Band& band = bands_[b];
+            dv::Event* slice = scratch_.data() + (band.begin + b) * 4;
+            size_t count = region_
+                ? decodeRows(frame_data, band.first_row, band.end_row, params, slice)
+                : kernel_(frame_data, band.begin, band.end, params, slice);
+            if (row_step_q16_ != 0) {
+                spreadRows(slice, count);
+            }
+            if (region_) {
+                count = applyRegion(slice, count, band.first_row, band.end_row);
+            }
+            fillPacket(*band.packet, slice, count);
+        });
+
+        // Concatenate in row order; EventStore::add() shares packets, no copy
+        for (Band& band : bands_) {
+            if (!band.packet->elements.empty()) {
+                num_events += band.packet->elements.size();
+                events.add(dv::EventStore(std::move(band.packet)));
+            }
+            band.packet.reset();
+        }
+    } else {
+        if (use_occupancy) {
+            num_events = unpackOccupied(frame_data, occupancy, params);
+        } else if (region_) {
+            num_events = decodeRows(frame_data, roi_y_, roi_y_ + roi_rows_, params, scratch_.data());
+        } else {
+            num_events = kernel_(frame_data, 0, static_cast<size_t>(expected_size), params, scratch_.data());
+        }
+        num_events = storeScratch(num_events, expected_events, events);
+    }
+
+    finishFrame(num_events, timestamp, last_frame_parallel_ ? " (parallel)" : "");
+    return num_events;
+}
+
+size_t FrameUnpacker::unpackEncoded(
+    const uint8_t* payload,
+    size_t payload_size,
+    FrameEncoding encoding,
+    int64_t timestamp,
+    dv::EventStore& events)
+{
+    if (encoding == FrameEncoding::Dense) {
+        return unpackWithTimestamp(payload, payload_size, timestamp, events);
+    }
+
+    UnpackParams params(config_.width, config_.total_pixels(), timestamp);
+    last_frame_parallel_ = false;
+    events = dv::EventStore();
+
+    // Decoding stays on this thread: the payload is already small
+    size_t num_events = 0;
+    if (!decodeCompressedFrame(encoding, payload, payload_size, static_cast<size_t>(config_.frame_size()),
+                               params, scratch_.data(), num_events)) {
+        std::cerr << "Warning: Malformed " << frameEncodingToString(encoding) << " frame ("
+                  << payload_size << " bytes), dropping it" << std::endl;
+        return 0;
+    }
+
+    const size_t expected_events = static_cast<size_t>(density_estimate_ * params.total_pixels * 1.5)
+                                   + kMinArenaEvents;
+    num_events = storeScratch(num_events, expected_events, events);
+
+    finishFrame(num_events, timestamp, encoding == FrameEncoding::ZeroRuns ? " (zero runs)" : " (byte list)");
+    return num_events;
+}
+
+size_t FrameUnpacker::storeScratch(size_t num_events, size_t expected_events, dv::EventStore& events)
+{
+    if (row_step_q16_ != 0) {
+        spreadRows(scratch_.data(), num_events);
+    }
+    if (region_) {
+        nextBinGeneration();
+        num_events = applyRegion(scratch_.data(), num_events, roi_y_, roi_y_ + roi_rows_);
+    }
+
+    // Hand the events over as one recycled packet (a single bulk copy
+    // into storage that is already there)
+    if (num_events > 0) {
+        std::shared_ptr<dv::EventPacket> packet = acquirePacket(std::max(expected_events, num_events));
+        fillPacket(*packet, scratch_.data(), num_events);
+        events = dv::EventStore(std::move(packet));
+    }
+    return num_events;
+}
 
-    const int width = config_.width;
-    const int height = config_.height;
-    const int total_pixels = config_.total_pixels();
-
-    // Process each byte (4 pixels per byte)
-    // FPGA format: bits 7-6 = pixel 0, bits 5-4 = pixel 1, bits 3-2 = pixel 2, bits 1-0 = pixel 3
-    // Values: 00 = no event, 01 = positive (p=1), 10 = negative (p=0), 11 = unused
-    
-    for (int byte_idx = 0; byte_idx < expected_size; byte_idx++) {
-        uint8_t byte_val = frame_data[byte_idx];
-        
-        // Skip zero bytes entirely - no events in this byte
-        // This is a key optimization for sparse event data
-        if (byte_val == 0) {
+size_t FrameUnpacker::decodeRows(const uint8_t* frame_data, int first_row, int end_row, const UnpackParams& params,
+                                 dv::Event* out) const
+{
+    const size_t width = static_cast<size_t>(config_.width);
+    const size_t frame_size = static_cast<size_t>(config_.frame_size());
+    if (roi_columns_ == config_.width) {
+        // Full rows are one contiguous byte range
+        const size_t begin = static_cast<size_t>(first_row) * width / 4;
+        const size_t end = std::min(frame_size, (static_cast<size_t>(end_row) * width + 3) / 4);
+        return kernel_(frame_data, begin, end, params, out);
+    }
+
+    // One kernel call per row, over the bytes holding the ROI's columns
+    size_t count = 0;
+    size_t decoded_end = 0;
+    for (size_t row = static_cast<size_t>(first_row); row < static_cast<size_t>(end_row); row++) {
+        const size_t first_pixel = row * width + static_cast<size_t>(roi_x_);
+        const size_t begin = std::max(first_pixel / 4, decoded_end);
+        const size_t end = std::min(frame_size, (first_pixel + static_cast<size_t>(roi_columns_) + 3) / 4);
+        if (begin < end) {
+            count += kernel_(frame_data, begin, end, params, out + count);
+            decoded_end = end;
+        }
+    }
+    return count;
+}
+
+void FrameUnpacker::nextBinGeneration()
+{
+    // Stamps hold the generation in 30 bits; start over before it wraps
+    bin_generation_ = (bin_generation_ + 1) & 0x3FFFFFFF;
+    if (bin_generation_ == 0) {
+        std::fill(bin_stamps_.begin(), bin_stamps_.end(), 0);
+        bin_generation_ = 1;
+    }
+}
+
+size_t FrameUnpacker::applyRegion(dv::Event* events, size_t count, int first_row, int end_row)
+{
+    const int x_end = roi_x_ + roi_columns_;
+    const uint32_t generation = bin_generation_ << 2;
+    size_t kept = 0;
+
+    for (size_t i = 0; i < count; i++) {
+        const dv::Event& event = events[i];
+        const int x = event.x();
+        const int y = event.y();
+        // Bytes at the ROI edges also decode a few pixels outside it
+        if (y < first_row || y >= end_row || x < roi_x_ || x >= x_end) {
             continue;
         }
-        
-        // Base pixel index for this byte
-        int base_pixel = byte_to_base_pixel_[byte_idx];
-        
-        // Extract 4 pixels from this byte (MSB first, as per FPGA format)
-        // shift = 6, 4, 2, 0 for pixels 0, 1, 2, 3
-        for (int px_in_byte = 0; px_in_byte < 4; px_in_byte++) {
-            int shift = 6 - (px_in_byte * 2);
-            uint8_t pixel_val = (byte_val >> shift) & 0x03;
-            
-            // Skip if no event (00) or unused (11)
-            if (pixel_val == 0 || pixel_val == 3) {
+        const int out_x = (x - roi_x_) >> bin_shift_;
+        const int out_y = (y - roi_y_) >> bin_shift_;
+
+        if (bin_shift_ > 0) {
+            uint32_t& stamp = bin_stamps_[static_cast<size_t>(out_y) * output_width_ + out_x];
+            const uint32_t seen = event.polarity() ? 2u : 1u;
+            if ((stamp & ~3u) != generation) {
+                stamp = generation;
+            } else if (stamp & seen) {
+                continue;   // This bin already fired with this polarity in this frame
+            }
+            stamp |= seen;
+        }
+
+        events[kept++] = dv::Event(event.timestamp(), static_cast<int16_t>(out_x), static_cast<int16_t>(out_y),
+                                   event.polarity());
+    }
+    return kept;
+}
+
+void FrameUnpacker::finishFrame(size_t num_events, int64_t timestamp, const char* note)
+{
+    // Weight recent frames heavily so bursts switch to bands within a frame or two
+    double density = static_cast<double>(num_events) / static_cast<double>(config_.total_pixels());
+    density_estimate_ = 0.5 * density_estimate_ + 0.5 * density;
+
+    if (config_.verbose) {
+        std::cout << "Frame at " << timestamp << " us: unpacked " << num_events << " events"
+                  << note << std::endl;
+    }
+}
+
+void FrameUnpacker::spreadRows(dv::Event* events, size_t count) const
+{
+    // Events come out in row order, so timestamps stay non-decreasing
+    for (size_t i = 0; i < count; i++) {
+        const dv::Event& event = events[i];
+        int64_t offset = (static_cast<int64_t>(event.y()) * row_step_q16_) >> 16;
+        events[i] = dv::Event(event.timestamp() + offset, event.x(), event.y(), event.polarity());
+    }
+}
+
+std::shared_ptr<dv::EventPacket> FrameUnpacker::acquirePacket(size_t expected_events)
+{
+    expected_events = std::min(expected_events, scratch_.size());
+
+    // A packet is free once no EventStore downstream shares it any more.
+    // Frames come back in order, so the search starts after the last hit.
+    std::shared_ptr<dv::EventPacket>* packet = nullptr;
+    for (size_t i = 0; i < arena_.size(); i++) {
+        size_t index = (arena_next_ + i) % arena_.size();
+        if (arena_[index].use_count() == 1) {
+            packet = &arena_[index];
+            arena_next_ = index + 1;
+            break;
+        }
+    }
+
+    if (packet != nullptr) {
+        // Pairs with the release in the last owner's reference drop
+        std::atomic_thread_fence(std::memory_order_acquire);
+        arena_reuses_.fetch_add(1, std::memory_order_relaxed);
+    } else {
+        arena_allocations_.fetch_add(1, std::memory_order_relaxed);
+        auto fresh = std::make_shared<dv::EventPacket>();
+        if (arena_.size() >= arena_limit_) {
+            // Everything is in flight; hand out an unpooled packet
+            fresh->elements.reserve(expected_events);
+            return fresh;
+        }
+        arena_.push_back(std::move(fresh));
+        packet = &arena_.back();
+    }
+
+    dv::EventPacket& target = **packet;
+    target.elements.clear();
+    if (target.elements.capacity() < expected_events) {
+        arena_allocations_.fetch_add(1, std::memory_order_relaxed);
+        target.elements.reserve(expected_events);
+    }
+    return *packet;
+}
+
+size_t FrameUnpacker::warmUp(size_t packets)
+{
+    // Start from the configured density, so the first frames already reserve
+    // what the warm packets hold (and pick bands when they will be dense)
+    density_estimate_ = std::max(0.0, config_.warm_start_density);
+    const size_t expected_events = std::min(
+        static_cast<size_t>(density_estimate_ * config_.total_pixels() * 1.5) + kMinArenaEvents, scratch_.size());
+
+    size_t bytes = 0;
+    while (arena_.size() < std::min(packets, arena_limit_)) {
+        auto packet = std::make_shared<dv::EventPacket>();
+        // Writing the events (not just reserving) faults the storage in
+        packet->elements.resize(expected_events);
+        packet->elements.clear();
+        bytes += expected_events * sizeof(dv::Event);
+        arena_.push_back(std::move(packet));
+    }
+    return bytes + scratch_.size() * sizeof(dv::Event);
+}
+
+void FrameUnpacker::fillPacket(dv::EventPacket& packet, const dv::Event* events, size_t count)
+{
+    if (packet.elements.capacity() < count) {
+        arena_allocations_.fetch_add(1, std::memory_order_relaxed);
+    }
+    packet.elements.assign(events, events + count);
+}
+
+size_t FrameUnpacker::unpackOccupied(const uint8_t* frame_data, const uint8_t* occupancy, const UnpackParams& params)
+{
+    const size_t units = occupancy_begin_.size();
+    const size_t map_bytes = (units + 7) / 8;
+    size_t count = 0;
+    size_t run_begin = 0;
+    size_t run_end = 0;
+
+    // Walk the set bits 64 at a time; empty words skip 64 rows or blocks at once
+    for (size_t base = 0; base < map_bytes; base += 8) {
+        uint64_t bits = 0;
+        const size_t n = std::min<size_t>(8, map_bytes - base);
+        for (size_t k = 0; k < n; k++) {
+            bits |= static_cast<uint64_t>(occupancy[base + k]) << (8 * k);
+        }
+
+        while (bits != 0) {
+            size_t unit = base * 8 + countTrailingZeros(bits);
+            bits &= bits - 1;
+            if (unit >= occupancy_end_unit_) {
+                break;  // Past the ROI, or padding bits of the last bitmap byte
+            }
+            if (unit < occupancy_first_unit_) {
                 continue;
             }
-            
-            // Calculate pixel index
-            int pixel_idx = base_pixel + px_in_byte;
-            
-            // Bounds check (handle last byte which may have padding)
-            if (pixel_idx >= total_pixels) {
+
+            // Extend the current run over adjacent (or byte-sharing) units
+            if (run_end > run_begin && occupancy_begin_[unit] <= run_end) {
+                run_end = std::max(run_end, occupancy_end_[unit]);
                 continue;
             }
-            
-            // Calculate x, y coordinates (row-major order)
-            int16_t x = static_cast<int16_t>(pixel_idx % width);
-            int16_t y = static_cast<int16_t>(pixel_idx / width);
-            
-            // Determine polarity: 01 = positive (true), 10 = negative (false)
-            bool polarity = (pixel_val == 1);
-            
-            // Add event
-            events.emplace_back(timestamp, x, y, polarity);
+
+            if (run_end > run_begin) {
+                count += kernel_(frame_data, run_begin, run_end, params, scratch_.data() + count);
+            }
+            run_begin = occupancy_begin_[unit];
+            run_end = occupancy_end_[unit];
         }
     }
 
-    if (config_.verbose) {
-        std::cout << "Frame " << frame_number << ": unpacked " << events.size() << " events" << std::endl;
+    if (run_end > run_begin) {
+        count += kernel_(frame_data, run_begin, run_end, params, scratch_.data() + count);
     }
 
-    return events.size();
+    return count;
 }
 
 } // namespace converter
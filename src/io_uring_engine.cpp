@@ -0,0 +1,336 @@
+#include "io_uring_engine.hpp"
+#include <iostream>
+#include <algorithm>
+#include <cerrno>
+#include <cstring>
+
+#if defined(__linux__) && __has_include(<linux/io_uring.h>)
+    #define CONVERTER_HAVE_IO_URING 1
+    #include <linux/io_uring.h>
+    #include <sys/mman.h>
+    #include <sys/socket.h>
+    #include <sys/syscall.h>
+    #include <sys/uio.h>
+    #include <unistd.h>
+#endif
+
+namespace converter {
+
+#ifdef CONVERTER_HAVE_IO_URING
+
+namespace {
+
+// One receive is in flight at a time; a few spare entries cost nothing
+constexpr unsigned kRingEntries = 8;
+
+int ioUringSetup(unsigned entries, struct io_uring_params* params)
+{
+    return static_cast<int>(syscall(__NR_io_uring_setup, entries, params));
+}
+
+int ioUringEnter(int ring_fd, unsigned to_submit, unsigned min_complete, unsigned flags)
+{
+    return static_cast<int>(syscall(__NR_io_uring_enter, ring_fd, to_submit, min_complete, flags, nullptr, 0));
+}
+
+int ioUringRegister(int ring_fd, unsigned opcode, const void* arg, unsigned nr_args)
+{
+    return static_cast<int>(syscall(__NR_io_uring_register, ring_fd, opcode, arg, nr_args));
+}
+
+uint32_t loadAcquire(const uint32_t* p)
+{
+    return __atomic_load_n(p, __ATOMIC_ACQUIRE);
+}
+
+void storeRelease(uint32_t* p, uint32_t value)
+{
+    __atomic_store_n(p, value, __ATOMIC_RELEASE);
+}
+
+template <typename T>
+T* ringPointer(void* ring, uint32_t offset)
+{
+    return reinterpret_cast<T*>(static_cast<uint8_t*>(ring) + offset);
+}
+
+} // namespace
+
+#endif
+
+IoUringEngine::IoUringEngine()
+    : ring_fd_(-1)
+    , socket_fd_(-1)
+    , sq_ring_(nullptr)
+    , cq_ring_(nullptr)
+    , sqes_(nullptr)
+    , sq_ring_size_(0)
+    , cq_ring_size_(0)
+    , sqes_size_(0)
+    , sq_head_(nullptr)
+    , sq_tail_(nullptr)
+    , sq_mask_(nullptr)
+    , sq_array_(nullptr)
+    , cq_head_(nullptr)
+    , cq_tail_(nullptr)
+    , cq_mask_(nullptr)
+    , cqes_(nullptr)
+    , registered_base_(nullptr)
+    , registered_size_(0)
+    , submit_calls_(0)
+{
+}
+
+IoUringEngine::~IoUringEngine()
+{
+    teardown();
+}
+
+bool IoUringEngine::isSupported()
+{
+#ifdef CONVERTER_HAVE_IO_URING
+    struct io_uring_params params;
+    std::memset(&params, 0, sizeof(params));
+    int fd = ioUringSetup(1, &params);
+    if (fd < 0) {
+        return false;
+    }
+    close(fd);
+    return true;
+#else
+    return false;
+#endif
+}
+
+bool IoUringEngine::init(int socket_fd)
+{
+    teardown();
+
+#ifdef CONVERTER_HAVE_IO_URING
+    struct io_uring_params params;
+    std::memset(&params, 0, sizeof(params));
+
+    // Completions are only reaped by the submitting thread, so the kernel
+    // need not interrupt it to run task work (Linux 5.19+, retried without)
+    params.flags = IORING_SETUP_COOP_TASKRUN;
+    ring_fd_ = ioUringSetup(kRingEntries, &params);
+    if (ring_fd_ < 0 && errno == EINVAL) {
+        std::memset(&params, 0, sizeof(params));
+        ring_fd_ = ioUringSetup(kRingEntries, &params);
+    }
+    if (ring_fd_ < 0) {
+        std::cerr << "io_uring_setup failed: " << std::strerror(errno) << std::endl;
+        return false;
+    }
+
+    sq_ring_size_ = params.sq_off.array + params.sq_entries * sizeof(uint32_t);
+    cq_ring_size_ = params.cq_off.cqes + params.cq_entries * sizeof(struct io_uring_cqe);
+    if (params.features & IORING_FEAT_SINGLE_MMAP) {
+        sq_ring_size_ = std::max(sq_ring_size_, cq_ring_size_);
+        cq_ring_size_ = 0;
+    }
+
+    sq_ring_ = mmap(nullptr, sq_ring_size_, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE,
+                    ring_fd_, IORING_OFF_SQ_RING);
+    if (sq_ring_ == MAP_FAILED) {
+        sq_ring_ = nullptr;
+        std::cerr << "Failed to map io_uring SQ ring: " << std::strerror(errno) << std::endl;
+        teardown();
+        return false;
+    }
+
+    if (cq_ring_size_ == 0) {
+        cq_ring_ = sq_ring_;
+    } else {
+        cq_ring_ = mmap(nullptr, cq_ring_size_, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE,
+                        ring_fd_, IORING_OFF_CQ_RING);
+        if (cq_ring_ == MAP_FAILED) {
+            cq_ring_ = nullptr;
+            std::cerr << "Failed to map io_uring CQ ring: " << std::strerror(errno) << std::endl;
+            teardown();
+            return false;
+        }
+    }
+
+    sqes_size_ = params.sq_entries * sizeof(struct io_uring_sqe);
+    sqes_ = mmap(nullptr, sqes_size_, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE,
+                 ring_fd_, IORING_OFF_SQES);
+    if (sqes_ == MAP_FAILED) {
+        sqes_ = nullptr;
+        std::cerr << "Failed to map io_uring SQEs: " << std::strerror(errno) << std::endl;
+        teardown();
+        return false;
+    }
+
+    sq_head_ = ringPointer<uint32_t>(sq_ring_, params.sq_off.head);
+    sq_tail_ = ringPointer<uint32_t>(sq_ring_, params.sq_off.tail);
+    sq_mask_ = ringPointer<uint32_t>(sq_ring_, params.sq_off.ring_mask);
+    sq_array_ = ringPointer<uint32_t>(sq_ring_, params.sq_off.array);
+    cq_head_ = ringPointer<uint32_t>(cq_ring_, params.cq_off.head);
+    cq_tail_ = ringPointer<uint32_t>(cq_ring_, params.cq_off.tail);
+    cq_mask_ = ringPointer<uint32_t>(cq_ring_, params.cq_off.ring_mask);
+    cqes_ = ringPointer<void>(cq_ring_, params.cq_off.cqes);
+
+    socket_fd_ = socket_fd;
+    submit_calls_ = 0;
+    return true;
+#else
+    (void)socket_fd;
+    std::cerr << "io_uring is not available on this platform" << std::endl;
+    return false;
+#endif
+}
+
+bool IoUringEngine::registerRegion(uint8_t* base, size_t size)
+{
+#ifdef CONVERTER_HAVE_IO_URING
+    if (ring_fd_ < 0) {
+        return false;
+    }
+
+    if (registered_base_ != nullptr) {
+        ioUringRegister(ring_fd_, IORING_UNREGISTER_BUFFERS, nullptr, 0);
+        registered_base_ = nullptr;
+        registered_size_ = 0;
+    }
+
+    struct iovec region;
+    region.iov_base = base;
+    region.iov_len = size;
+    if (ioUringRegister(ring_fd_, IORING_REGISTER_BUFFERS, &region, 1) < 0) {
+        std::cerr << "Warning: Failed to register frame pool with io_uring ("
+                  << std::strerror(errno) << "), using unregistered receives" << std::endl;
+        return false;
+    }
+
+    registered_base_ = base;
+    registered_size_ = size;
+    return true;
+#else
+    (void)base;
+    (void)size;
+    return false;
+#endif
+}
+
+int64_t IoUringEngine::receiveExact(uint8_t* buffer, size_t size)
+{
+#ifdef CONVERTER_HAVE_IO_URING
+    size_t total = 0;
+
+    while (total < size) {
+        uint8_t* dst = buffer + total;
+        size_t remaining = size - total;
+        bool fixed = registered_base_ != nullptr && dst >= registered_base_
+                     && dst + remaining <= registered_base_ + registered_size_;
+
+        int32_t result = submitReceive(dst, remaining, fixed);
+
+        // Kernel without fixed-buffer receive: drop the registration for good
+        if (result == -EINVAL && fixed) {
+            std::cerr << "Warning: Kernel cannot receive into registered buffers, "
+                      << "using unregistered receives" << std::endl;
+            ioUringRegister(ring_fd_, IORING_UNREGISTER_BUFFERS, nullptr, 0);
+            registered_base_ = nullptr;
+            registered_size_ = 0;
+            continue;
+        }
+
+        // MSG_WAITALL can still come back short on a signal; just go again
+        if (result == -EINTR || result == -EAGAIN) {
+            continue;
+        }
+        if (result < 0) {
+            return result;
+        }
+        if (result == 0) {
+            break;
+        }
+
+        total += static_cast<size_t>(result);
+    }
+
+    return static_cast<int64_t>(total);
+#else
+    (void)buffer;
+    (void)size;
+    return -ENOSYS;
+#endif
+}
+
+int32_t IoUringEngine::submitReceive(uint8_t* buffer, size_t size, bool fixed)
+{
+#ifdef CONVERTER_HAVE_IO_URING
+    // Single producer and consumer: the calling thread
+    uint32_t tail = *sq_tail_;
+    uint32_t index = tail & *sq_mask_;
+    struct io_uring_sqe* sqe = static_cast<struct io_uring_sqe*>(sqes_) + index;
+
+    std::memset(sqe, 0, sizeof(*sqe));
+    sqe->opcode = IORING_OP_RECV;
+    sqe->fd = socket_fd_;
+    sqe->addr = reinterpret_cast<uint64_t>(buffer);
+    sqe->len = static_cast<uint32_t>(std::min<size_t>(size, 0x7FFFFFFF));
+    sqe->msg_flags = MSG_WAITALL;
+    if (fixed) {
+        sqe->ioprio = IORING_RECVSEND_FIXED_BUF;
+        sqe->buf_index = 0;
+    }
+
+    sq_array_[index] = index;
+    storeRelease(sq_tail_, tail + 1);
+
+    // Submit and wait in the same syscall
+    unsigned to_submit = 1;
+    for (;;) {
+        submit_calls_++;
+        int ret = ioUringEnter(ring_fd_, to_submit, 1, IORING_ENTER_GETEVENTS);
+        if (ret >= 0) {
+            to_submit -= std::min<unsigned>(to_submit, static_cast<unsigned>(ret));
+        } else if (errno != EINTR) {
+            return -errno;
+        }
+
+        uint32_t head = *cq_head_;
+        if (head != loadAcquire(cq_tail_)) {
+            const struct io_uring_cqe* cqe = static_cast<const struct io_uring_cqe*>(cqes_) + (head & *cq_mask_);
+            int32_t result = cqe->res;
+            storeRelease(cq_head_, head + 1);
+            return result;
+        }
+    }
+#else
+    (void)buffer;
+    (void)size;
+    (void)fixed;
+    return -ENOSYS;
+#endif
+}
+
+void IoUringEngine::teardown()
+{
+#ifdef CONVERTER_HAVE_IO_URING
+    if (sqes_ != nullptr) {
+        munmap(sqes_, sqes_size_);
+    }
+    if (cq_ring_ != nullptr && cq_ring_ != sq_ring_) {
+        munmap(cq_ring_, cq_ring_size_);
+    }
+    if (sq_ring_ != nullptr) {
+        munmap(sq_ring_, sq_ring_size_);
+    }
+    if (ring_fd_ >= 0) {
+        close(ring_fd_);  // Also drops registered buffers
+    }
+#endif
+
+    ring_fd_ = -1;
+    socket_fd_ = -1;
+    sq_ring_ = nullptr;
+    cq_ring_ = nullptr;
+    sqes_ = nullptr;
+    registered_base_ = nullptr;
+    registered_size_ = 0;
+}
+
+} // namespace converter
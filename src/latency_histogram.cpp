@@ -0,0 +1,89 @@
+#include "latency_histogram.hpp"
+#include <cmath>
+#include <limits>
+
+namespace converter {
+
+uint64_t LatencyHistogram::bucketUpperBound(size_t index)
+{
+    if (index < kLinearBuckets) {
+        return static_cast<uint64_t>(index);
+    }
+    if (index >= kBucketCount - 1) {
+        return std::numeric_limits<uint64_t>::max();  // Also holds everything clamped into it
+    }
+    const size_t offset = index - kLinearBuckets;
+    const int shift = static_cast<int>(offset >> kSubBucketBits) + 1;
+    const uint64_t sub = (offset & ((size_t{1} << kSubBucketBits) - 1)) + (uint64_t{1} << kSubBucketBits);
+    return ((sub + 1) << shift) - 1;
+}
+
+LatencyHistogram::Snapshot LatencyHistogram::snapshot() const
+{
+    Snapshot snap;
+    snap.count = count_.load(std::memory_order_relaxed);
+    snap.sum_ns = sum_ns_.load(std::memory_order_relaxed);
+    snap.max_ns = max_ns_.load(std::memory_order_relaxed);
+    if (snap.count > 0) {
+        snap.counts.resize(kBucketCount);
+        for (size_t i = 0; i < kBucketCount; i++) {
+            snap.counts[i] = counts_[i].load(std::memory_order_relaxed);
+        }
+    }
+    return snap;
+}
+
+void LatencyHistogram::Snapshot::merge(const Snapshot& other)
+{
+    if (other.counts.empty()) {
+        return;
+    }
+    if (counts.empty()) {
+        counts.resize(kBucketCount);
+    }
+    for (size_t i = 0; i < kBucketCount; i++) {
+        counts[i] += other.counts[i];
+    }
+    count += other.count;
+    sum_ns += other.sum_ns;
+    max_ns = std::max(max_ns, other.max_ns);
+}
+
+uint64_t LatencyHistogram::Snapshot::percentile(double q) const
+{
+    if (counts.empty()) {
+        return 0;
+    }
+
+    // Rank of the wanted sample; the bucket totals are used rather than
+    // `count`, which may be a sample or two ahead while recording
+    uint64_t total = 0;
+    for (uint64_t c : counts) {
+        total += c;
+    }
+    if (total == 0) {
+        return 0;
+    }
+    q = std::min(1.0, std::max(0.0, q));
+    const uint64_t rank = std::max<uint64_t>(1, static_cast<uint64_t>(std::ceil(q * static_cast<double>(total))));
+
+    uint64_t seen = 0;
+    for (size_t i = 0; i < kBucketCount; i++) {
+        seen += counts[i];
+        if (seen >= rank) {
+            return std::min(bucketUpperBound(i), max_ns);
+        }
+    }
+    return max_ns;
+}
+
+uint64_t LatencyHistogram::Snapshot::countAtOrBelow(uint64_t value_ns) const
+{
+    uint64_t total = 0;
+    for (size_t i = 0; i < counts.size() && bucketUpperBound(i) <= value_ns; i++) {
+        total += counts[i];
+    }
+    return total;
+}
+
+} // namespace converter
@@ -1,34 +1,62 @@
 #include "config.hpp"
-#include "tcp_receiver.hpp"
-#include "udp_receiver.hpp"
-#include "frame_unpacker.hpp"
+#include "config_loader.hpp"
+#include "camera_source.hpp"
+#include "crc32c.hpp"
+#include "event_batcher.hpp"
+#include "event_fanout.hpp"
+#include "event_merger.hpp"
+#include "frame_accumulator.hpp"
+#include "frame_recorder.hpp"
+#include "metrics_server.hpp"
+#include "reactor.hpp"
+#include "shm_ring.hpp"
+#include "thread_placement.hpp"
 
 #include <dv-processing/io/network_writer.hpp>
 #include <dv-processing/io/stream.hpp>
 #include <dv-processing/core/event.hpp>
 
+#include <algorithm>
 #include <iostream>
 #include <iomanip>
 #include <chrono>
-#include <thread>
+#include <ctime>
 #include <csignal>
 #include <atomic>
+#include <functional>
 #include <memory>
+#include <string>
+#include <utility>
 #include <variant>
+#include <vector>
 
 // Global flag for graceful shutdown
 std::atomic<bool> running{true};
 
+// What the signal handler interrupts: the main loop and every camera source
+// (set up before the first connect, so a blocked accept ends on Ctrl+C too)
+converter::Reactor* main_loop = nullptr;
+std::vector<converter::CameraSource*> interruptible_sources;
+
 void signalHandler(int signum)
 {
     std::cout << "\nInterrupt signal (" << signum << ") received. Shutting down..." << std::endl;
     running = false;
+    if (main_loop != nullptr) {
+        main_loop->stop();
+    }
+    for (converter::CameraSource* source : interruptible_sources) {
+        source->interrupt();
+    }
 }
 
 void printStats(
+    const std::string& label,
     uint64_t frame_count,
     uint64_t total_events,
     uint64_t total_bytes,
+    uint64_t dropped_frames,
+    uint64_t event_allocations,
     std::chrono::steady_clock::time_point start_time)
 {
     auto now = std::chrono::steady_clock::now();
@@ -39,18 +67,117 @@ void printStats(
         double mbps = (total_bytes * 8.0) / (elapsed * 1000000.0);
         double meps = total_events / (elapsed * 1000000.0);  // Million events per second
         
-        std::cout << "Stats: "
+        std::cout << (label.empty() ? std::string("Stats: ") : "Stats [" + label + "]: ")
                   << "Frames: " << frame_count
                   << " | FPS: " << std::fixed << std::setprecision(1) << fps
                   << " | Events: " << total_events
                   << " | MEv/s: " << std::setprecision(2) << meps
                   << " | Throughput: " << std::setprecision(1) << mbps << " Mbps"
+                  << " | Dropped: " << dropped_frames
+                  << " | Event allocs: " << event_allocations
+                  << std::endl;
+    }
+}
+
+// Per-camera statistics that depend on the timestamp source and protocol
+void printSourceStats(const converter::CameraSource& source, const std::string& prefix)
+{
+    const converter::Config& config = source.getConfig();
+    const converter::Pipeline& pipeline = source.getPipeline();
+    const converter::TimestampEngine& timestamps = pipeline.getTimestampEngine();
+
+    // Tail latency per stage (p50 / p99 / p99.9 / max, microseconds)
+    std::cout << prefix << "Latency p50/p99/p99.9/max us:";
+    for (auto stage : {converter::PipelineStage::Receive, converter::PipelineStage::Unpack,
+                       converter::PipelineStage::Write, converter::PipelineStage::EndToEnd}) {
+        converter::LatencyHistogram::Snapshot latency = pipeline.getLatency(stage);
+        std::cout << (stage == converter::PipelineStage::Receive ? " " : " | ")
+                  << converter::pipelineStageToString(stage) << " " << std::fixed << std::setprecision(1)
+                  << latency.percentile(0.5) / 1000.0 << "/" << latency.percentile(0.99) / 1000.0 << "/"
+                  << latency.percentile(0.999) / 1000.0 << "/" << latency.max_ns / 1000.0;
+    }
+    std::cout << std::endl;
+
+    if (config.timestamp_pll && timestamps.getActiveSource() != converter::TimestampSource::FrameCounter &&
+        timestamps.getActiveSource() != converter::TimestampSource::FpgaHeader) {
+        std::cout << prefix << "Timestamp PLL: " << std::fixed << std::setprecision(1) << timestamps.getJitterUs()
+                  << " us jitter filtered | " << timestamps.getLateFrames() << " late frames | "
+                  << timestamps.getResyncs() << " resyncs" << std::endl;
+    }
+    if (const converter::NoiseFilter* filter = pipeline.getNoiseFilter()) {
+        std::cout << prefix << "Noise filter: " << filter->getEventsKept() << " events kept | "
+                  << filter->getHotPixelEvents() << " hot-pixel (" << filter->getHotPixels() << " pixels), "
+                  << filter->getRefractoryEvents() << " refractory, "
+                  << filter->getBackgroundEvents() << " background events removed" << std::endl;
+    }
+    if (auto* udp = std::get_if<converter::UdpReceiver>(&source.getReceiver())) {
+        std::cout << prefix << "Datagrams: " << udp->getTotalDatagramsReceived()
+                  << " (" << std::fixed << std::setprecision(2) << udp->getDatagramsPerSyscall()
+                  << " per syscall)" << std::endl;
+        if (config.udp_sequence_header) {
+            const auto& reassembly = udp->getReassemblyStats();
+            std::cout << prefix << "Reassembly: " << reassembly.frames_completed << " complete, "
+                      << reassembly.frames_zero_filled << " zero-filled, "
+                      << reassembly.frames_dropped << " dropped, "
+                      << reassembly.frames_missing << " missing frames | "
+                      << reassembly.fragments_lost << " lost, "
+                      << reassembly.fragments_reordered << " reordered, "
+                      << reassembly.fragments_duplicate << " duplicate, "
+                      << reassembly.fragments_late << " late, "
+                      << reassembly.fragments_malformed << " malformed fragments | "
+                      << reassembly.resyncs << " resyncs" << std::endl;
+        }
+    }
+    if (config.receive_mode == converter::ReceiveMode::BusyPoll) {
+        const converter::BusyPollStats& poll = std::visit(
+            [](const auto& receiver) -> const converter::BusyPollStats& { return receiver.getBusyPollStats(); },
+            source.getReceiver());
+        std::cout << prefix << "Busy poll: " << poll.spins << " spins, " << poll.yields << " yields | "
+                  << poll.hits << " receives found spinning, " << poll.waits << " kernel waits" << std::endl;
+    }
+    if (auto* tcp = std::get_if<converter::TcpReceiver>(&source.getReceiver())) {
+        uint64_t frames = std::max<uint64_t>(1, tcp->getTotalFramesReceived());
+        std::cout << prefix << "Receive backend: " << converter::tcpBackendToString(tcp->getActiveBackend())
+                  << " | " << tcp->getTotalReceiveCalls() << " syscalls ("
+                  << std::fixed << std::setprecision(2)
+                  << static_cast<double>(tcp->getTotalReceiveCalls()) / static_cast<double>(frames)
+                  << " per frame)" << std::endl;
+        if (tcp->getMalformedHeaders() > 0) {
+            std::cout << prefix << "Malformed frame headers: " << tcp->getMalformedHeaders()
+                      << " (connection reset each time)" << std::endl;
+        }
+    }
+    if (config.frame_crc_header_bytes() > 0 || config.frame_crc_trailer_bytes() > 0) {
+        const auto [errors, resyncs] = std::visit(
+            [](const auto& receiver) { return std::make_pair(receiver.getCrcErrors(), receiver.getCrcResyncs()); },
+            source.getReceiver());
+        std::cout << prefix << "Frame CRC: " << errors << " bad frames dropped, " << resyncs << " resyncs"
                   << std::endl;
     }
 }
 
 int main(int argc, char* argv[])
 {
+    // Defaults from config.hpp, then the config file, then --KEY=VALUE overrides
+    converter::CommandLine cli;
+    if (!converter::parseCommandLine(argc, argv, cli)) {
+        converter::printUsage(std::cerr, argv[0]);
+        return 1;
+    }
+    if (cli.help) {
+        converter::printUsage(std::cout, argv[0]);
+        return 0;
+    }
+    converter::Config& config = converter::config;
+    if (!converter::loadConfig(cli, config)) {
+        std::cerr << "Invalid configuration. Exiting." << std::endl;
+        return 1;
+    }
+    if (cli.print_config) {
+        converter::writeConfig(std::cout, config);
+        return 0;
+    }
+
     std::cout << "============================================" << std::endl;
     std::cout << "   DVBridge" << std::endl;
     std::cout << "============================================" << std::endl;
@@ -59,131 +186,605 @@ int main(int argc, char* argv[])
     std::signal(SIGINT, signalHandler);
     std::signal(SIGTERM, signalHandler);
 
-    // Use global config (modify in config.hpp or add command line parsing)
-    converter::Config& config = converter::config;
-
     // Print configuration
     std::cout << "\nConfiguration:" << std::endl;
+    if (!cli.config_path.empty()) {
+        std::cout << "  Config file: " << cli.config_path;
+        if (config.config_reload_ms > 0) {
+            std::cout << " (checked for changes every " << config.config_reload_ms << " ms)";
+        }
+        std::cout << std::endl;
+    }
     std::cout << "  Protocol: " << converter::protocolToString(config.protocol) << std::endl;
     std::cout << "  Frame size: " << config.width << " x " << config.height << std::endl;
     std::cout << "  Frame data size: " << config.frame_size() << " bytes" << std::endl;
+    if (config.roi_enabled()) {
+        std::cout << "  Output: " << config.output_width() << " x " << config.output_height() << " (ROI "
+                  << config.roi_columns() << " x " << config.roi_rows() << " at " << config.roi_left() << ","
+                  << config.roi_top() << ", binning " << config.binning_factor() << "x)" << std::endl;
+    }
+    const size_t num_cameras = config.camera_count();
+    const bool merged = num_cameras > 1 && config.camera_output == converter::CameraOutput::Merged;
+    if (num_cameras > 1) {
+        std::cout << "  Cameras: " << num_cameras << " ("
+                  << converter::cameraOutputToString(config.camera_output) << " output)" << std::endl;
+        for (size_t i = 0; i < num_cameras; i++) {
+            converter::Config camera = config.for_camera(i);
+            std::cout << "    " << config.camera_name(i) << ": " << converter::protocolToString(camera.protocol)
+                      << " port " << camera.camera_port;
+            if (!merged) {
+                std::cout << " -> AEDAT4 port " << camera.aedat_port;
+            }
+            if (!camera.pipeline_cpus.empty()) {
+                std::cout << ", cores";
+                for (int cpu : camera.pipeline_cpus) {
+                    std::cout << " " << cpu;
+                }
+            }
+            std::cout << std::endl;
+        }
+    }
     if (config.protocol == converter::Protocol::TCP) {
-        std::cout << "  TCP Server port: " << config.camera_port << " (FPGA connects here)" << std::endl;
+        if (num_cameras == 1) {
+            std::cout << "  TCP Server port: " << config.camera_port << " (FPGA connects here)" << std::endl;
+        }
+        std::cout << "  TCP receive backend: " << converter::tcpBackendToString(config.tcp_backend) << std::endl;
     } else {
-        std::cout << "  UDP Listen port: " << config.camera_port << std::endl;
+        if (num_cameras == 1) {
+            std::cout << "  UDP Listen port: " << config.camera_port << std::endl;
+        }
         std::cout << "  UDP packet size: " << config.udp_packet_size << " bytes" << std::endl;
+        if (config.udp_sequence_header) {
+            std::cout << "  UDP sequence header: yes (window " << config.udp_reorder_window << " frames, timeout "
+                      << config.udp_frame_timeout_us << " us, "
+                      << converter::incompleteFramePolicyToString(config.udp_incomplete_policy)
+                      << " incomplete frames)" << std::endl;
+        }
+    }
+    if (config.receive_mode == converter::ReceiveMode::BusyPoll) {
+        std::cout << "  Receive mode: BusyPoll (spin budget " << config.busy_poll_budget_us << " us, SO_BUSY_POLL "
+                  << config.socket_busy_poll_us << " us)" << std::endl;
+    }
+    if (num_cameras == 1 || merged) {
+        std::cout << "  AEDAT4 output port: " << config.aedat_port << std::endl;
     }
-    std::cout << "  AEDAT4 output port: " << config.aedat_port << std::endl;
     std::cout << "  Frame interval: " << config.frame_interval_us << " us" << std::endl;
+    std::cout << "  Timestamps: " << converter::timestampSourceToString(config.timestamp_source);
+    if (config.timestamp_pll && config.timestamp_source != converter::TimestampSource::FrameCounter &&
+        config.timestamp_source != converter::TimestampSource::FpgaHeader) {
+        std::cout << " (PLL " << config.timestamp_pll_bandwidth_hz << " Hz)";
+    }
+    if (config.frame_readout_us > 0) {
+        std::cout << ", rows spread over " << config.frame_readout_us << " us";
+    }
+    std::cout << std::endl;
     if (config.protocol == converter::Protocol::TCP) {
         std::cout << "  Has header: " << (config.has_header ? "yes" : "no") << std::endl;
+        if (config.occupancy_map != converter::OccupancyMap::None) {
+            if (config.has_header) {
+                std::cout << "  Occupancy bitmap: " << converter::occupancyMapToString(config.occupancy_map)
+                          << " (" << config.occupancy_units() << " units, "
+                          << config.occupancy_map_bytes() << " bytes per frame)" << std::endl;
+            } else {
+                std::cerr << "Warning: occupancy_map needs has_header, ignoring it" << std::endl;
+            }
+        }
+    }
+    if (config.frame_crc) {
+        if (config.frame_crc_header_bytes() > 0 || config.frame_crc_trailer_bytes() > 0) {
+            std::cout << "  Frame CRC: CRC32C (" << converter::crc32cImplementation() << "), "
+                      << (config.protocol == converter::Protocol::TCP ? "in the header" : "trailer") << std::endl;
+        } else if (config.protocol == converter::Protocol::TCP) {
+            std::cerr << "Warning: frame_crc needs has_header, ignoring it" << std::endl;
+        } else {
+            std::cerr << "Warning: frame_crc with udp_gro needs udp_sequence_header (coalesced datagrams "
+                         "hide where frames end), ignoring it" << std::endl;
+        }
     }
     std::cout << "  Pixel format: 2-bit packed (FPGA format)" << std::endl;
+    std::cout << "  Unpack workers: " << config.unpack_workers << std::endl;
+    if (config.unpack_band_threads > 1) {
+        std::cout << "  Band threads per frame: " << config.unpack_band_threads
+                  << " (density >= " << config.parallel_density_threshold << ")" << std::endl;
+    }
+    std::cout << "  Queue depth: " << config.queue_depth
+              << " (" << converter::queueFullPolicyToString(config.queue_full_policy) << " when full)" << std::endl;
+
+    // Open the camera ports first, so the FPGA can connect into the listen
+    // backlog while the buffers warm up and the outputs come up. The write
+    // callbacks are set once the outputs exist.
+    std::vector<std::unique_ptr<converter::CameraSource>> sources;
+    for (size_t i = 0; i < num_cameras; i++) {
+        sources.push_back(std::make_unique<converter::CameraSource>(config, i));
+        if (!sources.back()->listen()) {
+            std::cerr << (num_cameras > 1 ? "[" + sources.back()->getName() + "] " : std::string())
+                      << "Failed to initialize receiver. Exiting." << std::endl;
+            return 1;
+        }
+    }
+
+    size_t warm_bytes = 0;
+    int64_t warm_ms = 0;
+    if (config.warm_start) {
+        const auto warm_begin = std::chrono::steady_clock::now();
+        for (auto& source : sources) {
+            warm_bytes += source->warmUp();
+        }
+        warm_ms = std::chrono::duration_cast<std::chrono::milliseconds>(
+            std::chrono::steady_clock::now() - warm_begin).count();
+    }
+
+    // Create AEDAT4 TCP servers (DV viewer connects here): one per camera,
+    // or one for the merged stream
+    // With a ROI or binning the stream advertises the reduced resolution
+    cv::Size resolution(config.output_width(), config.output_height());
+
+    // Create event stream for the NetworkWriter
+    dv::io::Stream eventStream = dv::io::Stream::EventStream(0, "events", "DVS", resolution);
+
+    // Each output fans out to its AEDAT4 servers (aedat_port + output_sinks),
+    // every server a sink with its own queue and thread
+    const size_t num_outputs = merged ? 1 : num_cameras;
+    std::vector<std::unique_ptr<dv::io::NetworkWriter>> writers;
+    std::vector<std::unique_ptr<converter::EventFanout>> fanouts;
+    for (size_t i = 0; i < num_outputs; i++) {
+        auto fanout = std::make_unique<converter::EventFanout>();
+        auto add_server = [&](const std::string& name, int port, size_t depth, converter::QueueFullPolicy policy) {
+            std::cout << "Starting AEDAT4 server on port " << port << "..." << std::endl;
+            writers.push_back(std::make_unique<dv::io::NetworkWriter>(
+                "0.0.0.0",
+                static_cast<uint16_t>(port),
+                eventStream
+            ));
+            dv::io::NetworkWriter* output = writers.back().get();
+            fanout->addSink(name, depth, policy, [output](const dv::EventStore& events) {
+                output->writeEvents(events);
+            });
+            std::cout << "AEDAT4 server started. DV viewer can connect to port " << port << std::endl;
+        };
+
+        const std::string camera_suffix = num_outputs > 1 ? "-" + config.camera_name(i) : std::string();
+        const int port = merged ? config.aedat_port : config.for_camera(i).aedat_port;
+        add_server("aedat" + std::to_string(port), port, config.sink_queue_depth, config.sink_full_policy);
+        for (const converter::OutputSink& sink : config.output_sinks) {
+            const int sink_port = sink.port + static_cast<int>(i);
+            add_server(sink.name.empty() ? "aedat" + std::to_string(sink_port) : sink.name + camera_suffix,
+                       sink_port, sink.queue_depth > 0 ? sink.queue_depth : config.sink_queue_depth,
+                       sink.full_policy);
+        }
+        fanouts.push_back(std::move(fanout));
+    }
+
+    // Accumulated frame output: one frame stream server per camera, drawn on
+    // the camera's writer thread, written by the accumulator's own thread
+    std::vector<std::unique_ptr<dv::io::NetworkWriter>> frame_writers;
+    std::vector<std::unique_ptr<converter::FrameAccumulator>> accumulators;
+    if (config.frame_output_port > 0) {
+        for (size_t i = 0; i < num_cameras; i++) {
+            const converter::Config& camera_config = sources[i]->getConfig();
+            const int port = config.frame_output_port + static_cast<int>(i);
+            dv::io::Stream frameStream = dv::io::Stream::FrameStream(
+                0, "frames", "DVS", cv::Size(camera_config.output_width(), camera_config.output_height()));
+            frame_writers.push_back(std::make_unique<dv::io::NetworkWriter>(
+                "0.0.0.0",
+                static_cast<uint16_t>(port),
+                frameStream
+            ));
+            dv::io::NetworkWriter* output = frame_writers.back().get();
+            accumulators.push_back(std::make_unique<converter::FrameAccumulator>(
+                camera_config, [output](const dv::Frame& frame) {
+                    output->writeFrame(frame);
+                }));
+            accumulators.back()->start();
+            std::cout << "Frame output" << (num_cameras > 1 ? " [" + sources[i]->getName() + "]" : std::string())
+                      << ": " << converter::frameOutputModeToString(config.frame_output_mode) << " frames every "
+                      << config.frame_output_interval_us << " us on port " << port << std::endl;
+        }
+    }
+    if (config.output_batch_latency_us > 0) {
+        std::cout << "Output batching: up to " << config.output_batch_latency_us << " us / "
+                  << config.output_batch_max_events << " events per packet" << std::endl;
+    }
     std::cout << std::endl;
 
-    // Create receiver based on protocol
-    using ReceiverVariant = std::variant<converter::TcpReceiver, converter::UdpReceiver>;
-    std::unique_ptr<ReceiverVariant> receiver_ptr;
+    // Each output is fed through a batcher, which groups consecutive frames
+    // into one packet; every sink of the output gets the same packets
+    std::vector<std::unique_ptr<converter::EventBatcher>> batchers;
+    for (auto& fanout : fanouts) {
+        converter::EventFanout* output = fanout.get();
+        batchers.push_back(std::make_unique<converter::EventBatcher>(config, [output](const dv::EventStore& events) {
+            output->publish(events);
+        }));
+        fanout->start();
+    }
 
-    if (config.protocol == converter::Protocol::TCP) {
-        receiver_ptr = std::make_unique<ReceiverVariant>(std::in_place_type<converter::TcpReceiver>, config);
-    } else {
-        receiver_ptr = std::make_unique<ReceiverVariant>(std::in_place_type<converter::UdpReceiver>, config);
+    // Optional shared-memory rings next to the AEDAT4 servers (one per output)
+    std::vector<std::unique_ptr<converter::ShmRingWriter>> shm_rings;
+    if (!config.shm_output_name.empty()) {
+        for (size_t i = 0; i < num_outputs; i++) {
+            std::string name = merged || num_cameras == 1
+                ? config.shm_output_name
+                : config.shm_output_name + "-" + config.camera_name(i);
+            auto ring = std::make_unique<converter::ShmRingWriter>();
+            if (ring->create(name, config.shm_output_capacity, config.output_width(), config.output_height())) {
+                std::cout << "Shared-memory output: " << name << " (" << config.shm_output_capacity
+                          << " events)" << std::endl;
+                shm_rings.push_back(std::move(ring));
+            } else {
+                shm_rings.push_back(nullptr);
+            }
+        }
     }
 
-    // Helper lambdas to work with the variant
-    auto connect_receiver = [&]() -> bool {
-        return std::visit([](auto& r) { return r.connect(); }, *receiver_ptr);
-    };
+    // AEDAT4 recording: one file series per output, of what the output sends
+    std::vector<std::unique_ptr<converter::FrameRecorder>> event_recorders;
+    if (config.record_format == converter::RecordFormat::Aedat4) {
+        for (size_t i = 0; i < num_outputs; i++) {
+            std::string prefix = merged || num_cameras == 1
+                ? config.record_path
+                : config.record_path + "-" + config.camera_name(i);
+            auto recorder = std::make_unique<converter::FrameRecorder>(config, config.record_format, prefix);
+            if (recorder->start()) {
+                event_recorders.push_back(std::move(recorder));
+            } else {
+                event_recorders.push_back(nullptr);
+            }
+        }
+    }
 
-    auto disconnect_receiver = [&]() {
-        std::visit([](auto& r) { r.disconnect(); }, *receiver_ptr);
+    // Hand one output's events to its ring and recorder (if any) and its
+    // batcher; each output is fed from a single thread (its camera's writer
+    // or the merger)
+    auto publish = [&](size_t output, const dv::EventStore& events) {
+        if (!shm_rings.empty() && shm_rings[output]) {
+            shm_rings[output]->writeEvents(events);
+        }
+        if (!event_recorders.empty() && event_recorders[output]) {
+            event_recorders[output]->recordEvents(events);
+        }
+        batchers[output]->add(events);
     };
 
-    auto receive_frame = [&](std::vector<uint8_t>& buffer) -> bool {
-        return std::visit([&buffer](auto& r) { return r.receiveFrame(buffer); }, *receiver_ptr);
-    };
+    // Merged output: every camera's writer thread feeds the merger, which writes
+    std::unique_ptr<converter::EventMerger> merger;
+    if (merged) {
+        merger = std::make_unique<converter::EventMerger>(config, [&](const dv::EventStore& events) {
+            publish(0, events);
+        });
+    }
 
-    auto get_total_bytes = [&]() -> uint64_t {
-        return std::visit([](auto& r) { return r.getTotalBytesReceived(); }, *receiver_ptr);
+    // Main loop variables (each camera's are written by its writer thread only;
+    // atomic so the stats timer can read them)
+    struct CameraCounters {
+        std::atomic<uint64_t> frame_count{0};
+        std::atomic<uint64_t> total_events{0};
     };
+    std::vector<CameraCounters> counters(num_cameras);
 
-    converter::FrameUnpacker unpacker(config);
-    
-    // Create AEDAT4 TCP server (DV viewer connects here)
-    std::cout << "Starting AEDAT4 server on port " << config.aedat_port << "..." << std::endl;
-    cv::Size resolution = unpacker.getResolution();
+    // Hot-reloadable, read by the writer threads
+    std::atomic<int> stats_interval{config.stats_interval};
+    auto start_time = std::chrono::steady_clock::now();
+    std::clock_t start_cpu = std::clock();
 
-    // Create event stream for the NetworkWriter
-    dv::io::Stream eventStream = dv::io::Stream::EventStream(0, "events", "DVS", resolution);
+    for (size_t i = 0; i < num_cameras; i++) {
+        sources[i]->setWriteCallback(
+            [&, i](const converter::PipelineFrame& frame) {
+                const converter::CameraSource& source = *sources[i];
+                const converter::Pipeline& pipeline = source.getPipeline();
 
-    dv::io::NetworkWriter writer(
-        "0.0.0.0",
-        static_cast<uint16_t>(config.aedat_port),
-        eventStream
-    );
-    
-    std::cout << "AEDAT4 server started. DV viewer can connect to port " << config.aedat_port << std::endl;
-    std::cout << std::endl;
-    
-    // Connect/bind to receive data
-    if (config.protocol == converter::Protocol::TCP) {
-        std::cout << "Starting TCP server (waiting for FPGA connection)..." << std::endl;
-    } else {
-        std::cout << "Binding UDP socket..." << std::endl;
+                // Send events to AEDAT4 stream (merged: once no other camera can still precede them)
+                if (merger) {
+                    merger->push(i, frame.events, frame.timestamp + std::max<int64_t>(0, config.frame_readout_us));
+                } else {
+                    publish(i, frame.events);
+                }
+                if (!accumulators.empty()) {
+                    accumulators[i]->accumulate(frame);
+                }
+
+                // Update counters
+                CameraCounters& camera = counters[i];
+                uint64_t frame_count = camera.frame_count.load(std::memory_order_relaxed) + 1;
+                uint64_t total_events = camera.total_events.load(std::memory_order_relaxed) + frame.num_events;
+                camera.frame_count.store(frame_count, std::memory_order_relaxed);
+                camera.total_events.store(total_events, std::memory_order_relaxed);
+
+                // Print statistics periodically
+                const int interval = stats_interval.load(std::memory_order_relaxed);
+                if (interval > 0 && frame_count % static_cast<uint64_t>(interval) == 0) {
+                    printStats(num_cameras > 1 ? source.getName() : std::string(), frame_count,
+                               total_events, pipeline.getBytesReceived(), pipeline.getFramesDropped(),
+                               pipeline.getEventAllocations(), start_time);
+                }
+            });
     }
 
-    if (!connect_receiver()) {
-        std::cerr << "Failed to initialize receiver. Exiting." << std::endl;
-        return 1;
+    // Raw recording: each camera's frames as received, tapped before unpacking.
+    // Declared after the sources: queued frames hold slots of their pools
+    std::vector<std::unique_ptr<converter::FrameRecorder>> frame_recorders;
+    if (config.record_format == converter::RecordFormat::RawFrames) {
+        for (size_t i = 0; i < num_cameras; i++) {
+            std::string prefix = num_cameras == 1 ? config.record_path : config.record_path + "-" + sources[i]->getName();
+            auto recorder = std::make_unique<converter::FrameRecorder>(config, config.record_format, prefix);
+            if (!recorder->start()) {
+                continue;
+            }
+            converter::FrameRecorder* target = recorder.get();
+            sources[i]->setReceiveTap([target](const converter::PipelineFrame& frame) {
+                target->recordFrame(frame);
+            });
+            frame_recorders.push_back(std::move(recorder));
+        }
+    }
+    for (const auto* recorders : {&event_recorders, &frame_recorders}) {
+        for (const auto& recorder : *recorders) {
+            if (recorder) {
+                std::cout << "Recording " << converter::recordFormatToString(config.record_format) << " to "
+                          << config.record_path << "*" << (recorder->isDirectIo() ? " (O_DIRECT)" : "") << std::endl;
+                break;
+            }
+        }
+    }
+
+    // Everything large is mapped by now: lock it in (the pools' pages fault
+    // in on their NUMA nodes) and keep later allocations resident too
+    bool memory_locked = false;
+    if (config.lock_memory) {
+        memory_locked = converter::lockProcessMemory();
+        if (!memory_locked) {
+            std::cerr << "Warning: Could not lock memory (needs CAP_IPC_LOCK or a higher RLIMIT_MEMLOCK)" << std::endl;
+        }
+    }
+
+    const converter::Pipeline& first = sources.front()->getPipeline();
+    std::cout << "  Event loop: " << converter::Reactor::getBackendName() << std::endl;
+    std::cout << "  Unpack kernel: " << converter::unpackKernelToString(first.getActiveKernel())
+              << (converter::isUnpackGeometrySpecialized(config.width, config.height)
+                      ? " (" + std::to_string(config.width) + "x" + std::to_string(config.height) + " specialization)"
+                      : std::string())
+              << std::endl;
+    std::cout << "  Frame pool: " << first.getBufferPool().slotCount() << " x "
+              << first.getBufferPool().slotSize() << " bytes"
+              << (first.getBufferPool().usesHugePages() ? " (hugepages)" : "")
+              << (num_cameras > 1 ? " per camera" : "") << std::endl;
+    for (const auto& source : sources) {
+        const int node = source->getPipeline().getBufferPool().numaNode();
+        if (node >= 0) {
+            std::cout << "  Frame pool NUMA node: " << node
+                      << (num_cameras > 1 ? " (" + source->getName() + ")" : "") << std::endl;
+        }
+    }
+    if (config.realtime_priority > 0) {
+        std::cout << "  Scheduling: SCHED_FIFO priority " << config.realtime_priority << std::endl;
+    }
+    if (config.warm_start) {
+        std::cout << "  Warm start: " << (warm_bytes >> 20) << " MB of buffers pre-faulted in "
+                  << warm_ms << " ms" << std::endl;
+    }
+    if (memory_locked) {
+        std::cout << "  Memory: locked (mlockall)" << std::endl;
+    }
+    if (config.noise_filter_enabled()) {
+        std::cout << "  Noise filter: refractory " << config.refractory_period_us << " us | background activity "
+                  << config.background_activity_us << " us | hot pixels learned over "
+                  << config.hot_pixel_learn_frames << " frames" << std::endl;
     }
-    
-    std::cout << std::endl;
-    std::cout << "Starting main loop. Press Ctrl+C to stop." << std::endl;
-    std::cout << "============================================" << std::endl;
     std::cout << std::endl;
-    
-    // Main loop variables
-    std::vector<uint8_t> frame_buffer;
-    dv::EventStore events;
-    uint64_t frame_count = 0;
-    uint64_t total_events = 0;
-    auto start_time = std::chrono::steady_clock::now();
-    
-    // Main loop
-    while (running) {
-        // Receive frame from camera
-        if (!receive_frame(frame_buffer)) {
-            if (running) {
-                std::cerr << "Failed to receive frame. Reconnecting..." << std::endl;
-                disconnect_receiver();
-
-                // Wait a bit before reconnecting
-                std::this_thread::sleep_for(std::chrono::seconds(1));
-
-                if (!connect_receiver()) {
-                    std::cerr << "Reconnection failed. Exiting." << std::endl;
-                    break;
-                }
+
+    // The main loop waits on its own reactor: timers for the shutdown check
+    // and the periodic statistics, stop() from the signal handler
+    converter::Reactor loop;
+    if (!loop.isValid()) {
+        std::cerr << "Failed to create the event loop. Exiting." << std::endl;
+        return 1;
+    }
+    for (auto& source : sources) {
+        interruptible_sources.push_back(source.get());
+    }
+    main_loop = &loop;
+    if (!running) {
+        loop.stop();
+        for (auto& source : sources) {
+            source->interrupt();
+        }
+    }
+
+    if (merger) {
+        merger->start();
+    }
+
+    // Prometheus endpoint: renders straight from the pipelines' counters
+    std::unique_ptr<converter::MetricsServer> metrics;
+    if (config.metrics_port > 0) {
+        metrics = std::make_unique<converter::MetricsServer>(config, [&]() {
+            std::vector<converter::MetricsSource> exported;
+            for (const auto& source : sources) {
+                exported.push_back({source->getName(), &source->getPipeline()});
             }
-            continue;
+            std::vector<const converter::EventFanout*> outputs;
+            for (const auto& fanout : fanouts) {
+                outputs.push_back(fanout.get());
+            }
+            return converter::renderMetrics(exported, outputs);
+        });
+        if (metrics->start()) {
+            std::cout << "Metrics at http://0.0.0.0:" << config.metrics_port << "/metrics" << std::endl;
+        } else {
+            std::cerr << "Warning: Metrics endpoint disabled" << std::endl;
+            metrics.reset();
         }
-        
-        // Unpack frame to events
-        size_t num_events = unpacker.unpack(frame_buffer, frame_count, events);
-        
-        // Send events to AEDAT4 stream
-        if (num_events > 0) {
-            writer.writeEvents(events);
+    }
+
+    // Connect/bind each camera, then start its pipeline right away so a
+    // connected camera is drained while the next one is awaited
+    for (auto& source : sources) {
+        std::string prefix = num_cameras > 1 ? "[" + source->getName() + "] " : "";
+        if (config.protocol == converter::Protocol::TCP) {
+            std::cout << prefix << "Accepting FPGA connection on port " << source->getConfig().camera_port
+                      << "..." << std::endl;
+        } else {
+            std::cout << prefix << "Binding UDP socket..." << std::endl;
         }
-        
-        // Update counters
-        frame_count++;
-        total_events += num_events;
-        
-        // Print statistics periodically
-        if (config.stats_interval > 0 && frame_count % config.stats_interval == 0) {
-            printStats(frame_count, total_events, get_total_bytes(), start_time);
+
+        if (!source->connect()) {
+            if (!running) {
+                break;
+            }
+            std::cerr << prefix << "Failed to initialize receiver. Exiting." << std::endl;
+            // Cameras already started still feed the recorders, which go first
+            for (auto& started : sources) {
+                started->stop();
+            }
+            main_loop = nullptr;
+            interruptible_sources.clear();
+            return 1;
+        }
+
+        // Receive, unpack and write now run on this camera's own threads
+        source->start();
+        std::cout << prefix << "Threads:";
+        const char* separator = " ";
+        for (const auto& placement : source->getPipeline().getThreadPlacement()) {
+            std::cout << separator << placement.role << " cores " << converter::formatCpuList(placement.cpus);
+            if (placement.realtime_priority > 0) {
+                std::cout << " (SCHED_FIFO " << placement.realtime_priority << ")";
+            }
+            separator = ", ";
+        }
+        std::cout << std::endl;
+    }
+
+    if (running) {
+        std::cout << "Pipeline running. Press Ctrl+C to stop." << std::endl;
+        std::cout << "============================================" << std::endl;
+        std::cout << std::endl;
+
+        auto any_running = [&]() {
+            return std::any_of(sources.begin(), sources.end(), [](const auto& source) { return source->isRunning(); });
+        };
+        loop.addTimer(100000, 100000, [&]() {
+            if (!any_running()) {
+                loop.stop();
+            }
+        });
+        // Periodic timers, started again with their new period on a reload
+        auto arm = [&](converter::Reactor::TimerId& timer, int64_t period_us, converter::Reactor::TimerHandler handler) {
+            loop.cancelTimer(timer);
+            timer = period_us > 0 ? loop.addTimer(period_us, period_us, std::move(handler)) : 0;
+        };
+        converter::Reactor::TimerId flush_timer = 0;
+        converter::Reactor::TimerId stats_timer = 0;
+        converter::Reactor::TimerId reload_timer = 0;
+
+        // Batches held by a stream that paused go out once over budget
+        auto arm_flush = [&]() {
+            arm(flush_timer, batchers.front()->getFlushPeriodUs(), [&]() {
+                for (auto& batcher : batchers) {
+                    batcher->flushExpired();
+                }
+            });
+        };
+        auto arm_stats = [&]() {
+            arm(stats_timer, static_cast<int64_t>(config.stats_period_ms) * 1000, [&]() {
+                for (size_t i = 0; i < num_cameras; i++) {
+                    const converter::Pipeline& pipeline = sources[i]->getPipeline();
+                    printStats(num_cameras > 1 ? sources[i]->getName() : std::string(),
+                               counters[i].frame_count.load(std::memory_order_relaxed),
+                               counters[i].total_events.load(std::memory_order_relaxed),
+                               pipeline.getBytesReceived(), pipeline.getFramesDropped(),
+                               pipeline.getEventAllocations(), start_time);
+                }
+            });
+        };
+
+        // Config file edits: reloadable settings go to the running stages,
+        // which pick them up between frames; sockets and threads stay as they are
+        converter::ConfigWatcher watcher(cli);
+        std::function<void()> arm_reload;
+        auto reload = [&]() {
+            converter::Config loaded;
+            if (!watcher.poll(loaded)) {
+                return;
+            }
+            std::string applied;
+            for (const converter::ConfigChange& change : converter::diffConfig(config, loaded)) {
+                if (!change.reloadable) {
+                    std::cerr << "Warning: " << change.key << " changed in " << watcher.getPath()
+                              << ", restart to apply it" << std::endl;
+                    continue;
+                }
+                converter::setConfigValue(config, change.key, change.new_value);
+                applied += (applied.empty() ? " " : ", ") + change.key + " " + change.old_value + " -> " +
+                           change.new_value;
+            }
+            if (applied.empty()) {
+                return;
+            }
+            std::cout << "Reloaded " << watcher.getPath() << ":" << applied << std::endl;
+
+            stats_interval.store(config.stats_interval, std::memory_order_relaxed);
+            for (auto& batcher : batchers) {
+                batcher->reload(config);
+            }
+            for (auto& accumulator : accumulators) {
+                accumulator->reload(config);
+            }
+            bool restart_needed = false;
+            for (auto& source : sources) {
+                restart_needed = !source->reload(config) || restart_needed;
+            }
+            if (restart_needed) {
+                std::cerr << "Warning: A noise filter that was off at startup needs a restart to turn on" << std::endl;
+            }
+            for (auto& fanout : fanouts) {
+                fanout->setSinkPolicy(0, config.sink_full_policy);
+                for (size_t sink = 0; sink < config.output_sinks.size(); sink++) {
+                    fanout->setSinkPolicy(sink + 1, config.output_sinks[sink].full_policy);
+                }
+            }
+            arm_flush();
+            arm_stats();
+            arm_reload();
+        };
+        arm_reload = [&]() {
+            if (watcher.isEnabled()) {
+                arm(reload_timer, static_cast<int64_t>(config.config_reload_ms) * 1000, reload);
+            }
+        };
+
+        arm_flush();
+        arm_stats();
+        arm_reload();
+        loop.run();
+    }
+
+    if (metrics) {
+        metrics->stop();
+    }
+
+    // The merger first, so writer threads waiting on it are released
+    if (merger) {
+        merger->stop();
+    }
+    for (auto& source : sources) {
+        source->stop();
+    }
+    for (auto& batcher : batchers) {
+        batcher->flush();
+    }
+    // Sinks write out what they still hold
+    for (auto& fanout : fanouts) {
+        fanout->stop();
+    }
+    for (auto& accumulator : accumulators) {
+        accumulator->stop();
+    }
+    // Recorders last: they finish writing whatever the pipelines queued
+    for (const auto* recorders : {&event_recorders, &frame_recorders}) {
+        for (const auto& recorder : *recorders) {
+            if (recorder) {
+                recorder->stop();
+            }
         }
     }
 
@@ -191,12 +792,79 @@ int main(int argc, char* argv[])
     std::cout << std::endl;
     std::cout << "============================================" << std::endl;
     std::cout << "Final Statistics:" << std::endl;
-    printStats(frame_count, total_events, get_total_bytes(), start_time);
+    uint64_t bytes_received = 0;
+    for (size_t i = 0; i < num_cameras; i++) {
+        const converter::CameraSource& source = *sources[i];
+        const converter::Pipeline& pipeline = source.getPipeline();
+        std::string label = num_cameras > 1 ? source.getName() : std::string();
+        printStats(label, counters[i].frame_count, counters[i].total_events, pipeline.getBytesReceived(),
+                   pipeline.getFramesDropped(), pipeline.getEventAllocations(), start_time);
+        printSourceStats(source, label.empty() ? std::string() : "  ");
+        bytes_received += pipeline.getBytesReceived();
+    }
+    if (merger) {
+        std::cout << "Merged: " << merger->getEventsMerged() << " events | "
+                  << merger->getLateEvents() << " late events dropped | "
+                  << merger->getStalls() << " camera timeouts" << std::endl;
+    }
+    for (size_t i = 0; i < batchers.size(); i++) {
+        const converter::EventBatcher& batcher = *batchers[i];
+        uint64_t batches = batcher.getBatchesWritten();
+        std::cout << "Output" << (batchers.size() > 1 ? " [" + sources[i]->getName() + "]" : std::string()) << ": "
+                  << batches << " packets (" << std::fixed << std::setprecision(1)
+                  << static_cast<double>(batcher.getFramesBatched()) / static_cast<double>(std::max<uint64_t>(1, batches))
+                  << " frames per packet)" << std::endl;
+    }
+    for (const auto& fanout : fanouts) {
+        for (size_t sink = 0; sink < fanout->getSinkCount(); sink++) {
+            converter::EventFanout::SinkStats stats = fanout->getSinkStats(sink);
+            std::cout << "  Sink " << stats.name << ": " << stats.packets_written << " packets | "
+                      << stats.packets_dropped << " dropped (" << stats.events_dropped << " events) | lag "
+                      << std::fixed << std::setprecision(1) << stats.lag_ns / 1000.0 << " us, max "
+                      << stats.max_lag_ns / 1000.0 << " us" << std::endl;
+        }
+    }
+    for (size_t i = 0; i < accumulators.size(); i++) {
+        const converter::FrameAccumulator& accumulator = *accumulators[i];
+        std::cout << "Frame output" << (accumulators.size() > 1 ? " [" + sources[i]->getName() + "]" : std::string())
+                  << ": " << accumulator.getFramesWritten() << " frames | " << accumulator.getFramesDropped()
+                  << " dropped | " << std::fixed << std::setprecision(1)
+                  << 100.0 * static_cast<double>(accumulator.getPackedFrames()) /
+                     static_cast<double>(std::max<uint64_t>(1, accumulator.getInputFrames()))
+                  << "% of input frames read packed" << std::endl;
+    }
+    for (const auto* recorders : {&event_recorders, &frame_recorders}) {
+        for (const auto& recorder : *recorders) {
+            if (recorder) {
+                std::cout << "Recorded: " << recorder->getFramesRecorded()
+                          << (config.record_format == converter::RecordFormat::Aedat4 ? " batches | " : " frames | ")
+                          << recorder->getFramesDropped() << " dropped | " << std::fixed << std::setprecision(1)
+                          << static_cast<double>(recorder->getBytesWritten()) / 1e6 << " MB in "
+                          << recorder->getFilesWritten() << " files" << std::endl;
+            }
+        }
+    }
+    for (size_t i = 0; i < shm_rings.size(); i++) {
+        if (shm_rings[i]) {
+            std::cout << "Shared memory" << (shm_rings.size() > 1 ? " [" + sources[i]->getName() + "]" : std::string())
+                      << ": " << shm_rings[i]->getRecordsWritten() << " events" << std::endl;
+        }
+    }
+
+    // Whole-process CPU time per Gbit of input, for comparing receive backends
+    double cpu_seconds = static_cast<double>(std::clock() - start_cpu) / CLOCKS_PER_SEC;
+    double gbits = static_cast<double>(bytes_received) * 8.0 / 1e9;
+    if (gbits > 0) {
+        std::cout << "CPU: " << std::fixed << std::setprecision(1) << cpu_seconds << " s ("
+                  << cpu_seconds * 1000.0 / gbits << " ms per Gbit)" << std::endl;
+    }
     std::cout << "============================================" << std::endl;
 
-    // Cleanup
-    disconnect_receiver();
-    
+    // Cleanup (the sources disconnect their receivers)
+    main_loop = nullptr;
+    interruptible_sources.clear();
+    sources.clear();
+
     std::cout << "Shutdown complete." << std::endl;
     return 0;
 }
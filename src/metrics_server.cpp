@@ -0,0 +1,417 @@
+#include "metrics_server.hpp"
+#include <algorithm>
+#include <cstring>
+#include <iostream>
+#include <sstream>
+#include <utility>
+
+#ifdef _WIN32
+    #include <ws2tcpip.h>
+    #define INVALID_SOCK INVALID_SOCKET
+    #define SOCKET_ERROR_CODE WSAGetLastError()
+#else
+    #include <sys/socket.h>
+    #include <netinet/in.h>
+    #include <arpa/inet.h>
+    #include <unistd.h>
+    #include <cerrno>
+    #define INVALID_SOCK (-1)
+    #define SOCKET_ERROR_CODE errno
+#endif
+
+namespace converter {
+
+namespace {
+
+// Largest request header read before giving up on a client
+constexpr size_t kMaxRequestBytes = 8192;
+
+// A scraper hanging up early must not raise SIGPIPE
+#ifdef MSG_NOSIGNAL
+constexpr int kSendFlags = MSG_NOSIGNAL;
+#else
+constexpr int kSendFlags = 0;
+#endif
+
+// Export bucket bounds (ns): 1-2.5-5 steps from 1 us to 1 s
+const uint64_t kExportBucketsNs[] = {
+    1000, 2500, 5000,
+    10000, 25000, 50000,
+    100000, 250000, 500000,
+    1000000, 2500000, 5000000,
+    10000000, 25000000, 50000000,
+    100000000, 250000000, 500000000,
+    1000000000,
+};
+
+const PipelineStage kStages[] = {
+    PipelineStage::Receive, PipelineStage::Unpack, PipelineStage::Write, PipelineStage::EndToEnd,
+};
+
+const double kQuantiles[] = {0.5, 0.9, 0.99, 0.999};
+
+void closeSocket(socket_t fd)
+{
+#ifdef _WIN32
+    closesocket(fd);
+#else
+    close(fd);
+#endif
+}
+
+std::string seconds(uint64_t ns)
+{
+    std::ostringstream out;
+    out << static_cast<double>(ns) / 1e9;
+    return out.str();
+}
+
+std::string header(const char* name, const char* type, const char* help)
+{
+    return std::string("# HELP ") + name + " " + help + "\n# TYPE " + name + " " + type + "\n";
+}
+
+// Counter or gauge with one sample per camera
+template <typename Getter>
+void appendPerCamera(std::string& out, const std::vector<MetricsSource>& sources, const char* name,
+                     const char* type, const char* help, Getter get)
+{
+    out += header(name, type, help);
+    for (const MetricsSource& source : sources) {
+        out += std::string(name) + "{camera=\"" + source.camera + "\"} " + std::to_string(get(*source.pipeline)) + "\n";
+    }
+}
+
+// Counter or gauge with one sample per camera and worker
+template <typename Getter>
+void appendPerWorker(std::string& out, const std::vector<MetricsSource>& sources, const char* name,
+                     const char* type, const char* help, Getter get)
+{
+    out += header(name, type, help);
+    for (const MetricsSource& source : sources) {
+        for (size_t worker = 0; worker < source.pipeline->getWorkerCount(); worker++) {
+            out += std::string(name) + "{camera=\"" + source.camera + "\",worker=\"" + std::to_string(worker) + "\"} " +
+                   std::to_string(get(*source.pipeline, worker)) + "\n";
+        }
+    }
+}
+
+} // namespace
+
+std::string renderMetrics(const std::vector<MetricsSource>& sources, const std::vector<const EventFanout*>& outputs)
+{
+    std::string out;
+    out.reserve(16384);
+
+    appendPerCamera(out, sources, "dvbridge_frames_received_total", "counter", "Frames received from the camera",
+                    [](const Pipeline& p) { return p.getFramesReceived(); });
+    appendPerCamera(out, sources, "dvbridge_bytes_received_total", "counter", "Frame bytes received from the camera",
+                    [](const Pipeline& p) { return p.getBytesReceived(); });
+    appendPerCamera(out, sources, "dvbridge_frames_dropped_total", "counter", "Frames dropped by the DropOldest policy",
+                    [](const Pipeline& p) { return p.getFramesDropped(); });
+    appendPerCamera(out, sources, "dvbridge_frames_written_total", "counter", "Frames handed to the output",
+                    [](const Pipeline& p) { return p.getFramesWritten(); });
+    appendPerCamera(out, sources, "dvbridge_event_allocations_total", "counter", "Event storage allocations",
+                    [](const Pipeline& p) { return p.getEventAllocations(); });
+    appendPerCamera(out, sources, "dvbridge_queue_capacity", "gauge", "Frames each stage queue holds",
+                    [](const Pipeline& p) { return p.getQueueCapacity(); });
+
+    appendPerWorker(out, sources, "dvbridge_worker_frames_total", "counter", "Frames unpacked by a worker",
+                    [](const Pipeline& p, size_t w) { return p.getWorkerFrames(w); });
+    appendPerWorker(out, sources, "dvbridge_worker_events_total", "counter", "Events produced by a worker",
+                    [](const Pipeline& p, size_t w) { return p.getWorkerEvents(w); });
+    appendPerWorker(out, sources, "dvbridge_unpack_queue_depth", "gauge", "Frames waiting for a worker",
+                    [](const Pipeline& p, size_t w) { return p.getUnpackQueueDepth(w); });
+    appendPerWorker(out, sources, "dvbridge_write_queue_depth", "gauge", "Unpacked frames of a worker waiting for the writer",
+                    [](const Pipeline& p, size_t w) { return p.getWriteQueueDepth(w); });
+
+    // Noise filter, for the cameras that have one
+    out += header("dvbridge_noise_filtered_events_total", "counter", "Events removed by the noise filter");
+    for (const MetricsSource& source : sources) {
+        if (const NoiseFilter* filter = source.pipeline->getNoiseFilter()) {
+            const std::pair<const char*, uint64_t> reasons[] = {
+                {"hot_pixel", filter->getHotPixelEvents()},
+                {"refractory", filter->getRefractoryEvents()},
+                {"background", filter->getBackgroundEvents()},
+            };
+            for (const auto& [reason, count] : reasons) {
+                out += "dvbridge_noise_filtered_events_total{camera=\"" + source.camera + "\",reason=\"" + reason +
+                       "\"} " + std::to_string(count) + "\n";
+            }
+        }
+    }
+    out += header("dvbridge_hot_pixels", "gauge", "Pixels masked out as hot (0 while still learning)");
+    for (const MetricsSource& source : sources) {
+        if (const NoiseFilter* filter = source.pipeline->getNoiseFilter()) {
+            out += "dvbridge_hot_pixels{camera=\"" + source.camera + "\"} " + std::to_string(filter->getHotPixels()) + "\n";
+        }
+    }
+
+    // One snapshot per stage, shared by the histogram and the quantiles
+    std::vector<std::vector<LatencyHistogram::Snapshot>> latencies(sources.size());
+    for (size_t i = 0; i < sources.size(); i++) {
+        for (PipelineStage stage : kStages) {
+            latencies[i].push_back(sources[i].pipeline->getLatency(stage));
+        }
+    }
+
+    out += header("dvbridge_stage_latency_seconds", "histogram", "Per-frame latency of a pipeline stage");
+    for (size_t i = 0; i < sources.size(); i++) {
+        for (size_t s = 0; s < kPipelineStageCount; s++) {
+            const LatencyHistogram::Snapshot& snap = latencies[i][s];
+            const std::string labels = "camera=\"" + sources[i].camera + "\",stage=\"" +
+                                       pipelineStageToString(kStages[s]) + "\"";
+            uint64_t total = 0;
+            for (uint64_t c : snap.counts) {
+                total += c;
+            }
+            for (uint64_t bound : kExportBucketsNs) {
+                out += "dvbridge_stage_latency_seconds_bucket{" + labels + ",le=\"" + seconds(bound) + "\"} " +
+                       std::to_string(snap.countAtOrBelow(bound)) + "\n";
+            }
+            out += "dvbridge_stage_latency_seconds_bucket{" + labels + ",le=\"+Inf\"} " + std::to_string(total) + "\n";
+            out += "dvbridge_stage_latency_seconds_sum{" + labels + "} " + seconds(snap.sum_ns) + "\n";
+            out += "dvbridge_stage_latency_seconds_count{" + labels + "} " + std::to_string(total) + "\n";
+        }
+    }
+
+    out += header("dvbridge_stage_latency_quantile_seconds", "gauge",
+                  "Stage latency quantile from the full-resolution histogram (since start)");
+    for (size_t i = 0; i < sources.size(); i++) {
+        for (size_t s = 0; s < kPipelineStageCount; s++) {
+            const LatencyHistogram::Snapshot& snap = latencies[i][s];
+            const std::string labels = "camera=\"" + sources[i].camera + "\",stage=\"" +
+                                       pipelineStageToString(kStages[s]) + "\"";
+            for (double q : kQuantiles) {
+                std::ostringstream quantile;
+                quantile << q;
+                out += "dvbridge_stage_latency_quantile_seconds{" + labels + ",quantile=\"" + quantile.str() + "\"} " +
+                       seconds(snap.percentile(q)) + "\n";
+            }
+        }
+    }
+
+    out += header("dvbridge_stage_latency_max_seconds", "gauge", "Largest stage latency seen (since start)");
+    for (size_t i = 0; i < sources.size(); i++) {
+        for (size_t s = 0; s < kPipelineStageCount; s++) {
+            out += "dvbridge_stage_latency_max_seconds{camera=\"" + sources[i].camera + "\",stage=\"" +
+                   pipelineStageToString(kStages[s]) + "\"} " + seconds(latencies[i][s].max_ns) + "\n";
+        }
+    }
+
+    // Output sinks: one snapshot each, shared by all their samples
+    std::vector<EventFanout::SinkStats> sinks;
+    for (const EventFanout* output : outputs) {
+        for (size_t sink = 0; sink < output->getSinkCount(); sink++) {
+            sinks.push_back(output->getSinkStats(sink));
+        }
+    }
+    auto appendPerSink = [&](const char* name, const char* type, const char* help, auto get) {
+        out += header(name, type, help);
+        for (const EventFanout::SinkStats& sink : sinks) {
+            out += std::string(name) + "{sink=\"" + sink.name + "\"} " + get(sink) + "\n";
+        }
+    };
+    appendPerSink("dvbridge_sink_packets_total", "counter", "Event packets written by an output sink",
+                  [](const EventFanout::SinkStats& s) { return std::to_string(s.packets_written); });
+    appendPerSink("dvbridge_sink_events_total", "counter", "Events written by an output sink",
+                  [](const EventFanout::SinkStats& s) { return std::to_string(s.events_written); });
+    appendPerSink("dvbridge_sink_dropped_packets_total", "counter", "Packets an output sink fell too far behind for",
+                  [](const EventFanout::SinkStats& s) { return std::to_string(s.packets_dropped); });
+    appendPerSink("dvbridge_sink_dropped_events_total", "counter", "Events in the packets a sink dropped",
+                  [](const EventFanout::SinkStats& s) { return std::to_string(s.events_dropped); });
+    appendPerSink("dvbridge_sink_queue_depth", "gauge", "Packets waiting for an output sink",
+                  [](const EventFanout::SinkStats& s) { return std::to_string(s.queue_depth); });
+    appendPerSink("dvbridge_sink_lag_seconds", "gauge", "Queue wait of the last packet an output sink wrote",
+                  [](const EventFanout::SinkStats& s) { return seconds(static_cast<uint64_t>(s.lag_ns)); });
+    appendPerSink("dvbridge_sink_lag_max_seconds", "gauge", "Longest queue wait of an output sink (since start)",
+                  [](const EventFanout::SinkStats& s) { return seconds(static_cast<uint64_t>(s.max_lag_ns)); });
+
+    return out;
+}
+
+MetricsServer::MetricsServer(const Config& cfg, RenderFn render)
+    : config_(cfg)
+    , render_(std::move(render))
+    , listen_socket_(INVALID_SOCK)
+    , requests_served_(0)
+{
+}
+
+MetricsServer::~MetricsServer()
+{
+    stop();
+}
+
+bool MetricsServer::start()
+{
+    if (thread_.joinable()) {
+        return true;
+    }
+    if (!reactor_.isValid()) {
+        std::cerr << "Failed to create the metrics event loop" << std::endl;
+        return false;
+    }
+
+    listen_socket_ = socket(AF_INET, SOCK_STREAM, IPPROTO_TCP);
+    if (listen_socket_ == INVALID_SOCK) {
+        std::cerr << "Failed to create metrics socket: " << SOCKET_ERROR_CODE << std::endl;
+        return false;
+    }
+
+    int reuse = 1;
+    if (setsockopt(listen_socket_, SOL_SOCKET, SO_REUSEADDR,
+                   reinterpret_cast<const char*>(&reuse), sizeof(reuse)) < 0) {
+        std::cerr << "Warning: Failed to set SO_REUSEADDR on metrics socket" << std::endl;
+    }
+
+    struct sockaddr_in addr;
+    std::memset(&addr, 0, sizeof(addr));
+    addr.sin_family = AF_INET;
+    addr.sin_port = htons(static_cast<uint16_t>(config_.metrics_port));
+    addr.sin_addr.s_addr = INADDR_ANY;
+
+    if (bind(listen_socket_, reinterpret_cast<struct sockaddr*>(&addr), sizeof(addr)) < 0 ||
+        listen(listen_socket_, 16) < 0 || !setNonBlocking(listen_socket_, true) ||
+        !reactor_.add(listen_socket_, Reactor::Readable, [this](uint32_t) { acceptClients(); })) {
+        std::cerr << "Failed to listen for metrics on port " << config_.metrics_port << ": "
+                  << SOCKET_ERROR_CODE << std::endl;
+        closeSocket(listen_socket_);
+        listen_socket_ = INVALID_SOCK;
+        return false;
+    }
+
+    reactor_.resume();
+    thread_ = std::thread([this]() { reactor_.run(); });
+    return true;
+}
+
+void MetricsServer::stop()
+{
+    if (!thread_.joinable()) {
+        return;
+    }
+
+    reactor_.stop();
+    thread_.join();
+
+    while (!clients_.empty()) {
+        closeClient(clients_.back()->fd);
+    }
+    reactor_.remove(listen_socket_);
+    closeSocket(listen_socket_);
+    listen_socket_ = INVALID_SOCK;
+}
+
+void MetricsServer::acceptClients()
+{
+    for (;;) {
+        socket_t fd = accept(listen_socket_, nullptr, nullptr);
+        if (fd == INVALID_SOCK) {
+            if (!socketWouldBlock()) {
+                std::cerr << "Warning: Failed to accept metrics client: " << SOCKET_ERROR_CODE << std::endl;
+            }
+            return;
+        }
+
+        if (!setNonBlocking(fd, true) ||
+            !reactor_.add(fd, Reactor::Readable, [this, fd](uint32_t ready) { handleClient(fd, ready); })) {
+            closeSocket(fd);
+            continue;
+        }
+        clients_.push_back(std::make_unique<Client>());
+        clients_.back()->fd = fd;
+    }
+}
+
+void MetricsServer::handleClient(socket_t fd, uint32_t ready)
+{
+    auto it = std::find_if(clients_.begin(), clients_.end(), [fd](const auto& c) { return c->fd == fd; });
+    if (it == clients_.end()) {
+        return;
+    }
+    Client& client = **it;
+
+    // Read until the end of the request header
+    if ((ready & Reactor::Readable) && client.response.empty()) {
+        char buffer[2048];
+        for (;;) {
+            auto received = recv(fd, buffer, sizeof(buffer), 0);
+            if (received > 0) {
+                client.request.append(buffer, static_cast<size_t>(received));
+                if (client.request.size() > kMaxRequestBytes) {
+                    closeClient(fd);
+                    return;
+                }
+                continue;
+            }
+            if (received < 0 && socketWouldBlock()) {
+                break;
+            }
+            closeClient(fd);  // Closed or failed before a full request
+            return;
+        }
+        if (client.request.find("\r\n\r\n") == std::string::npos &&
+            client.request.find("\n\n") == std::string::npos) {
+            return;
+        }
+        respond(client);
+    }
+
+    // Send what the socket takes, then wait for it to drain
+    while (client.sent < client.response.size()) {
+        auto sent = send(fd, client.response.data() + client.sent,
+                         static_cast<int>(client.response.size() - client.sent), kSendFlags);
+        if (sent > 0) {
+            client.sent += static_cast<size_t>(sent);
+            continue;
+        }
+        if (sent < 0 && socketWouldBlock()) {
+            reactor_.modify(fd, Reactor::Writable);
+            return;
+        }
+        break;
+    }
+    if (!client.response.empty()) {
+        closeClient(fd);
+    }
+}
+
+void MetricsServer::respond(Client& client)
+{
+    const std::string& request = client.request;
+    const size_t line_end = request.find_first_of("\r\n");
+    std::istringstream line(request.substr(0, line_end));
+    std::string method;
+    std::string path;
+    line >> method >> path;
+    path = path.substr(0, path.find('?'));
+
+    std::string status = "200 OK";
+    std::string body;
+    if (method != "GET") {
+        status = "405 Method Not Allowed";
+        body = "Only GET is supported\n";
+    } else if (path != "/metrics" && path != "/") {
+        status = "404 Not Found";
+        body = "Metrics are at /metrics\n";
+    } else {
+        body = render_();
+        requests_served_.fetch_add(1, std::memory_order_relaxed);
+    }
+
+    client.response = "HTTP/1.1 " + status + "\r\n"
+                      "Content-Type: text/plain; version=0.0.4; charset=utf-8\r\n"
+                      "Content-Length: " + std::to_string(body.size()) + "\r\n"
+                      "Connection: close\r\n\r\n" + body;
+}
+
+void MetricsServer::closeClient(socket_t fd)
+{
+    reactor_.remove(fd);
+    closeSocket(fd);
+    clients_.erase(std::remove_if(clients_.begin(), clients_.end(), [fd](const auto& c) { return c->fd == fd; }),
+                   clients_.end());
+}
+
+} // namespace converter
@@ -0,0 +1,334 @@
+#include "noise_filter.hpp"
+#include <algorithm>
+#include <bit>
+#include <cstring>
+#include <iostream>
+
+namespace converter {
+
+namespace {
+
+// Low bit of every 2-bit pixel code
+constexpr uint64_t kPairLowBits = 0x5555555555555555ULL;
+
+// Pass granularity of filter(): a few rows, small enough to stay in L1/L2
+constexpr size_t kBandBytes = 4096;
+
+// "Never fired": far enough back for any window, in wrapping 32-bit time
+constexpr int32_t kNever = int32_t{1} << 30;
+
+/**
+ * Mark the pixels of a word that hold an event (codes 01 and 10; 11 is unused)
+ * @return Low bit of each such pixel's code
+ */
+inline uint64_t eventBits(uint64_t word)
+{
+    return (word ^ (word >> 1)) & kPairLowBits;
+}
+
+inline int countEvents(uint64_t word)
+{
+    return std::popcount(eventBits(word));
+}
+
+/**
+ * Load / store the 8-byte word at offset `i`, zero-padded past the end of the frame
+ */
+inline uint64_t loadWord(const uint8_t* frame, size_t i, size_t size)
+{
+    uint64_t word = 0;
+    if (size - i >= sizeof(word)) {
+        std::memcpy(&word, frame + i, sizeof(word));
+    } else {
+        std::memcpy(&word, frame + i, size - i);
+    }
+    return word;
+}
+
+inline void storeWord(uint8_t* frame, size_t i, size_t size, uint64_t word)
+{
+    if (size - i >= sizeof(word)) {
+        std::memcpy(frame + i, &word, sizeof(word));
+    } else {
+        std::memcpy(frame + i, &word, size - i);
+    }
+}
+
+/**
+ * Check if a 64-byte block at offset `i` is all zero (most of a sparse frame)
+ */
+inline bool emptyBlock(const uint8_t* frame, size_t i, size_t size)
+{
+    if ((i & 63) != 0 || size - i < 64) {
+        return false;
+    }
+    uint64_t block[8];
+    std::memcpy(block, frame + i, sizeof(block));
+    return (block[0] | block[1] | block[2] | block[3] | block[4] | block[5] | block[6] | block[7]) == 0;
+}
+
+/**
+ * Distance between two wrapping microsecond times
+ */
+inline uint32_t timeDistance(int32_t a, int32_t b)
+{
+    const int32_t d = static_cast<int32_t>(static_cast<uint32_t>(a) - static_cast<uint32_t>(b));
+    return d < 0 ? static_cast<uint32_t>(-static_cast<int64_t>(d)) : static_cast<uint32_t>(d);
+}
+
+/**
+ * Raise a stored time to `now` unless it is already later (frames may finish out of order)
+ */
+inline void advance(std::atomic<int32_t>& stored, int32_t now)
+{
+    const int32_t previous = stored.load(std::memory_order_relaxed);
+    if (static_cast<int32_t>(static_cast<uint32_t>(now) - static_cast<uint32_t>(previous)) > 0) {
+        stored.store(now, std::memory_order_relaxed);
+    }
+}
+
+// Refractory period and support window in one word, so a frame reads a consistent pair
+inline uint64_t packThresholds(const Config& cfg)
+{
+    const uint64_t refractory = static_cast<uint64_t>(std::clamp<int64_t>(cfg.refractory_period_us, 0, kNever / 2));
+    const uint64_t support = static_cast<uint64_t>(std::clamp<int64_t>(cfg.background_activity_us, 0, kNever / 2));
+    return refractory << 32 | support;
+}
+
+} // namespace
+
+NoiseFilter::NoiseFilter(const Config& cfg)
+    : config_(cfg)
+    , width_(cfg.width)
+    , stride_(cfg.width + 2)
+    , band_bytes_(std::max<size_t>(kBandBytes, (static_cast<size_t>(cfg.width) / 4 + 64) / 64 * 64 + 64))
+    , total_pixels_(cfg.total_pixels())
+    , thresholds_(packThresholds(cfg))
+    , hot_pixel_fraction_(cfg.hot_pixel_fraction)
+    , learn_frames_started_(0)
+    , learn_frames_done_(0)
+    , mask_ready_(false)
+    , hot_pixels_(0)
+    , hot_events_(0)
+    , refractory_events_(0)
+    , background_events_(0)
+    , events_kept_(0)
+{
+    const size_t pixels = static_cast<size_t>(total_pixels_);
+    if (thresholds_.load(std::memory_order_relaxed) != 0) {
+        // One-pixel border that never fires, so neighbourhoods need no edge tests
+        pixels_ = std::make_unique<PixelState[]>(static_cast<size_t>(stride_) * (cfg.height + 2));
+    }
+    if (cfg.hot_pixel_learn_frames > 0) {
+        fire_counts_ = std::make_unique<std::atomic<uint32_t>[]>(pixels);
+        // Padded to whole words so the mask can always be loaded 8 bytes at a time
+        mask_.assign((static_cast<size_t>(cfg.frame_size()) + 7) / 8 * 8, 0xFF);
+    }
+}
+
+bool NoiseFilter::reload(const Config& cfg)
+{
+    const uint64_t thresholds = packThresholds(cfg);
+    hot_pixel_fraction_.store(cfg.hot_pixel_fraction, std::memory_order_relaxed);
+    if (pixels_ == nullptr) {
+        return thresholds == 0;
+    }
+    thresholds_.store(thresholds, std::memory_order_relaxed);
+    return true;
+}
+
+size_t NoiseFilter::filter(const uint8_t* frame, uint8_t* out, size_t size, int64_t timestamp)
+{
+    const int32_t now = static_cast<int32_t>(static_cast<uint32_t>(static_cast<uint64_t>(timestamp)));
+    const uint64_t thresholds = thresholds_.load(std::memory_order_relaxed);
+    const uint32_t refractory = static_cast<uint32_t>(thresholds >> 32);
+    const uint32_t window = static_cast<uint32_t>(thresholds);
+    const bool stateful = pixels_ != nullptr;
+    if (stateful) {
+        std::call_once(pixels_init_, [&]() {
+            for (size_t i = 0; i < static_cast<size_t>(stride_) * (config_.height + 2); i++) {
+                pixels_[i].last_event.store(now - kNever, std::memory_order_relaxed);
+                pixels_[i].last_fire.store(now - kNever, std::memory_order_relaxed);
+            }
+        });
+    }
+
+    // Learning frames pass unmasked; the last of them to finish builds the mask
+    if (fire_counts_ && !hasMask()) {
+        if (learn_frames_started_.fetch_add(1, std::memory_order_relaxed) < config_.hot_pixel_learn_frames) {
+            learn(frame, std::min(size, static_cast<size_t>(config_.frame_size())));
+            if (learn_frames_done_.fetch_add(1, std::memory_order_acq_rel) + 1 == config_.hot_pixel_learn_frames) {
+                buildMask();
+            }
+        }
+    }
+    const uint8_t* mask = hasMask() ? mask_.data() : nullptr;
+    if (mask != nullptr) {
+        size = std::min(size, static_cast<size_t>(config_.frame_size()));
+    }
+
+    // Pass 1 masks a band and stamps its events, pass 2 checks the band before
+    // it (whose neighbours below are now stamped) while that is still in cache
+    Counts counts;
+    size_t checked = 0;
+    for (size_t begin = 0; begin < size; begin += band_bytes_) {
+        const size_t end = std::min(size, begin + band_bytes_);
+        maskAndStamp(frame, out, begin, end, size, mask, now, window, counts);
+        if (stateful) {
+            checkEvents(out, checked, begin, size, now, refractory, window, counts);
+            checked = begin;
+        }
+    }
+    if (stateful) {
+        checkEvents(out, checked, size, size, now, refractory, window, counts);
+    }
+
+    hot_events_.fetch_add(counts.hot, std::memory_order_relaxed);
+    refractory_events_.fetch_add(counts.refractory, std::memory_order_relaxed);
+    background_events_.fetch_add(counts.background, std::memory_order_relaxed);
+    events_kept_.fetch_add(counts.kept, std::memory_order_relaxed);
+    return static_cast<size_t>(counts.kept);
+}
+
+void NoiseFilter::maskAndStamp(const uint8_t* frame, uint8_t* out, size_t begin, size_t end, size_t size,
+                               const uint8_t* mask, int32_t now, uint32_t window, Counts& counts)
+{
+    const bool stateful = pixels_ != nullptr;
+    for (size_t i = begin; i < end; i += 8) {
+        if (emptyBlock(frame, i, size)) {
+            if (out != frame) {
+                std::memset(out + i, 0, 64);
+            }
+            i += 56;
+            continue;
+        }
+
+        const uint64_t word = loadWord(frame, i, size);
+        uint64_t kept = word;
+        if (word != 0 && mask != nullptr) {
+            uint64_t keep;
+            std::memcpy(&keep, mask + i, sizeof(keep));
+            kept &= keep;
+            counts.hot += static_cast<uint64_t>(countEvents(word) - countEvents(kept));
+        }
+        if (kept != 0 && window > 0) {
+            kept = forEachEvent(kept, i, [&](size_t index) {
+                advance(pixels_[index].last_fire, now);
+                return true;
+            });
+        }
+        if (!stateful) {
+            counts.kept += static_cast<uint64_t>(countEvents(kept));
+        }
+        storeWord(out, i, size, kept);
+    }
+}
+
+void NoiseFilter::checkEvents(uint8_t* out, size_t begin, size_t end, size_t size, int32_t now, uint32_t refractory,
+                              uint32_t window, Counts& counts)
+{
+    for (size_t i = begin; i < end; i += 8) {
+        if (emptyBlock(out, i, size)) {
+            i += 56;
+            continue;
+        }
+        uint64_t word = loadWord(out, i, size);
+        if (word == 0) {
+            continue;
+        }
+        word = forEachEvent(word, i, [&](size_t index) {
+            PixelState& state = pixels_[index];
+            if (refractory > 0 && timeDistance(now, state.last_event.load(std::memory_order_relaxed)) < refractory) {
+                counts.refractory++;
+                return false;
+            }
+            if (window > 0 && !isSupported(index, now, window)) {
+                counts.background++;
+                return false;
+            }
+            advance(state.last_event, now);
+            counts.kept++;
+            return true;
+        });
+        storeWord(out, i, size, word);
+    }
+}
+
+template<typename Fn>
+uint64_t NoiseFilter::forEachEvent(uint64_t word, size_t byte_index, Fn&& fn)
+{
+    // Position of the word's first pixel; its 32 pixels may wrap into later rows
+    const int first = static_cast<int>(byte_index * 4);
+    const int row = first / width_;
+    const int column = first - row * width_;
+
+    uint64_t pending = eventBits(word);
+    while (pending != 0) {
+        const unsigned bit = static_cast<unsigned>(std::countr_zero(pending));
+        pending &= pending - 1;
+
+        // Bit pair `bit` is pixel 3 - (bit % 8) / 2 of byte byte_index + bit / 8 (MSB first)
+        const int offset = static_cast<int>((bit / 8) * 4 + (3 - (bit % 8) / 2));
+        if (first + offset >= total_pixels_) {
+            word &= ~(uint64_t{3} << bit);  // Padding, never an event
+            continue;
+        }
+        int x = column + offset;
+        int y = row;
+        while (x >= width_) {
+            x -= width_;
+            y++;
+        }
+        if (!fn(static_cast<size_t>(y + 1) * stride_ + static_cast<size_t>(x + 1))) {
+            word &= ~(uint64_t{3} << bit);
+        }
+    }
+    return word;
+}
+
+bool NoiseFilter::isSupported(size_t index, int32_t now, uint32_t window) const
+{
+    // All eight loads are independent and unconditional, so their cache misses overlap
+    auto recent = [&](size_t neighbour) {
+        return timeDistance(now, pixels_[neighbour].last_fire.load(std::memory_order_relaxed)) <= window;
+    };
+    const size_t above = index - stride_;
+    const size_t below = index + stride_;
+    return recent(above - 1) | recent(above) | recent(above + 1) |
+           recent(index - 1) | recent(index + 1) |
+           recent(below - 1) | recent(below) | recent(below + 1);
+}
+
+void NoiseFilter::learn(const uint8_t* frame, size_t size)
+{
+    for (size_t i = 0; i < size; i += 8) {
+        uint64_t pending = eventBits(loadWord(frame, i, size));
+        while (pending != 0) {
+            const unsigned bit = static_cast<unsigned>(std::countr_zero(pending));
+            pending &= pending - 1;
+            const size_t pixel = (i + bit / 8) * 4 + (3 - (bit % 8) / 2);
+            if (pixel < static_cast<size_t>(total_pixels_)) {
+                fire_counts_[pixel].fetch_add(1, std::memory_order_relaxed);
+            }
+        }
+    }
+}
+
+void NoiseFilter::buildMask()
+{
+    const double threshold = hot_pixel_fraction_.load(std::memory_order_relaxed) * config_.hot_pixel_learn_frames;
+    size_t hot = 0;
+    for (int pixel = 0; pixel < total_pixels_; pixel++) {
+        if (fire_counts_[pixel].load(std::memory_order_relaxed) > threshold) {
+            mask_[pixel / 4] &= static_cast<uint8_t>(~(3u << (6 - 2 * (pixel % 4))));
+            hot++;
+        }
+    }
+    hot_pixels_.store(hot, std::memory_order_relaxed);
+    mask_ready_.store(true, std::memory_order_release);
+
+    std::cout << "Noise filter: masked " << hot << " hot pixels (learned over "
+              << config_.hot_pixel_learn_frames << " frames)" << std::endl;
+}
+
+} // namespace converter
@@ -0,0 +1,428 @@
+#include "pipeline.hpp"
+#include "thread_placement.hpp"
+#include <algorithm>
+#include <iostream>
+
+namespace converter {
+
+Pipeline::Pipeline(const Config& cfg, ReceiveFn receive, ReconnectFn reconnect, WriteFn write)
+    : config_(cfg)
+    , receive_(std::move(receive))
+    , reconnect_(std::move(reconnect))
+    , write_(std::move(write))
+    , num_workers_(static_cast<size_t>(std::max(1, cfg.unpack_workers)))
+    , timestamps_(cfg)
+    , running_(false)
+    , stop_requested_(false)
+    , queue_full_policy_(cfg.queue_full_policy)
+    , frames_received_(0)
+    , bytes_received_(0)
+    , frames_dropped_(0)
+    , frames_written_(0)
+{
+    const size_t depth = static_cast<size_t>(std::max(1, cfg.queue_depth));
+
+    for (size_t i = 0; i < num_workers_; i++) {
+        unpackers_.push_back(std::make_unique<FrameUnpacker>(cfg));
+        unpack_queues_.push_back(std::make_unique<FrameQueue>(depth));
+        write_queues_.push_back(std::make_unique<FrameQueue>(depth));
+        worker_counters_.push_back(std::make_unique<WorkerCounters>());
+        unpack_latency_.push_back(std::make_unique<LatencyHistogram>());
+    }
+
+    if (cfg.noise_filter_enabled()) {
+        noise_filter_ = std::make_unique<NoiseFilter>(cfg);
+        filtered_frames_.assign(num_workers_, std::vector<uint8_t>(static_cast<size_t>(cfg.frame_size())));
+    }
+
+    // Enough frames that every queue can be full while each worker, the
+    // receiver and the writer (one held frame per worker) also hold one.
+    // The receiver can then never run out of buffers under DropOldest.
+    const size_t queue_capacity = unpack_queues_.front()->capacity();
+    const size_t pool_size = num_workers_ * (2 * queue_capacity + 2) + 2;
+
+    // A few spare buffer slots cover handles still held outside the pipeline,
+    // plus every frame a raw recorder may have queued (its queue capacity,
+    // rounded up like BoundedQueue's, and the one being written).
+    // Each slot also has room for the frame's occupancy bitmap or CRC
+    // trailer, if any.
+    size_t spare_slots = 2;
+    if (cfg.record_format == RecordFormat::RawFrames) {
+        size_t record_slots = 2;
+        while (record_slots < cfg.record_queue_frames) {
+            record_slots <<= 1;
+        }
+        spare_slots += record_slots + 1;
+    }
+    // Keep the buffers on the NIC's node: the configured one, else the
+    // interface's, else that of the receiver's first core (if pinned)
+    int numa_node = cfg.numa_node;
+    if (numa_node < 0 && !cfg.numa_interface.empty()) {
+        numa_node = interfaceNumaNode(cfg.numa_interface);
+        if (numa_node < 0) {
+            std::cerr << "Warning: NUMA node of " << cfg.numa_interface << " unknown, frame pool not bound" << std::endl;
+        }
+    }
+    if (numa_node < 0 && cfg.numa_interface.empty()) {
+        const std::vector<int>& receiver = cfg.receiver_thread_cpus();
+        if (!receiver.empty()) {
+            numa_node = cpuNumaNode(receiver.front());
+        }
+    }
+    buffer_pool_ = std::make_unique<FramePool>(pool_size + spare_slots,
+                                               static_cast<size_t>(cfg.frame_size() + cfg.occupancy_map_bytes() +
+                                                                   cfg.frame_crc_trailer_bytes()),
+                                               cfg.use_hugepages, numa_node);
+
+    free_frames_ = std::make_unique<FrameQueue>(pool_size);
+    for (size_t i = 0; i < pool_size; i++) {
+        frames_.push_back(std::make_unique<PipelineFrame>());
+        PipelineFrame* frame = frames_.back().get();
+        free_frames_->tryPush(frame);
+    }
+}
+
+Pipeline::~Pipeline()
+{
+    stop();
+}
+
+uint64_t Pipeline::getEventAllocations() const
+{
+    uint64_t total = 0;
+    for (const auto& unpacker : unpackers_) {
+        total += unpacker->getArenaAllocations();
+    }
+    return total;
+}
+
+LatencyHistogram::Snapshot Pipeline::getLatency(PipelineStage stage) const
+{
+    switch (stage) {
+        case PipelineStage::Receive:
+            return receive_latency_.snapshot();
+        case PipelineStage::Unpack: {
+            LatencyHistogram::Snapshot merged;
+            for (const auto& histogram : unpack_latency_) {
+                merged.merge(histogram->snapshot());
+            }
+            return merged;
+        }
+        case PipelineStage::Write:
+            return write_latency_.snapshot();
+        default:
+            return end_to_end_latency_.snapshot();
+    }
+}
+
+void Pipeline::start()
+{
+    if (running_) {
+        return;
+    }
+
+    stop_requested_ = false;
+    running_ = true;
+
+    threads_.emplace_back(&Pipeline::writerLoop, this);
+    for (size_t i = 0; i < num_workers_; i++) {
+        threads_.emplace_back(&Pipeline::workerLoop, this, i);
+    }
+    threads_.emplace_back(&Pipeline::receiverLoop, this);
+
+    // threads_ is writer, workers, receiver; a role without its own cores
+    // falls back to pipeline_cpus, and each worker gets one core of worker_cpus
+    std::vector<std::vector<int>> cpus;
+    std::vector<std::string> roles;
+    cpus.push_back(config_.writer_cpus.empty() ? config_.pipeline_cpus : config_.writer_cpus);
+    roles.push_back("writer");
+    for (size_t i = 0; i < num_workers_; i++) {
+        if (config_.worker_cpus.empty()) {
+            cpus.push_back(config_.pipeline_cpus);
+        } else {
+            cpus.push_back({config_.worker_cpus[i % config_.worker_cpus.size()]});
+        }
+        roles.push_back("worker" + std::to_string(i));
+    }
+    cpus.push_back(config_.receiver_thread_cpus());
+    roles.push_back("receiver");
+
+    bool pinned = true;
+    bool realtime = true;
+    std::vector<ThreadPlacement> placement;
+    for (size_t i = 0; i < threads_.size(); i++) {
+        if (!cpus[i].empty()) {
+            pinned = pinThread(threads_[i], cpus[i]) && pinned;
+        }
+        if (config_.realtime_priority > 0) {
+            realtime = setRealtimePriority(threads_[i], config_.realtime_priority) && realtime;
+        }
+        placement.push_back(converter::getThreadPlacement(threads_[i], roles[i]));
+    }
+    if (!pinned) {
+        std::cerr << "Warning: Could not pin pipeline threads to the configured cores" << std::endl;
+    }
+    if (!realtime) {
+        std::cerr << "Warning: Could not set SCHED_FIFO priority " << config_.realtime_priority
+                  << " (needs CAP_SYS_NICE or an rtprio limit)" << std::endl;
+    }
+
+    // Reported in pipeline order: receiver, workers, writer
+    placement_.assign(1, placement.back());
+    placement_.insert(placement_.end(), placement.begin() + 1, placement.end() - 1);
+    placement_.push_back(placement.front());
+}
+
+void Pipeline::stop()
+{
+    stop_requested_ = true;
+
+    for (auto& thread : threads_) {
+        if (thread.joinable()) {
+            thread.join();
+        }
+    }
+    threads_.clear();
+
+    running_ = false;
+}
+
+size_t Pipeline::warmUp()
+{
+    size_t bytes = buffer_pool_->prefault();
+    // As many packets as frames a worker's queues, the worker and the writer hold
+    const size_t packets = 2 * unpack_queues_.front()->capacity() + 2;
+    for (auto& unpacker : unpackers_) {
+        bytes += unpacker->warmUp(packets);
+    }
+    return bytes;
+}
+
+bool Pipeline::reload(const Config& cfg)
+{
+    queue_full_policy_.store(cfg.queue_full_policy, std::memory_order_relaxed);
+    for (auto& unpacker : unpackers_) {
+        unpacker->reload(cfg);
+    }
+    if (noise_filter_) {
+        return noise_filter_->reload(cfg);
+    }
+    return !cfg.noise_filter_enabled();
+}
+
+PipelineFrame* Pipeline::acquireFrame()
+{
+    PipelineFrame* frame = nullptr;
+    QueueBackoff backoff;
+
+    while (!free_frames_->tryPop(frame)) {
+        if (stop_requested_) {
+            return nullptr;
+        }
+        backoff.wait();
+    }
+
+    // Slots can be held a little longer by whoever still references the
+    // frame, so the buffer pool may briefly run dry even with a free frame
+    backoff.reset();
+    while (!(frame->buffer = buffer_pool_->tryAcquire())) {
+        if (stop_requested_) {
+            free_frames_->tryPush(frame);
+            return nullptr;
+        }
+        backoff.wait();
+    }
+
+    return frame;
+}
+
+void Pipeline::recycleFrame(PipelineFrame* frame)
+{
+    // Release the buffer slot and event packet now rather than on reuse
+    frame->buffer.reset();
+    frame->events = dv::EventStore();
+    frame->num_events = 0;
+
+    // Cannot fail: the free list is sized for the whole pool
+    free_frames_->tryPush(frame);
+}
+
+bool Pipeline::pushFrame(FrameQueue& queue, PipelineFrame* frame)
+{
+    QueueBackoff backoff;
+    const QueueFullPolicy policy = queue_full_policy_.load(std::memory_order_relaxed);
+
+    while (!queue.tryPush(frame)) {
+        if (stop_requested_) {
+            return false;
+        }
+
+        if (policy == QueueFullPolicy::DropOldest) {
+            PipelineFrame* oldest = nullptr;
+            if (queue.tryPop(oldest)) {
+                recycleFrame(oldest);
+                frames_dropped_.fetch_add(1, std::memory_order_relaxed);
+            }
+            continue;
+        }
+
+        backoff.wait();
+    }
+
+    return true;
+}
+
+void Pipeline::receiverLoop()
+{
+    uint64_t sequence = 0;
+
+    while (!stop_requested_) {
+        PipelineFrame* frame = acquireFrame();
+        if (frame == nullptr) {
+            break;
+        }
+
+        if (!receive_(frame->buffer)) {
+            recycleFrame(frame);
+            if (stop_requested_) {
+                break;
+            }
+            if (!reconnect_()) {
+                break;
+            }
+            timestamps_.reset();  // New connection, new phase
+            continue;
+        }
+
+        // Receivers that cannot tell when a frame started count it as arriving complete
+        frame->received_ns = steadyClockNs();
+        if (frame->buffer.arrival() == 0) {
+            frame->buffer.setArrival(frame->received_ns);
+        }
+        receive_latency_.record(frame->received_ns - frame->buffer.arrival());
+
+        frame->sequence = sequence++;
+        frame->timestamp = timestamps_.frameTimestamp(frame->buffer.timestamp(), frame->sequence);
+        frames_received_.fetch_add(1, std::memory_order_relaxed);
+        bytes_received_.fetch_add(frame->buffer.size(), std::memory_order_relaxed);
+
+        if (receive_tap_) {
+            receive_tap_(*frame);
+        }
+
+        if (!pushFrame(*unpack_queues_[frame->sequence % num_workers_], frame)) {
+            recycleFrame(frame);
+            break;
+        }
+    }
+
+    // Tell the owner the input is gone (stop() still has to be called)
+    running_ = false;
+}
+
+void Pipeline::workerLoop(size_t worker)
+{
+    FrameQueue& input = *unpack_queues_[worker];
+    FrameQueue& output = *write_queues_[worker];
+    FrameUnpacker& unpacker = *unpackers_[worker];
+    WorkerCounters& counters = *worker_counters_[worker];
+    LatencyHistogram& latency = *unpack_latency_[worker];
+    QueueBackoff backoff;
+
+    while (!stop_requested_) {
+        PipelineFrame* frame = nullptr;
+        if (!input.tryPop(frame)) {
+            backoff.wait();
+            continue;
+        }
+        backoff.reset();
+
+        const FrameHandle& buffer = frame->buffer;
+        const int64_t unpack_start = steadyClockNs();
+        if (noise_filter_) {
+            std::vector<uint8_t>& filtered = filtered_frames_[worker];
+            const uint8_t* dense = buffer.data();
+            size_t size = buffer.size();
+            bool valid = true;
+            if (buffer.encoding() != FrameEncoding::Dense) {
+                valid = expandCompressedFrame(buffer.encoding(), buffer.data(), buffer.size(),
+                                              filtered.size(), filtered.data());
+                dense = filtered.data();
+                size = filtered.size();
+            }
+            if (valid) {
+                size = std::min(size, filtered.size());
+                noise_filter_->filter(dense, filtered.data(), size, frame->timestamp);
+                // Filtering only clears pixels, so the occupancy bitmap still holds
+                frame->num_events = unpacker.unpackWithTimestamp(
+                    filtered.data(), size, frame->timestamp, frame->events,
+                    buffer.encoding() == FrameEncoding::Dense ? buffer.occupancy() : nullptr);
+            } else {
+                // Reports the malformed payload and yields no events
+                frame->num_events = unpacker.unpackEncoded(buffer.data(), buffer.size(), buffer.encoding(),
+                                                           frame->timestamp, frame->events);
+            }
+        } else if (buffer.encoding() == FrameEncoding::Dense) {
+            frame->num_events = unpacker.unpackWithTimestamp(buffer.data(), buffer.size(), frame->timestamp,
+                                                             frame->events, buffer.occupancy());
+        } else {
+            frame->num_events = unpacker.unpackEncoded(buffer.data(), buffer.size(), buffer.encoding(),
+                                                       frame->timestamp, frame->events);
+        }
+        latency.record(steadyClockNs() - unpack_start);
+        counters.frames.store(counters.frames.load(std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+        counters.events.store(counters.events.load(std::memory_order_relaxed) + frame->num_events,
+                              std::memory_order_relaxed);
+
+        if (!pushFrame(output, frame)) {
+            recycleFrame(frame);
+            break;
+        }
+    }
+}
+
+void Pipeline::writerLoop()
+{
+    // Frame `sequence` always goes to worker (sequence % num_workers_), so
+    // visiting workers round-robin restores receive order. A frame dropped
+    // upstream shows up as the worker's next frame having a later sequence;
+    // it is held here until the writer's position catches up with it.
+    std::vector<PipelineFrame*> held(num_workers_, nullptr);
+    uint64_t next_sequence = 0;
+    QueueBackoff backoff;
+
+    while (!stop_requested_) {
+        size_t worker = next_sequence % num_workers_;
+        PipelineFrame*& frame = held[worker];
+
+        if (frame == nullptr && !write_queues_[worker]->tryPop(frame)) {
+            backoff.wait();
+            continue;
+        }
+        backoff.reset();
+
+        if (frame->sequence > next_sequence) {
+            next_sequence++;  // That frame was dropped
+            continue;
+        }
+
+        const int64_t write_start = steadyClockNs();
+        write_(*frame);
+        const int64_t write_end = steadyClockNs();
+        write_latency_.record(write_end - write_start);
+        end_to_end_latency_.record(write_end - frame->buffer.arrival());
+        frames_written_.fetch_add(1, std::memory_order_relaxed);
+
+        recycleFrame(frame);
+        frame = nullptr;
+        next_sequence++;
+    }
+
+    for (PipelineFrame* frame : held) {
+        if (frame != nullptr) {
+            recycleFrame(frame);
+        }
+    }
+}
+
+} // namespace converter
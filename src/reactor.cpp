@@ -0,0 +1,595 @@
+#include "reactor.hpp"
+#include <algorithm>
+#include <cerrno>
+#include <climits>
+#include <iostream>
+
+#if defined(__linux__)
+    #define CONVERTER_REACTOR_EPOLL 1
+    #include <sys/epoll.h>
+    #include <sys/eventfd.h>
+    #include <fcntl.h>
+    #include <unistd.h>
+#elif defined(__APPLE__) || defined(__FreeBSD__) || defined(__NetBSD__) || defined(__OpenBSD__)
+    #define CONVERTER_REACTOR_KQUEUE 1
+    #include <sys/types.h>
+    #include <sys/event.h>
+    #include <sys/time.h>
+    #include <fcntl.h>
+    #include <unistd.h>
+#elif defined(_WIN32)
+    #define CONVERTER_REACTOR_WSAPOLL 1
+    #include <ws2tcpip.h>
+#else
+    #define CONVERTER_REACTOR_POLL 1
+    #include <poll.h>
+    #include <fcntl.h>
+    #include <unistd.h>
+#endif
+
+namespace converter {
+
+namespace {
+
+#ifdef _WIN32
+const socket_t kNoSocket = INVALID_SOCKET;
+#else
+constexpr socket_t kNoSocket = -1;
+#endif
+
+// Ready events taken per backend call
+constexpr int kMaxEvents = 64;
+
+#if defined(CONVERTER_REACTOR_KQUEUE) || defined(CONVERTER_REACTOR_POLL)
+bool makePipe(socket_t& read_end, socket_t& write_end)
+{
+    int fds[2];
+    if (pipe(fds) != 0) {
+        return false;
+    }
+    for (int fd : fds) {
+        fcntl(fd, F_SETFL, fcntl(fd, F_GETFL) | O_NONBLOCK);
+        fcntl(fd, F_SETFD, FD_CLOEXEC);
+    }
+    read_end = fds[0];
+    write_end = fds[1];
+    return true;
+}
+#endif
+
+#ifdef CONVERTER_REACTOR_EPOLL
+uint32_t toEpoll(uint32_t interest)
+{
+    uint32_t events = 0;
+    if (interest & Reactor::Readable) {
+        events |= EPOLLIN | EPOLLRDHUP;
+    }
+    if (interest & Reactor::Writable) {
+        events |= EPOLLOUT;
+    }
+    return events;
+}
+#endif
+
+#ifdef CONVERTER_REACTOR_KQUEUE
+// Add or delete the read/write filters that differ between two interest sets
+bool applyKqueue(int kq, socket_t fd, uint32_t before, uint32_t after)
+{
+    struct kevent changes[2];
+    int count = 0;
+    const uint32_t bits[2] = {Reactor::Readable, Reactor::Writable};
+    const int16_t filters[2] = {EVFILT_READ, EVFILT_WRITE};
+
+    for (int i = 0; i < 2; i++) {
+        if ((after & bits[i]) && !(before & bits[i])) {
+            EV_SET(&changes[count++], fd, filters[i], EV_ADD, 0, 0, nullptr);
+        } else if (!(after & bits[i]) && (before & bits[i])) {
+            EV_SET(&changes[count++], fd, filters[i], EV_DELETE, 0, 0, nullptr);
+        }
+    }
+    return count == 0 || kevent(kq, changes, count, nullptr, 0, nullptr) == 0;
+}
+#endif
+
+#if defined(CONVERTER_REACTOR_POLL) || defined(CONVERTER_REACTOR_WSAPOLL)
+short toPoll(uint32_t interest)
+{
+    short events = 0;
+    if (interest & Reactor::Readable) {
+        events |= POLLIN;
+    }
+    if (interest & Reactor::Writable) {
+        events |= POLLOUT;
+    }
+    return events;
+}
+#endif
+
+} // namespace
+
+bool setNonBlocking(socket_t fd, bool enable)
+{
+#ifdef _WIN32
+    u_long mode = enable ? 1 : 0;
+    return ioctlsocket(fd, FIONBIO, &mode) == 0;
+#else
+    int flags = fcntl(fd, F_GETFL);
+    if (flags < 0) {
+        return false;
+    }
+    flags = enable ? (flags | O_NONBLOCK) : (flags & ~O_NONBLOCK);
+    return fcntl(fd, F_SETFL, flags) == 0;
+#endif
+}
+
+bool socketWouldBlock()
+{
+#ifdef _WIN32
+    return WSAGetLastError() == WSAEWOULDBLOCK;
+#else
+    return errno == EAGAIN || errno == EWOULDBLOCK || errno == EINTR;
+#endif
+}
+
+Reactor::Reactor()
+    : valid_(false)
+    , stopped_(false)
+    , poll_fd_(-1)
+    , wake_read_(kNoSocket)
+    , wake_write_(kNoSocket)
+    , next_timer_id_(1)
+{
+#if defined(CONVERTER_REACTOR_EPOLL)
+    poll_fd_ = epoll_create1(EPOLL_CLOEXEC);
+    int wake_fd = eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+    wake_read_ = wake_fd;
+    wake_write_ = wake_fd;
+    if (poll_fd_ >= 0 && wake_fd >= 0) {
+        struct epoll_event event = {};
+        event.events = EPOLLIN;
+        event.data.fd = wake_fd;
+        valid_ = epoll_ctl(poll_fd_, EPOLL_CTL_ADD, wake_fd, &event) == 0;
+    }
+#elif defined(CONVERTER_REACTOR_KQUEUE)
+    poll_fd_ = kqueue();
+    if (poll_fd_ >= 0 && makePipe(wake_read_, wake_write_)) {
+        valid_ = applyKqueue(poll_fd_, wake_read_, 0, Readable);
+    }
+#elif defined(CONVERTER_REACTOR_WSAPOLL)
+    // WSAPoll only takes sockets: wake through a UDP socket connected to itself
+    WSADATA wsa_data;
+    if (WSAStartup(MAKEWORD(2, 2), &wsa_data) == 0) {
+        SOCKET s = socket(AF_INET, SOCK_DGRAM, IPPROTO_UDP);
+        struct sockaddr_in addr = {};
+        addr.sin_family = AF_INET;
+        addr.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+        int addr_len = sizeof(addr);
+        u_long non_blocking = 1;
+        if (s != INVALID_SOCKET &&
+            bind(s, reinterpret_cast<struct sockaddr*>(&addr), sizeof(addr)) == 0 &&
+            getsockname(s, reinterpret_cast<struct sockaddr*>(&addr), &addr_len) == 0 &&
+            ::connect(s, reinterpret_cast<struct sockaddr*>(&addr), sizeof(addr)) == 0 &&
+            ioctlsocket(s, FIONBIO, &non_blocking) == 0) {
+            wake_read_ = s;
+            wake_write_ = s;
+            valid_ = true;
+        } else if (s != INVALID_SOCKET) {
+            closesocket(s);
+        }
+    }
+#else
+    valid_ = makePipe(wake_read_, wake_write_);
+#endif
+
+    if (!valid_) {
+        std::cerr << "Warning: Failed to create " << getBackendName() << " event loop" << std::endl;
+    }
+}
+
+Reactor::~Reactor()
+{
+#if defined(CONVERTER_REACTOR_WSAPOLL)
+    if (wake_read_ != kNoSocket) {
+        closesocket(wake_read_);
+    }
+    WSACleanup();
+#else
+    if (wake_read_ != kNoSocket) {
+        close(wake_read_);
+    }
+    if (wake_write_ != kNoSocket && wake_write_ != wake_read_) {
+        close(wake_write_);
+    }
+    if (poll_fd_ >= 0) {
+        close(poll_fd_);
+    }
+#endif
+}
+
+const char* Reactor::getBackendName()
+{
+#if defined(CONVERTER_REACTOR_EPOLL)
+    return "epoll";
+#elif defined(CONVERTER_REACTOR_KQUEUE)
+    return "kqueue";
+#elif defined(CONVERTER_REACTOR_WSAPOLL)
+    return "WSAPoll";
+#else
+    return "poll";
+#endif
+}
+
+Reactor::Entry* Reactor::find(socket_t fd)
+{
+    for (Entry& entry : entries_) {
+        if (entry.fd == fd) {
+            return &entry;
+        }
+    }
+    return nullptr;
+}
+
+bool Reactor::add(socket_t fd, uint32_t interest, IoHandler handler)
+{
+    if (Entry* entry = find(fd)) {
+        entry->handler = std::move(handler);
+        return modify(fd, interest);
+    }
+
+#if defined(CONVERTER_REACTOR_EPOLL)
+    struct epoll_event event = {};
+    event.events = toEpoll(interest);
+    event.data.fd = fd;
+    if (epoll_ctl(poll_fd_, EPOLL_CTL_ADD, fd, &event) != 0) {
+        return false;
+    }
+#elif defined(CONVERTER_REACTOR_KQUEUE)
+    if (!applyKqueue(poll_fd_, fd, 0, interest)) {
+        return false;
+    }
+#endif
+
+    entries_.push_back({fd, interest, std::move(handler)});
+    return true;
+}
+
+bool Reactor::modify(socket_t fd, uint32_t interest)
+{
+    Entry* entry = find(fd);
+    if (entry == nullptr) {
+        return false;
+    }
+
+#if defined(CONVERTER_REACTOR_EPOLL)
+    struct epoll_event event = {};
+    event.events = toEpoll(interest);
+    event.data.fd = fd;
+    if (epoll_ctl(poll_fd_, EPOLL_CTL_MOD, fd, &event) != 0) {
+        return false;
+    }
+#elif defined(CONVERTER_REACTOR_KQUEUE)
+    if (!applyKqueue(poll_fd_, fd, entry->interest, interest)) {
+        return false;
+    }
+#endif
+
+    entry->interest = interest;
+    return true;
+}
+
+void Reactor::remove(socket_t fd)
+{
+    Entry* entry = find(fd);
+    if (entry == nullptr) {
+        return;
+    }
+
+#if defined(CONVERTER_REACTOR_EPOLL)
+    epoll_ctl(poll_fd_, EPOLL_CTL_DEL, fd, nullptr);
+#elif defined(CONVERTER_REACTOR_KQUEUE)
+    applyKqueue(poll_fd_, fd, entry->interest, 0);
+#endif
+
+    entries_.erase(entries_.begin() + (entry - entries_.data()));
+}
+
+Reactor::TimerId Reactor::addTimer(int64_t delay_us, int64_t period_us, TimerHandler handler)
+{
+    TimerId id = next_timer_id_++;
+    timers_.push_back({id, std::chrono::steady_clock::now() + std::chrono::microseconds(std::max<int64_t>(0, delay_us)),
+                       std::chrono::microseconds(std::max<int64_t>(0, period_us)), std::move(handler)});
+    return id;
+}
+
+void Reactor::cancelTimer(TimerId id)
+{
+    timers_.erase(std::remove_if(timers_.begin(), timers_.end(), [id](const Timer& t) { return t.id == id; }),
+                  timers_.end());
+}
+
+void Reactor::stop()
+{
+    stopped_.store(true, std::memory_order_release);
+    wake();
+}
+
+void Reactor::wake()
+{
+    if (wake_write_ == kNoSocket) {
+        return;
+    }
+#if defined(CONVERTER_REACTOR_EPOLL)
+    uint64_t one = 1;
+    ssize_t written = write(wake_write_, &one, sizeof(one));
+    (void)written;  // Already pending if the counter is full
+#elif defined(CONVERTER_REACTOR_WSAPOLL)
+    char byte = 1;
+    send(wake_write_, &byte, 1, 0);
+#else
+    char byte = 1;
+    ssize_t written = write(wake_write_, &byte, 1);
+    (void)written;  // Already pending if the pipe is full
+#endif
+}
+
+void Reactor::drainWake()
+{
+    char scratch[64];
+#if defined(CONVERTER_REACTOR_WSAPOLL)
+    while (recv(wake_read_, scratch, sizeof(scratch), 0) > 0) {
+    }
+#else
+    while (read(wake_read_, scratch, sizeof(scratch)) > 0) {
+    }
+#endif
+}
+
+bool Reactor::poll(int timeout_ms)
+{
+    ready_.clear();
+
+#if defined(CONVERTER_REACTOR_EPOLL)
+    struct epoll_event events[kMaxEvents];
+    int count = epoll_wait(poll_fd_, events, kMaxEvents, timeout_ms);
+    if (count < 0) {
+        return errno == EINTR;
+    }
+    for (int i = 0; i < count; i++) {
+        const uint32_t e = events[i].events;
+        if (events[i].data.fd == wake_read_) {
+            drainWake();
+            continue;
+        }
+        uint32_t ready = 0;
+        if (e & (EPOLLIN | EPOLLRDHUP)) {
+            ready |= Readable;
+        }
+        if (e & EPOLLOUT) {
+            ready |= Writable;
+        }
+        if (e & (EPOLLERR | EPOLLHUP)) {
+            ready |= Readable | Writable;
+        }
+        ready_.push_back({events[i].data.fd, ready});
+    }
+#elif defined(CONVERTER_REACTOR_KQUEUE)
+    struct kevent events[kMaxEvents];
+    struct timespec timeout;
+    timeout.tv_sec = timeout_ms / 1000;
+    timeout.tv_nsec = static_cast<long>(timeout_ms % 1000) * 1000000;
+    int count = kevent(poll_fd_, nullptr, 0, events, kMaxEvents, timeout_ms < 0 ? nullptr : &timeout);
+    if (count < 0) {
+        return errno == EINTR;
+    }
+    for (int i = 0; i < count; i++) {
+        socket_t fd = static_cast<socket_t>(events[i].ident);
+        if (fd == wake_read_) {
+            drainWake();
+            continue;
+        }
+        uint32_t ready = events[i].filter == EVFILT_WRITE ? Writable : Readable;
+        if (events[i].flags & (EV_EOF | EV_ERROR)) {
+            ready |= Readable | Writable;
+        }
+        ready_.push_back({fd, ready});
+    }
+#else
+    #if defined(CONVERTER_REACTOR_WSAPOLL)
+    std::vector<WSAPOLLFD> fds;
+    #else
+    std::vector<struct pollfd> fds;
+    #endif
+    fds.reserve(entries_.size() + 1);
+    fds.push_back({});
+    fds.back().fd = wake_read_;
+    fds.back().events = POLLIN;
+    for (const Entry& entry : entries_) {
+        fds.push_back({});
+        fds.back().fd = entry.fd;
+        fds.back().events = toPoll(entry.interest);
+    }
+
+    #if defined(CONVERTER_REACTOR_WSAPOLL)
+    int count = WSAPoll(fds.data(), static_cast<ULONG>(fds.size()), timeout_ms);
+    if (count < 0) {
+        return false;
+    }
+    #else
+    int count = ::poll(fds.data(), static_cast<nfds_t>(fds.size()), timeout_ms);
+    if (count < 0) {
+        return errno == EINTR;
+    }
+    #endif
+
+    if (fds[0].revents != 0) {
+        drainWake();
+    }
+    for (size_t i = 1; i < fds.size(); i++) {
+        const short e = fds[i].revents;
+        uint32_t ready = 0;
+        if (e & POLLIN) {
+            ready |= Readable;
+        }
+        if (e & POLLOUT) {
+            ready |= Writable;
+        }
+        if (e & (POLLERR | POLLHUP | POLLNVAL)) {
+            ready |= Readable | Writable;
+        }
+        if (ready != 0) {
+            ready_.push_back({static_cast<socket_t>(fds[i].fd), ready});
+        }
+    }
+#endif
+
+    return true;
+}
+
+int64_t Reactor::dispatch(int64_t timeout_us, socket_t target)
+{
+    // Never sleep past the next timer
+    if (!timers_.empty()) {
+        auto next = std::min_element(timers_.begin(), timers_.end(),
+                                     [](const Timer& a, const Timer& b) { return a.due < b.due; })->due;
+        int64_t until = std::chrono::duration_cast<std::chrono::microseconds>(
+            next - std::chrono::steady_clock::now()).count();
+        until = std::max<int64_t>(0, until);
+        if (timeout_us < 0 || until < timeout_us) {
+            timeout_us = until;
+        }
+    }
+
+    // Round up so a short timeout does not turn into a busy loop
+    int timeout_ms = timeout_us < 0 ? -1 : static_cast<int>(std::min<int64_t>((timeout_us + 999) / 1000, INT_MAX));
+    if (!poll(timeout_ms)) {
+        return -1;
+    }
+
+    int64_t target_ready = 0;
+    for (size_t i = 0; i < ready_.size(); i++) {
+        const Ready ready = ready_[i];
+        if (ready.fd == target) {
+            target_ready |= ready.events;
+            continue;
+        }
+        Entry* entry = find(ready.fd);
+        if (entry != nullptr && entry->handler) {
+            IoHandler handler = entry->handler;  // The handler may remove its entry
+            handler(ready.events);
+        }
+    }
+
+    runTimers();
+    return target_ready;
+}
+
+void Reactor::runTimers()
+{
+    if (timers_.empty()) {
+        return;
+    }
+
+    const auto now = std::chrono::steady_clock::now();
+    std::vector<TimerId> due;
+    for (const Timer& timer : timers_) {
+        if (timer.due <= now) {
+            due.push_back(timer.id);
+        }
+    }
+
+    // Handlers may add or cancel timers, so look each one up again
+    for (TimerId id : due) {
+        auto it = std::find_if(timers_.begin(), timers_.end(), [id](const Timer& t) { return t.id == id; });
+        if (it == timers_.end()) {
+            continue;
+        }
+        TimerHandler handler = it->handler;
+        if (it->period.count() > 0) {
+            it->due = std::max(it->due + it->period, now);
+        } else {
+            timers_.erase(it);
+        }
+        handler();
+    }
+}
+
+bool Reactor::runOnce(int64_t timeout_us)
+{
+    if (isStopped() || !valid_) {
+        return false;
+    }
+    if (dispatch(timeout_us, kNoSocket) < 0) {
+        return false;
+    }
+    return !isStopped();
+}
+
+void Reactor::run()
+{
+    while (runOnce(-1)) {
+    }
+}
+
+bool Reactor::runFor(int64_t duration_us)
+{
+    const auto deadline = std::chrono::steady_clock::now() + std::chrono::microseconds(duration_us);
+
+    for (;;) {
+        int64_t remaining = std::chrono::duration_cast<std::chrono::microseconds>(
+            deadline - std::chrono::steady_clock::now()).count();
+        if (remaining <= 0) {
+            return !isStopped();
+        }
+        if (!runOnce(remaining)) {
+            return false;
+        }
+    }
+}
+
+Reactor::WaitResult Reactor::waitFor(socket_t fd, uint32_t interest, int64_t timeout_us)
+{
+    if (isStopped()) {
+        return WaitResult::Stopped;
+    }
+    if (!valid_) {
+        return WaitResult::Error;
+    }
+
+    Entry* entry = find(fd);
+    if (entry == nullptr) {
+        if (!add(fd, interest, nullptr)) {
+            return WaitResult::Error;
+        }
+    } else if (entry->interest != interest && !modify(fd, interest)) {
+        return WaitResult::Error;
+    }
+
+    const auto deadline = std::chrono::steady_clock::now() + std::chrono::microseconds(std::max<int64_t>(0, timeout_us));
+    bool first = true;
+
+    for (;;) {
+        if (isStopped()) {
+            return WaitResult::Stopped;
+        }
+
+        int64_t remaining = -1;
+        if (timeout_us >= 0) {
+            remaining = std::max<int64_t>(0, std::chrono::duration_cast<std::chrono::microseconds>(
+                deadline - std::chrono::steady_clock::now()).count());
+            if (remaining == 0 && !first) {
+                return WaitResult::Timeout;
+            }
+        }
+        first = false;
+
+        int64_t ready = dispatch(remaining, fd);
+        if (ready < 0) {
+            return WaitResult::Error;
+        }
+        if (ready & interest) {
+            return WaitResult::Ready;
+        }
+    }
+}
+
+} // namespace converter
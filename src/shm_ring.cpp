@@ -0,0 +1,355 @@
+#include "shm_ring.hpp"
+#include <chrono>
+#include <climits>
+#include <cerrno>
+#include <cstring>
+#include <iostream>
+#include <new>
+#include <thread>
+
+#ifndef _WIN32
+    #include <sys/mman.h>
+    #include <sys/stat.h>
+    #include <fcntl.h>
+    #include <unistd.h>
+#endif
+
+#if defined(__linux__)
+    #include <linux/futex.h>
+    #include <sys/syscall.h>
+#endif
+
+namespace converter {
+
+namespace {
+
+// Records start one page in, so the header can grow in later versions
+constexpr size_t kHeaderBytes = 4096;
+static_assert(sizeof(ShmRingHeader) <= kHeaderBytes, "ShmRingHeader must fit in the header page");
+
+// Readers without futexes poll at this period
+constexpr int64_t kPollPeriodUs = 200;
+
+/**
+ * POSIX shm names are "/name"; accept either form
+ */
+std::string shmPath(const std::string& name)
+{
+    return name.empty() || name[0] == '/' ? name : "/" + name;
+}
+
+uint64_t roundUpPowerOfTwo(uint64_t value)
+{
+    uint64_t result = 1;
+    while (result < value) {
+        result <<= 1;
+    }
+    return result;
+}
+
+#if defined(__linux__)
+// Shared (not FUTEX_PRIVATE) operations: the word lives in another process' mapping
+void futexWake(std::atomic<uint32_t>* word)
+{
+    syscall(SYS_futex, reinterpret_cast<uint32_t*>(word), FUTEX_WAKE, INT_MAX, nullptr, nullptr, 0);
+}
+
+void futexWait(const std::atomic<uint32_t>* word, uint32_t expected, int64_t timeout_us)
+{
+    struct timespec timeout;
+    struct timespec* timeout_ptr = nullptr;
+    if (timeout_us >= 0) {
+        timeout.tv_sec = static_cast<time_t>(timeout_us / 1000000);
+        timeout.tv_nsec = static_cast<long>((timeout_us % 1000000) * 1000);
+        timeout_ptr = &timeout;
+    }
+    syscall(SYS_futex, reinterpret_cast<const uint32_t*>(word), FUTEX_WAIT, expected, timeout_ptr, nullptr, 0);
+}
+#endif
+
+} // namespace
+
+// ============================================================================
+// ShmRingWriter
+// ============================================================================
+
+ShmRingWriter::~ShmRingWriter()
+{
+    close();
+}
+
+bool ShmRingWriter::create(const std::string& name, size_t capacity, int width, int height)
+{
+#ifdef _WIN32
+    (void)name;
+    (void)capacity;
+    (void)width;
+    (void)height;
+    std::cerr << "Warning: Shared-memory output is not supported on this platform" << std::endl;
+    return false;
+#else
+    close();
+
+    const std::string path = shmPath(name);
+    const uint64_t records = roundUpPowerOfTwo(std::max<uint64_t>(capacity, 1024));
+    const size_t bytes = kHeaderBytes + static_cast<size_t>(records) * sizeof(ShmEventRecord);
+
+    // Replace any ring left by an earlier run: readers still mapping it keep
+    // the old object and notice through ShmRingReader::isStale()
+    shm_unlink(path.c_str());
+    int fd = shm_open(path.c_str(), O_CREAT | O_EXCL | O_RDWR, 0644);
+    if (fd < 0) {
+        std::cerr << "Warning: Failed to create shared memory " << path << ": "
+                  << std::strerror(errno) << std::endl;
+        return false;
+    }
+    if (ftruncate(fd, static_cast<off_t>(bytes)) != 0) {
+        std::cerr << "Warning: Failed to size shared memory " << path << " to "
+                  << bytes << " bytes: " << std::strerror(errno) << std::endl;
+        ::close(fd);
+        shm_unlink(path.c_str());
+        return false;
+    }
+    void* mapping = mmap(nullptr, bytes, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+    ::close(fd);
+    if (mapping == MAP_FAILED) {
+        std::cerr << "Warning: Failed to map shared memory " << path << ": "
+                  << std::strerror(errno) << std::endl;
+        shm_unlink(path.c_str());
+        return false;
+    }
+
+    // The object is zero-filled; construct the header in place and publish
+    // the magic last so a reader never sees a half-initialized ring
+    header_ = new (mapping) ShmRingHeader();
+    header_->version = ShmRingHeader::kVersion;
+    header_->header_bytes = static_cast<uint32_t>(kHeaderBytes);
+    header_->record_bytes = static_cast<uint32_t>(sizeof(ShmEventRecord));
+    header_->capacity = records;
+    header_->width = static_cast<uint32_t>(width);
+    header_->height = static_cast<uint32_t>(height);
+    header_->session = static_cast<uint64_t>(
+        std::chrono::system_clock::now().time_since_epoch().count());
+    header_->write_index.store(0, std::memory_order_relaxed);
+    header_->reserve_index.store(0, std::memory_order_relaxed);
+    header_->notify.store(0, std::memory_order_relaxed);
+    header_->waiters.store(0, std::memory_order_relaxed);
+    header_->magic.store(ShmRingHeader::kMagic, std::memory_order_release);
+
+    records_ = reinterpret_cast<ShmEventRecord*>(static_cast<char*>(mapping) + kHeaderBytes);
+    mask_ = records - 1;
+    mapped_bytes_ = bytes;
+    name_ = path;
+    return true;
+#endif
+}
+
+void ShmRingWriter::close()
+{
+#ifndef _WIN32
+    if (header_ == nullptr) {
+        return;
+    }
+    // Wake sleeping readers so they can notice the ring going away
+    header_->notify.fetch_add(1);
+#if defined(__linux__)
+    futexWake(&header_->notify);
+#endif
+    munmap(header_, mapped_bytes_);
+    shm_unlink(name_.c_str());
+    header_ = nullptr;
+    records_ = nullptr;
+    mapped_bytes_ = 0;
+#endif
+}
+
+void ShmRingWriter::publish(uint64_t write_index)
+{
+    header_->write_index.store(write_index, std::memory_order_release);
+
+    // Bump the futex word before looking for sleepers: a reader registers as
+    // a waiter before it compares the word, so one of the two sees the other
+    header_->notify.fetch_add(1);
+    if (header_->waiters.load() != 0) {
+#if defined(__linux__)
+        futexWake(&header_->notify);
+#endif
+    }
+}
+
+// ============================================================================
+// ShmRingReader
+// ============================================================================
+
+ShmRingReader::~ShmRingReader()
+{
+    close();
+}
+
+bool ShmRingReader::open(const std::string& name)
+{
+#ifdef _WIN32
+    (void)name;
+    return false;
+#else
+    close();
+
+    const std::string path = shmPath(name);
+    // Read-write only for the waiter count; records are mapped read-only
+    int fd = shm_open(path.c_str(), O_RDWR, 0);
+    if (fd < 0) {
+        return false;
+    }
+    struct stat info;
+    if (fstat(fd, &info) != 0 || static_cast<size_t>(info.st_size) < kHeaderBytes) {
+        ::close(fd);
+        return false;
+    }
+
+    void* header_page = mmap(nullptr, kHeaderBytes, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+    if (header_page == MAP_FAILED) {
+        ::close(fd);
+        return false;
+    }
+    auto* header = static_cast<ShmRingHeader*>(header_page);
+    const bool ready = header->magic.load(std::memory_order_acquire) == ShmRingHeader::kMagic;
+    const uint64_t capacity = header->capacity;
+    const size_t bytes = kHeaderBytes + static_cast<size_t>(capacity) * sizeof(ShmEventRecord);
+    if (!ready || header->version != ShmRingHeader::kVersion ||
+        header->record_bytes != sizeof(ShmEventRecord) ||
+        capacity == 0 || (capacity & (capacity - 1)) != 0 ||
+        static_cast<size_t>(info.st_size) < bytes) {
+        munmap(header_page, kHeaderBytes);
+        ::close(fd);
+        return false;
+    }
+
+    void* mapping = mmap(nullptr, bytes, PROT_READ, MAP_SHARED, fd, 0);
+    ::close(fd);
+    if (mapping == MAP_FAILED) {
+        munmap(header_page, kHeaderBytes);
+        return false;
+    }
+
+    mutable_header_ = header;
+    header_ = static_cast<const ShmRingHeader*>(mapping);
+    records_ = reinterpret_cast<const ShmEventRecord*>(static_cast<const char*>(mapping) + header->header_bytes);
+    capacity_ = capacity;
+    mask_ = capacity - 1;
+    inode_ = static_cast<uint64_t>(info.st_ino);
+    mapped_bytes_ = bytes;
+    name_ = path;
+
+    // Start at the newest event
+    read_index_ = header_->write_index.load(std::memory_order_acquire);
+    lost_ = 0;
+    return true;
+#endif
+}
+
+void ShmRingReader::close()
+{
+#ifndef _WIN32
+    if (header_ == nullptr) {
+        return;
+    }
+    munmap(const_cast<ShmRingHeader*>(header_), mapped_bytes_);
+    munmap(mutable_header_, kHeaderBytes);
+    header_ = nullptr;
+    mutable_header_ = nullptr;
+    records_ = nullptr;
+    mapped_bytes_ = 0;
+#endif
+}
+
+size_t ShmRingReader::read(ShmEventRecord* out, size_t max_records)
+{
+    size_t copied = 0;
+    const size_t intact = consume([&](const ShmEventRecord* records, size_t count) {
+        std::memcpy(out + copied, records, count * sizeof(ShmEventRecord));
+        copied += count;
+    }, max_records);
+
+    // Overrun records are the oldest ones, at the front of the copy
+    const size_t torn = copied - intact;
+    if (torn > 0) {
+        std::memmove(out, out + torn, intact * sizeof(ShmEventRecord));
+    }
+    return intact;
+}
+
+bool ShmRingReader::wait(int64_t timeout_us)
+{
+    if (header_ == nullptr) {
+        return false;
+    }
+    const uint32_t seen = header_->notify.load();
+    if (header_->write_index.load(std::memory_order_acquire) != read_index_) {
+        return true;
+    }
+
+#if defined(__linux__)
+    mutable_header_->waiters.fetch_add(1);
+    futexWait(&header_->notify, seen, timeout_us);
+    mutable_header_->waiters.fetch_sub(1);
+#else
+    // No portable cross-process wait: poll the index
+    const auto deadline = std::chrono::steady_clock::now() + std::chrono::microseconds(timeout_us);
+    while (header_->notify.load() == seen &&
+           (timeout_us < 0 || std::chrono::steady_clock::now() < deadline)) {
+        std::this_thread::sleep_for(std::chrono::microseconds(kPollPeriodUs));
+    }
+#endif
+    return header_->write_index.load(std::memory_order_acquire) != read_index_;
+}
+
+bool ShmRingReader::isStale() const
+{
+#ifdef _WIN32
+    return false;
+#else
+    if (header_ == nullptr) {
+        return true;
+    }
+    struct stat info;
+    int fd = shm_open(name_.c_str(), O_RDONLY, 0);
+    if (fd < 0) {
+        return true;
+    }
+    const bool replaced = fstat(fd, &info) != 0 || static_cast<uint64_t>(info.st_ino) != inode_;
+    ::close(fd);
+    return replaced;
+#endif
+}
+
+uint64_t ShmRingReader::skipOverrun()
+{
+    if (header_ == nullptr) {
+        return 0;
+    }
+    const uint64_t written = header_->write_index.load(std::memory_order_acquire);
+    const uint64_t reserved = header_->reserve_index.load(std::memory_order_relaxed);
+    const uint64_t oldest = reserved > capacity_ ? reserved - capacity_ : 0;
+    if (read_index_ < oldest) {
+        lost_ += oldest - read_index_;
+        read_index_ = oldest;
+    }
+    return written > read_index_ ? written - read_index_ : 0;
+}
+
+uint64_t ShmRingReader::finishRead(uint64_t count)
+{
+    // Seqlock check: every slot the writer may have started on since is
+    // below reserve_index - capacity
+    std::atomic_thread_fence(std::memory_order_acquire);
+    const uint64_t reserved = header_->reserve_index.load(std::memory_order_relaxed);
+    const uint64_t oldest = reserved > capacity_ ? reserved - capacity_ : 0;
+    const uint64_t end = read_index_ + count;
+    const uint64_t intact = end > oldest ? end - std::max(read_index_, oldest) : 0;
+
+    lost_ += count - intact;
+    read_index_ = end;
+    return intact;
+}
+
+} // namespace converter
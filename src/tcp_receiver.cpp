@@ -1,6 +1,9 @@
 #include "tcp_receiver.hpp"
+#include "crc32c.hpp"
+#include "timestamp_engine.hpp"
 #include <iostream>
 #include <cstring>
+#include <algorithm>
 
 // Windows doesn't define ssize_t
 #ifdef _WIN32
@@ -12,13 +15,30 @@ namespace converter {
 // Static member initialization
 bool TcpReceiver::socket_lib_initialized_ = false;
 
-TcpReceiver::TcpReceiver(const Config& cfg)
+TcpReceiver::TcpReceiver(const Config& cfg, Reactor* reactor)
     : config_(cfg)
     , server_socket_(INVALID_SOCK)
     , client_socket_(INVALID_SOCK)
     , connected_(false)
+    , own_reactor_(reactor == nullptr ? std::make_unique<Reactor>() : nullptr)
+    , reactor_(reactor == nullptr ? own_reactor_.get() : reactor)
+    , blocking_socket_(INVALID_SOCK)
     , total_bytes_received_(0)
     , total_frames_received_(0)
+    , total_receive_calls_(0)
+    , poller_(cfg)
+    , registered_pool_(nullptr)
+    , header_encoding_(FrameEncoding::Dense)
+    , malformed_headers_(0)
+    , header_crc_(0)
+    , crc_errors_(0)
+    , crc_resyncs_(0)
+    , crc_error_run_(0)
+    , receive_timestamps_(false)
+    , header_timestamp_(0)
+    , receive_timestamp_(0)
+    , last_timestamp_(0)
+    , arrival_ns_(0)
 {
     initSocketLib();
 }
@@ -26,6 +46,7 @@ TcpReceiver::TcpReceiver(const Config& cfg)
 TcpReceiver::~TcpReceiver()
 {
     disconnect();
+    stopListening();
 }
 
 TcpReceiver::TcpReceiver(TcpReceiver&& other) noexcept
@@ -33,8 +54,26 @@ TcpReceiver::TcpReceiver(TcpReceiver&& other) noexcept
     , server_socket_(other.server_socket_)
     , client_socket_(other.client_socket_)
     , connected_(other.connected_)
+    , own_reactor_(std::move(other.own_reactor_))
+    , reactor_(other.reactor_)
+    , blocking_socket_(other.blocking_socket_.exchange(INVALID_SOCK))
     , total_bytes_received_(other.total_bytes_received_)
     , total_frames_received_(other.total_frames_received_)
+    , total_receive_calls_(other.total_receive_calls_)
+    , poller_(other.poller_)
+    , uring_(std::move(other.uring_))
+    , registered_pool_(other.registered_pool_)
+    , header_encoding_(other.header_encoding_)
+    , malformed_headers_(other.malformed_headers_)
+    , header_crc_(other.header_crc_)
+    , crc_errors_(other.crc_errors_)
+    , crc_resyncs_(other.crc_resyncs_)
+    , crc_error_run_(other.crc_error_run_)
+    , receive_timestamps_(other.receive_timestamps_)
+    , header_timestamp_(other.header_timestamp_)
+    , receive_timestamp_(other.receive_timestamp_)
+    , last_timestamp_(other.last_timestamp_)
+    , arrival_ns_(other.arrival_ns_)
 {
     other.server_socket_ = INVALID_SOCK;
     other.client_socket_ = INVALID_SOCK;
@@ -45,11 +84,30 @@ TcpReceiver& TcpReceiver::operator=(TcpReceiver&& other) noexcept
 {
     if (this != &other) {
         disconnect();
+        stopListening();
         server_socket_ = other.server_socket_;
         client_socket_ = other.client_socket_;
         connected_ = other.connected_;
+        own_reactor_ = std::move(other.own_reactor_);
+        reactor_ = other.reactor_;
+        blocking_socket_ = other.blocking_socket_.exchange(INVALID_SOCK);
         total_bytes_received_ = other.total_bytes_received_;
         total_frames_received_ = other.total_frames_received_;
+        total_receive_calls_ = other.total_receive_calls_;
+        poller_ = other.poller_;
+        uring_ = std::move(other.uring_);
+        registered_pool_ = other.registered_pool_;
+        header_encoding_ = other.header_encoding_;
+        malformed_headers_ = other.malformed_headers_;
+        header_crc_ = other.header_crc_;
+        crc_errors_ = other.crc_errors_;
+        crc_resyncs_ = other.crc_resyncs_;
+        crc_error_run_ = other.crc_error_run_;
+        receive_timestamps_ = other.receive_timestamps_;
+        header_timestamp_ = other.header_timestamp_;
+        receive_timestamp_ = other.receive_timestamp_;
+        last_timestamp_ = other.last_timestamp_;
+        arrival_ns_ = other.arrival_ns_;
         other.server_socket_ = INVALID_SOCK;
         other.client_socket_ = INVALID_SOCK;
         other.connected_ = false;
@@ -83,16 +141,12 @@ void TcpReceiver::cleanupSocketLib()
 #endif
 }
 
-bool TcpReceiver::connect()
+bool TcpReceiver::startListening()
 {
-    if (connected_) {
-        std::cerr << "Already connected" << std::endl;
+    if (server_socket_ != INVALID_SOCK) {
         return true;
     }
-    
-    // Close any existing sockets
-    disconnect();
-    
+
     // Create server socket
     server_socket_ = socket(AF_INET, SOCK_STREAM, IPPROTO_TCP);
     if (server_socket_ == INVALID_SOCK) {
@@ -106,6 +160,15 @@ bool TcpReceiver::connect()
                    reinterpret_cast<const char*>(&reuse), sizeof(reuse)) < 0) {
         std::cerr << "Warning: Failed to set SO_REUSEADDR" << std::endl;
     }
+
+    // Accepted sockets inherit the receive buffer; it has to be set before
+    // the handshake for the window scale to match, and a connection may
+    // complete in the backlog before accept()
+    int rcvbuf = config_.recv_buffer_size;
+    if (setsockopt(server_socket_, SOL_SOCKET, SO_RCVBUF,
+                   reinterpret_cast<const char*>(&rcvbuf), sizeof(rcvbuf)) < 0) {
+        std::cerr << "Warning: Failed to set receive buffer size" << std::endl;
+    }
     
     // Setup server address - bind to all interfaces
     struct sockaddr_in server_addr;
@@ -119,29 +182,68 @@ bool TcpReceiver::connect()
     
     if (bind(server_socket_, reinterpret_cast<struct sockaddr*>(&server_addr), sizeof(server_addr)) < 0) {
         std::cerr << "Failed to bind: " << SOCKET_ERROR_CODE << std::endl;
-        disconnect();
+        stopListening();
         return false;
     }
     
     // Listen for connections
     if (listen(server_socket_, 1) < 0) {
         std::cerr << "Failed to listen: " << SOCKET_ERROR_CODE << std::endl;
-        disconnect();
+        stopListening();
+        return false;
+    }
+
+    // Wait for the FPGA on the event loop rather than in accept(), so
+    // interrupt() can end the wait
+    if (!setNonBlocking(server_socket_, true)) {
+        std::cerr << "Failed to make listening socket non-blocking: " << SOCKET_ERROR_CODE << std::endl;
+        stopListening();
         return false;
     }
     
     std::cout << "Listening on port " << config_.camera_port << "..." << std::endl;
+    return true;
+}
+
+bool TcpReceiver::connect()
+{
+    if (connected_) {
+        std::cerr << "Already connected" << std::endl;
+        return true;
+    }
+    
+    // Close any previous connection; the listening socket stays open
+    disconnect();
+    if (!startListening()) {
+        return false;
+    }
+    
     std::cout << "Waiting for FPGA to connect..." << std::endl;
     
     // Accept connection from FPGA
     struct sockaddr_in client_addr;
     socklen_t client_len = sizeof(client_addr);
     
-    client_socket_ = accept(server_socket_, reinterpret_cast<struct sockaddr*>(&client_addr), &client_len);
-    if (client_socket_ == INVALID_SOCK) {
-        std::cerr << "Failed to accept connection: " << SOCKET_ERROR_CODE << std::endl;
-        disconnect();
-        return false;
+    for (;;) {
+        client_len = sizeof(client_addr);
+        client_socket_ = accept(server_socket_, reinterpret_cast<struct sockaddr*>(&client_addr), &client_len);
+        if (client_socket_ != INVALID_SOCK) {
+            break;
+        }
+        if (!socketWouldBlock()) {
+            std::cerr << "Failed to accept connection: " << SOCKET_ERROR_CODE << std::endl;
+            return false;
+        }
+
+        Reactor::WaitResult wait = reactor_->waitFor(server_socket_, Reactor::Readable);
+        if (wait == Reactor::WaitResult::Stopped) {
+            std::cerr << "Stopped waiting for FPGA connection" << std::endl;
+            return false;
+        }
+        if (wait == Reactor::WaitResult::Error) {
+            std::cerr << "Failed to wait for FPGA connection: event loop error" << std::endl;
+            return false;
+        }
     }
     
     // Get client IP for logging
@@ -149,13 +251,6 @@ bool TcpReceiver::connect()
     inet_ntop(AF_INET, &client_addr.sin_addr, client_ip, sizeof(client_ip));
     std::cout << "FPGA connected from " << client_ip << ":" << ntohs(client_addr.sin_port) << std::endl;
     
-    // Set receive buffer size on client socket
-    int rcvbuf = config_.recv_buffer_size;
-    if (setsockopt(client_socket_, SOL_SOCKET, SO_RCVBUF, 
-                   reinterpret_cast<const char*>(&rcvbuf), sizeof(rcvbuf)) < 0) {
-        std::cerr << "Warning: Failed to set receive buffer size" << std::endl;
-    }
-    
     // Disable Nagle's algorithm for lower latency
     int flag = 1;
     if (setsockopt(client_socket_, IPPROTO_TCP, TCP_NODELAY,
@@ -163,9 +258,58 @@ bool TcpReceiver::connect()
         std::cerr << "Warning: Failed to disable Nagle's algorithm" << std::endl;
     }
     
+#ifdef __linux__
+    if (config_.tcp_backend == TcpBackend::IoUring) {
+        uring_ = std::make_unique<IoUringEngine>();
+        if (!uring_->init(client_socket_)) {
+            std::cerr << "Warning: io_uring unavailable, falling back to recv()" << std::endl;
+            uring_.reset();
+        }
+    }
+
+    if (config_.receive_mode == ReceiveMode::BusyPoll) {
+        if (uring_) {
+            std::cerr << "Warning: busy polling needs the recv() backend, waiting in io_uring" << std::endl;
+        } else {
+            configureBusyPoll(client_socket_, config_);
+        }
+    }
+
+    // Kernel/NIC receive stamps arrive as recvmsg() control data
+    const bool wants_receive_timestamps = config_.timestamp_source == TimestampSource::KernelReceive ||
+                                          config_.timestamp_source == TimestampSource::HardwareReceive;
+    receive_timestamps_ = false;
+    if (wants_receive_timestamps) {
+        if (uring_) {
+            std::cerr << "Warning: receive timestamps need the recv() backend, "
+                      << "stamping io_uring frames on completion" << std::endl;
+        } else if (enableReceiveTimestamps(client_socket_, config_.timestamp_source)) {
+            receive_timestamps_ = true;
+        } else {
+            std::cerr << "Warning: Failed to enable receive timestamps, stamping frames on arrival" << std::endl;
+        }
+    }
+#else
+    if (config_.tcp_backend == TcpBackend::IoUring) {
+        std::cerr << "Warning: io_uring is Linux only, using recv()" << std::endl;
+    }
+    if (config_.timestamp_source == TimestampSource::KernelReceive ||
+        config_.timestamp_source == TimestampSource::HardwareReceive) {
+        std::cerr << "Warning: receive timestamps are Linux only, stamping frames on arrival" << std::endl;
+    }
+#endif
+
+    // recv() waits on the event loop; io_uring's MSG_WAITALL receives need
+    // a blocking socket (accepted sockets inherit O_NONBLOCK on some systems)
+    if (!setNonBlocking(client_socket_, !uring_)) {
+        std::cerr << "Warning: Failed to set client socket blocking mode" << std::endl;
+    }
+    blocking_socket_ = uring_ ? client_socket_ : INVALID_SOCK;
+
     connected_ = true;
     total_bytes_received_ = 0;
     total_frames_received_ = 0;
+    total_receive_calls_ = 0;
     
     std::cout << "Connection established successfully!" << std::endl;
     return true;
@@ -173,8 +317,14 @@ bool TcpReceiver::connect()
 
 void TcpReceiver::disconnect()
 {
+    // The ring goes first: it refers to the client socket
+    blocking_socket_ = INVALID_SOCK;
+    uring_.reset();
+    registered_pool_ = nullptr;
+
     // Close client socket
     if (client_socket_ != INVALID_SOCK) {
+        reactor_->remove(client_socket_);
 #ifdef _WIN32
         closesocket(client_socket_);
 #else
@@ -183,8 +333,13 @@ void TcpReceiver::disconnect()
         client_socket_ = INVALID_SOCK;
     }
     
-    // Close server socket
+    connected_ = false;
+}
+
+void TcpReceiver::stopListening()
+{
     if (server_socket_ != INVALID_SOCK) {
+        reactor_->remove(server_socket_);
 #ifdef _WIN32
         closesocket(server_socket_);
 #else
@@ -192,8 +347,6 @@ void TcpReceiver::disconnect()
 #endif
         server_socket_ = INVALID_SOCK;
     }
-    
-    connected_ = false;
 }
 
 bool TcpReceiver::isConnected() const
@@ -201,15 +354,77 @@ bool TcpReceiver::isConnected() const
     return connected_;
 }
 
-bool TcpReceiver::receiveExact(uint8_t* buffer, size_t size)
+void TcpReceiver::interrupt()
 {
+    reactor_->stop();
+
+#ifdef __linux__
+    // A MSG_WAITALL receive in io_uring does not wait on the reactor
+    socket_t blocking = blocking_socket_.exchange(INVALID_SOCK);
+    if (blocking != INVALID_SOCK) {
+        shutdown(blocking, SHUT_RDWR);
+    }
+#endif
+}
+
+void TcpReceiver::resume()
+{
+    reactor_->resume();
+}
+
+bool TcpReceiver::receiveExact(uint8_t* buffer, size_t size, uint32_t* crc)
+{
+    if (uring_) {
+        int64_t received = uring_->receiveExact(buffer, size);
+        if (received < static_cast<int64_t>(size)) {
+            if (received >= 0) {
+                std::cerr << "Connection closed by FPGA" << std::endl;
+            } else {
+                std::cerr << "Receive error: " << -received << std::endl;
+            }
+            total_bytes_received_ += static_cast<uint64_t>(std::max<int64_t>(received, 0));
+            connected_ = false;
+            return false;
+        }
+        total_bytes_received_ += size;
+        if (arrival_ns_ == 0) {
+            arrival_ns_ = steadyClockNs();
+        }
+        if (crc != nullptr) {
+            *crc = crc32c(buffer, size, *crc);
+        }
+        return true;
+    }
+
     size_t total_received = 0;
     
     while (total_received < size) {
+#ifdef __linux__
+        ssize_t received = receive_timestamps_
+            ? receiveStamped(buffer + total_received, size - total_received)
+            : recv(client_socket_, buffer + total_received, size - total_received, 0);
+#else
         ssize_t received = recv(client_socket_, 
                                 reinterpret_cast<char*>(buffer + total_received),
                                 size - total_received, 
                                 0);
+#endif
+        total_receive_calls_++;
+
+        if (received < 0 && socketWouldBlock()) {
+            if (poller_.shouldSpin() && !reactor_->isStopped()) {
+                continue;
+            }
+            Reactor::WaitResult wait = reactor_->waitFor(client_socket_, Reactor::Readable);
+            if (wait == Reactor::WaitResult::Ready) {
+                continue;
+            }
+            if (wait == Reactor::WaitResult::Error) {
+                std::cerr << "Receive error: event loop failed" << std::endl;
+                connected_ = false;
+            }
+            return false;  // Stopped: still connected, the caller is shutting down
+        }
         
         if (received <= 0) {
             if (received == 0) {
@@ -221,57 +436,281 @@ bool TcpReceiver::receiveExact(uint8_t* buffer, size_t size)
             return false;
         }
         
+        poller_.received();
+        if (crc != nullptr) {
+            *crc = crc32c(buffer + total_received, static_cast<size_t>(received), *crc);
+        }
         total_received += received;
         total_bytes_received_ += received;
+        if (arrival_ns_ == 0) {
+            arrival_ns_ = steadyClockNs();
+        }
     }
     
     return true;
 }
 
-bool TcpReceiver::receiveFrame(std::vector<uint8_t>& buffer)
+#ifdef __linux__
+ssize_t TcpReceiver::receiveStamped(uint8_t* buffer, size_t size)
 {
-    if (!connected_) {
-        std::cerr << "Not connected" << std::endl;
-        return false;
+    struct iovec iov;
+    iov.iov_base = buffer;
+    iov.iov_len = size;
+
+    alignas(struct cmsghdr) uint8_t control[kReceiveTimestampControlBytes];
+    struct msghdr msg;
+    std::memset(&msg, 0, sizeof(msg));
+    msg.msg_iov = &iov;
+    msg.msg_iovlen = 1;
+    msg.msg_control = control;
+    msg.msg_controllen = sizeof(control);
+
+    ssize_t received = recvmsg(client_socket_, &msg, 0);
+    if (received > 0) {
+        // The stamp of the newest segment this call returned
+        int64_t stamp = readReceiveTimestamp(msg, config_.timestamp_source);
+        if (stamp != 0) {
+            receive_timestamp_ = stamp;
+        }
     }
-    
-    int frame_size = getFrameSize();
-    
+    return received;
+}
+#endif
+
+int64_t TcpReceiver::stampFrame()
+{
+    switch (config_.timestamp_source) {
+        case TimestampSource::FpgaHeader:
+            last_timestamp_ = static_cast<int64_t>(header_timestamp_);
+            break;
+        case TimestampSource::KernelReceive:
+        case TimestampSource::HardwareReceive:
+            last_timestamp_ = receive_timestamps_ && receive_timestamp_ != 0 ? receive_timestamp_ : wallClockNs();
+            break;
+        case TimestampSource::SteadyClock:
+            last_timestamp_ = steadyClockNs();
+            break;
+        default:
+            last_timestamp_ = 0;
+            break;
+    }
+    return last_timestamp_;
+}
+
+bool TcpReceiver::receiveFrameSize(size_t& frame_size)
+{
+    frame_size = static_cast<size_t>(getFrameSize());
+
     // If has header, read frame size from header first
     if (config_.has_header) {
+        // Little-endian, header_size bytes (1-4, see validateConfig())
+        uint8_t header[sizeof(uint32_t)] = {};
+        const size_t header_bytes = static_cast<size_t>(std::clamp(config_.header_size, 1, 4));
+        if (!receiveExact(header, header_bytes)) {
+            return false;
+        }
         uint32_t header_frame_size = 0;
-        
-        if (!receiveExact(reinterpret_cast<uint8_t*>(&header_frame_size), config_.header_size)) {
+        for (size_t i = 0; i < header_bytes; i++) {
+            header_frame_size |= static_cast<uint32_t>(header[i]) << (8 * i);
+        }
+
+        // The top bits select the encoding. An unknown one leaves the payload
+        // length unknown, so the stream cannot be followed past it: reset the
+        // connection like a CRC resync instead of reading pixels
+        uint32_t encoding = header_frame_size >> kFrameEncodingShift;
+        if (encoding > static_cast<uint32_t>(FrameEncoding::ByteList)) {
+            malformed_headers_++;
+            std::cerr << "Warning: Unknown frame encoding " << encoding << " in header, "
+                      << "resetting the connection to resync" << std::endl;
+            connected_ = false;
             return false;
         }
-        
-        // Use header frame size if valid, otherwise use configured size
-        if (header_frame_size > 0 && header_frame_size < 100000000) {  // Sanity check: < 100MB
+        header_encoding_ = static_cast<FrameEncoding>(encoding);
+        header_frame_size &= kFrameSizeMask;
+
+        // A compressed size is always the payload length; 0 is an empty frame
+        // (no events). A dense size only replaces the configured one when it
+        // looks sane
+        if (header_encoding_ != FrameEncoding::Dense) {
+            frame_size = header_frame_size;
+        } else if (header_frame_size > 0 && header_frame_size < 100000000) {  // Sanity check: < 100MB
             frame_size = header_frame_size;
         }
-        
+
+        // FPGA timestamp follows the size
+        if (config_.timestamp_header_bytes() > 0 &&
+            !receiveExact(reinterpret_cast<uint8_t*>(&header_timestamp_), sizeof(header_timestamp_))) {
+            return false;
+        }
+
+        // Then the CRC of everything after it
+        if (config_.frame_crc_header_bytes() > 0 &&
+            !receiveExact(reinterpret_cast<uint8_t*>(&header_crc_), sizeof(header_crc_))) {
+            return false;
+        }
+
         if (config_.verbose) {
-            std::cout << "Frame header: size = " << frame_size << " bytes" << std::endl;
+            std::cout << "Frame header: size = " << frame_size << " bytes ("
+                      << frameEncodingToString(header_encoding_) << ")" << std::endl;
         }
     }
-    
-    // Resize buffer and receive frame data
-    buffer.resize(frame_size);
-    
-    if (!receiveExact(buffer.data(), frame_size)) {
+
+    return true;
+}
+
+bool TcpReceiver::checkFrameCrc(uint32_t crc)
+{
+    if (crc == header_crc_) {
+        crc_error_run_ = 0;
+        return true;
+    }
+
+    crc_errors_++;
+    std::cerr << "Warning: Frame CRC mismatch (0x" << std::hex << crc << ", header says 0x" << header_crc_
+              << std::dec << "), dropping frame" << std::endl;
+    if (++crc_error_run_ >= kCrcErrorsBeforeResync) {
+        std::cerr << "Warning: " << crc_error_run_ << " frames in a row failed the CRC check, "
+                  << "resetting the connection to resync" << std::endl;
+        crc_resyncs_++;
+        crc_error_run_ = 0;
+        connected_ = false;
+    }
+    return false;
+}
+
+bool TcpReceiver::discardExact(size_t size, uint8_t* scratch, size_t scratch_size)
+{
+    while (size > 0) {
+        size_t chunk = std::min(size, scratch_size);
+        if (!receiveExact(scratch, chunk)) {
+            return false;
+        }
+        size -= chunk;
+    }
+    return true;
+}
+
+bool TcpReceiver::receiveFrame(std::vector<uint8_t>& buffer)
+{
+    if (!connected_) {
+        std::cerr << "Not connected" << std::endl;
         return false;
     }
-    
+
+    const size_t occupancy_bytes = static_cast<size_t>(config_.occupancy_map_bytes());
+    uint32_t crc = 0;
+    uint32_t* const frame_crc = config_.frame_crc_header_bytes() > 0 ? &crc : nullptr;
+
+    for (;;) {
+        size_t frame_size = 0;
+        crc = 0;
+        if (!receiveFrameSize(frame_size)) {
+            return false;
+        }
+
+        // No room to hand an occupancy bitmap back, so just skip it
+        if (occupancy_bytes > 0) {
+            buffer.resize(occupancy_bytes);
+            if (!receiveExact(buffer.data(), occupancy_bytes, frame_crc)) {
+                return false;
+            }
+        }
+
+        // Resize buffer and receive frame data
+        buffer.resize(frame_size);
+
+        if (!receiveExact(buffer.data(), frame_size, frame_crc)) {
+            return false;
+        }
+        if (frame_crc == nullptr || checkFrameCrc(crc)) {
+            break;
+        }
+        if (!connected_) {
+            return false;
+        }
+    }
+    stampFrame();
+
     total_frames_received_++;
-    
+
+    if (config_.verbose) {
+        std::cout << "Received frame " << total_frames_received_
+                  << " (" << buffer.size() << " bytes)" << std::endl;
+    }
+
+    return true;
+}
+
+bool TcpReceiver::receiveFrame(FrameHandle& frame)
+{
+    if (!connected_) {
+        std::cerr << "Not connected" << std::endl;
+        return false;
+    }
+
+    // The occupancy bitmap follows the size header and goes to the end of the slot
+    const size_t occupancy_bytes = static_cast<size_t>(config_.occupancy_map_bytes());
+    const size_t frame_capacity = frame.capacity() - occupancy_bytes;
+    uint8_t* occupancy = frame.reserveOccupancy(occupancy_bytes);
+    uint32_t crc = 0;
+    uint32_t* const frame_crc = config_.frame_crc_header_bytes() > 0 ? &crc : nullptr;
+    size_t frame_size = 0;
+
+    for (;;) {
+        arrival_ns_ = 0;
+        crc = 0;
+        if (!receiveFrameSize(frame_size) || !receiveExact(occupancy, occupancy_bytes, frame_crc)) {
+            return false;
+        }
+
+        // A frame that does not fit the slot is skipped whole to stay aligned
+        if (frame_size > frame_capacity) {
+            std::cerr << "Warning: Frame of " << frame_size << " bytes exceeds pool slot ("
+                      << frame_capacity << " bytes), dropping it" << std::endl;
+            if (!discardExact(frame_size, frame.data(), frame_capacity)) {
+                return false;
+            }
+            continue;
+        }
+
+        // Hand the whole pool to io_uring once so receives into it stay pinned
+        if (uring_ && registered_pool_ != frame.pool()) {
+            registered_pool_ = frame.pool();
+            uring_->registerRegion(registered_pool_->baseAddress(),
+                                   registered_pool_->slotCount() * registered_pool_->slotSize());
+        }
+
+        // recv() lands directly in the pool slot; the CRC follows each chunk
+        if (!receiveExact(frame.data(), frame_size, frame_crc)) {
+            return false;
+        }
+        if (frame_crc == nullptr || checkFrameCrc(crc)) {
+            break;
+        }
+        if (!connected_) {
+            return false;   // Lost alignment: reconnect
+        }
+    }
+    frame.setSize(frame_size);
+    frame.setTimestamp(stampFrame());
+    frame.setEncoding(header_encoding_);
+    frame.setArrival(arrival_ns_);
+
+    total_frames_received_++;
+
     if (config_.verbose) {
-        std::cout << "Received frame " << total_frames_received_ 
+        std::cout << "Received frame " << total_frames_received_
                   << " (" << frame_size << " bytes)" << std::endl;
     }
-    
+
     return true;
 }
 
+uint64_t TcpReceiver::getTotalReceiveCalls() const
+{
+    return uring_ ? uring_->getSubmitCalls() : total_receive_calls_;
+}
+
 int TcpReceiver::getFrameSize() const
 {
     return config_.frame_size();
@@ -0,0 +1,138 @@
+#include "thread_placement.hpp"
+#include <filesystem>
+#include <fstream>
+
+#ifdef __linux__
+    #include <pthread.h>
+    #include <sched.h>
+    #include <sys/mman.h>
+#endif
+
+namespace converter {
+
+bool pinThread(std::thread& thread, const std::vector<int>& cpus)
+{
+#ifdef __linux__
+    cpu_set_t set;
+    CPU_ZERO(&set);
+    for (int cpu : cpus) {
+        if (cpu >= 0 && cpu < CPU_SETSIZE) {
+            CPU_SET(cpu, &set);
+        }
+    }
+    return CPU_COUNT(&set) > 0 && pthread_setaffinity_np(thread.native_handle(), sizeof(set), &set) == 0;
+#else
+    (void)thread;
+    (void)cpus;
+    return false;
+#endif
+}
+
+bool setRealtimePriority(std::thread& thread, int priority)
+{
+#ifdef __linux__
+    sched_param param{};
+    param.sched_priority = priority;
+    return priority >= sched_get_priority_min(SCHED_FIFO) && priority <= sched_get_priority_max(SCHED_FIFO) &&
+           pthread_setschedparam(thread.native_handle(), SCHED_FIFO, &param) == 0;
+#else
+    (void)thread;
+    (void)priority;
+    return false;
+#endif
+}
+
+ThreadPlacement getThreadPlacement(std::thread& thread, std::string role)
+{
+    ThreadPlacement placement;
+    placement.role = std::move(role);
+#ifdef __linux__
+    cpu_set_t set;
+    CPU_ZERO(&set);
+    if (pthread_getaffinity_np(thread.native_handle(), sizeof(set), &set) == 0) {
+        for (int cpu = 0; cpu < CPU_SETSIZE; cpu++) {
+            if (CPU_ISSET(cpu, &set)) {
+                placement.cpus.push_back(cpu);
+            }
+        }
+    }
+    int policy = SCHED_OTHER;
+    sched_param param{};
+    if (pthread_getschedparam(thread.native_handle(), &policy, &param) == 0 && policy == SCHED_FIFO) {
+        placement.realtime_priority = param.sched_priority;
+    }
+#else
+    (void)thread;
+#endif
+    return placement;
+}
+
+int cpuNumaNode(int cpu)
+{
+#ifdef __linux__
+    // cpuN/ holds a nodeK link for the node the core belongs to
+    std::error_code error;
+    const std::filesystem::path dir("/sys/devices/system/cpu/cpu" + std::to_string(cpu));
+    for (const auto& entry : std::filesystem::directory_iterator(dir, error)) {
+        const std::string name = entry.path().filename().string();
+        if (name.size() > 4 && name.compare(0, 4, "node") == 0 &&
+            name.find_first_not_of("0123456789", 4) == std::string::npos) {
+            return std::stoi(name.substr(4));
+        }
+    }
+#else
+    (void)cpu;
+#endif
+    return -1;
+}
+
+int interfaceNumaNode(const std::string& interface)
+{
+#ifdef __linux__
+    if (interface.empty() || interface.find('/') != std::string::npos) {
+        return -1;
+    }
+    std::ifstream file("/sys/class/net/" + interface + "/device/numa_node");
+    int node = -1;
+    if (file >> node) {
+        return node;
+    }
+#else
+    (void)interface;
+#endif
+    return -1;
+}
+
+bool lockProcessMemory()
+{
+#ifdef __linux__
+    return mlockall(MCL_CURRENT | MCL_FUTURE) == 0;
+#else
+    return false;
+#endif
+}
+
+std::string formatCpuList(const std::vector<int>& cpus)
+{
+    if (cpus.empty()) {
+        return "none";
+    }
+    std::string text;
+    for (size_t i = 0; i < cpus.size();) {
+        size_t end = i + 1;
+        while (end < cpus.size() && cpus[end] == cpus[end - 1] + 1) {
+            end++;
+        }
+        if (!text.empty()) {
+            text += ",";
+        }
+        text += std::to_string(cpus[i]);
+        if (end - i > 1) {
+            text += "-" + std::to_string(cpus[end - 1]);
+        }
+        i = end;
+    }
+    return text;
+}
+
+} // namespace converter
@@ -0,0 +1,190 @@
+#include "timestamp_engine.hpp"
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstring>
+#include <iostream>
+
+#ifdef __linux__
+    #include <sys/socket.h>
+    #include <linux/net_tstamp.h>
+    #include <time.h>
+#endif
+
+namespace converter {
+
+namespace {
+
+constexpr double kPi = 3.14159265358979323846;
+
+// How far the tracked period may wander from frame_interval_us
+constexpr double kMaxPeriodDeviation = 0.25;
+
+// Errors beyond this many periods (or 100 ms) mean the stream restarted
+constexpr double kResyncPeriods = 16.0;
+constexpr double kMinResyncNs = 100e6;
+
+} // namespace
+
+int64_t wallClockNs()
+{
+#ifdef __linux__
+    struct timespec ts;
+    clock_gettime(CLOCK_REALTIME, &ts);
+    return static_cast<int64_t>(ts.tv_sec) * 1000000000 + ts.tv_nsec;
+#else
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(
+        std::chrono::system_clock::now().time_since_epoch()).count();
+#endif
+}
+
+int64_t steadyClockNs()
+{
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(
+        std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+TimestampEngine::TimestampEngine(const Config& cfg)
+    : config_(cfg)
+    , source_(cfg.timestamp_source)
+    , steady_to_wall_ns_(wallClockNs() - steadyClockNs())
+    , locked_(false)
+    , phase_(0.0)
+    , period_(0.0)
+    , nominal_period_(static_cast<double>(std::max<int64_t>(1, cfg.frame_interval_us)) * 1000.0)
+    , next_allowed_us_(0)
+    , resyncs_(0)
+    , late_frames_(0)
+    , jitter_ns_(0)
+{
+    // Second-order loop with 1/sqrt(2) damping (as in JACK's DLL): omega = 2 pi B T
+    const double omega = 2.0 * kPi * std::max(0.0, cfg.timestamp_pll_bandwidth_hz) * nominal_period_ * 1e-9;
+    gain_phase_ = std::min(1.0, std::sqrt(2.0) * omega);
+    gain_period_ = omega * omega;
+    resync_threshold_ = std::max(kMinResyncNs, kResyncPeriods * nominal_period_);
+
+    if (source_ == TimestampSource::FpgaHeader &&
+        (cfg.protocol != Protocol::TCP || cfg.timestamp_header_bytes() == 0)) {
+        std::cerr << "Warning: FpgaHeader timestamps need TCP with has_header, using the frame counter"
+                  << std::endl;
+        source_ = TimestampSource::FrameCounter;
+    }
+}
+
+int64_t TimestampEngine::frameTimestamp(int64_t raw, uint64_t frame_number)
+{
+    int64_t timestamp_us;
+
+    switch (source_) {
+        case TimestampSource::FpgaHeader:
+            // Split so nanosecond ticks since the epoch cannot overflow
+            timestamp_us = raw / 1000 * config_.fpga_timestamp_tick_ns
+                           + raw % 1000 * config_.fpga_timestamp_tick_ns / 1000;
+            break;
+
+        case TimestampSource::KernelReceive:
+        case TimestampSource::HardwareReceive:
+        case TimestampSource::SteadyClock: {
+            if (raw == 0) {
+                // The receiver could not stamp this frame; use the time it reached us
+                raw = source_ == TimestampSource::SteadyClock ? steadyClockNs() : wallClockNs();
+            }
+            int64_t wall_ns = source_ == TimestampSource::SteadyClock ? raw + steady_to_wall_ns_ : raw;
+            timestamp_us = (config_.timestamp_pll ? track(wall_ns) : wall_ns) / 1000;
+            break;
+        }
+
+        case TimestampSource::FrameCounter:
+        default:
+            timestamp_us = static_cast<int64_t>(frame_number) * config_.frame_interval_us;
+            break;
+    }
+
+    // Never before the end of the previous frame's readout
+    timestamp_us = std::max(timestamp_us, next_allowed_us_);
+    next_allowed_us_ = timestamp_us + std::max<int64_t>(0, config_.frame_readout_us);
+    return timestamp_us;
+}
+
+int64_t TimestampEngine::track(int64_t measured_ns)
+{
+    const double measured = static_cast<double>(measured_ns);
+
+    if (!locked_) {
+        locked_ = true;
+        phase_ = measured;
+        period_ = nominal_period_;
+        return measured_ns;
+    }
+
+    double predicted = phase_ + period_;
+    double error = measured - predicted;
+
+    if (std::abs(error) > resync_threshold_) {
+        resyncs_.fetch_add(1, std::memory_order_relaxed);
+        phase_ = measured;
+        return measured_ns;
+    }
+
+    // A late frame (jitter, a sender catching up, or a frame lost upstream)
+    // moves the phase by only gain_phase_ of its error; the loop absorbs a
+    // lost frame over about 1 / gain_phase_ frames
+    if (error > 0.5 * period_) {
+        late_frames_.fetch_add(1, std::memory_order_relaxed);
+    }
+
+    phase_ = predicted + gain_phase_ * error;
+    period_ += gain_period_ * error;
+    period_ = std::clamp(period_, nominal_period_ * (1.0 - kMaxPeriodDeviation),
+                         nominal_period_ * (1.0 + kMaxPeriodDeviation));
+
+    // Running mean of |error|, 1/64 weight per frame
+    int64_t jitter = jitter_ns_.load(std::memory_order_relaxed);
+    jitter += (static_cast<int64_t>(std::abs(error)) - jitter) / 64;
+    jitter_ns_.store(jitter, std::memory_order_relaxed);
+
+    return static_cast<int64_t>(phase_);
+}
+
+#ifdef __linux__
+bool enableReceiveTimestamps(int fd, TimestampSource source)
+{
+    if (source == TimestampSource::KernelReceive) {
+        int on = 1;
+        return setsockopt(fd, SOL_SOCKET, SO_TIMESTAMPNS, &on, sizeof(on)) == 0;
+    }
+    if (source == TimestampSource::HardwareReceive) {
+        int flags = SOF_TIMESTAMPING_RX_HARDWARE | SOF_TIMESTAMPING_RAW_HARDWARE
+                    | SOF_TIMESTAMPING_RX_SOFTWARE | SOF_TIMESTAMPING_SOFTWARE;
+        return setsockopt(fd, SOL_SOCKET, SO_TIMESTAMPING, &flags, sizeof(flags)) == 0;
+    }
+    return true;
+}
+
+int64_t readReceiveTimestamp(const msghdr& msg, TimestampSource source)
+{
+    for (cmsghdr* cmsg = CMSG_FIRSTHDR(const_cast<msghdr*>(&msg)); cmsg != nullptr;
+         cmsg = CMSG_NXTHDR(const_cast<msghdr*>(&msg), cmsg)) {
+        if (cmsg->cmsg_level != SOL_SOCKET) {
+            continue;
+        }
+
+        if (source == TimestampSource::KernelReceive && cmsg->cmsg_type == SCM_TIMESTAMPNS) {
+            struct timespec ts;
+            std::memcpy(&ts, CMSG_DATA(cmsg), sizeof(ts));
+            return static_cast<int64_t>(ts.tv_sec) * 1000000000 + ts.tv_nsec;
+        }
+
+        if (source == TimestampSource::HardwareReceive && cmsg->cmsg_type == SCM_TIMESTAMPING) {
+            // [0] software, [1] deprecated, [2] raw hardware
+            struct timespec ts[3];
+            std::memcpy(ts, CMSG_DATA(cmsg), sizeof(ts));
+            const struct timespec& best = (ts[2].tv_sec != 0 || ts[2].tv_nsec != 0) ? ts[2] : ts[0];
+            return static_cast<int64_t>(best.tv_sec) * 1000000000 + best.tv_nsec;
+        }
+    }
+    return 0;
+}
+#endif
+
+} // namespace converter
@@ -0,0 +1,626 @@
+#include "unpack_kernels.hpp"
+
+// Pick the SIMD flavours this build can contain. x86 kernels are compiled with
+// per-function target attributes so the binary still runs on older CPUs; the
+// CPU is queried once at runtime before any of them is used.
+#if defined(__x86_64__) || defined(_M_X64) || defined(__i386__) || defined(_M_IX86)
+    #define CONVERTER_X86_KERNELS 1
+    #include <immintrin.h>
+    #if defined(_MSC_VER) && !defined(__clang__)
+        #define CONVERTER_TARGET(isa)
+    #else
+        #define CONVERTER_TARGET(isa) __attribute__((target(isa)))
+    #endif
+#elif defined(__aarch64__) || defined(_M_ARM64) || defined(__ARM_NEON)
+    #define CONVERTER_NEON_KERNELS 1
+    #include <arm_neon.h>
+#endif
+
+#include <algorithm>
+#include <array>
+#include <cstring>
+
+namespace converter {
+
+namespace {
+
+/**
+ * Events encoded by one byte value, in pixel order
+ *
+ * Slots past `count` repeat the last event (or pixel 0 for an empty byte), so
+ * a byte can always be expanded with four unconditional stores.
+ */
+struct ByteEvents {
+    uint8_t count;
+    uint8_t offset[4];      // Pixel within the byte (0 = bits 7-6)
+    uint8_t polarity[4];    // 1 for 01, 0 for 10
+};
+
+constexpr std::array<ByteEvents, 256> makeByteEventTable()
+{
+    std::array<ByteEvents, 256> table{};
+    for (int value = 0; value < 256; value++) {
+        ByteEvents entry{};
+        for (int px = 0; px < 4; px++) {
+            int pixel_val = (value >> (6 - px * 2)) & 0x03;
+
+            // Only 01 (positive) and 10 (negative) are events; 00 and 11 are not
+            if (pixel_val == 1 || pixel_val == 2) {
+                entry.offset[entry.count] = static_cast<uint8_t>(px);
+                entry.polarity[entry.count] = static_cast<uint8_t>(pixel_val == 1);
+                entry.count++;
+            }
+        }
+        for (int slot = entry.count; slot < 4 && entry.count > 0; slot++) {
+            entry.offset[slot] = entry.offset[entry.count - 1];
+            entry.polarity[slot] = entry.polarity[entry.count - 1];
+        }
+        table[static_cast<size_t>(value)] = entry;
+    }
+    return table;
+}
+
+// Built at compile time, shared by every kernel's byte expansion
+constexpr std::array<ByteEvents, 256> kByteEvents = makeByteEventTable();
+
+/**
+ * Frame geometry of a kernel instantiation
+ *
+ * Width and Height are the sensor size, or 0 for the generic kernels, which
+ * take them from UnpackParams. With constants the row division becomes a
+ * multiply by an immediate reciprocal, and when the width is a multiple of 4
+ * no byte straddles two rows and the last byte of the frame is never padded,
+ * so both per-event checks disappear.
+ */
+template<int Width, int Height>
+struct Geometry {
+    static constexpr bool kFixed = Width > 0;
+    static constexpr bool kWholeBytesPerRow = kFixed && Width % 4 == 0;
+    static_assert(!kFixed || UnpackParams::supportsGeometry(Width, Width * Height));
+
+    static int width(const UnpackParams& params) { return kFixed ? Width : params.width; }
+    static int totalPixels(const UnpackParams& params) { return kFixed ? Width * Height : params.total_pixels; }
+
+    // Same reciprocal as UnpackParams::width_reciprocal, as an immediate
+    static constexpr uint64_t kWidthReciprocal = kFixed ? ((uint64_t{1} << 40) / Width) + 1 : 0;
+
+    static int row(int pixel, const UnpackParams& params)
+    {
+        const uint64_t reciprocal = kFixed ? kWidthReciprocal : params.width_reciprocal;
+        return static_cast<int>((static_cast<uint64_t>(pixel) * reciprocal) >> 40);
+    }
+};
+
+using GenericGeometry = Geometry<0, 0>;
+
+/**
+ * Expand the events of one byte through kByteEvents and append them
+ *
+ * Only one (reciprocal) division per byte: x/y of the first pixel are derived
+ * once and each event is offset from there, wrapping when a byte straddles
+ * rows (once at most, frames are at least 4 pixels wide). All four slots are stored unconditionally and the table provides the
+ * count, so there is no per-pixel branch or bit twiddling.
+ */
+template<typename G>
+inline size_t emitByte(uint8_t byte_val, size_t byte_idx, const UnpackParams& params, dv::Event* out)
+{
+    const int width = G::width(params);
+    const int base_pixel = static_cast<int>(byte_idx) * 4;
+    const int y = G::row(base_pixel, params);
+    const int x = base_pixel - y * width;
+
+    // Padding pixels past the end of the frame never produce events
+    if constexpr (!G::kWholeBytesPerRow) {
+        const int pixels = G::totalPixels(params) - base_pixel;
+        if (pixels < 4) {
+            byte_val &= static_cast<uint8_t>(0xFF << (8 - 2 * pixels));
+        }
+    }
+
+    const ByteEvents& entry = kByteEvents[byte_val];
+    for (int slot = 0; slot < 4; slot++) {
+        int px = x + entry.offset[slot];
+        if constexpr (G::kWholeBytesPerRow) {
+            out[slot] = dv::Event(params.timestamp, static_cast<int16_t>(px), static_cast<int16_t>(y),
+                                  entry.polarity[slot] != 0);
+        } else {
+            int wrap = px >= width;
+            out[slot] = dv::Event(params.timestamp, static_cast<int16_t>(px - wrap * width),
+                                  static_cast<int16_t>(y + wrap), entry.polarity[slot] != 0);
+        }
+    }
+
+    return entry.count;
+}
+
+// Scalar loop over [begin, end), used as the reference kernel and for SIMD tails
+template<typename G>
+inline size_t unpackRange(const uint8_t* data, size_t begin, size_t end,
+                          const UnpackParams& params, dv::Event* out)
+{
+    size_t count = 0;
+    for (size_t byte_idx = begin; byte_idx < end; byte_idx++) {
+        uint8_t byte_val = data[byte_idx];
+
+        // Skip zero bytes entirely - no events in this byte
+        if (byte_val == 0) {
+            continue;
+        }
+
+        count += emitByte<G>(byte_val, byte_idx, params, out + count);
+    }
+    return count;
+}
+
+// Emit every byte flagged in `mask` (bit i = byte block_start + i)
+template<typename G>
+inline size_t emitMask(uint64_t mask, const uint8_t* data, size_t block_start,
+                       const UnpackParams& params, dv::Event* out)
+{
+    size_t count = 0;
+    while (mask != 0) {
+        size_t byte_idx = block_start + countTrailingZeros(mask);
+        mask &= mask - 1;
+        count += emitByte<G>(data[byte_idx], byte_idx, params, out + count);
+    }
+    return count;
+}
+
+template<typename G>
+size_t unpackScalar(const uint8_t* data, size_t begin, size_t end,
+                    const UnpackParams& params, dv::Event* out)
+{
+    return unpackRange<G>(data, begin, end, params, out);
+}
+
+// Load 8 frame bytes so that byte k of the frame lands in bits 8k..8k+7
+inline uint64_t loadWord(const uint8_t* p)
+{
+    uint64_t word;
+    std::memcpy(&word, p, sizeof(word));
+#if defined(__BYTE_ORDER__) && __BYTE_ORDER__ == __ORDER_BIG_ENDIAN__
+    word = __builtin_bswap64(word);
+#endif
+    return word;
+}
+
+// Reverse the four 2-bit pixels inside every byte, so pixel p of byte k sits
+// at bits 8k + 2p and ascending bit order is ascending pixel order
+inline uint64_t pixelOrder(uint64_t word)
+{
+    word = ((word & 0x0F0F0F0F0F0F0F0FULL) << 4) | ((word >> 4) & 0x0F0F0F0F0F0F0F0FULL);
+    word = ((word & 0x3333333333333333ULL) << 2) | ((word >> 2) & 0x3333333333333333ULL);
+    return word;
+}
+
+// Emit the events of one non-zero word starting at byte `byte_idx`: one ctz,
+// one reciprocal division and one store per event, nothing per empty pixel
+template<typename G>
+inline size_t emitWord(uint64_t word, size_t byte_idx, const UnpackParams& params, dv::Event* out)
+{
+    uint64_t pixels = pixelOrder(word);
+    uint64_t valid = (pixels ^ (pixels >> 1)) & 0x5555555555555555ULL;
+    const int base_pixel = static_cast<int>(byte_idx) * 4;
+    size_t count = 0;
+
+    while (valid != 0) {
+        unsigned bit = countTrailingZeros(valid);
+        valid &= valid - 1;
+
+        int pixel = base_pixel + static_cast<int>(bit / 2);
+        int y = G::row(pixel, params);
+        int x = pixel - y * G::width(params);
+
+        // Low bit of the pixel is 1 for 01 (positive), 0 for 10 (negative)
+        out[count++] = dv::Event(params.timestamp, static_cast<int16_t>(x), static_cast<int16_t>(y),
+                                 ((pixels >> bit) & 1) != 0);
+    }
+
+    return count;
+}
+
+/**
+ * Sparse kernel: cost follows the event count, not the frame size
+ *
+ * Empty 32-byte spans are rejected with one OR of four words, empty words
+ * with one compare, and set pixels are then visited directly with ctz. Only
+ * bytes whose four pixels are all inside the frame go through the word loop;
+ * the padded last byte and any unaligned tail use the scalar path.
+ */
+template<typename G>
+size_t unpackSparse(const uint8_t* data, size_t begin, size_t end,
+                    const UnpackParams& params, dv::Event* out)
+{
+    const size_t full_end = std::max(begin, std::min(end, static_cast<size_t>(G::totalPixels(params)) / 4));
+    size_t count = 0;
+    size_t i = begin;
+
+    for (; i + 32 <= full_end; i += 32) {
+        uint64_t w0 = loadWord(data + i);
+        uint64_t w1 = loadWord(data + i + 8);
+        uint64_t w2 = loadWord(data + i + 16);
+        uint64_t w3 = loadWord(data + i + 24);
+        if ((w0 | w1 | w2 | w3) == 0) {
+            continue;
+        }
+
+        if (w0 != 0) count += emitWord<G>(w0, i, params, out + count);
+        if (w1 != 0) count += emitWord<G>(w1, i + 8, params, out + count);
+        if (w2 != 0) count += emitWord<G>(w2, i + 16, params, out + count);
+        if (w3 != 0) count += emitWord<G>(w3, i + 24, params, out + count);
+    }
+
+    for (; i + 8 <= full_end; i += 8) {
+        uint64_t word = loadWord(data + i);
+        if (word != 0) {
+            count += emitWord<G>(word, i, params, out + count);
+        }
+    }
+
+    return count + unpackRange<G>(data, i, end, params, out + count);
+}
+
+// A pixel carries an event when its two bits differ (01 or 10). For every byte
+// (v ^ (v >> 1)) & 0x55 is therefore non-zero exactly when that byte holds at
+// least one event, which lets the SIMD kernels reject 00 and 11 in one compare.
+// A 16-bit lane shift is fine: the bit leaking in from the neighbouring byte
+// lands in bit 7, which the 0x55 mask discards.
+
+#ifdef CONVERTER_X86_KERNELS
+
+template<typename G>
+CONVERTER_TARGET("sse4.1")
+size_t unpackSse41(const uint8_t* data, size_t begin, size_t end,
+                   const UnpackParams& params, dv::Event* out)
+{
+    const __m128i pixel_lsb = _mm_set1_epi8(0x55);
+    const __m128i zero = _mm_setzero_si128();
+    size_t count = 0;
+    size_t i = begin;
+
+    for (; i + 16 <= end; i += 16) {
+        __m128i v = _mm_loadu_si128(reinterpret_cast<const __m128i*>(data + i));
+        __m128i valid = _mm_and_si128(_mm_xor_si128(v, _mm_srli_epi16(v, 1)), pixel_lsb);
+
+        if (_mm_testz_si128(valid, valid)) {
+            continue;
+        }
+
+        uint32_t mask = ~static_cast<uint32_t>(_mm_movemask_epi8(_mm_cmpeq_epi8(valid, zero))) & 0xFFFFu;
+        count += emitMask<G>(mask, data, i, params, out + count);
+    }
+
+    return count + unpackRange<G>(data, i, end, params, out + count);
+}
+
+template<typename G>
+CONVERTER_TARGET("avx2")
+size_t unpackAvx2(const uint8_t* data, size_t begin, size_t end,
+                  const UnpackParams& params, dv::Event* out)
+{
+    const __m256i pixel_lsb = _mm256_set1_epi8(0x55);
+    const __m256i zero = _mm256_setzero_si256();
+    size_t count = 0;
+    size_t i = begin;
+
+    for (; i + 32 <= end; i += 32) {
+        __m256i v = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(data + i));
+        __m256i valid = _mm256_and_si256(_mm256_xor_si256(v, _mm256_srli_epi16(v, 1)), pixel_lsb);
+
+        if (_mm256_testz_si256(valid, valid)) {
+            continue;
+        }
+
+        uint32_t mask = ~static_cast<uint32_t>(_mm256_movemask_epi8(_mm256_cmpeq_epi8(valid, zero)));
+        count += emitMask<G>(mask, data, i, params, out + count);
+    }
+
+    return count + unpackRange<G>(data, i, end, params, out + count);
+}
+
+bool cpuHasSse41()
+{
+#if defined(_MSC_VER) && !defined(__clang__)
+    int info[4];
+    __cpuid(info, 1);
+    return (info[2] & (1 << 19)) != 0;
+#else
+    return __builtin_cpu_supports("sse4.1");
+#endif
+}
+
+bool cpuHasAvx2()
+{
+#if defined(_MSC_VER) && !defined(__clang__)
+    int info[4];
+    __cpuid(info, 1);
+    bool osxsave = (info[2] & (1 << 27)) != 0;
+    if (!osxsave || (_xgetbv(0) & 0x6) != 0x6) {
+        return false;  // OS does not save YMM state
+    }
+    __cpuidex(info, 7, 0);
+    return (info[1] & (1 << 5)) != 0;
+#else
+    return __builtin_cpu_supports("avx2");
+#endif
+}
+
+#endif // CONVERTER_X86_KERNELS
+
+#ifdef CONVERTER_NEON_KERNELS
+
+template<typename G>
+size_t unpackNeon(const uint8_t* data, size_t begin, size_t end,
+                  const UnpackParams& params, dv::Event* out)
+{
+    const uint8x16_t pixel_lsb = vdupq_n_u8(0x55);
+    size_t count = 0;
+    size_t i = begin;
+
+    for (; i + 16 <= end; i += 16) {
+        uint8x16_t v = vld1q_u8(data + i);
+        uint8x16_t valid = vandq_u8(veorq_u8(v, vshrq_n_u8(v, 1)), pixel_lsb);
+        uint8x16_t nonzero = vtstq_u8(valid, valid);
+
+        // NEON has no movemask: narrow to one nibble per byte, keep one bit each
+        uint8x8_t nibbles = vshrn_n_u16(vreinterpretq_u16_u8(nonzero), 4);
+        uint64_t nibble_mask = vget_lane_u64(vreinterpret_u64_u8(nibbles), 0);
+        if (nibble_mask == 0) {
+            continue;
+        }
+
+        nibble_mask &= 0x1111111111111111ULL;
+        while (nibble_mask != 0) {
+            size_t byte_idx = i + countTrailingZeros(nibble_mask) / 4;
+            nibble_mask &= nibble_mask - 1;
+            count += emitByte<G>(data[byte_idx], byte_idx, params, out + count);
+        }
+    }
+
+    return count + unpackRange<G>(data, i, end, params, out + count);
+}
+
+#endif // CONVERTER_NEON_KERNELS
+
+// [uint16 zeros][uint16 literals][literal bytes] ..., see FrameEncoding::ZeroRuns
+bool decodeZeroRuns(const uint8_t* payload, size_t payload_size, size_t frame_bytes,
+                    const UnpackParams& params, dv::Event* out, size_t& count)
+{
+    size_t pos = 0;
+    size_t cursor = 0;  // Frame byte the next literal goes to
+
+    while (pos < payload_size) {
+        if (payload_size - pos < 4) {
+            return false;
+        }
+        uint16_t run[2];
+        std::memcpy(run, payload + pos, sizeof(run));
+        pos += sizeof(run);
+
+        cursor += run[0];
+        const size_t literals = run[1];
+        if (literals > payload_size - pos || cursor > frame_bytes || literals > frame_bytes - cursor) {
+            return false;
+        }
+
+        for (size_t k = 0; k < literals; k++) {
+            uint8_t byte_val = payload[pos + k];
+            if (byte_val != 0) {
+                count += emitByte<GenericGeometry>(byte_val, cursor + k, params, out + count);
+            }
+        }
+        pos += literals;
+        cursor += literals;
+    }
+    return true;
+}
+
+// uint32 (offset << 8) | value per non-zero byte, see FrameEncoding::ByteList
+bool decodeByteList(const uint8_t* payload, size_t payload_size, size_t frame_bytes,
+                    const UnpackParams& params, dv::Event* out, size_t& count)
+{
+    if (payload_size % sizeof(uint32_t) != 0) {
+        return false;
+    }
+
+    // Strictly increasing offsets keep the events in frame order and make
+    // sure no byte (and its 4 output slots) is expanded twice
+    size_t next_offset = 0;
+    for (size_t pos = 0; pos < payload_size; pos += sizeof(uint32_t)) {
+        uint32_t entry;
+        std::memcpy(&entry, payload + pos, sizeof(entry));
+        const size_t offset = entry >> 8;
+        if (offset < next_offset || offset >= frame_bytes) {
+            return false;
+        }
+        next_offset = offset + 1;
+        count += emitByte<GenericGeometry>(static_cast<uint8_t>(entry & 0xFF), offset, params, out + count);
+    }
+    return true;
+}
+
+bool expandZeroRuns(const uint8_t* payload, size_t payload_size, size_t frame_bytes, uint8_t* frame)
+{
+    size_t pos = 0;
+    size_t cursor = 0;
+
+    while (pos < payload_size) {
+        if (payload_size - pos < 4) {
+            return false;
+        }
+        uint16_t run[2];
+        std::memcpy(run, payload + pos, sizeof(run));
+        pos += sizeof(run);
+
+        cursor += run[0];
+        const size_t literals = run[1];
+        if (literals > payload_size - pos || cursor > frame_bytes || literals > frame_bytes - cursor) {
+            return false;
+        }
+        std::memcpy(frame + cursor, payload + pos, literals);
+        pos += literals;
+        cursor += literals;
+    }
+    return true;
+}
+
+bool expandByteList(const uint8_t* payload, size_t payload_size, size_t frame_bytes, uint8_t* frame)
+{
+    if (payload_size % sizeof(uint32_t) != 0) {
+        return false;
+    }
+
+    size_t next_offset = 0;
+    for (size_t pos = 0; pos < payload_size; pos += sizeof(uint32_t)) {
+        uint32_t entry;
+        std::memcpy(&entry, payload + pos, sizeof(entry));
+        const size_t offset = entry >> 8;
+        if (offset < next_offset || offset >= frame_bytes) {
+            return false;
+        }
+        next_offset = offset + 1;
+        frame[offset] = static_cast<uint8_t>(entry & 0xFF);
+    }
+    return true;
+}
+
+} // namespace
+
+bool isUnpackKernelSupported(UnpackKernel kernel)
+{
+    switch (kernel) {
+        case UnpackKernel::Auto:
+        case UnpackKernel::Scalar:
+        case UnpackKernel::Sparse:
+            return true;
+#ifdef CONVERTER_X86_KERNELS
+        case UnpackKernel::SSE41: {
+            static const bool supported = cpuHasSse41();
+            return supported;
+        }
+        case UnpackKernel::AVX2: {
+            static const bool supported = cpuHasAvx2();
+            return supported;
+        }
+#endif
+#ifdef CONVERTER_NEON_KERNELS
+        case UnpackKernel::NEON:
+            return true;
+#endif
+        default:
+            return false;
+    }
+}
+
+UnpackKernel resolveUnpackKernel(UnpackKernel requested)
+{
+    if (requested == UnpackKernel::Auto) {
+        for (UnpackKernel candidate : {UnpackKernel::AVX2, UnpackKernel::SSE41, UnpackKernel::NEON}) {
+            if (isUnpackKernelSupported(candidate)) {
+                return candidate;
+            }
+        }
+        return UnpackKernel::Scalar;
+    }
+
+    return isUnpackKernelSupported(requested) ? requested : UnpackKernel::Scalar;
+}
+
+namespace {
+
+template<typename G>
+UnpackKernelFn selectKernel(UnpackKernel kernel)
+{
+    switch (kernel) {
+        case UnpackKernel::Sparse: return unpackSparse<G>;
+#ifdef CONVERTER_X86_KERNELS
+        case UnpackKernel::SSE41: return unpackSse41<G>;
+        case UnpackKernel::AVX2: return unpackAvx2<G>;
+#endif
+#ifdef CONVERTER_NEON_KERNELS
+        case UnpackKernel::NEON: return unpackNeon<G>;
+#endif
+        default: return unpackScalar<G>;
+    }
+}
+
+/**
+ * Sensor geometries with their own kernel instantiations
+ *
+ * Widths that are a multiple of 4 end their rows on byte boundaries, which
+ * removes the per-event work. DAVIS346 (346x260) keeps the row wrap and the
+ * padded last byte but still gets the immediate reciprocal and bound.
+ *
+ * Only the geometry is a template parameter: the kernels decode the 2-bit
+ * packed format, the only one senders produce, and compressed frames
+ * (decodeCompressedFrame) expand through the same emitByte. Specialising on
+ * the encoding as well is out of scope until another bit depth exists.
+ */
+struct SpecializedGeometry {
+    int width;
+    int height;
+    UnpackKernelFn (*select)(UnpackKernel kernel);
+};
+
+constexpr SpecializedGeometry kSpecializedGeometries[] = {
+    {1280, 720, selectKernel<Geometry<1280, 720>>},
+    {640, 480, selectKernel<Geometry<640, 480>>},
+    {346, 260, selectKernel<Geometry<346, 260>>},
+};
+
+} // namespace
+
+UnpackKernelFn getUnpackKernel(UnpackKernel kernel)
+{
+    return selectKernel<GenericGeometry>(resolveUnpackKernel(kernel));
+}
+
+UnpackKernelFn getUnpackKernel(UnpackKernel kernel, int width, int height)
+{
+    for (const SpecializedGeometry& geometry : kSpecializedGeometries) {
+        if (geometry.width == width && geometry.height == height) {
+            return geometry.select(resolveUnpackKernel(kernel));
+        }
+    }
+    return getUnpackKernel(kernel);
+}
+
+bool isUnpackGeometrySpecialized(int width, int height)
+{
+    for (const SpecializedGeometry& geometry : kSpecializedGeometries) {
+        if (geometry.width == width && geometry.height == height) {
+            return true;
+        }
+    }
+    return false;
+}
+
+bool decodeCompressedFrame(FrameEncoding encoding, const uint8_t* payload, size_t payload_size,
+                           size_t frame_bytes, const UnpackParams& params, dv::Event* out, size_t& count)
+{
+    count = 0;
+    switch (encoding) {
+        case FrameEncoding::ZeroRuns:
+            return decodeZeroRuns(payload, payload_size, frame_bytes, params, out, count);
+        case FrameEncoding::ByteList:
+            return decodeByteList(payload, payload_size, frame_bytes, params, out, count);
+        default:
+            return false;
+    }
+}
+
+bool expandCompressedFrame(FrameEncoding encoding, const uint8_t* payload, size_t payload_size,
+                           size_t frame_bytes, uint8_t* frame)
+{
+    std::memset(frame, 0, frame_bytes);
+    switch (encoding) {
+        case FrameEncoding::ZeroRuns:
+            return expandZeroRuns(payload, payload_size, frame_bytes, frame);
+        case FrameEncoding::ByteList:
+            return expandByteList(payload, payload_size, frame_bytes, frame);
+        default:
+            return false;
+    }
+}
+
+} // namespace converter
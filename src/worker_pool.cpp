@@ -0,0 +1,98 @@
+#include "worker_pool.hpp"
+
+namespace converter {
+
+WorkerPool::WorkerPool(size_t num_threads)
+    : task_(nullptr)
+    , num_tasks_(0)
+    , next_task_(0)
+    , busy_threads_(0)
+    , generation_(0)
+    , stopping_(false)
+{
+    threads_.reserve(num_threads);
+    for (size_t i = 0; i < num_threads; i++) {
+        threads_.emplace_back(&WorkerPool::workerLoop, this);
+    }
+}
+
+WorkerPool::~WorkerPool()
+{
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        stopping_ = true;
+    }
+    work_cv_.notify_all();
+
+    for (auto& thread : threads_) {
+        thread.join();
+    }
+}
+
+void WorkerPool::run(size_t num_tasks, const std::function<void(size_t)>& task)
+{
+    if (num_tasks == 0) {
+        return;
+    }
+
+    // Nothing to hand out: run inline and skip the wake-up entirely
+    if (threads_.empty() || num_tasks == 1) {
+        for (size_t i = 0; i < num_tasks; i++) {
+            task(i);
+        }
+        return;
+    }
+
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        task_ = &task;
+        num_tasks_ = num_tasks;
+        next_task_.store(0, std::memory_order_relaxed);
+        busy_threads_ = threads_.size();
+        generation_++;
+    }
+    work_cv_.notify_all();
+
+    runTasks();
+
+    std::unique_lock<std::mutex> lock(mutex_);
+    done_cv_.wait(lock, [this] { return busy_threads_ == 0; });
+    task_ = nullptr;
+}
+
+void WorkerPool::runTasks()
+{
+    for (;;) {
+        size_t index = next_task_.fetch_add(1, std::memory_order_relaxed);
+        if (index >= num_tasks_) {
+            return;
+        }
+        (*task_)(index);
+    }
+}
+
+void WorkerPool::workerLoop()
+{
+    uint64_t seen_generation = 0;
+
+    for (;;) {
+        {
+            std::unique_lock<std::mutex> lock(mutex_);
+            work_cv_.wait(lock, [&] { return stopping_ || generation_ != seen_generation; });
+            if (stopping_) {
+                return;
+            }
+            seen_generation = generation_;
+        }
+
+        runTasks();
+
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            busy_threads_--;
+        }
+        done_cv_.notify_one();
+    }
+}
+
+} // namespace converter
@@ -0,0 +1,185 @@
+#include "bench_common.hpp"
+#include "crc32c.hpp"
+#include <algorithm>
+#include <chrono>
+#include <random>
+
+#include <arpa/inet.h>
+#include <netinet/in.h>
+#include <sys/socket.h>
+#include <unistd.h>
+
+#ifndef MSG_NOSIGNAL
+    #define MSG_NOSIGNAL 0  // macOS: SIGPIPE is ignored via SO_NOSIGPIPE below
+#endif
+
+namespace converter {
+namespace bench {
+
+Config makeConfig(int width, int height)
+{
+    Config cfg;
+    cfg.width = width;
+    cfg.height = height;
+    cfg.stats_interval = 0;
+    cfg.verbose = false;
+    return cfg;
+}
+
+std::vector<uint8_t> makeFrame(const Config& cfg, double density, uint32_t seed)
+{
+    std::vector<uint8_t> frame(static_cast<size_t>(cfg.frame_size()), 0);
+    if (density <= 0.0) {
+        return frame;
+    }
+
+    // Jump straight from one event to the next (geometric gaps), so sparse
+    // frames are as cheap to build as they are to unpack
+    std::mt19937 rng(seed);
+    std::geometric_distribution<int64_t> gap(std::min(density, 1.0));
+    std::bernoulli_distribution positive(0.5);
+
+    for (int64_t pixel = gap(rng); pixel < cfg.total_pixels(); pixel += 1 + gap(rng)) {
+        uint8_t code = positive(rng) ? 0x01 : 0x02;
+        frame[static_cast<size_t>(pixel / 4)] |= static_cast<uint8_t>(code << (6 - 2 * (pixel % 4)));
+    }
+    return frame;
+}
+
+size_t countEvents(const Config& cfg, const std::vector<uint8_t>& frame)
+{
+    size_t count = 0;
+    for (int pixel = 0; pixel < cfg.total_pixels(); pixel++) {
+        int value = (frame[static_cast<size_t>(pixel / 4)] >> (6 - 2 * (pixel % 4))) & 0x03;
+        count += (value == 1) || (value == 2);
+    }
+    return count;
+}
+
+int nextPort()
+{
+    static std::atomic<int> port{17400};
+    return port.fetch_add(1);
+}
+
+LoopbackSender::LoopbackSender(const Config& cfg, std::vector<std::vector<uint8_t>> frames)
+    : config_(cfg)
+    , frames_(std::move(frames))
+    , running_(true)
+    , frames_sent_(0)
+{
+    // Frame CRCs up front: header words for TCP, appended trailers for UDP
+    if (config_.frame_crc_header_bytes() > 0 || config_.frame_crc_trailer_bytes() > 0) {
+        for (std::vector<uint8_t>& frame : frames_) {
+            uint32_t crc = crc32c(frame.data(), frame.size());
+            if (config_.frame_crc_trailer_bytes() > 0) {
+                const uint8_t* bytes = reinterpret_cast<const uint8_t*>(&crc);
+                frame.insert(frame.end(), bytes, bytes + sizeof(crc));
+            }
+            crcs_.push_back(crc);
+        }
+    }
+
+    thread_ = std::thread([this]() {
+        if (config_.protocol == Protocol::TCP) {
+            sendTcp();
+        } else {
+            sendUdp();
+        }
+    });
+}
+
+LoopbackSender::~LoopbackSender()
+{
+    stop();
+}
+
+void LoopbackSender::stop()
+{
+    running_ = false;
+    if (thread_.joinable()) {
+        thread_.join();
+    }
+}
+
+void LoopbackSender::sendTcp()
+{
+    sockaddr_in addr{};
+    addr.sin_family = AF_INET;
+    addr.sin_port = htons(static_cast<uint16_t>(config_.camera_port));
+    inet_pton(AF_INET, "127.0.0.1", &addr.sin_addr);
+
+    // The receiver starts listening inside connect(); keep trying until it does
+    int sock = -1;
+    while (running_) {
+        sock = socket(AF_INET, SOCK_STREAM, 0);
+        if (::connect(sock, reinterpret_cast<sockaddr*>(&addr), sizeof(addr)) == 0) {
+            break;
+        }
+        close(sock);
+        sock = -1;
+        std::this_thread::sleep_for(std::chrono::milliseconds(5));
+    }
+    if (sock < 0) {
+        return;
+    }
+
+#ifdef SO_NOSIGPIPE
+    int one = 1;
+    setsockopt(sock, SOL_SOCKET, SO_NOSIGPIPE, &one, sizeof(one));
+#endif
+
+    for (size_t f = 0; running_; f = (f + 1) % frames_.size()) {
+        const std::vector<uint8_t>& frame = frames_[f];
+
+        if (config_.has_header) {
+            uint32_t size = static_cast<uint32_t>(frame.size());
+            if (send(sock, &size, sizeof(size), MSG_NOSIGNAL) != static_cast<ssize_t>(sizeof(size))) {
+                break;
+            }
+        }
+        if (config_.frame_crc_header_bytes() > 0 &&
+            send(sock, &crcs_[f], sizeof(uint32_t), MSG_NOSIGNAL) != static_cast<ssize_t>(sizeof(uint32_t))) {
+            break;
+        }
+
+        size_t offset = 0;
+        while (offset < frame.size()) {
+            ssize_t sent = send(sock, frame.data() + offset, frame.size() - offset, MSG_NOSIGNAL);
+            if (sent <= 0) {
+                close(sock);
+                return;  // Receiver went away
+            }
+            offset += static_cast<size_t>(sent);
+        }
+        frames_sent_.fetch_add(1, std::memory_order_relaxed);
+    }
+
+    close(sock);
+}
+
+void LoopbackSender::sendUdp()
+{
+    int sock = socket(AF_INET, SOCK_DGRAM, 0);
+    sockaddr_in addr{};
+    addr.sin_family = AF_INET;
+    addr.sin_port = htons(static_cast<uint16_t>(config_.camera_port));
+    inet_pton(AF_INET, "127.0.0.1", &addr.sin_addr);
+
+    const size_t packet = static_cast<size_t>(config_.udp_packet_size);
+
+    for (size_t f = 0; running_; f = (f + 1) % frames_.size()) {
+        const std::vector<uint8_t>& frame = frames_[f];
+
+        for (size_t offset = 0; offset < frame.size(); offset += packet) {
+            size_t len = std::min(packet, frame.size() - offset);
+            sendto(sock, frame.data() + offset, len, 0, reinterpret_cast<sockaddr*>(&addr), sizeof(addr));
+        }
+        frames_sent_.fetch_add(1, std::memory_order_relaxed);
+    }
+
+    close(sock);
+}
+
+} // namespace bench
+} // namespace converter
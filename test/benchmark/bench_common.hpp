@@ -0,0 +1,110 @@
+#pragma once
+
+#include "config.hpp"
+#include <atomic>
+#include <cstdint>
+#include <thread>
+#include <vector>
+
+namespace converter {
+namespace bench {
+
+/**
+ * Resolutions swept by the benchmarks (benchmark argument = index)
+ */
+struct Resolution {
+    int width;
+    int height;
+};
+
+inline constexpr Resolution kResolutions[] = {
+    {346, 260},     // DAVIS346
+    {640, 480},     // VGA
+    {1280, 720},    // FPGA default
+};
+
+/**
+ * Densities swept by the benchmarks, in events per 1000 pixels
+ * (0%, 0.1%, 1%, 10%, 50%)
+ */
+inline const std::vector<int64_t> kDensitiesPermille = {0, 1, 10, 100, 500};
+
+/**
+ * Config for a benchmark run (no stats or debug output)
+ * @param width Frame width
+ * @param height Frame height
+ * @return Configuration
+ */
+Config makeConfig(int width, int height);
+
+/**
+ * Generate a 2-bit packed frame with events at random pixels
+ * @param cfg Frame geometry
+ * @param density Fraction of pixels carrying an event (0..1)
+ * @param seed Random seed (same seed, same frame)
+ * @return Packed frame of cfg.frame_size() bytes
+ */
+std::vector<uint8_t> makeFrame(const Config& cfg, double density, uint32_t seed);
+
+/**
+ * Count the events a packed frame holds
+ * @param cfg Frame geometry
+ * @param frame Packed frame
+ * @return Number of 01/10 pixels
+ */
+size_t countEvents(const Config& cfg, const std::vector<uint8_t>& frame);
+
+/**
+ * Get a fresh loopback port for each benchmark run (avoids TIME_WAIT clashes)
+ * @return Port number
+ */
+int nextPort();
+
+/**
+ * Streams pre-generated frames to a receiver on 127.0.0.1 until stopped
+ *
+ * TCP: connects (retrying until the receiver listens) and writes frames back
+ * to back. UDP: sends each frame as cfg.udp_packet_size datagrams.
+ */
+class LoopbackSender {
+public:
+    /**
+     * Constructor - starts the sender thread
+     * @param cfg Protocol, port, packet size and frame CRC to use
+     * @param frames Frames to send, cycled in order
+     */
+    LoopbackSender(const Config& cfg, std::vector<std::vector<uint8_t>> frames);
+
+    /**
+     * Destructor - stops the sender
+     */
+    ~LoopbackSender();
+
+    LoopbackSender(const LoopbackSender&) = delete;
+    LoopbackSender& operator=(const LoopbackSender&) = delete;
+
+    /**
+     * Stop sending and join the thread
+     */
+    void stop();
+
+    /**
+     * Get number of complete frames sent
+     * @return Frames sent
+     */
+    uint64_t getFramesSent() const { return frames_sent_.load(std::memory_order_relaxed); }
+
+private:
+    void sendTcp();
+    void sendUdp();
+
+    Config config_;
+    std::vector<std::vector<uint8_t>> frames_;
+    std::vector<uint32_t> crcs_;
+    std::atomic<bool> running_;
+    std::atomic<uint64_t> frames_sent_;
+    std::thread thread_;
+};
+
+} // namespace bench
+} // namespace converter
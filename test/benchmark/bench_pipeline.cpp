@@ -0,0 +1,74 @@
+#include "bench_common.hpp"
+#include "pipeline.hpp"
+#include <benchmark/benchmark.h>
+#include <algorithm>
+#include <cstring>
+#include <thread>
+
+using namespace converter;
+
+namespace {
+
+// Args: unpack workers, band threads, density (permille). Frames come from
+// memory, so this measures unpack + hand-off throughput, not the network.
+void BM_Pipeline(benchmark::State& state)
+{
+    Config cfg = bench::makeConfig(1280, 720);
+    cfg.unpack_workers = static_cast<int>(state.range(0));
+    cfg.unpack_band_threads = static_cast<int>(state.range(1));
+    const double density = static_cast<double>(state.range(2)) / 1000.0;
+
+    std::vector<std::vector<uint8_t>> frames;
+    for (uint32_t seed = 1; seed <= 8; seed++) {
+        frames.push_back(bench::makeFrame(cfg, density, seed));
+    }
+
+    uint64_t next = 0;
+    std::atomic<uint64_t> events{0};
+    std::atomic<uint64_t> written{0};
+
+    Pipeline pipeline(cfg,
+        [&](FrameHandle& frame) {
+            const std::vector<uint8_t>& src = frames[next++ % frames.size()];
+            std::memcpy(frame.data(), src.data(), src.size());
+            frame.setSize(src.size());
+            return true;
+        },
+        []() { return false; },
+        [&](const PipelineFrame& frame) {
+            events.fetch_add(frame.num_events, std::memory_order_relaxed);
+            written.fetch_add(1, std::memory_order_release);
+        });
+
+    pipeline.start();
+
+    // One iteration = one frame out of the writer
+    uint64_t target = written.load(std::memory_order_acquire);
+    for (auto _ : state) {
+        target++;
+        while (written.load(std::memory_order_acquire) < target) {
+            std::this_thread::yield();
+        }
+    }
+
+    const uint64_t events_seen = events.load(std::memory_order_relaxed);
+    const uint64_t frames_seen = std::max<uint64_t>(1, written.load(std::memory_order_relaxed));
+    pipeline.stop();
+
+    state.SetBytesProcessed(static_cast<int64_t>(state.iterations()) * cfg.frame_size());
+    state.counters["frames_per_s"] = benchmark::Counter(static_cast<double>(state.iterations()),
+                                                        benchmark::Counter::kIsRate);
+    state.counters["MEv_per_s"] = benchmark::Counter(
+        static_cast<double>(state.iterations()) * static_cast<double>(events_seen)
+            / static_cast<double>(frames_seen) / 1e6,
+        benchmark::Counter::kIsRate);
+    state.counters["event_allocs"] = static_cast<double>(pipeline.getEventAllocations());
+}
+BENCHMARK(BM_Pipeline)
+    ->ArgsProduct({{1, 2, 4}, {1}, {1, 10, 100}})
+    ->Args({1, 4, 100})
+    ->Args({1, 4, 500})
+    ->ArgNames({"workers", "bands", "permille"})
+    ->UseRealTime();
+
+} // namespace
@@ -0,0 +1,125 @@
+#include "bench_common.hpp"
+#include "crc32c.hpp"
+#include "frame_pool.hpp"
+#include "tcp_receiver.hpp"
+#include "udp_receiver.hpp"
+#include <benchmark/benchmark.h>
+#include <algorithm>
+
+using namespace converter;
+
+namespace {
+
+std::vector<std::vector<uint8_t>> makeFrames(const Config& cfg, double density)
+{
+    std::vector<std::vector<uint8_t>> frames;
+    for (uint32_t seed = 1; seed <= 8; seed++) {
+        frames.push_back(bench::makeFrame(cfg, density, seed));
+    }
+    return frames;
+}
+
+template <typename Receiver>
+void receiveFrames(benchmark::State& state, const Config& cfg, Receiver& receiver)
+{
+    FramePool pool(2, static_cast<size_t>(cfg.frame_size() + cfg.occupancy_map_bytes() +
+                                          cfg.frame_crc_trailer_bytes()));
+    FrameHandle frame = pool.tryAcquire();
+
+    for (auto _ : state) {
+        if (!receiver.receiveFrame(frame)) {
+            state.SkipWithError("receive failed");
+            break;
+        }
+        benchmark::DoNotOptimize(frame.data());
+    }
+
+    state.SetBytesProcessed(static_cast<int64_t>(state.iterations()) * cfg.frame_size());
+    state.counters["frames_per_s"] = benchmark::Counter(static_cast<double>(state.iterations()),
+                                                        benchmark::Counter::kIsRate);
+}
+
+// Args: frame size in bytes
+void BM_Crc32c(benchmark::State& state)
+{
+    const std::vector<uint8_t> data(static_cast<size_t>(state.range(0)), 0x5A);
+    uint32_t crc = 0;
+
+    for (auto _ : state) {
+        crc = crc32c(data.data(), data.size(), crc);
+        benchmark::DoNotOptimize(crc);
+    }
+
+    state.SetBytesProcessed(static_cast<int64_t>(state.iterations()) * state.range(0));
+    state.SetLabel(crc32cImplementation());
+}
+BENCHMARK(BM_Crc32c)->Arg(4096)->Arg(230400)->ArgName("bytes");
+
+// Args: backend (0 = Socket, 1 = io_uring), has_header, frame_crc (needs has_header)
+void BM_TcpReceive(benchmark::State& state)
+{
+    Config cfg = bench::makeConfig(1280, 720);
+    cfg.protocol = Protocol::TCP;
+    cfg.camera_port = bench::nextPort();
+    cfg.tcp_backend = state.range(0) == 0 ? TcpBackend::Socket : TcpBackend::IoUring;
+    cfg.has_header = state.range(1) != 0;
+    cfg.frame_crc = state.range(2) != 0;
+
+    bench::LoopbackSender sender(cfg, makeFrames(cfg, 0.01));
+    TcpReceiver receiver(cfg);
+    if (!receiver.connect()) {
+        state.SkipWithError("connect failed");
+        return;
+    }
+
+    receiveFrames(state, cfg, receiver);
+
+    const double frames = static_cast<double>(std::max<uint64_t>(1, receiver.getTotalFramesReceived()));
+    state.counters["syscalls_per_frame"] = static_cast<double>(receiver.getTotalReceiveCalls()) / frames;
+    state.SetLabel(tcpBackendToString(receiver.getActiveBackend()));
+
+    receiver.disconnect();
+    sender.stop();
+}
+BENCHMARK(BM_TcpReceive)
+    ->ArgsProduct({{0, 1}, {0, 1}, {0}})
+    ->Args({0, 1, 1})
+    ->Args({1, 1, 1})
+    ->ArgNames({"backend", "header", "crc"})
+    ->UseRealTime();
+
+// Args: datagrams per recvmmsg batch (1 = plain recvmsg), frame_crc
+void BM_UdpReceive(benchmark::State& state)
+{
+    Config cfg = bench::makeConfig(1280, 720);
+    cfg.protocol = Protocol::UDP;
+    cfg.camera_port = bench::nextPort();
+    cfg.udp_packet_size = 8192;
+    cfg.udp_batch_size = static_cast<int>(state.range(0));
+    cfg.frame_crc = state.range(1) != 0;
+
+    UdpReceiver receiver(cfg);
+    if (!receiver.connect()) {
+        state.SkipWithError("bind failed");
+        return;
+    }
+    bench::LoopbackSender sender(cfg, makeFrames(cfg, 0.01));
+
+    receiveFrames(state, cfg, receiver);
+
+    // Loopback UDP drops when the sender outruns the receiver; counted, not fatal
+    const double sent = static_cast<double>(sender.getFramesSent());
+    state.counters["datagrams_per_syscall"] = receiver.getDatagramsPerSyscall();
+    state.counters["frames_sent"] = sent;
+
+    sender.stop();
+    receiver.disconnect();
+}
+BENCHMARK(BM_UdpReceive)
+    ->Args({1, 0})
+    ->Args({32, 0})
+    ->Args({32, 1})
+    ->ArgNames({"batch", "crc"})
+    ->UseRealTime();
+
+} // namespace
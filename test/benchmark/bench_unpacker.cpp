@@ -0,0 +1,185 @@
+#include "bench_common.hpp"
+#include "frame_accumulator.hpp"
+#include "frame_pool.hpp"
+#include "frame_unpacker.hpp"
+#include "noise_filter.hpp"
+#include "pipeline.hpp"
+#include "unpack_kernels.hpp"
+#include <benchmark/benchmark.h>
+#include <cstring>
+#include <string>
+
+using namespace converter;
+
+namespace {
+
+constexpr UnpackKernel kKernels[] = {
+    UnpackKernel::Scalar,
+    UnpackKernel::SSE41,
+    UnpackKernel::AVX2,
+    UnpackKernel::NEON,
+    UnpackKernel::Sparse,
+};
+
+void setFrameCounters(benchmark::State& state, const Config& cfg, size_t events)
+{
+    const double frames = static_cast<double>(state.iterations());
+    state.SetBytesProcessed(static_cast<int64_t>(state.iterations()) * cfg.frame_size());
+    state.counters["frames_per_s"] = benchmark::Counter(frames, benchmark::Counter::kIsRate);
+    state.counters["events_per_s"] = benchmark::Counter(frames * static_cast<double>(events),
+                                                        benchmark::Counter::kIsRate);
+    state.counters["events_per_frame"] = static_cast<double>(events);
+}
+
+// Args: resolution index, density (permille)
+void BM_FrameUnpacker(benchmark::State& state)
+{
+    const bench::Resolution& res = bench::kResolutions[state.range(0)];
+    Config cfg = bench::makeConfig(res.width, res.height);
+    std::vector<uint8_t> frame = bench::makeFrame(cfg, static_cast<double>(state.range(1)) / 1000.0, 1);
+
+    FrameUnpacker unpacker(cfg);
+    dv::EventStore events;
+    uint64_t frame_number = 0;
+    size_t count = 0;
+
+    for (auto _ : state) {
+        count = unpacker.unpack(frame.data(), frame.size(), frame_number++, events);
+        benchmark::DoNotOptimize(count);
+    }
+
+    setFrameCounters(state, cfg, count);
+    state.SetLabel(unpackKernelToString(unpacker.getActiveKernel()));
+}
+BENCHMARK(BM_FrameUnpacker)
+    ->ArgsProduct({{0, 1, 2}, bench::kDensitiesPermille})
+    ->ArgNames({"res", "permille"});
+
+// Args: kernel index, density (permille), specialized; 1280x720, kernel call only
+// (specialized = 1: the 1280x720 instantiation, 0: the generic kernel)
+void BM_UnpackKernel(benchmark::State& state)
+{
+    const UnpackKernel kernel = kKernels[state.range(0)];
+    if (!isUnpackKernelSupported(kernel)) {
+        state.SkipWithError("kernel not supported on this CPU");
+        return;
+    }
+
+    Config cfg = bench::makeConfig(1280, 720);
+    std::vector<uint8_t> frame = bench::makeFrame(cfg, static_cast<double>(state.range(1)) / 1000.0, 1);
+    std::vector<dv::Event> out(frame.size() * 4);
+    UnpackParams params(cfg.width, cfg.total_pixels(), 0);
+    const bool specialized = state.range(2) != 0;
+    UnpackKernelFn fn = specialized ? getUnpackKernel(kernel, cfg.width, cfg.height) : getUnpackKernel(kernel);
+    size_t count = 0;
+
+    for (auto _ : state) {
+        count = fn(frame.data(), 0, frame.size(), params, out.data());
+        benchmark::DoNotOptimize(count);
+        benchmark::ClobberMemory();
+    }
+
+    setFrameCounters(state, cfg, count);
+    state.SetLabel(std::string(unpackKernelToString(kernel)) + (specialized ? " 1280x720" : " generic"));
+}
+BENCHMARK(BM_UnpackKernel)
+    ->ArgsProduct({{0, 1, 2, 3, 4}, bench::kDensitiesPermille, {0, 1}})
+    ->ArgNames({"kernel", "permille", "specialized"});
+
+// Args: density (permille); events only in a few rows, with a row occupancy bitmap
+void BM_FrameUnpackerOccupancy(benchmark::State& state)
+{
+    Config cfg = bench::makeConfig(1280, 720);
+    cfg.has_header = true;
+    cfg.occupancy_map = OccupancyMap::Rows;
+
+    // Every 16th row active at the given density, the rest empty
+    std::vector<uint8_t> frame(static_cast<size_t>(cfg.frame_size()), 0);
+    std::vector<uint8_t> dense = bench::makeFrame(cfg, static_cast<double>(state.range(0)) / 1000.0, 1);
+    std::vector<uint8_t> occupancy(static_cast<size_t>(cfg.occupancy_map_bytes()), 0);
+    const size_t row_bytes = static_cast<size_t>(cfg.width) / 4;
+    for (int row = 0; row < cfg.height; row += 16) {
+        std::copy_n(dense.begin() + row * row_bytes, row_bytes, frame.begin() + row * row_bytes);
+        occupancy[static_cast<size_t>(row) / 8] |= static_cast<uint8_t>(1u << (row % 8));
+    }
+
+    FrameUnpacker unpacker(cfg);
+    dv::EventStore events;
+    uint64_t frame_number = 0;
+    size_t count = 0;
+
+    for (auto _ : state) {
+        count = unpacker.unpack(frame.data(), frame.size(), frame_number++, events, occupancy.data());
+        benchmark::DoNotOptimize(count);
+    }
+
+    setFrameCounters(state, cfg, count);
+}
+BENCHMARK(BM_FrameUnpackerOccupancy)->Arg(10)->Arg(100)->Arg(500)->ArgName("permille");
+
+// Args: density (permille); 1280x720, hot-pixel mask + refractory + background activity
+void BM_NoiseFilter(benchmark::State& state)
+{
+    Config cfg = bench::makeConfig(1280, 720);
+    cfg.refractory_period_us = 1000;
+    cfg.background_activity_us = 2000;
+    cfg.hot_pixel_learn_frames = 1;
+    cfg.hot_pixel_fraction = 1.0;   // Learn an empty mask: the AND runs, nothing is hot
+
+    std::vector<uint8_t> frame = bench::makeFrame(cfg, static_cast<double>(state.range(0)) / 1000.0, 1);
+    std::vector<uint8_t> out(frame.size());
+    NoiseFilter filter(cfg);
+    int64_t timestamp = 0;
+    filter.filter(frame.data(), out.data(), frame.size(), timestamp);
+
+    size_t kept = 0;
+    for (auto _ : state) {
+        timestamp += cfg.frame_interval_us;
+        kept = filter.filter(frame.data(), out.data(), frame.size(), timestamp);
+        benchmark::DoNotOptimize(kept);
+    }
+
+    setFrameCounters(state, cfg, bench::countEvents(cfg, frame));
+    state.counters["events_kept"] = static_cast<double>(kept);
+}
+BENCHMARK(BM_NoiseFilter)->Arg(1)->Arg(10)->Arg(100)->ArgName("permille");
+
+// Args: mode (0 = Polarity, 1 = TimeSurface), density (permille), packed (1 = hand
+// over the packed frame, read when dense enough, 0 = its events only); 1280x720,
+// one image rendered per 33 ms window
+void BM_FrameAccumulator(benchmark::State& state)
+{
+    Config cfg = bench::makeConfig(1280, 720);
+    cfg.frame_output_mode = state.range(0) == 0 ? FrameOutputMode::Polarity : FrameOutputMode::TimeSurface;
+    std::vector<uint8_t> packed = bench::makeFrame(cfg, static_cast<double>(state.range(1)) / 1000.0, 1);
+    const bool use_packed = state.range(2) != 0;
+
+    FramePool pool(1, packed.size());
+    PipelineFrame frame;
+    frame.num_events = bench::countEvents(cfg, packed);
+    if (use_packed) {
+        frame.buffer = pool.tryAcquire();
+        std::memcpy(frame.buffer.data(), packed.data(), packed.size());
+        frame.buffer.setSize(packed.size());
+    } else {
+        FrameUnpacker unpacker(cfg);
+        unpacker.unpack(packed.data(), packed.size(), 0, frame.events);
+    }
+
+    FrameAccumulator accumulator(cfg, [](const dv::Frame& image) { benchmark::DoNotOptimize(image.timestamp); });
+    accumulator.start();
+    for (auto _ : state) {
+        frame.timestamp += cfg.frame_interval_us;
+        accumulator.accumulate(frame);
+    }
+    accumulator.stop();
+
+    setFrameCounters(state, cfg, frame.num_events);
+    state.counters["images"] = static_cast<double>(accumulator.getFramesWritten());
+    state.SetLabel(std::string(frameOutputModeToString(cfg.frame_output_mode)) + (use_packed ? " packed" : " events"));
+}
+BENCHMARK(BM_FrameAccumulator)
+    ->ArgsProduct({{0, 1}, bench::kDensitiesPermille, {0, 1}})
+    ->ArgNames({"mode", "permille", "packed"});
+
+} // namespace
@@ -0,0 +1,122 @@
+#include "bench_common.hpp"
+#include "event_batcher.hpp"
+#include <dv-processing/io/network_reader.hpp>
+#include <dv-processing/io/network_writer.hpp>
+#include <dv-processing/io/stream.hpp>
+#include <benchmark/benchmark.h>
+#include <memory>
+#include <vector>
+
+using namespace converter;
+
+namespace {
+
+// Store of `count` events spread over a 1280x720 frame, as the unpacker makes it
+dv::EventStore makeStore(size_t count, int64_t first_timestamp = 0)
+{
+    auto packet = std::make_shared<dv::EventPacket>();
+    packet->elements.reserve(count);
+    for (size_t i = 0; i < count; i++) {
+        size_t pixel = (i * 7919) % (1280 * 720);
+        packet->elements.emplace_back(first_timestamp + static_cast<int64_t>(i), static_cast<int16_t>(pixel % 1280),
+                                      static_cast<int16_t>(pixel / 1280), (i & 1) != 0);
+    }
+    return dv::EventStore(std::move(packet));
+}
+
+// Args: events per store. A local NetworkReader is connected and drained,
+// so the writer really serializes and sends every packet.
+void BM_NetworkWriterEncode(benchmark::State& state)
+{
+    const size_t count = static_cast<size_t>(state.range(0));
+    const uint16_t port = static_cast<uint16_t>(bench::nextPort());
+    dv::io::Stream stream = dv::io::Stream::EventStream(0, "events", "DVS", cv::Size(1280, 720));
+    dv::io::NetworkWriter writer("127.0.0.1", port, stream);
+
+    std::atomic<bool> running{true};
+    std::thread reader_thread([&]() {
+        dv::io::NetworkReader reader("127.0.0.1", port);
+        while (running) {
+            if (!reader.getNextEventBatch()) {
+                std::this_thread::sleep_for(std::chrono::microseconds(50));
+            }
+        }
+    });
+
+    // Do not time the client handshake
+    while (writer.getClientCount() == 0) {
+        std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    }
+
+    dv::EventStore store = makeStore(count);
+    for (auto _ : state) {
+        writer.writeEvents(store);
+    }
+
+    state.counters["events_per_s"] = benchmark::Counter(
+        static_cast<double>(state.iterations()) * static_cast<double>(count), benchmark::Counter::kIsRate);
+    state.counters["queued_packets"] = static_cast<double>(writer.getQueuedPacketCount());
+
+    running = false;
+    reader_thread.join();
+}
+BENCHMARK(BM_NetworkWriterEncode)
+    ->Arg(1000)->Arg(10000)->Arg(100000)->Arg(600000)
+    ->ArgName("events")
+    ->UseRealTime();
+
+// Args: events per frame, frames per packet. One iteration is one frame fed
+// through an EventBatcher, so frames_per_s compares packet overheads.
+void BM_NetworkWriterBatched(benchmark::State& state)
+{
+    const size_t count = static_cast<size_t>(state.range(0));
+    const size_t frames_per_packet = static_cast<size_t>(state.range(1));
+    const uint16_t port = static_cast<uint16_t>(bench::nextPort());
+    dv::io::Stream stream = dv::io::Stream::EventStream(0, "events", "DVS", cv::Size(1280, 720));
+    dv::io::NetworkWriter writer("127.0.0.1", port, stream);
+
+    std::atomic<bool> running{true};
+    std::thread reader_thread([&]() {
+        dv::io::NetworkReader reader("127.0.0.1", port);
+        while (running) {
+            if (!reader.getNextEventBatch()) {
+                std::this_thread::sleep_for(std::chrono::microseconds(50));
+            }
+        }
+    });
+    while (writer.getClientCount() == 0) {
+        std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    }
+
+    // Only the event limit flushes: each packet is exactly frames_per_packet frames
+    Config cfg;
+    cfg.output_batch_latency_us = 10000000;
+    cfg.output_batch_max_events = count * frames_per_packet;
+    EventBatcher batcher(cfg, [&writer](const dv::EventStore& events) { writer.writeEvents(events); });
+
+    // A packet's frames must be in timestamp order; every packet reuses the same ones
+    std::vector<dv::EventStore> frames;
+    for (size_t i = 0; i < frames_per_packet; i++) {
+        frames.push_back(makeStore(count, static_cast<int64_t>(i * count)));
+    }
+
+    size_t next = 0;
+    for (auto _ : state) {
+        batcher.add(frames[next]);
+        next = next + 1 == frames_per_packet ? 0 : next + 1;
+    }
+    batcher.flush();
+
+    state.counters["frames_per_s"] = benchmark::Counter(static_cast<double>(state.iterations()),
+                                                        benchmark::Counter::kIsRate);
+    state.counters["packets"] = static_cast<double>(batcher.getBatchesWritten());
+
+    running = false;
+    reader_thread.join();
+}
+BENCHMARK(BM_NetworkWriterBatched)
+    ->ArgsProduct({{100, 1000}, {1, 10, 50}})
+    ->ArgNames({"events", "frames"})
+    ->UseRealTime();
+
+} // namespace
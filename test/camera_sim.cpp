@@ -0,0 +1,903 @@
+/**
+ * camera_sim - high-rate synthetic FPGA camera
+ *
+ * Generates 2-bit packed frames (same layout and size as Config::frame_size())
+ * into one memory-mapped region up front, then sends them over TCP (writev,
+ * several frames per call) or UDP (sendmmsg, a batch of datagrams per call)
+ * paced against the steady clock. Nothing is generated or copied while
+ * sending, so the generator can saturate 10/25 GbE and the converter is what
+ * gets measured.
+ *
+ * Usage:
+ *   camera_sim --fps 10000 --density 0.01                # TCP to 127.0.0.1:6000
+ *   camera_sim --protocol udp --packet-size 8192 --fps 0 # UDP, unpaced
+ *   camera_sim --scene circles --header --occupancy rows # Exercise the header paths
+ *   camera_sim --fpga-timestamp                          # Microsecond FPGA timestamp per frame
+ *   camera_sim --encoding zero-runs --fps 10000          # Compressed frames (see FrameEncoding)
+ *   camera_sim --crc --bad-crc 16                        # Frame CRC, every 16th one wrong
+ *   camera_sim --help
+ */
+
+#include "config.hpp"
+#include "crc32c.hpp"
+#include "udp_receiver.hpp"
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cmath>
+#include <csignal>
+#include <cstdlib>
+#include <cstring>
+#include <iomanip>
+#include <iostream>
+#include <random>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include <arpa/inet.h>
+#include <climits>
+#include <netinet/in.h>
+#include <sys/mman.h>
+#include <sys/socket.h>
+#include <sys/uio.h>
+#include <unistd.h>
+
+#ifndef MSG_NOSIGNAL
+    #define MSG_NOSIGNAL 0
+#endif
+
+using namespace converter;
+using Clock = std::chrono::steady_clock;
+
+namespace {
+
+std::atomic<bool> running{true};
+
+void signalHandler(int)
+{
+    running = false;
+}
+
+/**
+ * What the generated frames show
+ */
+enum class Scene {
+    Random,     // Independent pixels at the given density
+    Circles,    // Two moving circle outlines (opposite polarity) over noise
+    Bars        // A vertical bar sweeping across, edges only, over noise
+};
+
+struct SimOptions {
+    Protocol protocol = Protocol::TCP;
+    std::string target = "127.0.0.1";
+    int port = 6000;
+    int width = 1280;
+    int height = 720;
+    double fps = 100.0;             // 0 = as fast as possible
+    double density = 0.001;         // Event fraction (Random) or background noise
+    Scene scene = Scene::Random;
+    int frames = 64;                // Distinct frames generated up front
+    double duration = 0.0;          // Seconds, 0 = until Ctrl+C
+    int packet_size = 8192;         // UDP datagram size, headers included
+    int batch = 64;                 // Frames per writev / datagrams per sendmmsg
+    bool header = false;            // TCP: 4-byte size header per frame
+    OccupancyMap occupancy = OccupancyMap::None;   // TCP: bitmap after the header
+    bool fpga_timestamp = false;    // TCP: 64-bit microsecond timestamp after the size
+    bool sequence_header = false;   // UDP: UdpFragmentHeader per datagram
+    FrameEncoding encoding = FrameEncoding::Dense;  // Compression (frames that do not shrink stay dense)
+    bool crc = false;               // CRC32C per frame (frame_crc = true)
+    int bad_crc = 0;                // Corrupt the CRC of every Nth stored frame, 0 = none
+    int send_buffer = 16 * 1024 * 1024;
+};
+
+void printUsage()
+{
+    std::cout <<
+        "camera_sim - high-rate synthetic camera for DVBridge\n\n"
+        "  --protocol tcp|udp     Transport (default tcp)\n"
+        "  --target IP            Converter address (default 127.0.0.1)\n"
+        "  --port N               Converter camera port (default 6000)\n"
+        "  --width N --height N   Frame geometry (default 1280 x 720)\n"
+        "  --fps F                Frames per second, 0 = unpaced (default 100)\n"
+        "  --density D            Event density / noise level, 0..1 (default 0.001)\n"
+        "  --scene random|circles|bars\n"
+        "  --frames N             Distinct frames to pre-generate (default 64)\n"
+        "  --duration S           Stop after S seconds (default: run until Ctrl+C)\n"
+        "  --packet-size N        UDP datagram size in bytes (default 8192)\n"
+        "  --batch N              Frames per writev / datagrams per sendmmsg (default 64)\n"
+        "  --header               TCP: send a 4-byte size header (has_header = true)\n"
+        "  --occupancy rows|blocks  TCP: send an occupancy bitmap after the header\n"
+        "  --fpga-timestamp       TCP: send a microsecond send timestamp after the size\n"
+        "                         (timestamp_source = FpgaHeader)\n"
+        "  --sequence-header      UDP: prefix datagrams with UdpFragmentHeader\n"
+        "  --encoding dense|zero-runs|byte-list\n"
+        "                         Compress frames, flagged in the size header (TCP, implies\n"
+        "                         --header) or fragment header (UDP, needs --sequence-header)\n"
+        "  --crc                  Send a CRC32C per frame (frame_crc = true): in the header\n"
+        "                         (TCP, implies --header) or as a trailer (UDP)\n"
+        "  --bad-crc N            Corrupt the CRC of every Nth stored frame (N <= --frames)\n";
+}
+
+bool parseOptions(int argc, char* argv[], SimOptions& opt)
+{
+    for (int i = 1; i < argc; i++) {
+        std::string arg = argv[i];
+        auto value = [&]() -> std::string {
+            if (i + 1 >= argc) {
+                throw std::invalid_argument("missing value for " + arg);
+            }
+            return argv[++i];
+        };
+
+        if (arg == "--help" || arg == "-h") {
+            printUsage();
+            std::exit(0);
+        } else if (arg == "--protocol") {
+            std::string p = value();
+            if (p != "tcp" && p != "udp") {
+                throw std::invalid_argument("protocol must be tcp or udp");
+            }
+            opt.protocol = p == "tcp" ? Protocol::TCP : Protocol::UDP;
+        } else if (arg == "--target") {
+            opt.target = value();
+        } else if (arg == "--port") {
+            opt.port = std::stoi(value());
+        } else if (arg == "--width") {
+            opt.width = std::stoi(value());
+        } else if (arg == "--height") {
+            opt.height = std::stoi(value());
+        } else if (arg == "--fps") {
+            opt.fps = std::stod(value());
+        } else if (arg == "--density") {
+            opt.density = std::stod(value());
+        } else if (arg == "--scene") {
+            std::string s = value();
+            if (s == "random") {
+                opt.scene = Scene::Random;
+            } else if (s == "circles") {
+                opt.scene = Scene::Circles;
+            } else if (s == "bars") {
+                opt.scene = Scene::Bars;
+            } else {
+                throw std::invalid_argument("unknown scene " + s);
+            }
+        } else if (arg == "--frames") {
+            opt.frames = std::stoi(value());
+        } else if (arg == "--duration") {
+            opt.duration = std::stod(value());
+        } else if (arg == "--packet-size") {
+            opt.packet_size = std::stoi(value());
+        } else if (arg == "--batch") {
+            opt.batch = std::stoi(value());
+        } else if (arg == "--header") {
+            opt.header = true;
+        } else if (arg == "--occupancy") {
+            std::string m = value();
+            if (m != "rows" && m != "blocks") {
+                throw std::invalid_argument("occupancy must be rows or blocks");
+            }
+            opt.occupancy = m == "rows" ? OccupancyMap::Rows : OccupancyMap::Blocks;
+        } else if (arg == "--fpga-timestamp") {
+            opt.fpga_timestamp = true;
+        } else if (arg == "--sequence-header") {
+            opt.sequence_header = true;
+        } else if (arg == "--encoding") {
+            std::string e = value();
+            if (e == "dense") {
+                opt.encoding = FrameEncoding::Dense;
+            } else if (e == "zero-runs") {
+                opt.encoding = FrameEncoding::ZeroRuns;
+            } else if (e == "byte-list") {
+                opt.encoding = FrameEncoding::ByteList;
+            } else {
+                throw std::invalid_argument("unknown encoding " + e);
+            }
+        } else if (arg == "--crc") {
+            opt.crc = true;
+        } else if (arg == "--bad-crc") {
+            opt.bad_crc = std::stoi(value());
+        } else {
+            throw std::invalid_argument("unknown option " + arg);
+        }
+    }
+
+    if (opt.width <= 0 || opt.height <= 0 || opt.frames <= 0 || opt.batch <= 0 || opt.fps < 0) {
+        throw std::invalid_argument("width, height, frames and batch must be positive, fps >= 0");
+    }
+    if (opt.density < 0.0 || opt.density > 1.0) {
+        throw std::invalid_argument("density must be between 0 and 1");
+    }
+    if (opt.occupancy != OccupancyMap::None || opt.fpga_timestamp || opt.encoding != FrameEncoding::Dense ||
+        (opt.crc && opt.protocol == Protocol::TCP)) {
+        opt.header = true;  // Bitmap, timestamp, encoding flag and CRC live in the size header
+    }
+    if (opt.bad_crc < 0 || opt.bad_crc > opt.frames || (opt.bad_crc > 0 && !opt.crc)) {
+        throw std::invalid_argument("--bad-crc needs --crc and at most --frames");
+    }
+    if (opt.protocol == Protocol::UDP && opt.encoding != FrameEncoding::Dense && !opt.sequence_header) {
+        throw std::invalid_argument("compressed UDP frames need --sequence-header");
+    }
+    int overhead = opt.sequence_header ? static_cast<int>(sizeof(UdpFragmentHeader)) : 0;
+    if (opt.protocol == Protocol::UDP && (opt.packet_size <= overhead || opt.packet_size > 65507)) {
+        throw std::invalid_argument("packet size must fit a UDP datagram (at most 65507 bytes)");
+    }
+    return true;
+}
+
+// =========================================================================
+// FRAME GENERATION
+// =========================================================================
+
+void setPixel(uint8_t* frame, const Config& cfg, int x, int y, bool positive)
+{
+    if (x < 0 || y < 0 || x >= cfg.width || y >= cfg.height) {
+        return;
+    }
+    size_t pixel = static_cast<size_t>(y) * cfg.width + x;
+    int shift = 6 - 2 * static_cast<int>(pixel % 4);
+    uint8_t& byte = frame[pixel / 4];
+    byte = static_cast<uint8_t>((byte & ~(0x03 << shift)) | ((positive ? 0x01 : 0x02) << shift));
+}
+
+// Independent events at `density`, jumping from one event to the next
+void addNoise(uint8_t* frame, const Config& cfg, double density, std::mt19937& rng)
+{
+    if (density <= 0.0) {
+        return;
+    }
+    std::geometric_distribution<int64_t> gap(std::min(density, 1.0));
+    std::bernoulli_distribution positive(0.5);
+    for (int64_t pixel = gap(rng); pixel < cfg.total_pixels(); pixel += 1 + gap(rng)) {
+        setPixel(frame, cfg, static_cast<int>(pixel % cfg.width), static_cast<int>(pixel / cfg.width), positive(rng));
+    }
+}
+
+void drawCircle(uint8_t* frame, const Config& cfg, int cx, int cy, int radius, bool positive)
+{
+    const int steps = std::max(16, static_cast<int>(2.0 * M_PI * radius));
+    for (int thickness = 0; thickness < 2; thickness++) {
+        for (int s = 0; s < steps; s++) {
+            double angle = 2.0 * M_PI * s / steps;
+            setPixel(frame, cfg, cx + static_cast<int>(std::lround((radius + thickness) * std::cos(angle))),
+                     cy + static_cast<int>(std::lround((radius + thickness) * std::sin(angle))), positive);
+        }
+    }
+}
+
+void renderFrame(uint8_t* frame, const Config& cfg, const SimOptions& opt, int index, std::mt19937& rng)
+{
+    std::memset(frame, 0, static_cast<size_t>(cfg.frame_size()));
+    const double phase = 2.0 * M_PI * index / opt.frames;
+
+    switch (opt.scene) {
+        case Scene::Random:
+            addNoise(frame, cfg, opt.density, rng);
+            break;
+
+        case Scene::Circles: {
+            int radius = std::max(4, std::min(cfg.width, cfg.height) / 10);
+            drawCircle(frame, cfg, cfg.width / 2 + static_cast<int>(cfg.width / 3 * std::sin(phase)),
+                       cfg.height / 3, radius, true);
+            drawCircle(frame, cfg, cfg.width / 2,
+                       cfg.height / 2 + static_cast<int>(cfg.height / 3 * std::sin(phase * 2)), radius, false);
+            addNoise(frame, cfg, opt.density, rng);
+            break;
+        }
+
+        case Scene::Bars: {
+            // Leading edge brightens, trailing edge darkens
+            int bar_width = std::max(2, cfg.width / 16);
+            int left = static_cast<int>((cfg.width + bar_width) * index / opt.frames) - bar_width;
+            for (int y = 0; y < cfg.height; y++) {
+                setPixel(frame, cfg, left + bar_width, y, true);
+                setPixel(frame, cfg, left, y, false);
+            }
+            addNoise(frame, cfg, opt.density, rng);
+            break;
+        }
+    }
+}
+
+// Set bit i of the bitmap when unit i of the frame holds an event (LSB first)
+void buildOccupancy(const uint8_t* frame, const Config& cfg, uint8_t* bitmap)
+{
+    std::memset(bitmap, 0, static_cast<size_t>(cfg.occupancy_map_bytes()));
+    for (int byte = 0; byte < cfg.frame_size(); byte++) {
+        uint8_t v = frame[byte];
+        if (((v ^ (v >> 1)) & 0x55) == 0) {
+            continue;
+        }
+        for (int px = 0; px < 4; px++) {
+            int pixel = byte * 4 + px;
+            int value = (v >> (6 - 2 * px)) & 0x03;
+            if ((value != 1 && value != 2) || pixel >= cfg.total_pixels()) {
+                continue;
+            }
+            int unit = cfg.occupancy_map == OccupancyMap::Rows ? pixel / cfg.width
+                                                              : byte / cfg.occupancy_block_bytes;
+            bitmap[unit / 8] |= static_cast<uint8_t>(1u << (unit % 8));
+        }
+    }
+}
+
+// [uint16 zeros][uint16 literals][literal bytes] runs, see FrameEncoding::ZeroRuns
+std::vector<uint8_t> encodeZeroRuns(const uint8_t* frame, size_t size)
+{
+    std::vector<uint8_t> out;
+    size_t i = 0;
+    while (i < size) {
+        size_t zeros = 0;
+        while (i < size && frame[i] == 0 && zeros < 0xFFFF) {
+            i++;
+            zeros++;
+        }
+        if (i == size) {
+            break;  // Trailing zeros are implied
+        }
+
+        // Literals run until 4+ zero bytes (worth a new run header) or the length limit
+        const size_t start = i;
+        const size_t limit = std::min(size, start + 0xFFFF);
+        size_t end = start;
+        while (end < limit) {
+            if (frame[end] != 0) {
+                end++;
+                continue;
+            }
+            size_t z = end;
+            while (z < size && frame[z] == 0 && z - end < 4) {
+                z++;
+            }
+            if (z - end >= 4 || z == size || z > limit) {
+                break;
+            }
+            end = z;
+        }
+
+        uint16_t run[2] = {static_cast<uint16_t>(zeros), static_cast<uint16_t>(end - start)};
+        const uint8_t* header = reinterpret_cast<const uint8_t*>(run);
+        out.insert(out.end(), header, header + sizeof(run));
+        out.insert(out.end(), frame + start, frame + end);
+        i = end;
+    }
+    return out;
+}
+
+// uint32 (offset << 8) | value per non-zero byte, see FrameEncoding::ByteList
+std::vector<uint8_t> encodeByteList(const uint8_t* frame, size_t size)
+{
+    std::vector<uint8_t> out;
+    for (size_t i = 0; i < size; i++) {
+        if (frame[i] != 0) {
+            uint32_t entry = static_cast<uint32_t>(i << 8) | frame[i];
+            const uint8_t* bytes = reinterpret_cast<const uint8_t*>(&entry);
+            out.insert(out.end(), bytes, bytes + sizeof(entry));
+        }
+    }
+    return out;
+}
+
+/**
+ * All frames, pre-rendered back to back in one mapping
+ *
+ * Each entry is the exact TCP wire image ([size][timestamp][crc][bitmap][payload]),
+ * so one writev iovec covers one frame. With FPGA timestamps the header
+ * (size + timestamp) is built per send instead and the iovec starts after it.
+ * UDP sends slices of the payload part, plus the CRC trailer stored after it.
+ * The payload is the dense frame, or its compressed form when an encoding was
+ * requested and it came out smaller.
+ */
+class FrameStore {
+public:
+    FrameStore(const Config& cfg, const SimOptions& opt)
+        : frame_offset_(0)
+        , stride_(0)
+        , count_(static_cast<size_t>(opt.frames))
+        , mapped_(0)
+        , base_(nullptr)
+    {
+        const size_t header = opt.protocol == Protocol::TCP && opt.header
+                              ? sizeof(uint32_t) + static_cast<size_t>(cfg.timestamp_header_bytes()) : 0;
+        header_size_ = header;
+        const size_t crc_header = static_cast<size_t>(cfg.frame_crc_header_bytes());
+        const size_t bitmap = static_cast<size_t>(cfg.occupancy_map_bytes());
+        const size_t frame_size = static_cast<size_t>(cfg.frame_size());
+        frame_offset_ = header + crc_header + bitmap;
+        trailer_size_ = static_cast<size_t>(cfg.frame_crc_trailer_bytes());
+
+        // Render (and compress) first: the stride depends on the largest payload
+        std::vector<std::vector<uint8_t>> dense(count_, std::vector<uint8_t>(frame_size));
+        std::vector<std::vector<uint8_t>> encoded(count_);
+        encoding_.assign(count_, FrameEncoding::Dense);
+        payload_size_.assign(count_, frame_size);
+        size_t largest = 0;
+
+        std::mt19937 rng(12345);
+        for (size_t i = 0; i < count_; i++) {
+            renderFrame(dense[i].data(), cfg, opt, static_cast<int>(i), rng);
+            events_ += countEvents(dense[i].data(), cfg);
+
+            if (opt.encoding == FrameEncoding::ZeroRuns) {
+                encoded[i] = encodeZeroRuns(dense[i].data(), frame_size);
+            } else if (opt.encoding == FrameEncoding::ByteList && frame_size <= (size_t{1} << 24)) {
+                encoded[i] = encodeByteList(dense[i].data(), frame_size);
+            }
+            if (opt.encoding != FrameEncoding::Dense && encoded[i].size() < frame_size) {
+                encoding_[i] = opt.encoding;
+                payload_size_[i] = encoded[i].size();
+            }
+            largest = std::max(largest, payload_size_[i]);
+            payload_bytes_ += payload_size_[i];
+        }
+
+        // Cache-line aligned frames; at least one line, every frame may be empty
+        stride_ = std::max<size_t>(64, (frame_offset_ + largest + trailer_size_ + 63) & ~size_t{63});
+        mapped_ = stride_ * count_;
+
+        void* mem = mmap(nullptr, mapped_, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+        if (mem == MAP_FAILED) {
+            throw std::runtime_error("Failed to map frame store");
+        }
+        base_ = static_cast<uint8_t*>(mem);
+
+        for (size_t i = 0; i < count_; i++) {
+            uint8_t* wire = base_ + i * stride_;
+            const bool compressed = encoding_[i] != FrameEncoding::Dense;
+            std::memcpy(wire + frame_offset_, compressed ? encoded[i].data() : dense[i].data(), payload_size_[i]);
+            if (header > 0) {
+                // Receiver reads it in host order; the top bits flag the encoding
+                uint32_t size = static_cast<uint32_t>(payload_size_[i])
+                                | static_cast<uint32_t>(encoding_[i]) << kFrameEncodingShift;
+                std::memcpy(wire, &size, sizeof(size));
+            }
+            if (bitmap > 0) {
+                buildOccupancy(dense[i].data(), cfg, wire + header + crc_header);
+            }
+            if (crc_header > 0 || trailer_size_ > 0) {
+                // Covers the bitmap and payload; a deliberately bad one is off by a bit
+                uint32_t crc = crc32c(wire + header + crc_header, bitmap + payload_size_[i]);
+                if (opt.bad_crc > 0 && (i + 1) % static_cast<size_t>(opt.bad_crc) == 0) {
+                    crc ^= 1;
+                }
+                std::memcpy(crc_header > 0 ? wire + header : wire + frame_offset_ + payload_size_[i],
+                            &crc, sizeof(crc));
+            }
+        }
+
+        // Read-only from here on; keep it resident
+        mprotect(base_, mapped_, PROT_READ);
+        mlock(base_, mapped_);
+    }
+
+    ~FrameStore()
+    {
+        if (base_ != nullptr) {
+            munmap(base_, mapped_);
+        }
+    }
+
+    FrameStore(const FrameStore&) = delete;
+    FrameStore& operator=(const FrameStore&) = delete;
+
+    const uint8_t* wire(size_t i) const { return base_ + (i % count_) * stride_; }
+    const uint8_t* frame(size_t i) const { return wire(i) + frame_offset_; }
+    size_t wireSize(size_t i) const { return frame_offset_ + payload_size_[i % count_]; }
+    size_t payloadSize(size_t i) const { return payload_size_[i % count_]; }
+    size_t trailerSize() const { return trailer_size_; }
+    FrameEncoding encoding(size_t i) const { return encoding_[i % count_]; }
+    size_t headerSize() const { return header_size_; }
+    size_t count() const { return count_; }
+    double eventsPerFrame() const { return static_cast<double>(events_) / static_cast<double>(count_); }
+    double payloadPerFrame() const { return static_cast<double>(payload_bytes_) / static_cast<double>(count_); }
+    size_t mappedBytes() const { return mapped_; }
+
+private:
+    static size_t countEvents(const uint8_t* frame, const Config& cfg)
+    {
+        size_t count = 0;
+        for (int pixel = 0; pixel < cfg.total_pixels(); pixel++) {
+            int value = (frame[pixel / 4] >> (6 - 2 * (pixel % 4))) & 0x03;
+            count += (value == 1) || (value == 2);
+        }
+        return count;
+    }
+
+    size_t frame_offset_;
+    size_t header_size_ = 0;
+    size_t trailer_size_ = 0;
+    std::vector<size_t> payload_size_;
+    std::vector<FrameEncoding> encoding_;
+    size_t payload_bytes_ = 0;
+    size_t stride_;
+    size_t count_;
+    size_t mapped_;
+    uint8_t* base_;
+    size_t events_ = 0;
+};
+
+// =========================================================================
+// PACING
+// =========================================================================
+
+/**
+ * Frame clock: frame k is due at start + k / fps
+ *
+ * Frames that are late are sent straight away (up to `burst` per call), so
+ * the long-run rate is exact even when individual wakeups are not.
+ */
+class Pacer {
+public:
+    Pacer(double fps, size_t burst)
+        : unpaced_(fps <= 0.0)
+        , interval_(unpaced_ ? 0.0 : 1.0 / fps)
+        , burst_(burst)
+        , start_(Clock::now())
+    {}
+
+    /**
+     * Wait until at least one frame is due
+     * @param sent Frames sent so far
+     * @return Number of frames to send now (0 if stopping)
+     */
+    size_t waitForDue(uint64_t sent)
+    {
+        if (unpaced_) {
+            return burst_;
+        }
+
+        const auto due_at = start_ + std::chrono::duration_cast<Clock::duration>(
+                                         std::chrono::duration<double>(interval_ * static_cast<double>(sent)));
+
+        // Sleep most of the way, spin the rest (sleep wakeups are ~50-100 us late)
+        for (;;) {
+            auto now = Clock::now();
+            if (now >= due_at || !running) {
+                break;
+            }
+            auto remaining = due_at - now;
+            if (remaining > std::chrono::microseconds(200)) {
+                std::this_thread::sleep_for(remaining - std::chrono::microseconds(100));
+            }
+        }
+
+        double elapsed = std::chrono::duration<double>(Clock::now() - start_).count();
+        uint64_t due = static_cast<uint64_t>(elapsed / interval_) + 1;
+        return static_cast<size_t>(std::min<uint64_t>(due > sent ? due - sent : 1, burst_));
+    }
+
+private:
+    bool unpaced_;
+    double interval_;
+    size_t burst_;
+    Clock::time_point start_;
+};
+
+// =========================================================================
+// SENDERS
+// =========================================================================
+
+sockaddr_in targetAddress(const SimOptions& opt)
+{
+    sockaddr_in addr{};
+    addr.sin_family = AF_INET;
+    addr.sin_port = htons(static_cast<uint16_t>(opt.port));
+    if (inet_pton(AF_INET, opt.target.c_str(), &addr.sin_addr) <= 0) {
+        throw std::invalid_argument("invalid target address " + opt.target);
+    }
+    return addr;
+}
+
+// Size + FPGA timestamp, host byte order like the converter reads them
+#pragma pack(push, 1)
+struct TimestampHeader {
+    uint32_t size;
+    uint64_t timestamp_us;
+};
+#pragma pack(pop)
+
+struct SendStats {
+    std::atomic<uint64_t> frames{0};
+    std::atomic<uint64_t> bytes{0};
+    std::atomic<uint64_t> syscalls{0};
+};
+
+// Write a whole iovec array, resuming after short writes
+bool writeAll(int sock, iovec* iov, int count, SendStats& stats)
+{
+    while (count > 0) {
+        ssize_t written = writev(sock, iov, count);
+        stats.syscalls.fetch_add(1, std::memory_order_relaxed);
+        if (written < 0) {
+            if (errno == EINTR) {
+                continue;
+            }
+            return false;
+        }
+        stats.bytes.fetch_add(static_cast<uint64_t>(written), std::memory_order_relaxed);
+
+        size_t left = static_cast<size_t>(written);
+        while (count > 0 && left >= iov->iov_len) {
+            left -= iov->iov_len;
+            iov++;
+            count--;
+        }
+        if (count > 0) {
+            iov->iov_base = static_cast<uint8_t*>(iov->iov_base) + left;
+            iov->iov_len -= left;
+        }
+    }
+    return true;
+}
+
+void runTcp(const SimOptions& opt, const FrameStore& store, SendStats& stats)
+{
+    const sockaddr_in addr = targetAddress(opt);
+
+    // The converter is the server; wait for it
+    int sock = -1;
+    while (running) {
+        sock = socket(AF_INET, SOCK_STREAM, 0);
+        if (connect(sock, reinterpret_cast<const sockaddr*>(&addr), sizeof(addr)) == 0) {
+            break;
+        }
+        close(sock);
+        sock = -1;
+        std::cout << "Waiting for converter on " << opt.target << ":" << opt.port << "..." << std::endl;
+        std::this_thread::sleep_for(std::chrono::seconds(1));
+    }
+    if (sock < 0) {
+        return;
+    }
+    setsockopt(sock, SOL_SOCKET, SO_SNDBUF, &opt.send_buffer, sizeof(opt.send_buffer));
+#ifdef SO_NOSIGPIPE
+    int one = 1;
+    setsockopt(sock, SOL_SOCKET, SO_NOSIGPIPE, &one, sizeof(one));
+#endif
+    std::cout << "Connected, sending frames" << std::endl;
+
+    // With FPGA timestamps each frame is two iovecs: fresh header, then the rest
+    const size_t parts = opt.fpga_timestamp ? 2 : 1;
+    const size_t burst = std::min<size_t>(static_cast<size_t>(opt.batch), IOV_MAX / parts);
+    std::vector<iovec> iov(burst * parts);
+    std::vector<TimestampHeader> headers(burst);
+    Pacer pacer(opt.fps, burst);
+    uint64_t sent = 0;
+
+    while (running) {
+        size_t n = pacer.waitForDue(sent);
+        for (size_t i = 0; i < n; i++) {
+            const uint8_t* wire = store.wire(sent + i);
+            if (opt.fpga_timestamp) {
+                std::memcpy(&headers[i].size, wire, sizeof(headers[i].size));
+                headers[i].timestamp_us = static_cast<uint64_t>(
+                    std::chrono::duration_cast<std::chrono::microseconds>(
+                        std::chrono::system_clock::now().time_since_epoch()).count());
+                iov[i * 2] = {&headers[i], sizeof(TimestampHeader)};
+                iov[i * 2 + 1] = {const_cast<uint8_t*>(wire) + store.headerSize(),
+                                  store.wireSize(sent + i) - store.headerSize()};
+            } else {
+                iov[i] = {const_cast<uint8_t*>(wire), store.wireSize(sent + i)};
+            }
+        }
+        if (!running || !writeAll(sock, iov.data(), static_cast<int>(n * parts), stats)) {
+            break;
+        }
+        sent += n;
+        stats.frames.fetch_add(n, std::memory_order_relaxed);
+    }
+
+    if (running) {
+        std::cerr << "Connection closed by converter" << std::endl;
+    }
+    close(sock);
+}
+
+void runUdp(const SimOptions& opt, const FrameStore& store, SendStats& stats)
+{
+    sockaddr_in addr = targetAddress(opt);
+    int sock = socket(AF_INET, SOCK_DGRAM, 0);
+    setsockopt(sock, SOL_SOCKET, SO_SNDBUF, &opt.send_buffer, sizeof(opt.send_buffer));
+    if (connect(sock, reinterpret_cast<const sockaddr*>(&addr), sizeof(addr)) != 0) {
+        std::cerr << "Failed to set UDP destination: " << std::strerror(errno) << std::endl;
+        close(sock);
+        return;
+    }
+
+    const size_t header = opt.sequence_header ? sizeof(UdpFragmentHeader) : 0;
+    const size_t payload = static_cast<size_t>(opt.packet_size) - header;
+    const size_t batch = static_cast<size_t>(opt.batch);
+
+    std::vector<UdpFragmentHeader> headers(batch);
+    std::vector<iovec> iov(batch * 2);
+#ifdef __linux__
+    std::vector<mmsghdr> msgs(batch);
+#else
+    std::vector<msghdr> msgs(batch);
+#endif
+
+    // Frame pacing, with datagrams of a frame sent in sendmmsg batches
+    Pacer pacer(opt.fps, 1);
+    uint64_t sent = 0;
+
+    while (running) {
+        if (pacer.waitForDue(sent) == 0) {
+            continue;
+        }
+        const uint8_t* frame = store.frame(sent);
+        // The CRC trailer rides in the last fragment; frame_bytes is the payload only.
+        // An empty compressed frame (all-zero pixels) is one header-only datagram
+        const size_t frame_size = store.payloadSize(sent) + store.trailerSize();
+        const size_t fragments = std::max<size_t>(1, (frame_size + payload - 1) / payload);
+        const uint32_t frame_bytes = static_cast<uint32_t>(store.payloadSize(sent))
+                                     | static_cast<uint32_t>(store.encoding(sent)) << kFrameEncodingShift;
+
+        for (size_t first = 0; first < fragments && running; first += batch) {
+            const size_t n = std::min(batch, fragments - first);
+            for (size_t k = 0; k < n; k++) {
+                const size_t index = first + k;
+                const size_t offset = index * payload;
+                const size_t len = std::min(payload, frame_size - offset);
+                int parts = 0;
+
+                if (header > 0) {
+                    UdpFragmentHeader& h = headers[k];
+                    h.frame_id = htonl(static_cast<uint32_t>(sent));
+                    h.fragment_index = htons(static_cast<uint16_t>(index));
+                    h.fragment_count = htons(static_cast<uint16_t>(fragments));
+                    h.frame_bytes = htonl(frame_bytes);
+                    h.fragment_offset = htonl(static_cast<uint32_t>(offset));
+                    iov[k * 2] = {&h, sizeof(h)};
+                    parts++;
+                }
+                iov[k * 2 + parts] = {const_cast<uint8_t*>(frame + offset), len};
+                parts++;
+
+#ifdef __linux__
+                std::memset(&msgs[k], 0, sizeof(msgs[k]));
+                msgs[k].msg_hdr.msg_iov = &iov[k * 2];
+                msgs[k].msg_hdr.msg_iovlen = static_cast<size_t>(parts);
+#else
+                std::memset(&msgs[k], 0, sizeof(msgs[k]));
+                msgs[k].msg_iov = &iov[k * 2];
+                msgs[k].msg_iovlen = parts;
+#endif
+                stats.bytes.fetch_add(header + len, std::memory_order_relaxed);
+            }
+
+            // Resume after partial batches; a full socket buffer just retries
+            size_t done = 0;
+            while (done < n && running) {
+#ifdef __linux__
+                int result = sendmmsg(sock, &msgs[done], static_cast<unsigned>(n - done), 0);
+#else
+                int result = sendmsg(sock, &msgs[done], 0) < 0 ? -1 : 1;
+#endif
+                stats.syscalls.fetch_add(1, std::memory_order_relaxed);
+                if (result < 0) {
+                    if (errno == ECONNREFUSED) {
+                        break;  // Nobody listening (yet); drop the batch like a camera would
+                    }
+                    if (errno == EINTR || errno == ENOBUFS || errno == EAGAIN) {
+                        continue;  // NIC queue full
+                    }
+                    std::cerr << "sendmmsg failed: " << std::strerror(errno) << std::endl;
+                    close(sock);
+                    return;
+                }
+                done += static_cast<size_t>(result);
+            }
+        }
+
+        sent++;
+        stats.frames.fetch_add(1, std::memory_order_relaxed);
+    }
+
+    close(sock);
+}
+
+} // namespace
+
+int main(int argc, char* argv[])
+{
+    SimOptions opt;
+    try {
+        parseOptions(argc, argv, opt);
+    } catch (const std::exception& e) {
+        std::cerr << "Error: " << e.what() << " (see --help)" << std::endl;
+        return 1;
+    }
+
+    std::signal(SIGINT, signalHandler);
+    std::signal(SIGTERM, signalHandler);
+    std::signal(SIGPIPE, SIG_IGN);
+
+    // Frame geometry exactly as the converter computes it
+    Config cfg;
+    cfg.width = opt.width;
+    cfg.height = opt.height;
+    cfg.has_header = opt.protocol == Protocol::TCP && opt.header;
+    cfg.occupancy_map = opt.occupancy;
+    cfg.protocol = opt.protocol;
+    cfg.udp_sequence_header = opt.sequence_header;
+    cfg.frame_crc = opt.crc;
+    if (opt.fpga_timestamp) {
+        cfg.timestamp_source = TimestampSource::FpgaHeader;
+    }
+
+    std::cout << "Generating " << opt.frames << " frames (" << cfg.width << " x " << cfg.height << ", "
+              << cfg.frame_size() << " bytes)..." << std::endl;
+    FrameStore store(cfg, opt);
+
+    std::cout << "  Protocol: " << protocolToString(opt.protocol) << " -> " << opt.target << ":" << opt.port
+              << std::endl;
+    std::cout << "  Rate: " << (opt.fps > 0 ? std::to_string(opt.fps) + " FPS" : std::string("unpaced"))
+              << ", " << std::fixed << std::setprecision(0) << store.eventsPerFrame() << " events/frame" << std::endl;
+    if (cfg.has_header) {
+        std::cout << "  Header: size" << (opt.fpga_timestamp ? " + timestamp" : "") << (opt.crc ? " + crc" : "")
+                  << (opt.occupancy != OccupancyMap::None
+                      ? std::string(" + ") + occupancyMapToString(opt.occupancy) + " bitmap"
+                      : std::string()) << std::endl;
+    }
+    if (store.trailerSize() > 0) {
+        std::cout << "  Trailer: crc" << std::endl;
+    }
+    if (opt.bad_crc > 0) {
+        std::cout << "  Bad CRC: every " << opt.bad_crc << " frames" << std::endl;
+    }
+    if (opt.encoding != FrameEncoding::Dense) {
+        std::cout << "  Encoding: " << frameEncodingToString(opt.encoding) << ", " << std::setprecision(0)
+                  << store.payloadPerFrame() << " bytes/frame (" << std::setprecision(1)
+                  << 100.0 * store.payloadPerFrame() / cfg.frame_size() << "% of dense)" << std::endl;
+    }
+    std::cout << "  Store: " << store.mappedBytes() / (1024 * 1024) << " MB mapped" << std::endl;
+
+    SendStats stats;
+    std::thread sender([&]() {
+        if (opt.protocol == Protocol::TCP) {
+            runTcp(opt, store, stats);
+        } else {
+            runUdp(opt, store, stats);
+        }
+        running = false;
+    });
+
+    // Rate report once a second
+    const auto start = Clock::now();
+    auto last = start;
+    uint64_t last_frames = 0;
+    uint64_t last_bytes = 0;
+
+    while (running) {
+        std::this_thread::sleep_for(std::chrono::milliseconds(100));
+        auto now = Clock::now();
+        if (opt.duration > 0 && std::chrono::duration<double>(now - start).count() >= opt.duration) {
+            running = false;
+        }
+        double dt = std::chrono::duration<double>(now - last).count();
+        if (dt < 1.0 && running) {
+            continue;
+        }
+
+        uint64_t frames = stats.frames.load(std::memory_order_relaxed);
+        uint64_t bytes = stats.bytes.load(std::memory_order_relaxed);
+        std::cout << "Sent: " << frames << " frames | FPS: " << std::setprecision(0)
+                  << (frames - last_frames) / dt << " | " << std::setprecision(2)
+                  << (bytes - last_bytes) * 8.0 / dt / 1e9 << " Gbit/s | MEv/s: "
+                  << (frames - last_frames) * store.eventsPerFrame() / dt / 1e6 << std::endl;
+        last = now;
+        last_frames = frames;
+        last_bytes = bytes;
+    }
+
+    sender.join();
+
+    double elapsed = std::chrono::duration<double>(Clock::now() - start).count();
+    uint64_t frames = stats.frames.load();
+    std::cout << "Total: " << frames << " frames in " << std::setprecision(1) << elapsed << " s ("
+              << std::setprecision(2) << stats.bytes.load() * 8.0 / std::max(elapsed, 1e-9) / 1e9
+              << " Gbit/s, " << static_cast<double>(stats.syscalls.load()) / std::max<uint64_t>(frames, 1)
+              << " syscalls per frame)" << std::endl;
+    return 0;
+}
@@ -16,16 +16,28 @@ Frame format (matches FPGA):
     10 = negative polarity (p=0)
     11 = unused
 
+With --sequence-header every datagram starts with the converter's 16-byte
+UdpFragmentHeader (big-endian), matching Config::udp_sequence_header = true:
+    uint32 frame_id          +1 per frame
+    uint16 fragment_index    0 .. fragment_count-1
+    uint16 fragment_count
+    uint32 frame_bytes       total frame size
+    uint32 fragment_offset   where this payload goes in the frame
+--drop-rate and --reorder-rate then exercise loss and reorder handling.
+
 Usage:
     python3 fake_camera_udp.py [--port 6000] [--fps 100] [--target 127.0.0.1]
+    python3 fake_camera_udp.py --sequence-header [--drop-rate 0.001] [--reorder-rate 0.01]
 """
 
 import socket
 import time
 import argparse
 import signal
+import struct
 import sys
 import math
+import random
 
 # Frame configuration (must match config.hpp and FPGA)
 WIDTH = 1280
@@ -38,6 +50,9 @@ FRAME_SIZE = (TOTAL_PIXELS + 3) // 4             # 230,400 bytes (2 bits per pix
 # For standard Ethernet: use ~1472 (1500 MTU - 28 bytes IP/UDP headers)
 DEFAULT_PACKET_SIZE = 8192
 
+# Fragment header (see UdpFragmentHeader in include/udp_receiver.hpp)
+FRAGMENT_HEADER = struct.Struct("!IHHII")
+
 # Running flag for graceful shutdown
 running = True
 
@@ -143,6 +158,45 @@ def send_frame_udp(sock: socket.socket, target: tuple, frame_data: bytes, packet
         offset += len(chunk)
 
 
+def send_frame_udp_sequenced(sock: socket.socket, target: tuple, frame_data: bytes, packet_size: int,
+                             frame_id: int, drop_rate: float, reorder_rate: float) -> int:
+    """
+    Send a frame as header-tagged fragments, optionally dropping or swapping some.
+
+    Args:
+        sock: UDP socket
+        target: (ip, port) tuple
+        frame_data: Complete frame data
+        packet_size: Maximum bytes per UDP packet (header included)
+        frame_id: Frame id for the header (wraps at 2^32)
+        drop_rate: Probability of not sending a fragment
+        reorder_rate: Probability of swapping a fragment with the next one
+
+    Returns:
+        Number of fragments dropped
+    """
+    payload_size = packet_size - FRAGMENT_HEADER.size
+    count = (len(frame_data) + payload_size - 1) // payload_size
+
+    datagrams = []
+    for index in range(count):
+        offset = index * payload_size
+        header = FRAGMENT_HEADER.pack(frame_id & 0xFFFFFFFF, index, count, len(frame_data), offset)
+        datagrams.append(header + frame_data[offset:offset + payload_size])
+
+    for i in range(len(datagrams) - 1):
+        if random.random() < reorder_rate:
+            datagrams[i], datagrams[i + 1] = datagrams[i + 1], datagrams[i]
+
+    dropped = 0
+    for datagram in datagrams:
+        if random.random() < drop_rate:
+            dropped += 1
+            continue
+        sock.sendto(datagram, target)
+    return dropped
+
+
 def main():
     global running
     
@@ -152,6 +206,12 @@ def main():
     parser.add_argument("--target", type=str, default="127.0.0.1", help="Target IP address")
     parser.add_argument("--packet-size", type=int, default=DEFAULT_PACKET_SIZE,
                         help=f"UDP packet size (default: {DEFAULT_PACKET_SIZE})")
+    parser.add_argument("--sequence-header", action="store_true",
+                        help="Prefix each datagram with a fragment header (udp_sequence_header)")
+    parser.add_argument("--drop-rate", type=float, default=0.0,
+                        help="Fraction of fragments to drop (needs --sequence-header)")
+    parser.add_argument("--reorder-rate", type=float, default=0.0,
+                        help="Fraction of fragments to swap with their successor (needs --sequence-header)")
     args = parser.parse_args()
 
     # Validate arguments
@@ -163,6 +223,14 @@ def main():
         print(f"Error: --packet-size must be between 1 and 65535, got {args.packet_size}", file=sys.stderr)
         sys.exit(1)
 
+    if args.sequence_header and args.packet_size <= FRAGMENT_HEADER.size:
+        print(f"Error: --packet-size must exceed the {FRAGMENT_HEADER.size}-byte header", file=sys.stderr)
+        sys.exit(1)
+
+    if (args.drop_rate or args.reorder_rate) and not args.sequence_header:
+        print("Error: --drop-rate/--reorder-rate need --sequence-header", file=sys.stderr)
+        sys.exit(1)
+
     # Setup signal handler
     signal.signal(signal.SIGINT, signal_handler)
     signal.signal(signal.SIGTERM, signal_handler)
@@ -177,7 +245,8 @@ def main():
         print("Warning: Could not set large send buffer size")
 
     target = (args.target, args.port)
-    packets_per_frame = (FRAME_SIZE + args.packet_size - 1) // args.packet_size
+    payload_size = args.packet_size - (FRAGMENT_HEADER.size if args.sequence_header else 0)
+    packets_per_frame = (FRAME_SIZE + payload_size - 1) // payload_size
 
     print(f"=" * 50)
     print(f"Fake Camera Simulator (UDP, 2-bit FPGA format)")
@@ -187,12 +256,15 @@ def main():
     print(f"Target: {args.target}:{args.port}")
     print(f"Packet size: {args.packet_size} bytes ({packets_per_frame} packets/frame)")
     print(f"Target FPS: {args.fps}")
+    if args.sequence_header:
+        print(f"Sequence header: on (drop {args.drop_rate:.2%}, reorder {args.reorder_rate:.2%})")
     print(f"=" * 50)
     print("Press Ctrl+C to stop...")
     print()
 
     frame_interval = 1.0 / args.fps
     frame_num = 0
+    fragments_dropped = 0
     start_time = time.time()
 
     while running:
@@ -201,7 +273,11 @@ def main():
 
         try:
             # Send frame via UDP
-            send_frame_udp(udp_socket, target, frame_data, args.packet_size)
+            if args.sequence_header:
+                fragments_dropped += send_frame_udp_sequenced(udp_socket, target, frame_data, args.packet_size,
+                                                              frame_num, args.drop_rate, args.reorder_rate)
+            else:
+                send_frame_udp(udp_socket, target, frame_data, args.packet_size)
 
             frame_num += 1
 
@@ -210,7 +286,10 @@ def main():
                 elapsed = time.time() - start_time
                 actual_fps = frame_num / elapsed if elapsed > 0 else 0
                 throughput_mbps = (frame_num * FRAME_SIZE * 8) / (elapsed * 1_000_000) if elapsed > 0 else 0
-                print(f"Sent {frame_num} frames | FPS: {actual_fps:.1f} | Throughput: {throughput_mbps:.1f} Mbps")
+                status = f"Sent {frame_num} frames | FPS: {actual_fps:.1f} | Throughput: {throughput_mbps:.1f} Mbps"
+                if args.sequence_header:
+                    status += f" | Fragments dropped: {fragments_dropped}"
+                print(status)
 
             # Rate limiting
             target_time = start_time + frame_num * frame_interval
@@ -0,0 +1,74 @@
+#pragma once
+
+#include <dv-processing/core/event.hpp>
+#include <cstdint>
+#include <random>
+#include <vector>
+
+namespace converter {
+namespace test {
+
+/**
+ * Reference event of a packed frame (what every unpack path must produce)
+ */
+struct ExpectedEvent {
+    int x;
+    int y;
+    bool polarity;
+};
+
+/**
+ * Generate a 2-bit packed frame with events at random pixels
+ *
+ * Pixels hold 00, 01, 10 or 11 (11 is not an event, but kernels must still
+ * skip it). Padding pixels past width * height are set to 01 so a kernel
+ * that decodes them is caught.
+ *
+ * @param width Frame width
+ * @param height Frame height
+ * @param density Fraction of pixels carrying an event (0..1)
+ * @param seed Random seed (same seed, same frame)
+ * @return Packed frame of (width * height + 3) / 4 bytes
+ */
+inline std::vector<uint8_t> makePackedFrame(int width, int height, double density, uint32_t seed)
+{
+    const int total = width * height;
+    std::vector<uint8_t> frame(static_cast<size_t>((total + 3) / 4), 0);
+
+    std::mt19937 rng(seed);
+    std::uniform_real_distribution<double> uniform(0.0, 1.0);
+    for (int pixel = 0; pixel < static_cast<int>(frame.size()) * 4; pixel++) {
+        uint8_t code;
+        if (pixel >= total) {
+            code = 0x01;
+        } else if (uniform(rng) < density) {
+            code = (rng() & 1) ? 0x01 : 0x02;
+        } else {
+            code = (rng() % 8 == 0) ? 0x03 : 0x00;
+        }
+        frame[static_cast<size_t>(pixel / 4)] |= static_cast<uint8_t>(code << (6 - 2 * (pixel % 4)));
+    }
+    return frame;
+}
+
+/**
+ * Decode a packed frame pixel by pixel
+ * @param frame Packed frame
+ * @param width Frame width
+ * @param height Frame height
+ * @return Events in pixel order
+ */
+inline std::vector<ExpectedEvent> decodeReference(const std::vector<uint8_t>& frame, int width, int height)
+{
+    std::vector<ExpectedEvent> events;
+    for (int pixel = 0; pixel < width * height; pixel++) {
+        int value = (frame[static_cast<size_t>(pixel / 4)] >> (6 - 2 * (pixel % 4))) & 0x03;
+        if (value == 1 || value == 2) {
+            events.push_back({pixel % width, pixel / width, value == 1});
+        }
+    }
+    return events;
+}
+
+} // namespace test
+} // namespace converter
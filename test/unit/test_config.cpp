@@ -0,0 +1,236 @@
+#include "config_loader.hpp"
+#include <gtest/gtest.h>
+#include <filesystem>
+#include <fstream>
+#include <sstream>
+#include <string>
+#include <vector>
+
+using namespace converter;
+
+namespace {
+
+/**
+ * Configuration file in the temp directory, removed with the test
+ */
+class TempConfigFile {
+public:
+    explicit TempConfigFile(const std::string& contents)
+        : path_(std::filesystem::temp_directory_path()
+                / ("dvbridge_test_" + std::to_string(::testing::UnitTest::GetInstance()->random_seed()) + "_"
+                   + ::testing::UnitTest::GetInstance()->current_test_info()->name() + ".toml"))
+    {
+        write(contents);
+    }
+
+    ~TempConfigFile()
+    {
+        std::error_code ec;
+        std::filesystem::remove(path_, ec);
+    }
+
+    void write(const std::string& contents)
+    {
+        std::ofstream(path_) << contents;
+    }
+
+    std::string path() const { return path_.string(); }
+
+private:
+    std::filesystem::path path_;
+};
+
+std::string printConfig(const Config& cfg)
+{
+    std::ostringstream out;
+    writeConfig(out, cfg);
+    return out.str();
+}
+
+const ConfigChange* findChange(const std::vector<ConfigChange>& changes, const std::string& key)
+{
+    for (const ConfigChange& change : changes) {
+        if (change.key == key) {
+            return &change;
+        }
+    }
+    return nullptr;
+}
+
+} // namespace
+
+TEST(Config, ParsePrintReparse)
+{
+    TempConfigFile file(
+        "# Test configuration\n"
+        "width = 346\n"
+        "height = 260\n"
+        "protocol = \"UDP\"\n"
+        "udp_packet_size = 8972\n"
+        "udp_sequence_header = true\n"
+        "stats_interval = 250\n"
+        "queue_full_policy = Block\n"
+        "\n"
+        "[[cameras]]\n"
+        "name = \"left\"\n"
+        "camera_port = 6001\n"
+        "cpus = [2, 3]\n"
+        "\n"
+        "[[output_sinks]]\n"
+        "name = \"recorder\"\n"
+        "port = 7777\n"
+        "queue_depth = 64\n");
+
+    Config cfg;
+    ASSERT_TRUE(loadConfigFile(file.path(), cfg));
+    EXPECT_EQ(cfg.width, 346);
+    EXPECT_EQ(cfg.height, 260);
+    EXPECT_EQ(cfg.protocol, Protocol::UDP);
+    EXPECT_EQ(cfg.udp_packet_size, 8972);
+    EXPECT_TRUE(cfg.udp_sequence_header);
+    EXPECT_EQ(cfg.stats_interval, 250);
+    EXPECT_EQ(cfg.queue_full_policy, QueueFullPolicy::Block);
+    ASSERT_EQ(cfg.cameras.size(), 1u);
+    EXPECT_EQ(cfg.cameras[0].name, "left");
+    EXPECT_EQ(cfg.cameras[0].camera_port, 6001);
+    EXPECT_EQ(cfg.cameras[0].cpus, (std::vector<int>{2, 3}));
+    ASSERT_EQ(cfg.output_sinks.size(), 1u);
+    EXPECT_EQ(cfg.output_sinks[0].name, "recorder");
+    EXPECT_EQ(cfg.output_sinks[0].port, 7777);
+    EXPECT_EQ(cfg.output_sinks[0].queue_depth, 64u);
+
+    // --print-config output loads back into the same configuration
+    const std::string printed = printConfig(cfg);
+    file.write(printed);
+    Config reparsed;
+    ASSERT_TRUE(loadConfigFile(file.path(), reparsed));
+    EXPECT_TRUE(diffConfig(cfg, reparsed).empty());
+    EXPECT_EQ(printConfig(reparsed), printed);
+
+    // So do the defaults
+    file.write(printConfig(Config{}));
+    Config defaults;
+    ASSERT_TRUE(loadConfigFile(file.path(), defaults));
+    EXPECT_TRUE(diffConfig(Config{}, defaults).empty());
+}
+
+TEST(Config, RejectsInvalidLines)
+{
+    Config cfg;
+    TempConfigFile file("no_such_setting = 1\n");
+    EXPECT_FALSE(loadConfigFile(file.path(), cfg));
+
+    file.write("width = wide\n");
+    EXPECT_FALSE(loadConfigFile(file.path(), cfg));
+
+    EXPECT_FALSE(setConfigValue(cfg, "queue_full_policy", "Sometimes"));
+    EXPECT_TRUE(setConfigValue(cfg, "udp-packet-size", "1400"));
+    EXPECT_EQ(cfg.udp_packet_size, 1400);
+}
+
+TEST(Config, CommandLineOverridesFile)
+{
+    TempConfigFile file("stats_interval = 250\nwidth = 640\nheight = 480\n");
+    const std::string config_arg = "--config=" + file.path();
+    std::vector<std::string> args = {"converter", config_arg, "--stats-interval=10", "--udp_sequence_header"};
+    std::vector<char*> argv;
+    for (std::string& arg : args) {
+        argv.push_back(arg.data());
+    }
+
+    CommandLine cli;
+    ASSERT_TRUE(parseCommandLine(static_cast<int>(argv.size()), argv.data(), cli));
+    EXPECT_EQ(cli.config_path, file.path());
+
+    Config cfg;
+    ASSERT_TRUE(loadConfig(cli, cfg));
+    EXPECT_EQ(cfg.stats_interval, 10);
+    EXPECT_EQ(cfg.width, 640);
+    EXPECT_TRUE(cfg.udp_sequence_header);
+}
+
+TEST(Config, ReloadDiff)
+{
+    Config running;
+    Config reloaded = running;
+    reloaded.stats_interval = running.stats_interval * 10;
+    reloaded.queue_full_policy = QueueFullPolicy::DropOldest;
+    reloaded.udp_packet_size = 1400;
+    reloaded.output_sinks.push_back(OutputSink{});
+    running.output_sinks.push_back(OutputSink{});
+    reloaded.output_sinks[0].full_policy = QueueFullPolicy::Block;
+
+    std::vector<ConfigChange> changes = diffConfig(running, reloaded);
+    ASSERT_EQ(changes.size(), 4u);
+
+    const ConfigChange* stats = findChange(changes, "stats_interval");
+    ASSERT_NE(stats, nullptr);
+    EXPECT_EQ(stats->old_value, std::to_string(running.stats_interval));
+    EXPECT_EQ(stats->new_value, std::to_string(reloaded.stats_interval));
+    EXPECT_TRUE(stats->reloadable);
+
+    const ConfigChange* policy = findChange(changes, "queue_full_policy");
+    ASSERT_NE(policy, nullptr);
+    EXPECT_TRUE(policy->reloadable);
+
+    const ConfigChange* packet = findChange(changes, "udp_packet_size");
+    ASSERT_NE(packet, nullptr);
+    EXPECT_EQ(packet->new_value, "1400");
+    EXPECT_FALSE(packet->reloadable);
+
+    const ConfigChange* sink = findChange(changes, "output_sinks[0].full_policy");
+    ASSERT_NE(sink, nullptr);
+    EXPECT_TRUE(sink->reloadable);
+
+    EXPECT_TRUE(isReloadableConfigKey("output_batch_latency_us"));
+    EXPECT_FALSE(isReloadableConfigKey("camera_port"));
+    EXPECT_TRUE(diffConfig(running, running).empty());
+}
+
+TEST(Config, ValidateRejectsUnsupportedValues)
+{
+    Config cfg;
+    EXPECT_TRUE(validateConfig(cfg));
+
+    Config header = cfg;
+    header.header_size = 8;
+    EXPECT_FALSE(validateConfig(header));
+    header.header_size = 2;
+    EXPECT_TRUE(validateConfig(header));
+
+    Config geometry = cfg;
+    geometry.width = 2;
+    EXPECT_FALSE(validateConfig(geometry));
+    geometry.width = 40000;
+    EXPECT_FALSE(validateConfig(geometry));
+    geometry.width = 32767;
+    geometry.height = 32767;
+    EXPECT_FALSE(validateConfig(geometry));
+    geometry.width = 346;
+    geometry.height = 260;
+    EXPECT_TRUE(validateConfig(geometry));
+}
+
+TEST(Config, WatcherReloadsEditedFile)
+{
+    TempConfigFile file("stats_interval = 250\n");
+    CommandLine cli;
+    cli.config_path = file.path();
+    ConfigWatcher watcher(cli);
+    ASSERT_TRUE(watcher.isEnabled());
+
+    Config loaded;
+    EXPECT_FALSE(watcher.poll(loaded));
+
+    file.write("stats_interval = 500\n");
+    std::filesystem::last_write_time(file.path(),
+                                     std::filesystem::last_write_time(file.path()) + std::chrono::seconds(2));
+    ASSERT_TRUE(watcher.poll(loaded));
+    EXPECT_EQ(loaded.stats_interval, 500);
+
+    // An invalid edit is skipped, not applied
+    file.write("header_size = 9\n");
+    std::filesystem::last_write_time(file.path(),
+                                     std::filesystem::last_write_time(file.path()) + std::chrono::seconds(4));
+    EXPECT_FALSE(watcher.poll(loaded));
+}
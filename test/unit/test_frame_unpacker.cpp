@@ -0,0 +1,227 @@
+#include "fixtures/test_frames.hpp"
+#include "frame_unpacker.hpp"
+#include "unpack_kernels.hpp"
+#include <gtest/gtest.h>
+#include <iterator>
+#include <string>
+#include <utility>
+#include <vector>
+
+using namespace converter;
+using converter::test::ExpectedEvent;
+using converter::test::decodeReference;
+using converter::test::makePackedFrame;
+
+namespace {
+
+constexpr UnpackKernel kKernels[] = {
+    UnpackKernel::Scalar, UnpackKernel::SSE41, UnpackKernel::AVX2, UnpackKernel::NEON, UnpackKernel::Sparse,
+};
+
+struct TestGeometry {
+    int width;
+    int height;
+};
+
+// Specialised sizes (multiple of 4 or not) and generic ones, including a
+// width that leaves the last byte of the frame padded
+constexpr TestGeometry kGeometries[] = {
+    {1280, 720}, {640, 480}, {346, 260}, {320, 240}, {97, 33}, {4, 1},
+};
+
+void expectEvents(const std::vector<ExpectedEvent>& expected, const dv::Event* events, size_t count,
+                  int64_t timestamp, const std::string& what)
+{
+    ASSERT_EQ(count, expected.size()) << what;
+    for (size_t i = 0; i < count; i++) {
+        ASSERT_EQ(events[i].x(), expected[i].x) << what << ", event " << i;
+        ASSERT_EQ(events[i].y(), expected[i].y) << what << ", event " << i;
+        ASSERT_EQ(events[i].polarity(), expected[i].polarity) << what << ", event " << i;
+        ASSERT_EQ(events[i].timestamp(), timestamp) << what << ", event " << i;
+    }
+}
+
+std::vector<dv::Event> toVector(const dv::EventStore& store)
+{
+    std::vector<dv::Event> events;
+    events.reserve(store.size());
+    for (const dv::Event& event : store) {
+        events.push_back(event);
+    }
+    return events;
+}
+
+std::string describe(UnpackKernel kernel, const TestGeometry& geometry, double density)
+{
+    return std::string(unpackKernelToString(kernel)) + " " + std::to_string(geometry.width) + "x"
+        + std::to_string(geometry.height) + " density " + std::to_string(density);
+}
+
+} // namespace
+
+TEST(UnpackKernels, MatchScalarReference)
+{
+    for (UnpackKernel kernel : kKernels) {
+        if (!isUnpackKernelSupported(kernel)) {
+            continue;
+        }
+        for (const TestGeometry& geometry : kGeometries) {
+            for (double density : {0.0, 0.001, 0.05, 0.5, 1.0}) {
+                std::vector<uint8_t> frame = makePackedFrame(geometry.width, geometry.height, density, 42);
+                std::vector<ExpectedEvent> expected = decodeReference(frame, geometry.width, geometry.height);
+                UnpackParams params(geometry.width, geometry.width * geometry.height, 1234);
+                std::vector<dv::Event> events(frame.size() * 4);
+
+                size_t generic = getUnpackKernel(kernel)(frame.data(), 0, frame.size(), params, events.data());
+                expectEvents(expected, events.data(), generic, 1234, describe(kernel, geometry, density) + " generic");
+
+                size_t chosen = getUnpackKernel(kernel, geometry.width, geometry.height)(
+                    frame.data(), 0, frame.size(), params, events.data());
+                expectEvents(expected, events.data(), chosen, 1234, describe(kernel, geometry, density) + " by geometry");
+            }
+        }
+    }
+}
+
+TEST(UnpackKernels, SubRangesDecodeLikeTheWholeFrame)
+{
+    const TestGeometry geometry{346, 260};
+    std::vector<uint8_t> frame = makePackedFrame(geometry.width, geometry.height, 0.2, 7);
+    std::vector<ExpectedEvent> all = decodeReference(frame, geometry.width, geometry.height);
+    UnpackParams params(geometry.width, geometry.width * geometry.height, 0);
+
+    for (UnpackKernel kernel : kKernels) {
+        if (!isUnpackKernelSupported(kernel)) {
+            continue;
+        }
+        UnpackKernelFn fn = getUnpackKernel(kernel, geometry.width, geometry.height);
+
+        // Odd split points, so ranges start mid-row and off SIMD block boundaries
+        std::vector<dv::Event> events(frame.size() * 4);
+        size_t count = 0;
+        const size_t splits[] = {0, 3, 37, 1000, 1001, 9999, frame.size()};
+        for (size_t i = 0; i + 1 < std::size(splits); i++) {
+            count += fn(frame.data(), splits[i], splits[i + 1], params, events.data() + count);
+        }
+        expectEvents(all, events.data(), count, 0, std::string(unpackKernelToString(kernel)) + " split");
+    }
+}
+
+TEST(UnpackKernels, SupportedGeometries)
+{
+    EXPECT_TRUE(UnpackParams::supportsGeometry(1280, 1280 * 720));
+    EXPECT_TRUE(UnpackParams::supportsGeometry(4, 4));
+    EXPECT_FALSE(UnpackParams::supportsGeometry(3, 3 * 100));
+    EXPECT_FALSE(UnpackParams::supportsGeometry(32767, 32767 * 32767));
+
+    EXPECT_TRUE(isUnpackGeometrySpecialized(1280, 720));
+    EXPECT_TRUE(isUnpackGeometrySpecialized(640, 480));
+    EXPECT_TRUE(isUnpackGeometrySpecialized(346, 260));
+    EXPECT_FALSE(isUnpackGeometrySpecialized(320, 240));
+}
+
+TEST(FrameUnpacker, DenseFrameMatchesReference)
+{
+    Config cfg;
+    cfg.width = 346;
+    cfg.height = 260;
+
+    // Single-threaded and split into row bands
+    for (int band_threads : {1, 3}) {
+        cfg.unpack_band_threads = band_threads;
+        cfg.parallel_density_threshold = 0.0;
+        FrameUnpacker unpacker(cfg);
+
+        std::vector<uint8_t> frame = makePackedFrame(cfg.width, cfg.height, 0.3, 11);
+        std::vector<ExpectedEvent> expected = decodeReference(frame, cfg.width, cfg.height);
+
+        dv::EventStore store;
+        size_t count = unpacker.unpackWithTimestamp(frame.data(), frame.size(), 5000, store);
+        ASSERT_EQ(count, expected.size());
+        ASSERT_EQ(store.size(), expected.size());
+        EXPECT_EQ(unpacker.lastFrameWasParallel(), band_threads > 1);
+
+        std::vector<dv::Event> events = toVector(store);
+        expectEvents(expected, events.data(), events.size(), 5000, "band threads " + std::to_string(band_threads));
+    }
+}
+
+TEST(FrameUnpacker, OccupancyBitmapSkipsClearUnits)
+{
+    Config cfg;
+    cfg.width = 346;
+    cfg.height = 260;
+    cfg.has_header = true;
+
+    // Events in a few rows only; 346 is not a multiple of 4, so bytes straddle rows
+    std::vector<uint8_t> dense = makePackedFrame(cfg.width, cfg.height, 0.5, 5);
+    std::vector<uint8_t> frame(dense.size(), 0);
+    for (int row : {0, 1, 63, 64, 130, 259}) {
+        for (int x = 0; x < cfg.width; x++) {
+            int pixel = row * cfg.width + x;
+            uint8_t shift = static_cast<uint8_t>(6 - 2 * (pixel % 4));
+            frame[static_cast<size_t>(pixel / 4)] |= dense[static_cast<size_t>(pixel / 4)] & (0x03 << shift);
+        }
+    }
+    std::vector<ExpectedEvent> expected = decodeReference(frame, cfg.width, cfg.height);
+
+    for (OccupancyMap map : {OccupancyMap::Rows, OccupancyMap::Blocks}) {
+        cfg.occupancy_map = map;
+        cfg.occupancy_block_bytes = 64;
+        FrameUnpacker unpacker(cfg);
+
+        // Exact bitmap: every unit holding an event is set
+        std::vector<uint8_t> occupancy(static_cast<size_t>(cfg.occupancy_map_bytes()), 0);
+        const size_t unit_bytes = map == OccupancyMap::Blocks ? 64 : 0;
+        for (const ExpectedEvent& event : expected) {
+            int pixel = event.y * cfg.width + event.x;
+            size_t unit = unit_bytes > 0 ? static_cast<size_t>(pixel / 4) / unit_bytes : static_cast<size_t>(event.y);
+            occupancy[unit / 8] |= static_cast<uint8_t>(1 << (unit % 8));
+        }
+
+        dv::EventStore store;
+        size_t count = unpacker.unpackWithTimestamp(frame.data(), frame.size(), 9, store, occupancy.data());
+        ASSERT_EQ(count, expected.size()) << occupancyMapToString(map);
+        std::vector<dv::Event> events = toVector(store);
+        expectEvents(expected, events.data(), events.size(), 9, occupancyMapToString(map));
+
+        // An empty bitmap reads nothing, even though the frame holds events
+        std::vector<uint8_t> empty(occupancy.size(), 0);
+        EXPECT_EQ(unpacker.unpackWithTimestamp(frame.data(), frame.size(), 9, store, empty.data()), 0u)
+            << occupancyMapToString(map);
+    }
+}
+
+TEST(FrameUnpacker, ByteListMatchesDenseFrame)
+{
+    Config cfg;
+    cfg.width = 640;
+    cfg.height = 480;
+    FrameUnpacker unpacker(cfg);
+
+    std::vector<uint8_t> frame = makePackedFrame(cfg.width, cfg.height, 0.002, 3);
+    std::vector<ExpectedEvent> expected = decodeReference(frame, cfg.width, cfg.height);
+
+    std::vector<uint8_t> payload;
+    for (size_t offset = 0; offset < frame.size(); offset++) {
+        if (frame[offset] != 0) {
+            uint32_t entry = static_cast<uint32_t>(offset) << 8 | frame[offset];
+            const uint8_t* bytes = reinterpret_cast<const uint8_t*>(&entry);
+            payload.insert(payload.end(), bytes, bytes + sizeof(entry));
+        }
+    }
+
+    dv::EventStore store;
+    size_t count = unpacker.unpackEncoded(payload.data(), payload.size(), FrameEncoding::ByteList, 77, store);
+    ASSERT_EQ(count, expected.size());
+
+    std::vector<dv::Event> events = toVector(store);
+    expectEvents(expected, events.data(), events.size(), 77, "ByteList");
+
+    // Offsets must be strictly increasing: a malformed payload yields nothing
+    std::swap(payload[0], payload[4]);
+    std::swap(payload[1], payload[5]);
+    std::swap(payload[2], payload[6]);
+    std::swap(payload[3], payload[7]);
+    EXPECT_EQ(unpacker.unpackEncoded(payload.data(), payload.size(), FrameEncoding::ByteList, 77, store), 0u);
+}
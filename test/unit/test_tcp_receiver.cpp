@@ -0,0 +1,162 @@
+#include "crc32c.hpp"
+#include "frame_pool.hpp"
+#include "tcp_receiver.hpp"
+#include <gtest/gtest.h>
+#include <arpa/inet.h>
+#include <netinet/in.h>
+#include <sys/socket.h>
+#include <unistd.h>
+#include <vector>
+
+using namespace converter;
+
+namespace {
+
+constexpr int kWidth = 64;
+constexpr int kHeight = 32;
+constexpr size_t kFrameBytes = kWidth * kHeight / 4;   // 512
+
+int nextPort()
+{
+    static int port = 47000 + static_cast<int>(getpid() % 1000) * 8;
+    return port++;
+}
+
+Config makeConfig(bool frame_crc)
+{
+    Config cfg;
+    cfg.protocol = Protocol::TCP;
+    cfg.width = kWidth;
+    cfg.height = kHeight;
+    cfg.camera_ip = "127.0.0.1";
+    cfg.camera_port = nextPort();
+    cfg.has_header = true;
+    cfg.header_size = 4;
+    cfg.frame_crc = frame_crc;
+    return cfg;
+}
+
+/**
+ * Client side of the camera link: writes size headers and payloads
+ */
+class StreamSender {
+public:
+    explicit StreamSender(const Config& cfg)
+        : socket_(::socket(AF_INET, SOCK_STREAM, 0))
+        , frame_crc_(cfg.frame_crc_header_bytes() > 0)
+    {
+        sockaddr_in addr{};
+        addr.sin_family = AF_INET;
+        addr.sin_port = htons(static_cast<uint16_t>(cfg.camera_port));
+        inet_pton(AF_INET, "127.0.0.1", &addr.sin_addr);
+        connected_ = ::connect(socket_, reinterpret_cast<const sockaddr*>(&addr), sizeof(addr)) == 0;
+    }
+
+    ~StreamSender() { close(socket_); }
+
+    bool isConnected() const { return connected_; }
+
+    void sendFrame(FrameEncoding encoding, const std::vector<uint8_t>& payload)
+    {
+        sendHeader((static_cast<uint32_t>(encoding) << kFrameEncodingShift) | static_cast<uint32_t>(payload.size()),
+                   crc32c(payload.data(), payload.size()));
+        sendBytes(payload.data(), payload.size());
+    }
+
+    // End of stream: a receiver that reads past the last frame sees the close instead of blocking
+    void finish() { ::shutdown(socket_, SHUT_WR); }
+
+    void sendHeader(uint32_t size_word, uint32_t crc)
+    {
+        const uint8_t size[4] = {static_cast<uint8_t>(size_word), static_cast<uint8_t>(size_word >> 8),
+                                 static_cast<uint8_t>(size_word >> 16), static_cast<uint8_t>(size_word >> 24)};
+        sendBytes(size, sizeof(size));  // Little-endian, see TcpReceiver::receiveFrameSize()
+        if (frame_crc_) {
+            sendBytes(&crc, sizeof(crc));   // Host byte order, like the receiver reads it
+        }
+    }
+
+private:
+    void sendBytes(const void* data, size_t size)
+    {
+        if (size > 0) {
+            ASSERT_EQ(::send(socket_, data, size, 0), static_cast<ssize_t>(size));
+        }
+    }
+
+    int socket_;
+    bool frame_crc_;
+    bool connected_ = false;
+};
+
+std::vector<uint8_t> makeDenseFrame()
+{
+    std::vector<uint8_t> frame(kFrameBytes);
+    for (size_t i = 0; i < frame.size(); i++) {
+        frame[i] = static_cast<uint8_t>(i * 13 + 5);
+    }
+    return frame;
+}
+
+} // namespace
+
+TEST(TcpReceiver, EmptyCompressedFrameKeepsStreamAligned)
+{
+    for (bool frame_crc : {false, true}) {
+        Config cfg = makeConfig(frame_crc);
+        TcpReceiver receiver(cfg);
+        ASSERT_TRUE(receiver.startListening());
+
+        StreamSender sender(cfg);
+        ASSERT_TRUE(sender.isConnected());
+        ASSERT_TRUE(receiver.connect());
+
+        const std::vector<uint8_t> dense = makeDenseFrame();
+        sender.sendFrame(FrameEncoding::ZeroRuns, {});
+        sender.sendFrame(FrameEncoding::ByteList, {});
+        sender.sendFrame(FrameEncoding::Dense, dense);
+        sender.finish();
+
+        FramePool pool(2, kFrameBytes);
+        FrameHandle frame = pool.tryAcquire();
+        ASSERT_TRUE(receiver.receiveFrame(frame));
+        EXPECT_EQ(frame.encoding(), FrameEncoding::ZeroRuns);
+        EXPECT_EQ(frame.size(), 0u);
+
+        std::vector<uint8_t> buffer;
+        ASSERT_TRUE(receiver.receiveFrame(buffer));
+        EXPECT_EQ(receiver.getLastFrameEncoding(), FrameEncoding::ByteList);
+        EXPECT_TRUE(buffer.empty());
+
+        ASSERT_TRUE(receiver.receiveFrame(frame));
+        EXPECT_EQ(frame.encoding(), FrameEncoding::Dense);
+        ASSERT_EQ(frame.size(), dense.size());
+        EXPECT_EQ(std::vector<uint8_t>(frame.data(), frame.data() + frame.size()), dense);
+
+        EXPECT_EQ(receiver.getTotalFramesReceived(), 3u);
+        EXPECT_EQ(receiver.getCrcErrors(), 0u);
+    }
+}
+
+TEST(TcpReceiver, UnknownEncodingResetsConnection)
+{
+    Config cfg = makeConfig(false);
+    TcpReceiver receiver(cfg);
+    ASSERT_TRUE(receiver.startListening());
+
+    StreamSender sender(cfg);
+    ASSERT_TRUE(sender.isConnected());
+    ASSERT_TRUE(receiver.connect());
+
+    // Encoding 7 does not exist: its payload length is unknown, so the
+    // dense frame after it must not be read as part of it
+    sender.sendHeader((uint32_t{7} << kFrameEncodingShift) | 16, 0);
+    sender.sendFrame(FrameEncoding::Dense, makeDenseFrame());
+    sender.finish();
+
+    std::vector<uint8_t> buffer;
+    EXPECT_FALSE(receiver.receiveFrame(buffer));
+    EXPECT_FALSE(receiver.isConnected());
+    EXPECT_EQ(receiver.getMalformedHeaders(), 1u);
+    EXPECT_EQ(receiver.getTotalFramesReceived(), 0u);
+}
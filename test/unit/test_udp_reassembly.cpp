@@ -0,0 +1,291 @@
+#include "udp_receiver.hpp"
+#include <gtest/gtest.h>
+#include <algorithm>
+#include <arpa/inet.h>
+#include <cstring>
+#include <netinet/in.h>
+#include <sys/socket.h>
+#include <unistd.h>
+#include <vector>
+
+using namespace converter;
+
+namespace {
+
+constexpr int kWidth = 64;
+constexpr int kHeight = 32;
+constexpr size_t kFrameBytes = kWidth * kHeight / 4;   // 512
+constexpr size_t kFragmentBytes = 128;
+constexpr uint16_t kFragments = kFrameBytes / kFragmentBytes;
+
+int nextPort()
+{
+    static int port = 46000 + static_cast<int>(getpid() % 1000) * 8;
+    return port++;
+}
+
+/**
+ * Frame whose bytes identify it and their offset
+ */
+std::vector<uint8_t> makeFrame(uint32_t frame_id)
+{
+    std::vector<uint8_t> frame(kFrameBytes);
+    for (size_t i = 0; i < frame.size(); i++) {
+        frame[i] = static_cast<uint8_t>(frame_id * 31 + i / kFragmentBytes * 7 + 1);
+    }
+    return frame;
+}
+
+/**
+ * Sends hand-picked fragments to a receiver on 127.0.0.1
+ */
+class FragmentSender {
+public:
+    explicit FragmentSender(int port)
+        : socket_(::socket(AF_INET, SOCK_DGRAM, 0))
+    {
+        addr_.sin_family = AF_INET;
+        addr_.sin_port = htons(static_cast<uint16_t>(port));
+        inet_pton(AF_INET, "127.0.0.1", &addr_.sin_addr);
+    }
+
+    ~FragmentSender() { close(socket_); }
+
+    void send(uint32_t frame_id, uint16_t fragment_index)
+    {
+        const std::vector<uint8_t> frame = makeFrame(frame_id);
+        const size_t offset = fragment_index * kFragmentBytes;
+
+        UdpFragmentHeader header;
+        header.frame_id = htonl(frame_id);
+        header.fragment_index = htons(fragment_index);
+        header.fragment_count = htons(kFragments);
+        header.frame_bytes = htonl(static_cast<uint32_t>(kFrameBytes));
+        header.fragment_offset = htonl(static_cast<uint32_t>(offset));
+
+        std::vector<uint8_t> datagram(sizeof(header) + kFragmentBytes);
+        std::memcpy(datagram.data(), &header, sizeof(header));
+        std::memcpy(datagram.data() + sizeof(header), frame.data() + offset, kFragmentBytes);
+        sendto(socket_, datagram.data(), datagram.size(), 0, reinterpret_cast<const sockaddr*>(&addr_), sizeof(addr_));
+    }
+
+    // Empty compressed frame: one datagram with just the header
+    void sendEmpty(uint32_t frame_id, FrameEncoding encoding)
+    {
+        UdpFragmentHeader header;
+        header.frame_id = htonl(frame_id);
+        header.fragment_index = htons(0);
+        header.fragment_count = htons(1);
+        header.frame_bytes = htonl(static_cast<uint32_t>(encoding) << kFrameEncodingShift);
+        header.fragment_offset = htonl(0);
+        sendto(socket_, &header, sizeof(header), 0, reinterpret_cast<const sockaddr*>(&addr_), sizeof(addr_));
+    }
+
+    void sendFrame(uint32_t frame_id)
+    {
+        for (uint16_t i = 0; i < kFragments; i++) {
+            send(frame_id, i);
+        }
+    }
+
+private:
+    int socket_;
+    sockaddr_in addr_{};
+};
+
+Config makeConfig(IncompleteFramePolicy policy)
+{
+    Config cfg;
+    cfg.protocol = Protocol::UDP;
+    cfg.width = kWidth;
+    cfg.height = kHeight;
+    cfg.camera_ip = "127.0.0.1";
+    cfg.camera_port = nextPort();
+    cfg.udp_sequence_header = true;
+    cfg.udp_packet_size = static_cast<int>(sizeof(UdpFragmentHeader) + kFragmentBytes);
+    cfg.udp_reorder_window = 4;
+    cfg.udp_frame_timeout_us = 2000;
+    cfg.udp_incomplete_policy = policy;
+    return cfg;
+}
+
+} // namespace
+
+TEST(UdpReassembly, OutOfOrderFragments)
+{
+    Config cfg = makeConfig(IncompleteFramePolicy::Drop);
+    UdpReceiver receiver(cfg);
+    ASSERT_TRUE(receiver.connect());
+    FragmentSender sender(cfg.camera_port);
+
+    // Two frames interleaved, each in reverse or shuffled fragment order
+    const uint16_t order_a[] = {3, 2, 1, 0};
+    const uint16_t order_b[] = {2, 0, 3, 1};
+    for (int i = 0; i < kFragments; i++) {
+        sender.send(0, order_a[i]);
+        sender.send(1, order_b[i]);
+    }
+    sender.sendFrame(2);
+
+    std::vector<uint8_t> frame;
+    for (uint32_t id = 0; id < 3; id++) {
+        ASSERT_TRUE(receiver.receiveFrame(frame));
+        EXPECT_EQ(frame, makeFrame(id)) << "frame " << id;
+    }
+
+    const UdpReassemblyStats& stats = receiver.getReassemblyStats();
+    EXPECT_EQ(stats.frames_completed, 3u);
+    EXPECT_EQ(stats.frames_dropped, 0u);
+    EXPECT_EQ(stats.fragments_lost, 0u);
+    EXPECT_GT(stats.fragments_reordered, 0u);
+}
+
+TEST(UdpReassembly, DuplicateFragmentsAreIgnored)
+{
+    Config cfg = makeConfig(IncompleteFramePolicy::Drop);
+    UdpReceiver receiver(cfg);
+    ASSERT_TRUE(receiver.connect());
+    FragmentSender sender(cfg.camera_port);
+
+    sender.send(0, 0);
+    sender.send(0, 1);
+    sender.send(0, 1);
+    sender.send(0, 2);
+    sender.send(0, 3);
+    sender.sendFrame(1);
+
+    std::vector<uint8_t> frame;
+    ASSERT_TRUE(receiver.receiveFrame(frame));
+    EXPECT_EQ(frame, makeFrame(0));
+    ASSERT_TRUE(receiver.receiveFrame(frame));
+    EXPECT_EQ(frame, makeFrame(1));
+    EXPECT_EQ(receiver.getReassemblyStats().fragments_duplicate, 1u);
+}
+
+TEST(UdpReassembly, LostFragmentDropsFrame)
+{
+    Config cfg = makeConfig(IncompleteFramePolicy::Drop);
+    UdpReceiver receiver(cfg);
+    ASSERT_TRUE(receiver.connect());
+    FragmentSender sender(cfg.camera_port);
+
+    sender.sendFrame(0);
+    sender.send(1, 0);
+    sender.send(1, 1);
+    sender.send(1, 3);
+    sender.sendFrame(2);
+
+    std::vector<uint8_t> frame;
+    ASSERT_TRUE(receiver.receiveFrame(frame));
+    EXPECT_EQ(frame, makeFrame(0));
+    ASSERT_TRUE(receiver.receiveFrame(frame));
+    EXPECT_EQ(frame, makeFrame(2));
+
+    const UdpReassemblyStats& stats = receiver.getReassemblyStats();
+    EXPECT_EQ(stats.frames_completed, 2u);
+    EXPECT_EQ(stats.frames_dropped, 1u);
+    EXPECT_EQ(stats.fragments_lost, 1u);
+}
+
+TEST(UdpReassembly, LostFragmentZeroFilled)
+{
+    Config cfg = makeConfig(IncompleteFramePolicy::ZeroFill);
+    UdpReceiver receiver(cfg);
+    ASSERT_TRUE(receiver.connect());
+    FragmentSender sender(cfg.camera_port);
+
+    sender.send(0, 3);
+    sender.send(0, 0);
+    sender.send(0, 1);
+    sender.sendFrame(1);
+
+    std::vector<uint8_t> expected = makeFrame(0);
+    std::fill(expected.begin() + 2 * kFragmentBytes, expected.begin() + 3 * kFragmentBytes, 0);
+
+    std::vector<uint8_t> frame;
+    ASSERT_TRUE(receiver.receiveFrame(frame));
+    EXPECT_EQ(frame, expected);
+    ASSERT_TRUE(receiver.receiveFrame(frame));
+    EXPECT_EQ(frame, makeFrame(1));
+
+    const UdpReassemblyStats& stats = receiver.getReassemblyStats();
+    EXPECT_EQ(stats.frames_zero_filled, 1u);
+    EXPECT_EQ(stats.frames_completed, 1u);
+    EXPECT_EQ(stats.fragments_lost, 1u);
+}
+
+TEST(UdpReassembly, SkippedFrameIdsCountAsMissing)
+{
+    Config cfg = makeConfig(IncompleteFramePolicy::Drop);
+    UdpReceiver receiver(cfg);
+    ASSERT_TRUE(receiver.connect());
+    FragmentSender sender(cfg.camera_port);
+
+    sender.sendFrame(0);
+    sender.sendFrame(3);
+
+    std::vector<uint8_t> frame;
+    ASSERT_TRUE(receiver.receiveFrame(frame));
+    EXPECT_EQ(frame, makeFrame(0));
+    ASSERT_TRUE(receiver.receiveFrame(frame));
+    EXPECT_EQ(frame, makeFrame(3));
+    EXPECT_EQ(receiver.getReassemblyStats().frames_missing, 2u);
+}
+
+TEST(UdpReassembly, EmptyCompressedFrame)
+{
+    Config cfg = makeConfig(IncompleteFramePolicy::Drop);
+    UdpReceiver receiver(cfg);
+    ASSERT_TRUE(receiver.connect());
+    FragmentSender sender(cfg.camera_port);
+
+    sender.sendFrame(0);
+    sender.sendEmpty(1, FrameEncoding::ZeroRuns);
+    sender.sendEmpty(1, FrameEncoding::ZeroRuns);
+    sender.sendEmpty(2, FrameEncoding::ByteList);
+    sender.sendFrame(3);
+    // Spare frames: a receiver that loses the empty ones fails the checks below instead of waiting
+    sender.sendFrame(4);
+    sender.sendFrame(5);
+
+    std::vector<uint8_t> frame;
+    ASSERT_TRUE(receiver.receiveFrame(frame));
+    EXPECT_EQ(frame, makeFrame(0));
+
+    ASSERT_TRUE(receiver.receiveFrame(frame));
+    EXPECT_TRUE(frame.empty());
+    EXPECT_EQ(receiver.getLastFrameEncoding(), FrameEncoding::ZeroRuns);
+
+    ASSERT_TRUE(receiver.receiveFrame(frame));
+    EXPECT_TRUE(frame.empty());
+    EXPECT_EQ(receiver.getLastFrameEncoding(), FrameEncoding::ByteList);
+
+    ASSERT_TRUE(receiver.receiveFrame(frame));
+    EXPECT_EQ(frame, makeFrame(3));
+    EXPECT_EQ(receiver.getLastFrameEncoding(), FrameEncoding::Dense);
+
+    const UdpReassemblyStats& stats = receiver.getReassemblyStats();
+    EXPECT_GE(stats.frames_completed, 4u);
+    EXPECT_EQ(stats.frames_missing, 0u);
+    EXPECT_EQ(stats.fragments_malformed, 0u);
+    // The repeated datagram is a duplicate, or late if frame 1 went out first
+    EXPECT_EQ(stats.fragments_duplicate + stats.fragments_late, 1u);
+}
+
+TEST(UdpReassembly, HeaderOnlyDenseFragmentIsMalformed)
+{
+    Config cfg = makeConfig(IncompleteFramePolicy::Drop);
+    UdpReceiver receiver(cfg);
+    ASSERT_TRUE(receiver.connect());
+    FragmentSender sender(cfg.camera_port);
+
+    // Only an empty compressed frame may come without payload bytes
+    sender.sendEmpty(0, FrameEncoding::Dense);
+    sender.sendFrame(0);
+    sender.sendFrame(1);
+
+    std::vector<uint8_t> frame;
+    ASSERT_TRUE(receiver.receiveFrame(frame));
+    EXPECT_EQ(frame, makeFrame(0));
+    EXPECT_EQ(receiver.getReassemblyStats().fragments_malformed, 1u);
+}
@@ -11,6 +11,8 @@ Usage:
     pip install dv-processing opencv-python numpy
     python viewer.py
     python viewer.py --port 7777 --host 127.0.0.1
+    python viewer.py --shm dvbridge     # same host, shm_output_name = "dvbridge"
+    python viewer.py --frames --port 7790   # accumulated frames, frame_output_port = 7790
 
 Controls:
     Q or ESC: Quit
@@ -23,6 +25,9 @@ Controls:
 import cv2
 import numpy as np
 import argparse
+import mmap
+import os
+import struct
 import time
 import sys
 from collections import deque
@@ -30,15 +35,109 @@ from collections import deque
 try:
     import dv_processing as dv
 except ImportError:
-    print("Error: dv-processing not installed")
-    print("Install with: pip install dv-processing")
-    sys.exit(1)
+    dv = None  # Only needed for the network connection
+
+
+# Shared-memory ring written by DVBridge (shm_output_name, see shm_ring.hpp)
+SHM_MAGIC = 0x52425644  # "DVBR"
+SHM_VERSION = 1
+SHM_HEADER = struct.Struct("<IIIIQIIQ")  # magic, version, header/record bytes, capacity, width, height, session
+SHM_WRITE_INDEX_OFFSET = 64
+SHM_RESERVE_INDEX_OFFSET = 72
+SHM_RECORD_DTYPE = np.dtype([("timestamp", "<i8"), ("x", "<i2"), ("y", "<i2"),
+                             ("polarity", "u1"), ("reserved", "u1", 3)])
+
+
+class ShmEventBatch:
+    """Events read from the ring, with the dv.EventStore calls the viewer uses"""
+
+    def __init__(self, records):
+        self.records = records
+
+    def __len__(self):
+        return len(self.records)
+
+    def coordinates(self):
+        return np.stack((self.records["x"], self.records["y"]), axis=1)
+
+    def polarities(self):
+        return self.records["polarity"] != 0
+
+
+class ShmEventReader:
+    """Reads DVBridge's shared-memory event ring (no network, no dv-processing)
+
+    Starts at the newest event. Records are copied out and then checked
+    against the writer's reserve index: any the writer may have overwritten
+    during the copy are dropped and counted as lost.
+    """
+
+    def __init__(self, name, max_batch=1 << 20):
+        self.path = os.path.join("/dev/shm", name.lstrip("/"))
+        self.max_batch = max_batch
+        self.lost = 0
+        self.mm = None
+        self.open()
+
+    def open(self):
+        with open(self.path, "rb") as f:
+            self.inode = os.fstat(f.fileno()).st_ino
+            self.mm = mmap.mmap(f.fileno(), 0, access=mmap.ACCESS_READ)
+        magic, version, header_bytes, record_bytes, capacity, width, height, _ = \
+            SHM_HEADER.unpack_from(self.mm, 0)
+        if magic != SHM_MAGIC or version != SHM_VERSION or record_bytes != SHM_RECORD_DTYPE.itemsize:
+            raise RuntimeError(f"{self.path} is not a DVBridge event ring (version {SHM_VERSION})")
+        self.capacity = capacity
+        self.width = width
+        self.height = height
+        self.records = np.frombuffer(self.mm, dtype=SHM_RECORD_DTYPE, count=capacity, offset=header_bytes)
+        self.read_index = self._index(SHM_WRITE_INDEX_OFFSET)
+
+    def _index(self, offset):
+        return struct.unpack_from("<Q", self.mm, offset)[0]
+
+    def _oldest_intact(self):
+        return max(0, self._index(SHM_RESERVE_INDEX_OFFSET) - self.capacity)
+
+    def _reopen_if_replaced(self):
+        try:
+            if os.stat(self.path).st_ino != self.inode:
+                self.open()
+                print("DVBridge restarted, reopened shared memory")
+        except (OSError, RuntimeError):
+            pass  # Converter not running; keep the old mapping until it is back
+
+    def getNextEventBatch(self):
+        written = self._index(SHM_WRITE_INDEX_OFFSET)
+        oldest = self._oldest_intact()
+        if self.read_index < oldest:
+            self.lost += oldest - self.read_index
+            self.read_index = oldest
+        count = min(written - self.read_index, self.max_batch)
+        if count <= 0:
+            self._reopen_if_replaced()
+            return None
+
+        first = self.read_index % self.capacity
+        if first + count <= self.capacity:
+            batch = self.records[first:first + count].copy()
+        else:
+            batch = np.concatenate((self.records[first:], self.records[:first + count - self.capacity]))
+
+        # Drop whatever the writer may have overwritten while we copied
+        torn = max(0, min(count, self._oldest_intact() - self.read_index))
+        self.read_index += count
+        self.lost += torn
+        return ShmEventBatch(batch[torn:]) if torn < count else None
 
 
 class EventVisualizer:
-    def __init__(self, host="127.0.0.1", port=7777, width=1280, height=720):
+    def __init__(self, host="127.0.0.1", port=7777, width=1280, height=720, shm=None, frames=False):
         self.host = host
         self.port = port
+        self.shm = shm
+        self.frames = frames
+        self.latest_frame = None  # Last image from the frame output (--frames)
         self.width = width
         self.height = height
         
@@ -64,6 +163,21 @@ class EventVisualizer:
         
     def connect(self):
         """Connect to DVBridge"""
+        if self.shm:
+            print(f"Opening DVBridge shared memory '{self.shm}'...")
+            try:
+                self.reader = ShmEventReader(self.shm)
+                print(f"Opened! ({self.reader.width}x{self.reader.height}, "
+                      f"{self.reader.capacity:,} event ring)")
+                return True
+            except (OSError, RuntimeError) as e:
+                print(f"Failed to open: {e}")
+                return False
+
+        if dv is None:
+            print("Error: dv-processing not installed")
+            print("Install with: pip install dv-processing")
+            return False
         print(f"Connecting to DVBridge at {self.host}:{self.port}...")
         try:
             self.reader = dv.io.NetworkReader(self.host, self.port)
@@ -114,8 +228,23 @@ class EventVisualizer:
         
         return num_events
     
+    def process_frame(self, frame):
+        """Keep an image accumulated by DVBridge (frame output), no drawing needed"""
+        if frame is None:
+            return
+        image = frame.image
+        if image.ndim == 2:
+            image = cv2.cvtColor(image, cv2.COLOR_GRAY2BGR)
+        self.latest_frame = image
+        self.frame_count += 1
+
     def get_display_frame(self):
         """Convert accumulated events to RGB display frame"""
+        if self.frames:
+            if self.latest_frame is None:
+                return np.zeros((self.height, self.width, 3), dtype=np.uint8)
+            return self.latest_frame.copy()
+
         frame = np.zeros((self.height, self.width, 3), dtype=np.uint8)
         
         # Green channel for positive events
@@ -230,13 +359,18 @@ class EventVisualizer:
         
         try:
             while True:
-                # Get events from DVBridge (non-blocking batches)
-                events = self.reader.getNextEventBatch()
-                
-                if events is not None:
-                    batch_events = self.process_events(events)
-                else:
+                if self.frames:
+                    # Images are already accumulated by DVBridge
+                    self.process_frame(self.reader.getNextFrame())
                     batch_events = 0
+                else:
+                    # Get events from DVBridge (non-blocking batches)
+                    events = self.reader.getNextEventBatch()
+
+                    if events is not None:
+                        batch_events = self.process_events(events)
+                    else:
+                        batch_events = 0
                 
                 # Update statistics
                 self.update_stats(batch_events)
@@ -285,6 +419,8 @@ class EventVisualizer:
             print(f"{'='*50}")
             print(f"  Duration: {elapsed:.1f} seconds")
             print(f"  Total events: {self.total_events:,}")
+            if self.shm:
+                print(f"  Lost events (ring overrun): {self.reader.lost:,}")
             if elapsed > 0:
                 avg_rate = self.total_events / elapsed
                 print(f"  Average events/sec: {avg_rate:,.0f}")
@@ -302,6 +438,10 @@ def main():
                         help="Frame width (default: 1280)")
     parser.add_argument("--height", type=int, default=720,
                         help="Frame height (default: 720)")
+    parser.add_argument("--shm", type=str, default=None,
+                        help="Read DVBridge's shared-memory ring (shm_output_name) instead of the network")
+    parser.add_argument("--frames", action="store_true",
+                        help="Show the accumulated frames of DVBridge's frame output (--port = frame_output_port)")
     args = parser.parse_args()
     
     print("=" * 50)
@@ -312,7 +452,9 @@ def main():
         host=args.host,
         port=args.port,
         width=args.width,
-        height=args.height
+        height=args.height,
+        shm=args.shm,
+        frames=args.frames
     )
     visualizer.run()
 